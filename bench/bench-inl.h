@@ -0,0 +1,49 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+namespace wasp {
+namespace bench {
+
+template <typename F>
+void Runner::Run(string_view name, std::size_t bytes, F&& f) {
+  if (!Matches(name)) {
+    return;
+  }
+
+  using Clock = std::chrono::steady_clock;
+  u64 iterations = 0;
+  u64 batch = 1;
+  double seconds = 0;
+  auto start = Clock::now();
+  do {
+    for (u64 i = 0; i < batch; ++i) {
+      f();
+    }
+    iterations += batch;
+    batch *= 2;
+    seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  } while (seconds < options_.min_seconds);
+
+  Report(name, iterations, seconds, bytes);
+}
+
+template <typename T>
+void DoNotOptimize(const T& value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+}  // namespace bench
+}  // namespace wasp
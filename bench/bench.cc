@@ -0,0 +1,128 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "bench/bench.h"
+
+#include <string>
+#include <utility>
+
+#include "wasp/base/format.h"
+
+namespace wasp {
+namespace bench {
+
+namespace {
+
+std::vector<std::pair<string_view, BenchmarkFunction>>& GetRegistry() {
+  static std::vector<std::pair<string_view, BenchmarkFunction>> registry;
+  return registry;
+}
+
+}  // namespace
+
+Registration::Registration(string_view name, BenchmarkFunction function) {
+  GetRegistry().emplace_back(name, function);
+}
+
+void RunAll(Runner& runner) {
+  for (auto& pair : GetRegistry()) {
+    pair.second(runner);
+  }
+}
+
+Runner::Runner(const Options& options) : options_{options} {}
+
+bool Runner::Matches(string_view name) const {
+  return options_.filter.empty() ||
+         name.find(options_.filter) != string_view::npos;
+}
+
+void Runner::Report(string_view name,
+                    u64 iterations,
+                    double seconds,
+                    std::size_t bytes) {
+  double ns_per_iter = seconds * 1e9 / iterations;
+  results_.push_back(Result{name.to_string(), iterations, ns_per_iter, bytes});
+  if (options_.format != Format::Text) {
+    return;
+  }
+
+  print("{:<48} {:>10} {:>14.1f} ns", name, iterations, ns_per_iter);
+  if (bytes != 0) {
+    print(" {:>10.1f} MB/s", bytes * iterations / seconds / (1024 * 1024));
+  }
+  print("\n");
+}
+
+void Runner::Finish() {
+  if (options_.format != Format::Json) {
+    return;
+  }
+
+  // Benchmark names are plain identifiers separated by '/', so they need no
+  // escaping.
+  print("{{\n  \"benchmarks\": [");
+  string_view separator = "";
+  for (const auto& result : results_) {
+    print("{}\n    {{\"name\": \"{}\", \"iterations\": {}, "
+          "\"ns_per_iteration\": {:.1f}",
+          separator, result.name, result.iterations, result.ns_per_iteration);
+    if (result.bytes != 0) {
+      print(", \"bytes_per_iteration\": {}, \"mb_per_second\": {:.1f}",
+            result.bytes,
+            result.bytes * 1e9 / result.ns_per_iteration / (1024 * 1024));
+    }
+    print("}}");
+    separator = ",";
+  }
+  print("\n  ]\n}}\n");
+}
+
+}  // namespace bench
+}  // namespace wasp
+
+using namespace ::wasp;
+using namespace ::wasp::bench;
+
+int main(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    string_view arg = argv[i];
+    if (arg == "--filter" && i + 1 < argc) {
+      options.filter = argv[++i];
+    } else if (arg == "--min-time" && i + 1 < argc) {
+      options.min_seconds = std::stod(argv[++i]);
+    } else if (arg == "--format" && i + 1 < argc &&
+               string_view{argv[i + 1]} == "text") {
+      options.format = Format::Text;
+      ++i;
+    } else if (arg == "--format" && i + 1 < argc &&
+               string_view{argv[i + 1]} == "json") {
+      options.format = Format::Json;
+      ++i;
+    } else {
+      print(stderr,
+            "Usage: wasp_bench [--filter <substr>] [--min-time <s>] "
+            "[--format text|json]\n");
+      return 1;
+    }
+  }
+
+  Runner runner{options};
+  RunAll(runner);
+  runner.Finish();
+  return 0;
+}
@@ -0,0 +1,95 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BENCH_BENCH_H_
+#define WASP_BENCH_BENCH_H_
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "wasp/base/string_view.h"
+#include "wasp/base/types.h"
+
+namespace wasp {
+namespace bench {
+
+enum class Format {
+  Text,  // One aligned line per benchmark, printed as it finishes.
+  Json,  // A single JSON object, printed once all benchmarks have run.
+};
+
+struct Options {
+  string_view filter;
+  double min_seconds = 0.25;
+  Format format = Format::Text;
+};
+
+struct Result {
+  std::string name;
+  u64 iterations;
+  double ns_per_iteration;
+  std::size_t bytes;  // Per iteration; 0 if not reported.
+};
+
+class Runner {
+ public:
+  explicit Runner(const Options&);
+
+  // Calls |f| repeatedly until at least |min_seconds| have elapsed, then
+  // reports the mean time per call. |bytes| is the amount of input processed
+  // by each call, used to report throughput; pass 0 to omit it.
+  template <typename F>
+  void Run(string_view name, std::size_t bytes, F&& f);
+
+  // Prints anything that is only written once all benchmarks have run.
+  void Finish();
+
+  const std::vector<Result>& results() const { return results_; }
+
+ private:
+  bool Matches(string_view name) const;
+  void Report(string_view name, u64 iterations, double seconds,
+              std::size_t bytes);
+
+  Options options_;
+  std::vector<Result> results_;
+};
+
+using BenchmarkFunction = void (*)(Runner&);
+
+struct Registration {
+  Registration(string_view name, BenchmarkFunction);
+};
+
+void RunAll(Runner&);
+
+// Prevents the compiler from discarding a computed value.
+template <typename T>
+void DoNotOptimize(const T& value);
+
+}  // namespace bench
+}  // namespace wasp
+
+#define WASP_BENCHMARK(name)                                             \
+  static void name(::wasp::bench::Runner&);                              \
+  static ::wasp::bench::Registration name##_registration{#name, name}; \
+  static void name(::wasp::bench::Runner& runner)
+
+#include "bench/bench-inl.h"
+
+#endif  // WASP_BENCH_BENCH_H_
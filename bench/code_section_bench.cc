@@ -0,0 +1,117 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <vector>
+
+#include "bench/bench.h"
+#include "wasp/base/features.h"
+#include "wasp/binary/errors.h"
+#include "wasp/binary/errors_nop.h"
+#include "wasp/binary/lazy_code_section.h"
+#include "wasp/binary/lazy_expression.h"
+
+namespace {
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+
+// Ignores everything, but through the virtual handlers; this is what
+// ErrorsNop cost before it discarded errors inline.
+class ErrorsVirtualNop : public Errors {
+ protected:
+  void HandlePushContext(SpanU8 pos, string_view desc) override {}
+  void HandlePopContext() override {}
+  void HandleOnError(SpanU8 pos, string_view message) override {}
+};
+
+// Tracks the context stack, as a diagnostic Errors would.
+class ErrorsTracking : public Errors {
+ protected:
+  void HandlePushContext(SpanU8 pos, string_view desc) override {
+    context.push_back(desc);
+  }
+  void HandlePopContext() override { context.pop_back(); }
+  void HandleOnError(SpanU8 pos, string_view message) override {}
+
+  std::vector<string_view> context;
+};
+
+// The contents of a code section with |count| functions, each with a mix of
+// instructions.
+std::vector<u8> MakeCodeSection(u32 count) {
+  std::vector<u8> body;
+  body.push_back(0);  // No locals.
+  for (int i = 0; i < 20; ++i) {
+    body.insert(body.end(), {
+        0x20, 0x00,              // local.get 0
+        0x41, 0xe8, 0x07,        // i32.const 1000
+        0x6a,                    // i32.add
+        0x28, 0x02, 0x10,        // i32.load align=2 offset=16
+        0x10, 0x01,              // call 1
+        0x1a,                    // drop
+    });
+  }
+  body.push_back(0x0b);  // end
+
+  // Both the count and the body size fit in a two-byte LEB128.
+  auto push_u32 = [](std::vector<u8>& out, u32 value) {
+    out.push_back(static_cast<u8>(0x80 | (value & 0x7f)));
+    out.push_back(static_cast<u8>(value >> 7));
+  };
+
+  std::vector<u8> section;
+  push_u32(section, count);
+  for (u32 i = 0; i < count; ++i) {
+    push_u32(section, body.size());
+    section.insert(section.end(), body.begin(), body.end());
+  }
+  return section;
+}
+
+u32 DecodeCodeSection(SpanU8 data, const Features& features, Errors& errors) {
+  u32 count = 0;
+  for (const auto& code : ReadCodeSection(data, features, errors).sequence) {
+    for (const auto& instr : ReadExpression(code.body, features, errors)) {
+      count += static_cast<u32>(instr.opcode);
+    }
+  }
+  return count;
+}
+
+}  // namespace
+
+// Decoding every instruction in a code section, with errors discarded inline,
+// discarded through virtual calls, and tracked.
+WASP_BENCHMARK(CodeSectionBenchmarks) {
+  Features features;
+  auto section = MakeCodeSection(500);
+  SpanU8 data{section};
+
+  runner.Run("code_section/decode/errors_nop", section.size(), [&]() {
+    ErrorsNop errors;
+    bench::DoNotOptimize(DecodeCodeSection(data, features, errors));
+  });
+
+  runner.Run("code_section/decode/errors_virtual_nop", section.size(), [&]() {
+    ErrorsVirtualNop errors;
+    bench::DoNotOptimize(DecodeCodeSection(data, features, errors));
+  });
+
+  runner.Run("code_section/decode/errors_tracking", section.size(), [&]() {
+    ErrorsTracking errors;
+    bench::DoNotOptimize(DecodeCodeSection(data, features, errors));
+  });
+}
@@ -0,0 +1,79 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <iterator>
+#include <vector>
+
+#include "bench/bench.h"
+#include "bench/synthetic_module.h"
+#include "wasp/base/features.h"
+#include "wasp/base/file.h"
+#include "wasp/binary/errors_nop.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/write/write_var_int.h"
+
+namespace {
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+
+// A module with a tiny type section followed by a large custom section, so
+// the first section is available long before the end of the file.
+std::vector<u8> MakeLargeModule(u32 custom_size) {
+  std::vector<u8> data{0, 'a', 's', 'm', 1, 0, 0, 0};
+  // Type section: 1 type, () -> ().
+  data.insert(data.end(), {1, 4, 1, 0x60, 0, 0});
+  // Custom section "big".
+  data.push_back(0);
+  WriteVarInt(custom_size + 4, std::back_inserter(data));
+  data.insert(data.end(), {3, 'b', 'i', 'g'});
+  data.resize(data.size() + custom_size, 0xcc);
+  return data;
+}
+
+template <typename F>
+void FirstSection(SpanU8 data, F&& f) {
+  Features features;
+  ErrorsNop errors;
+  auto module = ReadModule(data, features, errors);
+  auto it = module.sections.begin();
+  if (it != module.sections.end()) {
+    f(*it);
+  }
+}
+
+}  // namespace
+
+// Time from opening a file to having its first section in hand, comparing
+// memory-mapping against reading the whole file into a vector.
+WASP_BENCHMARK(FileBenchmarks) {
+  const u32 kCustomSize = 16 * 1024 * 1024;
+  auto module_data = MakeLargeModule(kCustomSize);
+  bench::TempFile file{module_data};
+  auto size = module_data.size();
+
+  runner.Run("file/first_section/read_file", size, [&]() {
+    auto optbuf = ReadFile(file.filename());
+    FirstSection(SpanU8{*optbuf},
+                 [](const Section& section) { bench::DoNotOptimize(section); });
+  });
+
+  runner.Run("file/first_section/map_file", size, [&]() {
+    auto optfile = MapFile(file.filename());
+    FirstSection(optfile->data(),
+                 [](const Section& section) { bench::DoNotOptimize(section); });
+  });
+}
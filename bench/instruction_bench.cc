@@ -0,0 +1,139 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <vector>
+
+#include "bench/bench.h"
+#include "wasp/base/features.h"
+#include "wasp/binary/compact_instruction.h"
+#include "wasp/binary/encoding/opcode_encoding.h"
+#include "wasp/binary/errors_nop.h"
+#include "wasp/binary/lazy_expression.h"
+#include "wasp/binary/opcode_info.h"
+#include "wasp/binary/opcode_scanner.h"
+
+namespace {
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+
+// A function body with a mix of instructions, including a br_table.
+std::vector<u8> MakeBody(int repeat) {
+  std::vector<u8> body;
+  for (int i = 0; i < repeat; ++i) {
+    body.insert(body.end(), {
+        0x02, 0x40,              // block
+        0x20, 0x00,              // local.get 0
+        0x41, 0xe8, 0x07,        // i32.const 1000
+        0x6a,                    // i32.add
+        0x28, 0x02, 0x10,        // i32.load align=2 offset=16
+        0x0e, 0x03, 0, 0, 0, 0,  // br_table 0 0 0 0
+        0x0b,                    // end
+    });
+  }
+  body.push_back(0x0b);  // end
+  return body;
+}
+
+// Every opcode, as the (prefix, code) pair it is encoded as. Single-byte
+// opcodes have no prefix.
+std::vector<encoding::EncodedOpcode> MakeEncodedOpcodes(int repeat) {
+  std::vector<encoding::EncodedOpcode> encoded;
+  for (int i = 0; i < repeat; ++i) {
+    for (u32 opcode = 0; GetOpcodeInfo(static_cast<Opcode>(opcode));
+         ++opcode) {
+      encoded.push_back(encoding::Opcode::Encode(static_cast<Opcode>(opcode)));
+    }
+  }
+  return encoded;
+}
+
+}  // namespace
+
+// Walking a function body many times: re-decoding each time, decoding once
+// into a CompactExpression, and scanning for a single opcode.
+WASP_BENCHMARK(InstructionBenchmarks) {
+  Features features;
+  ErrorsNop errors;
+  auto body = MakeBody(10000);
+  Expression expr{SpanU8{body}};
+  const int kPasses = 4;
+
+  runner.Run("instruction/iterate/lazy", body.size() * kPasses, [&]() {
+    u32 count = 0;
+    for (int pass = 0; pass < kPasses; ++pass) {
+      for (const auto& instr : ReadExpression(expr, features, errors)) {
+        count += static_cast<u32>(instr.opcode);
+      }
+    }
+    bench::DoNotOptimize(count);
+  });
+
+  CompactExpression compact;
+  runner.Run("instruction/iterate/compact", body.size() * kPasses, [&]() {
+    ReadCompactExpression(expr, features, errors, &compact);
+    u32 count = 0;
+    for (int pass = 0; pass < kPasses; ++pass) {
+      for (const auto& instr : compact.instructions) {
+        count += static_cast<u32>(instr.opcode());
+      }
+    }
+    bench::DoNotOptimize(count);
+  });
+
+  const OpcodeSet loads{Opcode::I32Load};
+  runner.Run("instruction/iterate/scan_loads", body.size() * kPasses, [&]() {
+    u32 count = 0;
+    for (int pass = 0; pass < kPasses; ++pass) {
+      OpcodeScanner scanner{expr.data, loads, features, errors};
+      while (auto scanned = scanner.Next()) {
+        count += scanned->instruction.mem_arg_immediate().offset;
+      }
+    }
+    bench::DoNotOptimize(count);
+  });
+}
+
+// Decoding opcodes with the switches in opcode_encoding.h versus the lookup
+// tables built from opcode.def.
+WASP_BENCHMARK(OpcodeBenchmarks) {
+  Features features;
+  features.EnableAll();
+  auto encoded = MakeEncodedOpcodes(100);
+
+  runner.Run("instruction/opcode/switch", encoded.size(), [&]() {
+    u32 count = 0;
+    for (const auto& code : encoded) {
+      auto opcode =
+          code.u32_code
+              ? encoding::Opcode::Decode(code.u8_code, *code.u32_code, features)
+              : encoding::Opcode::Decode(code.u8_code, features);
+      count += static_cast<u32>(*opcode);
+    }
+    bench::DoNotOptimize(count);
+  });
+
+  runner.Run("instruction/opcode/table", encoded.size(), [&]() {
+    u32 count = 0;
+    for (const auto& code : encoded) {
+      auto info = code.u32_code
+                      ? DecodeOpcode(code.u8_code, *code.u32_code, features)
+                      : DecodeOpcode(code.u8_code, features);
+      count += static_cast<u32>(info->opcode);
+    }
+    bench::DoNotOptimize(count);
+  });
+}
@@ -0,0 +1,86 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <vector>
+
+#include "bench/bench.h"
+#include "wasp/base/features.h"
+#include "wasp/binary/errors_nop.h"
+#include "wasp/binary/read/read_var_int.h"
+#include "wasp/binary/read/read_var_u32s.h"
+
+namespace {
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+
+// |count| LEB128-encoded u32s. Every |wide_every|th value takes 3 bytes, the
+// rest take one, as with the indexes in typical function sections and
+// br_tables.
+std::vector<u8> MakeVarU32s(u32 count, u32 wide_every) {
+  std::vector<u8> bytes;
+  for (u32 i = 0; i < count; ++i) {
+    if (wide_every != 0 && i % wide_every == 0) {
+      bytes.insert(bytes.end(), {0xd0, 0x84, 0x02});
+    } else {
+      bytes.push_back(i & 0x7f);
+    }
+  }
+  return bytes;
+}
+
+void RunLebBenchmarks(bench::Runner& runner,
+                      const std::string& name,
+                      u32 wide_every) {
+  Features features;
+  ErrorsNop errors;
+  const u32 kCount = 100000;
+  auto bytes = MakeVarU32s(kCount, wide_every);
+
+  runner.Run("leb/" + name + "/byte_at_a_time", bytes.size(), [&]() {
+    SpanU8 data{bytes};
+    u32 sum = 0;
+    for (u32 i = 0; i < kCount; ++i) {
+      sum += *ReadVarIntSlow<u32>(&data, features, errors, "u32");
+    }
+    bench::DoNotOptimize(sum);
+  });
+
+  runner.Run("leb/" + name + "/fast_path", bytes.size(), [&]() {
+    SpanU8 data{bytes};
+    u32 sum = 0;
+    for (u32 i = 0; i < kCount; ++i) {
+      sum += *ReadVarInt<u32>(&data, features, errors, "u32");
+    }
+    bench::DoNotOptimize(sum);
+  });
+
+  std::vector<u32> out(kCount);
+  runner.Run("leb/" + name + "/batch", bytes.size(), [&]() {
+    SpanU8 data{bytes};
+    ReadVarU32s(&data, out.data(), kCount, features, errors);
+    bench::DoNotOptimize(out.data());
+  });
+}
+
+}  // namespace
+
+// Decoding runs of u32s: the byte-at-a-time reader, the single-value fast
+// path, and the batch decoder.
+WASP_BENCHMARK(LebBenchmarks) {
+  RunLebBenchmarks(runner, "narrow", 0);
+  RunLebBenchmarks(runner, "mixed", 8);
+}
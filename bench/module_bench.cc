@@ -0,0 +1,242 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench/bench.h"
+#include "bench/synthetic_module.h"
+#include "wasp/analysis/call_graph.h"
+#include "wasp/analysis/cfg.h"
+#include "wasp/analysis/dfg.h"
+#include "wasp/analysis/dominator_tree.h"
+#include "wasp/base/features.h"
+#include "wasp/binary/errors_nop.h"
+#include "wasp/binary/lazy_code_section.h"
+#include "wasp/binary/lazy_function_section.h"
+#include "wasp/binary/lazy_memory_section.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/lazy_module_utils.h"
+#include "wasp/binary/lazy_type_section.h"
+#include "wasp/binary/section_index.h"
+#include "wasp/valid/context.h"
+#include "wasp/valid/errors_nop.h"
+#include "wasp/valid/validate_code.h"
+#include "wasp/valid/validate_code_fused.h"
+#include "wasp/valid/validate_code_section_parallel.h"
+#include "wasp/valid/validate_function.h"
+#include "wasp/valid/validate_memory.h"
+#include "wasp/valid/validate_type_entry.h"
+
+namespace {
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+
+const Index kFunctionCount = 2000;
+
+// Fills in the module-level part of |context| from the type, function and
+// memory sections.
+void PrepareContext(const SectionIndex& index,
+                    valid::Context& context,
+                    const Features& features) {
+  ErrorsNop errors;
+  valid::ErrorsNop valid_errors;
+  if (auto section = index.GetKnownSection(SectionId::Type)) {
+    for (auto entry : ReadTypeSection(*section, features, errors).sequence) {
+      valid::Validate(entry, context, features, valid_errors);
+    }
+  }
+  if (auto section = index.GetKnownSection(SectionId::Function)) {
+    for (auto func : ReadFunctionSection(*section, features, errors).sequence) {
+      valid::Validate(func, context, features, valid_errors);
+    }
+  }
+  if (auto section = index.GetKnownSection(SectionId::Memory)) {
+    for (auto memory : ReadMemorySection(*section, features, errors).sequence) {
+      valid::Validate(memory, context, features, valid_errors);
+    }
+  }
+}
+
+}  // namespace
+
+// Walking the sections of a module, with and without building an index.
+WASP_BENCHMARK(SectionBenchmarks) {
+  Features features;
+  ErrorsNop errors;
+  auto data = bench::MakeSyntheticModule(kFunctionCount);
+
+  runner.Run("module/sections/iterate", data.size(), [&]() {
+    auto module = ReadModule(SpanU8{data}, features, errors);
+    u32 count = 0;
+    for (const auto& section : module.sections) {
+      count += section.is_known();
+    }
+    bench::DoNotOptimize(count);
+  });
+
+  runner.Run("module/sections/index", data.size(), [&]() {
+    auto module = ReadModule(SpanU8{data}, features, errors);
+    SectionIndex index{module};
+    bench::DoNotOptimize(index.entries().size());
+  });
+}
+
+// Copying the function names out of the "name" section, as the tools do.
+WASP_BENCHMARK(NameBenchmarks) {
+  Features features;
+  ErrorsNop errors;
+  auto data = bench::MakeSyntheticModule(kFunctionCount);
+  auto module = ReadModule(SpanU8{data}, features, errors);
+  SectionIndex index{module};
+
+  runner.Run("module/names/copy_to_map", 0, [&]() {
+    std::map<Index, string_view> names;
+    CopyFunctionNames(index, std::inserter(names, names.end()), features,
+                      errors);
+    bench::DoNotOptimize(names.size());
+  });
+
+  runner.Run("module/names/copy_strings", 0, [&]() {
+    std::vector<std::pair<Index, std::string>> names;
+    ForEachFunctionName(index,
+                        [&](const IndexNamePair& pair) {
+                          names.emplace_back(pair.first,
+                                             pair.second.to_string());
+                        },
+                        features, errors);
+    bench::DoNotOptimize(names.size());
+  });
+}
+
+// Validating every function body, one at a time and in parallel.
+WASP_BENCHMARK(ValidateBenchmarks) {
+  Features features;
+  ErrorsNop errors;
+  valid::ErrorsNop valid_errors;
+  auto data = bench::MakeSyntheticModule(kFunctionCount);
+  auto module = ReadModule(SpanU8{data}, features, errors);
+  SectionIndex index{module};
+  valid::Context module_context;
+  PrepareContext(index, module_context, features);
+
+  std::vector<Code> codes;
+  if (auto section = index.GetKnownSection(SectionId::Code)) {
+    for (auto code : ReadCodeSection(*section, features, errors).sequence) {
+      codes.push_back(code);
+    }
+  }
+  const auto code_bytes = index.GetKnownSection(SectionId::Code)->data.size();
+
+  runner.Run("valid/code/per_function", code_bytes, [&]() {
+    valid::FunctionContext function_context;
+    bool valid = true;
+    for (Index i = 0; i < codes.size(); ++i) {
+      valid &= valid::Validate(codes[i], i, module_context, function_context,
+                               features, valid_errors);
+    }
+    bench::DoNotOptimize(valid);
+  });
+
+  runner.Run("valid/code/fused", code_bytes, [&]() {
+    valid::FunctionContext function_context;
+    bool valid = true;
+    for (Index i = 0; i < codes.size(); ++i) {
+      valid &= valid::ValidateFused(codes[i], i, module_context,
+                                    function_context, features, valid_errors);
+    }
+    bench::DoNotOptimize(valid);
+  });
+
+  runner.Run("valid/code/parallel", code_bytes, [&]() {
+    valid::Context context = module_context;
+    bench::DoNotOptimize(valid::ValidateCodeSectionParallel(
+        codes, context, features, valid_errors));
+  });
+}
+
+// Building the call graph, and the control-flow and data-flow graphs of every
+// function body.
+WASP_BENCHMARK(AnalysisBenchmarks) {
+  Features features;
+  ErrorsNop errors;
+  auto data = bench::MakeSyntheticModule(kFunctionCount);
+  auto module = ReadModule(SpanU8{data}, features, errors);
+  SectionIndex index{module};
+
+  std::vector<TypeEntry> type_entries;
+  if (auto section = index.GetKnownSection(SectionId::Type)) {
+    auto seq = ReadTypeSection(*section, features, errors).sequence;
+    std::copy(seq.begin(), seq.end(), std::back_inserter(type_entries));
+  }
+  std::vector<Function> functions;
+  if (auto section = index.GetKnownSection(SectionId::Function)) {
+    auto seq = ReadFunctionSection(*section, features, errors).sequence;
+    std::copy(seq.begin(), seq.end(), std::back_inserter(functions));
+  }
+  std::vector<Code> codes;
+  if (auto section = index.GetKnownSection(SectionId::Code)) {
+    for (auto code : ReadCodeSection(*section, features, errors).sequence) {
+      codes.push_back(code);
+    }
+  }
+  const auto code_bytes = index.GetKnownSection(SectionId::Code)->data.size();
+
+  runner.Run("analysis/call_graph/one_thread", code_bytes, [&]() {
+    auto graph = analysis::BuildCallGraph(index, features, errors, 1);
+    bench::DoNotOptimize(graph.edge_count());
+  });
+
+  runner.Run("analysis/call_graph/parallel", code_bytes, [&]() {
+    auto graph = analysis::BuildCallGraph(index, features, errors);
+    bench::DoNotOptimize(graph.edge_count());
+  });
+
+  runner.Run("analysis/cfg/all_functions", code_bytes, [&]() {
+    Index edge_count = 0;
+    for (const auto& code : codes) {
+      auto cfg = analysis::BuildCfg(code, features, errors);
+      edge_count += cfg.edge_count();
+    }
+    bench::DoNotOptimize(edge_count);
+  });
+
+  runner.Run("analysis/cfg/dominators", code_bytes, [&]() {
+    Index node_count = 0;
+    for (const auto& code : codes) {
+      auto cfg = analysis::BuildCfg(code, features, errors);
+      node_count += analysis::ComputeDominators(cfg).size() +
+                    analysis::ComputePostDominators(cfg).size();
+    }
+    bench::DoNotOptimize(node_count);
+  });
+
+  runner.Run("analysis/dfg/all_functions", code_bytes, [&]() {
+    analysis::DfgBuilder builder{type_entries, functions, features, errors};
+    size_t value_count = 0;
+    for (Index i = 0; i < codes.size(); ++i) {
+      builder.Build(type_entries[functions[i].type_index].type, codes[i]);
+      builder.RemoveTrivialPhis();
+      value_count += builder.values().size();
+    }
+    bench::DoNotOptimize(value_count);
+  });
+}
@@ -0,0 +1,185 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "bench/synthetic_module.h"
+
+#include <cstdio>
+#include <fstream>
+#include <utility>
+
+#include "wasp/base/format.h"
+#include "wasp/binary/write/size_of.h"
+#include "wasp/binary/write/write_buffer.h"
+#include "wasp/binary/write/write_code.h"
+#include "wasp/binary/write/write_export.h"
+#include "wasp/binary/write/write_function.h"
+#include "wasp/binary/write/write_index.h"
+#include "wasp/binary/write/write_instruction.h"
+#include "wasp/binary/write/write_locals.h"
+#include "wasp/binary/write/write_memory.h"
+#include "wasp/binary/write/write_name_subsection_id.h"
+#include "wasp/binary/write/write_section_id.h"
+#include "wasp/binary/write/write_string.h"
+#include "wasp/binary/write/write_type_entry.h"
+#include "wasp/binary/write/write_u32.h"
+#include "wasp/binary/write/write_vector.h"
+
+namespace wasp {
+namespace bench {
+
+namespace {
+
+using namespace ::wasp::binary;
+
+// Writes a section that holds a vector of |items|. The section size is
+// computed with SizeOfVector, so the contents are written directly.
+template <typename T>
+void WriteVectorSection(SectionId id,
+                        const std::vector<T>& items,
+                        WriteBuffer& out) {
+  auto it = out.output();
+  it = Write(id, it);
+  it = Write(static_cast<u32>(SizeOfVector(items.begin(), items.end())), it);
+  WriteVector(items.begin(), items.end(), it);
+}
+
+// Writes the body of function |func_index| (without the locals or the size)
+// to |out|.
+void WriteBody(Index func_index,
+               Index function_count,
+               Index blocks_per_function,
+               WriteBuffer& out) {
+  using I = Instruction;
+  using O = Opcode;
+
+  const Index callee = (func_index + 1) % function_count;
+  const BrTableTargetsBuffer targets{0, 0, 0};
+  const std::vector<I> block{
+      I{O::Block, BlockType::Void},
+      I{O::LocalGet, Index{0}},
+      I{O::BrIf, Index{0}},
+      I{O::LocalGet, Index{0}},
+      I{O::I32Const, s32{1000}},
+      I{O::I32Add},
+      I{O::I32Load, MemArgImmediate{2, 16}},
+      I{O::Call, callee},
+      I{O::LocalSet, Index{1}},
+      I{O::LocalGet, Index{1}},
+      I{O::BrTable, BrTableImmediate{targets.targets(), 0}},
+      I{O::End},
+  };
+
+  auto it = out.output();
+  for (Index i = 0; i < blocks_per_function; ++i) {
+    for (const auto& instr : block) {
+      it = Write(instr, it);
+    }
+  }
+  it = Write(I{O::LocalGet, Index{1}}, it);
+  Write(I{O::End}, it);
+}
+
+}  // namespace
+
+std::vector<u8> MakeSyntheticModule(Index function_count,
+                                    Index blocks_per_function) {
+  WriteBuffer module;
+  module.Append(SpanU8{reinterpret_cast<const u8*>("\0asm\1\0\0\0"), 8});
+
+  // One type, (i32) -> i32.
+  WriteVectorSection(
+      SectionId::Type,
+      std::vector<TypeEntry>{
+          TypeEntry{FunctionType{{ValueType::I32}, {ValueType::I32}}}},
+      module);
+  WriteVectorSection(SectionId::Function,
+                     std::vector<Function>(function_count, Function{0}),
+                     module);
+  WriteVectorSection(SectionId::Memory,
+                     std::vector<Memory>{Memory{MemoryType{Limits{1}}}},
+                     module);
+
+  std::vector<std::string> names;
+  names.reserve(function_count);
+  for (Index i = 0; i < function_count; ++i) {
+    names.push_back(format("func_{}", i));
+  }
+
+  std::vector<Export> exports;
+  exports.reserve(function_count);
+  for (Index i = 0; i < function_count; ++i) {
+    exports.push_back(Export{ExternalKind::Function, names[i], i});
+  }
+  WriteVectorSection(SectionId::Export, exports, module);
+
+  // The bodies are written into one buffer, and the Code entries refer to
+  // them. This must happen in two steps, since the buffer may move as it
+  // grows.
+  WriteBuffer bodies;
+  std::vector<size_t> body_ends;
+  body_ends.reserve(function_count);
+  for (Index i = 0; i < function_count; ++i) {
+    WriteBody(i, function_count, blocks_per_function, bodies);
+    body_ends.push_back(bodies.size());
+  }
+  std::vector<Code> codes;
+  codes.reserve(function_count);
+  size_t body_start = 0;
+  for (auto body_end : body_ends) {
+    codes.push_back(Code{{Locals{1, ValueType::I32}},
+                         Expression{bodies.data().subspan(
+                             body_start, body_end - body_start)}});
+    body_start = body_end;
+  }
+  WriteVectorSection(SectionId::Code, codes, module);
+
+  // "name" section, with a function names subsection. Each size is computed
+  // before its contents are written.
+  size_t function_names_size = SizeOf(function_count);
+  for (Index i = 0; i < function_count; ++i) {
+    function_names_size += SizeOf(i) + SizeOf(string_view{names[i]});
+  }
+  auto it = module.output();
+  it = Write(SectionId::Custom, it);
+  it = Write(static_cast<u32>(SizeOf(string_view{"name"}) +
+                              SizeOf(NameSubsectionId::FunctionNames) +
+                              SizeOf(static_cast<u32>(function_names_size)) +
+                              function_names_size),
+             it);
+  it = Write(string_view{"name"}, it);
+  it = Write(NameSubsectionId::FunctionNames, it);
+  it = Write(static_cast<u32>(function_names_size), it);
+  it = Write(function_count, it);
+  for (Index i = 0; i < function_count; ++i) {
+    it = WriteIndex(i, it);
+    it = Write(string_view{names[i]}, it);
+  }
+
+  return module.Release();
+}
+
+TempFile::TempFile(const std::vector<u8>& data, std::string filename)
+    : filename_{std::move(filename)} {
+  std::ofstream stream{filename_, std::ios::out | std::ios::binary};
+  stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+TempFile::~TempFile() {
+  std::remove(filename_.c_str());
+}
+
+}  // namespace bench
+}  // namespace wasp
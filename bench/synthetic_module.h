@@ -0,0 +1,56 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BENCH_SYNTHETIC_MODULE_H_
+#define WASP_BENCH_SYNTHETIC_MODULE_H_
+
+#include <string>
+#include <vector>
+
+#include "wasp/base/string_view.h"
+#include "wasp/base/types.h"
+
+namespace wasp {
+namespace bench {
+
+// Builds a valid module with |function_count| functions of type
+// (i32) -> i32, written with the binary::Write functions. Each body repeats a
+// block |blocks_per_function| times; the block has a local, a memory load, a
+// call to the next function and a br_table. Every function is exported and
+// named in a "name" section.
+std::vector<u8> MakeSyntheticModule(Index function_count,
+                                    Index blocks_per_function = 10);
+
+// Writes data to a file that is removed when this object is destroyed.
+class TempFile {
+ public:
+  explicit TempFile(const std::vector<u8>& data,
+                    std::string filename = "wasp_bench_tmp.wasm");
+  ~TempFile();
+
+  TempFile(const TempFile&) = delete;
+  TempFile& operator=(const TempFile&) = delete;
+
+  string_view filename() const { return filename_; }
+
+ private:
+  std::string filename_;
+};
+
+}  // namespace bench
+}  // namespace wasp
+
+#endif  // WASP_BENCH_SYNTHETIC_MODULE_H_
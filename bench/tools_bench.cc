@@ -0,0 +1,115 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "bench/bench.h"
+#include "bench/synthetic_module.h"
+#include "src/tools/callgraph.h"
+#include "src/tools/cfg.h"
+#include "src/tools/dfg.h"
+#include "src/tools/dump.h"
+#include "src/tools/strip.h"
+#include "wasp/base/format.h"
+
+namespace {
+
+using namespace ::wasp;
+
+using ToolMain = int (*)(int argc, char** argv);
+
+// Sends stdout to /dev/null while in scope, so tools that print their
+// results don't swamp the benchmark output.
+class SilenceStdout {
+ public:
+  SilenceStdout() {
+    std::fflush(stdout);
+    saved_ = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    dup2(null_fd, STDOUT_FILENO);
+    close(null_fd);
+  }
+
+  ~SilenceStdout() {
+    std::fflush(stdout);
+    dup2(saved_, STDOUT_FILENO);
+    close(saved_);
+  }
+
+ private:
+  int saved_;
+};
+
+int RunTool(ToolMain main, std::vector<std::string> args) {
+  std::vector<char*> argv;
+  for (auto& arg : args) {
+    argv.push_back(&arg[0]);
+  }
+  SilenceStdout silence;
+  return main(static_cast<int>(argv.size()), argv.data());
+}
+
+}  // namespace
+
+// Each tool run end to end on a large synthetic module, from the file on disk
+// to its output.
+WASP_BENCHMARK(ToolBenchmarks) {
+  auto data = bench::MakeSyntheticModule(500);
+  bench::TempFile file{data};
+  const std::string filename = file.filename().to_string();
+  const std::size_t size = data.size();
+
+  runner.Run("tools/dump/headers", size, [&]() {
+    RunTool(tools::dump::Main, {filename, "-h"});
+  });
+
+  runner.Run("tools/dump/details", size, [&]() {
+    RunTool(tools::dump::Main, {filename, "-x"});
+  });
+
+  runner.Run("tools/dump/disassemble", size, [&]() {
+    RunTool(tools::dump::Main, {filename, "-d"});
+  });
+
+  runner.Run("tools/callgraph", size, [&]() {
+    RunTool(tools::callgraph::Main, {filename, "-o", "/dev/null"});
+  });
+
+  runner.Run("tools/cfg", size, [&]() {
+    RunTool(tools::cfg::Main, {filename, "-f", "func_0", "-o", "/dev/null"});
+  });
+
+  runner.Run("tools/dfg", size, [&]() {
+    RunTool(tools::dfg::Main, {filename, "-f", "func_0", "-o", "/dev/null"});
+  });
+
+  // strip writes a real output file, so its status can be checked; /dev/null
+  // isn't a regular file.
+  bench::TempFile strip_output{{}, "wasp_bench_strip_tmp.wasm"};
+  const std::string strip_filename = strip_output.filename().to_string();
+  runner.Run("tools/strip", size, [&]() {
+    if (RunTool(tools::strip::Main, {filename, "-o", strip_filename}) != 0) {
+      print(stderr, "tools/strip failed\n");
+      std::abort();
+    }
+  });
+}
@@ -0,0 +1,87 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_ANALYSIS_CALL_GRAPH_H_
+#define WASP_ANALYSIS_CALL_GRAPH_H_
+
+#include <vector>
+
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+
+namespace wasp {
+
+class Features;
+
+namespace binary {
+
+class Errors;
+class SectionIndex;
+
+}  // namespace binary
+
+namespace analysis {
+
+using IndexSpan = span<const Index>;
+
+/// ---
+// The calls between the functions of a module, including imported functions.
+// The edges are stored twice in compressed-sparse-row form: callees sorted by
+// caller, and callers sorted by callee. Each edge is stored once per
+// direction, however many times the caller calls the callee.
+class CallGraph {
+ public:
+  CallGraph() = default;
+
+  Index function_count() const { return callee_offsets_.size() - 1; }
+  Index edge_count() const { return callees_.size(); }
+
+  // Both are sorted by function index.
+  IndexSpan callees(Index caller) const;
+  IndexSpan callers(Index callee) const;
+
+ private:
+  friend CallGraph BuildCallGraph(const binary::SectionIndex&,
+                                  const Features&,
+                                  binary::Errors&,
+                                  unsigned);
+
+  std::vector<Index> callee_offsets_{0};  // function_count() + 1 entries.
+  std::vector<Index> callees_;
+  std::vector<Index> caller_offsets_{0};  // function_count() + 1 entries.
+  std::vector<Index> callers_;
+};
+
+// Builds the call graph from the module's sections, decoding the function
+// bodies on up to |thread_count| threads (0 means one per hardware thread).
+//
+// `call` and `return_call` add an edge to their callee. `call_indirect` and
+// `return_call_indirect` add an edge to every function that the element
+// segments can put in the table, and whose signature matches the call's
+// type. Passive segments can be copied into any table, so their functions are
+// candidates for every table.
+//
+// Errors reading the module's sections are reported to |errors|. Errors in
+// function bodies are not; the rest of that body is skipped.
+CallGraph BuildCallGraph(const binary::SectionIndex&,
+                         const Features&,
+                         binary::Errors&,
+                         unsigned thread_count = 0);
+
+}  // namespace analysis
+}  // namespace wasp
+
+#endif  // WASP_ANALYSIS_CALL_GRAPH_H_
@@ -0,0 +1,108 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_ANALYSIS_CFG_H_
+#define WASP_ANALYSIS_CFG_H_
+
+#include <vector>
+
+#include "wasp/analysis/types.h"
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/code.h"
+#include "wasp/binary/instruction.h"
+
+namespace wasp {
+
+class Features;
+
+namespace binary {
+
+class Errors;
+
+}  // namespace binary
+
+namespace analysis {
+
+enum class CfgEdgeKind : u8 {
+  Unconditional,  // Fallthrough, `br`, or the end of an `if` or `else` arm.
+  True,           // `if` or `br_if` when the condition is non-zero.
+  False,          // `if` or `br_if` when the condition is zero.
+  Case,           // A `br_table` target; the case value is the edge's index.
+  Default,        // The `br_table` default target.
+};
+
+// An edge to InvalidBBID leaves the function.
+struct CfgEdge {
+  BBID target;
+  CfgEdgeKind kind;
+};
+
+using CfgEdgeSpan = span<const CfgEdge>;
+using BBIDSpan = span<const BBID>;
+
+/// ---
+// The control-flow graph of one function. Edges are stored in
+// compressed-sparse-row form: the successors (and predecessors) of all blocks
+// are in one array, and each block stores where its range begins. Each
+// block's instructions are a span of the function body, so nothing is copied
+// or decoded again.
+//
+// Blocks are numbered in the order they appear in the body. Blocks with no
+// instructions other than `block`, `else`, `end` and `br` are removed, and
+// edges to them go to the block they lead to.
+class Cfg {
+ public:
+  Cfg() = default;
+
+  // InvalidBBID if the function has no code.
+  BBID start() const { return start_; }
+  Index block_count() const { return code_.size(); }
+  Index edge_count() const { return successors_.size(); }
+
+  // The instructions of the block.
+  SpanU8 code(BBID) const;
+
+  // Successors in the order of the branches, e.g. True before False, and
+  // `br_table` cases before the default.
+  CfgEdgeSpan successors(BBID) const;
+
+  // Predecessors, one per edge; edges that leave the function aren't
+  // included.
+  BBIDSpan predecessors(BBID) const;
+
+ private:
+  friend class CfgBuilder;
+
+  BBID start_ = InvalidBBID;
+  std::vector<SpanU8> code_;
+  std::vector<Index> successor_offsets_;  // block_count() + 1 entries.
+  std::vector<CfgEdge> successors_;
+  std::vector<Index> predecessor_offsets_;  // block_count() + 1 entries.
+  std::vector<BBID> predecessors_;
+};
+
+Cfg BuildCfg(const binary::Code&, const Features&, binary::Errors&);
+
+// True for instructions that only affect control flow, which a Cfg's edges
+// already describe (`block`, `else`, `end` and `br`). A block with nothing
+// else is removed from the Cfg.
+bool IsExtraneousInstruction(const binary::Instruction&);
+
+}  // namespace analysis
+}  // namespace wasp
+
+#endif  // WASP_ANALYSIS_CFG_H_
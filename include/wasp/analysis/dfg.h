@@ -0,0 +1,229 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef WASP_ANALYSIS_DFG_H_
+#define WASP_ANALYSIS_DFG_H_
+
+#include <vector>
+
+#include "wasp/analysis/types.h"
+#include "wasp/base/optional.h"
+#include "wasp/base/span.h"
+#include "wasp/base/string_view.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/code.h"
+#include "wasp/binary/function.h"
+#include "wasp/binary/function_type.h"
+#include "wasp/binary/instruction.h"
+#include "wasp/binary/type_entry.h"
+
+namespace wasp {
+
+class Features;
+
+namespace binary {
+
+class Errors;
+
+}  // namespace binary
+
+namespace analysis {
+
+using ValueID = u32;
+using VarID = u32;
+
+using ValueIDs = std::vector<ValueID>;
+
+constexpr ValueID InvalidValueID = ~0;
+
+struct DfgValue {
+  bool is_phi() const { return !instr; }
+
+  BBID block;
+  optional<binary::Instruction> instr;
+  ValueIDs operands;
+};
+
+/// ---
+// Maps (variable, block) pairs to the value that the variable holds at the
+// end of the block. Open addressing with linear probing keeps every entry in
+// one flat array, so lookups don't chase pointers and clearing the table for
+// the next function keeps its storage.
+class DefinitionTable {
+ public:
+  DefinitionTable();
+
+  Index size() const { return size_; }
+
+  // Removes all entries. The storage is kept, but is shrunk when it is much
+  // larger than the last function needed.
+  void Clear();
+
+  // Returns InvalidValueID if |var| has no definition in |bbid|.
+  ValueID Find(VarID var, BBID bbid) const;
+  void Insert(VarID var, BBID bbid, ValueID);
+
+ private:
+  struct Slot {
+    u64 key;
+    ValueID value;
+  };
+
+  static u64 MakeKey(VarID var, BBID bbid);
+  Index FindSlot(u64 key) const;
+  void Resize(Index capacity);
+
+  std::vector<Slot> slots_;
+  Index size_ = 0;
+  int shift_ = 0;
+};
+
+/// ---
+// Builds the data-flow graph of a function in SSA form, using the algorithm
+// from "Simple and Efficient Construction of Static Single Assignment Form"
+// (Braun et al.). Locals and value stack slots are both treated as variables;
+// every instruction becomes a value whose operands are the values it reads.
+//
+// The builder only holds references to the module's types and functions, so
+// one builder can be reused for every function of a module. Its tables keep
+// their storage between calls to Build.
+class DfgBuilder {
+ public:
+  // |functions| must include the imported functions, so it can be indexed by
+  // function index.
+  explicit DfgBuilder(const std::vector<binary::TypeEntry>&,
+                      const std::vector<binary::Function>&,
+                      const Features&,
+                      binary::Errors&);
+
+  // Replaces the current graph with the graph of the given function. Returns
+  // false, after reporting an error, if the body can't be decoded, uses an
+  // instruction the graph can't represent (exception handling, or multiple
+  // results), or is malformed in a way that leaves no value to use (e.g.
+  // `local.set` with an empty value stack); the graph is then incomplete.
+  bool Build(const binary::FunctionType&, const binary::Code&);
+
+  // Replaces phis whose operands are all the same value (or the phi itself)
+  // with that value. Removed phis are left in place with no operands.
+  void RemoveTrivialPhis();
+
+  const std::vector<DfgValue>& values() const { return values_; }
+  Index block_count() const { return bbs_.size(); }
+
+ private:
+  struct Block {
+    std::vector<BBID> preds;
+    std::vector<std::pair<VarID, ValueID>> incomplete_phis;
+    Index value_count;
+    bool is_loop_header;
+    bool sealed;
+  };
+
+  // Locals [previous run's end, end) have the given type.
+  struct LocalRun {
+    Index end;
+    binary::ValueType type;
+  };
+
+  // A phi operand that is still to be read from the phi's |index|th
+  // predecessor.
+  struct PhiOperand {
+    VarID var;
+    ValueID phi;
+    Index index;
+  };
+
+  struct Label {
+    binary::Opcode opcode;
+    BBID parent;
+    BBID br;
+    BBID next;
+    Index value_stack_size;
+    bool unreachable;
+  };
+
+  void Reset();
+  void OnError(string_view message);
+  void Fail(string_view message);
+  void OnUnsupported(const binary::Instruction&);
+  optional<binary::FunctionType> GetFunctionType(Index) const;
+  void DoInstruction(const binary::Instruction&);
+  optional<ValueID> GetTrivialPhiOperand(ValueID) const;
+
+  static Index BlockTypeToValueCount(binary::BlockType);
+
+  void PushLabel(binary::Opcode, BBID br, BBID next);
+  Label PopLabel();
+
+  BBID NewBlock(Index value_count = 0, bool is_loop_header = false);
+  void StartBlock(BBID);
+  Block& GetBlock(BBID);
+  void MarkUnreachable();
+  void AddPred(BBID);
+  void AddPred(BBID block, BBID pred);
+  void Br(Index);
+  void Return();
+
+  ValueID NewValue(const binary::Instruction&, Index operand_count = 0);
+  ValueID NewPhi(BBID);
+  ValueID NewLocalDefault(VarID);
+  bool IsLocal(VarID) const;
+  ValueID Undef();
+
+  Index GetStackSize() const;
+  DfgValue& GetValue(ValueID);
+  void CopyValues(Index count, ValueIDs& out);
+  void ForwardValues(const Label&, BBID target);
+  void PushValue(ValueID);
+  void PushUndefValues(Index count);
+  ValueID PopValue();
+  void PopValues(Index count);
+  void BasicInstruction(const binary::Instruction&,
+                        Index operand_count,
+                        Index result_count);
+
+  void WriteVariable(VarID, BBID, ValueID);
+  ValueID ReadVariable(VarID, BBID);
+  ValueID LookupVariable(VarID, BBID);
+  void QueuePhiOperands(VarID, ValueID phi);
+  void FillPhiOperands();
+  void AddPhiOperands(VarID, ValueID phi);
+  void SealBlock(BBID);
+
+  const std::vector<binary::TypeEntry>& type_entries_;
+  const std::vector<binary::Function>& functions_;
+  const Features& features_;
+  binary::Errors& errors_;
+  SpanU8 instr_pos_;
+  std::vector<Label> labels_;
+  std::vector<Block> bbs_;
+  std::vector<DfgValue> values_;
+  std::vector<LocalRun> local_runs_;
+  Index locals_begin_ = 0;
+  DefinitionTable current_def_;
+  std::vector<BBID> read_chain_;
+  std::vector<PhiOperand> phi_operands_;
+  std::vector<std::vector<ValueID>> users_;
+  Index value_stack_size_ = 0;
+  BBID start_bbid_ = InvalidBBID;
+  BBID current_bbid_ = InvalidBBID;
+  ValueID undef_ = InvalidValueID;
+  bool failed_ = false;
+};
+
+}  // namespace analysis
+}  // namespace wasp
+
+#endif  // WASP_ANALYSIS_DFG_H_
@@ -0,0 +1,80 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_ANALYSIS_DOMINATOR_TREE_H_
+#define WASP_ANALYSIS_DOMINATOR_TREE_H_
+
+#include <vector>
+
+#include "wasp/analysis/cfg.h"
+#include "wasp/analysis/types.h"
+#include "wasp/base/types.h"
+
+namespace wasp {
+namespace analysis {
+
+/// ---
+// A dominator or post-dominator tree of a Cfg, computed with the
+// Lengauer-Tarjan algorithm using path compression, in O(E log V) time.
+//
+// The post-dominator tree has one more node than the Cfg has blocks: node
+// cfg.block_count() stands for leaving the function, and is the root.
+//
+// Dominates answers in constant time, using the preorder and postorder
+// numbers of the tree.
+class DominatorTree {
+ public:
+  DominatorTree() = default;
+
+  Index size() const { return idom_.size(); }
+
+  // InvalidBBID if the graph is empty.
+  BBID root() const { return root_; }
+
+  // InvalidBBID for the root, and for nodes that can't be reached from it.
+  BBID idom(BBID) const;
+
+  bool reachable(BBID) const;
+
+  // True if |a| is on every path from the root to |b|. A node dominates
+  // itself; a node that isn't reachable doesn't dominate anything, and
+  // isn't dominated.
+  bool Dominates(BBID a, BBID b) const;
+
+  // The nodes that |bbid| immediately dominates, in increasing order.
+  BBIDSpan children(BBID) const;
+
+ private:
+  friend DominatorTree ComputeDominators(const Cfg&);
+  friend DominatorTree ComputePostDominators(const Cfg&);
+
+  explicit DominatorTree(BBID root, std::vector<BBID> idom);
+
+  BBID root_ = InvalidBBID;
+  std::vector<BBID> idom_;
+  std::vector<Index> child_offsets_;  // size() + 1 entries.
+  std::vector<BBID> children_;
+  std::vector<Index> preorder_;
+  std::vector<Index> postorder_;
+};
+
+DominatorTree ComputeDominators(const Cfg&);
+DominatorTree ComputePostDominators(const Cfg&);
+
+}  // namespace analysis
+}  // namespace wasp
+
+#endif  // WASP_ANALYSIS_DOMINATOR_TREE_H_
@@ -0,0 +1,33 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_ANALYSIS_TYPES_H_
+#define WASP_ANALYSIS_TYPES_H_
+
+#include "wasp/base/types.h"
+
+namespace wasp {
+namespace analysis {
+
+// Identifies a basic block of a function.
+using BBID = u32;
+
+constexpr BBID InvalidBBID = ~0;
+
+}  // namespace analysis
+}  // namespace wasp
+
+#endif  // WASP_ANALYSIS_TYPES_H_
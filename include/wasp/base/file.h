@@ -17,9 +17,11 @@
 #ifndef WASP_BASE_FILE_H_
 #define WASP_BASE_FILE_H_
 
+#include <cstddef>
 #include <vector>
 
 #include "wasp/base/optional.h"
+#include "wasp/base/span.h"
 #include "wasp/base/string_view.h"
 #include "wasp/base/types.h"
 
@@ -27,6 +29,36 @@ namespace wasp {
 
 optional<std::vector<u8>> ReadFile(string_view filename);
 
+// The contents of a file, either memory-mapped or (for pipes, stdin, and
+// platforms without mmap) copied into an owned buffer. The mapping is
+// released when the MappedFile is destroyed, so any SpanU8 obtained from
+// data() must not outlive it.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  explicit MappedFile(std::vector<u8>&& buffer);
+  MappedFile(void* addr, std::size_t size);
+  MappedFile(MappedFile&&);
+  MappedFile& operator=(MappedFile&&);
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile();
+
+  SpanU8 data() const;
+  bool is_mapped() const { return addr_ != nullptr; }
+
+ private:
+  void Unmap();
+
+  void* addr_ = nullptr;
+  std::size_t size_ = 0;
+  std::vector<u8> buffer_;
+};
+
+// Maps |filename| into memory. The filename "-" reads from stdin. Files that
+// cannot be mapped (e.g. pipes) are read into a buffer instead.
+optional<MappedFile> MapFile(string_view filename);
+
 }  // namespace wasp
 
 #endif  // WASP_BASE_FILE_H_
@@ -27,6 +27,7 @@ namespace wasp {
 using fmt::format;
 using fmt::print;
 using fmt::vprint;
+using fmt::vformat;
 using fmt::make_format_args;
 using fmt::format_arg_store;
 using fmt::basic_format_args;
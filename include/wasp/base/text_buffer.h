@@ -0,0 +1,82 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BASE_TEXT_BUFFER_H_
+#define WASP_BASE_TEXT_BUFFER_H_
+
+#include <cstddef>
+#include <iosfwd>
+#include <iterator>
+#include <string>
+
+#include "wasp/base/format.h"
+#include "wasp/base/string_view.h"
+#include "wasp/base/types.h"
+
+namespace wasp {
+
+/// ---
+// A reusable buffer for writing large amounts of text to a stream. Text is
+// appended to an in-memory buffer, which is written to the stream in one
+// chunk whenever it grows past |flush_size|, and when the TextBuffer is
+// destroyed.
+//
+// The Append functions write numbers and strings directly, without parsing
+// a format string; Print is available for everything else.
+class TextBuffer {
+ public:
+  static constexpr size_t kDefaultFlushSize = 64 * 1024;
+
+  explicit TextBuffer(std::ostream&, size_t flush_size = kDefaultFlushSize);
+  TextBuffer(const TextBuffer&) = delete;
+  TextBuffer& operator=(const TextBuffer&) = delete;
+  ~TextBuffer();
+
+  void Append(char);
+  void Append(string_view);
+  void AppendSpaces(size_t count);
+  void AppendUnsigned(u64);
+  void AppendSigned(s64);
+  // Writes |value| in lowercase hex, zero-padded to at least |width| digits.
+  void AppendHex(u64 value, int width = 0);
+
+  template <typename... Args>
+  void Print(string_view format, const Args&...);
+
+  void Flush();
+
+  size_t size() const { return buffer_.size(); }
+  string_view text() const { return buffer_; }
+
+ private:
+  void MaybeFlush();
+
+  std::ostream& stream_;
+  size_t flush_size_;
+  std::string buffer_;
+};
+
+template <typename... Args>
+void TextBuffer::Print(string_view format, const Args&... args) {
+  fmt::vformat_to(std::back_inserter(buffer_),
+                  fmt::string_view{format.data(), format.size()},
+                  make_format_args(args...));
+  MaybeFlush();
+}
+
+}  // namespace wasp
+
+#endif  // WASP_BASE_TEXT_BUFFER_H_
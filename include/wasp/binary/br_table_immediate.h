@@ -17,15 +17,114 @@
 #ifndef WASP_BINARY_BR_TABLE_IMMEDIATE_H_
 #define WASP_BINARY_BR_TABLE_IMMEDIATE_H_
 
+#include <initializer_list>
+#include <iterator>
 #include <vector>
 
+#include "wasp/base/span.h"
 #include "wasp/base/types.h"
 
 namespace wasp {
 namespace binary {
 
+/// ---
+// The targets of a br_table instruction, as a view of their LEB128 encoding.
+// Targets are decoded as they are iterated, so reading a br_table doesn't
+// allocate, and the number of targets is known without decoding them.
+//
+// BrTableTargets doesn't own the encoded bytes. When read from a binary they
+// are part of the module's data, which must outlive the targets (and the
+// Instruction that holds them). To build targets by hand, use a
+// BrTableTargetsBuffer.
+class BrTableTargets {
+ public:
+  class const_iterator;
+  using iterator = const_iterator;
+  using value_type = Index;
+  using size_type = Index;
+
+  BrTableTargets() = default;
+  // |data| must hold exactly |count| well-formed LEB128-encoded u32 values;
+  // this is checked in debug builds.
+  explicit BrTableTargets(Index count, SpanU8 data);
+
+  Index size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+  SpanU8 data() const { return data_; }
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+ private:
+  SpanU8 data_;
+  Index count_ = 0;
+};
+
+class BrTableTargets::const_iterator {
+ public:
+  using difference_type = std::ptrdiff_t;
+  using value_type = Index;
+  using pointer = const Index*;
+  using reference = const Index&;
+  using iterator_category = std::forward_iterator_tag;
+
+  reference operator*() const { return value_; }
+  pointer operator->() const { return &value_; }
+
+  const_iterator& operator++();
+  const_iterator operator++(int);
+
+  friend bool operator==(const const_iterator& lhs, const const_iterator& rhs) {
+    return lhs.index_ == rhs.index_;
+  }
+
+  friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs) {
+    return !(lhs == rhs);
+  }
+
+ private:
+  friend class BrTableTargets;
+
+  explicit const_iterator(const u8* data, Index index, Index count);
+  void Load();
+
+  const u8* data_;  // The next encoded target.
+  Index index_;
+  Index count_;
+  Index value_;
+};
+
+bool operator==(const BrTableTargets&, const BrTableTargets&);
+bool operator!=(const BrTableTargets&, const BrTableTargets&);
+
+/// ---
+// Owns the encoding of a list of br_table targets, e.g. for building a
+// br_table instruction by hand. The BrTableTargets returned by targets()
+// refer to this buffer, so it must outlive them.
+class BrTableTargetsBuffer {
+ public:
+  BrTableTargetsBuffer() = default;
+  BrTableTargetsBuffer(std::initializer_list<Index>);
+  explicit BrTableTargetsBuffer(const std::vector<Index>&);
+
+  template <typename Iterator>
+  BrTableTargetsBuffer(Iterator begin, Iterator end) {
+    for (; begin != end; ++begin) {
+      push_back(*begin);
+    }
+  }
+
+  void push_back(Index);
+
+  BrTableTargets targets() const;
+
+ private:
+  std::vector<u8> data_;
+  Index count_ = 0;
+};
+
 struct BrTableImmediate {
-  std::vector<Index> targets;
+  BrTableTargets targets;
   Index default_target;
 };
 
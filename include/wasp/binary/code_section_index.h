@@ -0,0 +1,67 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_CODE_SECTION_INDEX_H_
+#define WASP_BINARY_CODE_SECTION_INDEX_H_
+
+#include <vector>
+
+#include "wasp/base/optional.h"
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/code.h"
+#include "wasp/binary/known_section.h"
+
+namespace wasp {
+
+class Features;
+
+namespace binary {
+
+class Errors;
+
+struct CodeIndexEntry {
+  SpanU8 locals;  // The encoded locals vector.
+  SpanU8 body;    // The encoded instructions, including the final `end`.
+};
+
+/// ---
+// Records where each function body in a code section begins and ends, so a
+// single Code can be read without decoding the ones before it. Building the
+// index only reads the body lengths and skips over the locals declarations;
+// instructions are not decoded.
+//
+// Entries are indexed by their position in the code section, so imported
+// functions are not counted.
+class CodeSectionIndex {
+ public:
+  CodeSectionIndex() = default;
+  explicit CodeSectionIndex(SpanU8, const Features&, Errors&);
+  explicit CodeSectionIndex(KnownSection, const Features&, Errors&);
+
+  Index size() const { return entries_.size(); }
+  const std::vector<CodeIndexEntry>& entries() const { return entries_; }
+
+  optional<Code> GetCode(Index, const Features&, Errors&) const;
+
+ private:
+  std::vector<CodeIndexEntry> entries_;
+};
+
+}  // namespace binary
+}  // namespace wasp
+
+#endif  // WASP_BINARY_CODE_SECTION_INDEX_H_
@@ -0,0 +1,114 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <cstring>
+
+namespace wasp {
+namespace binary {
+
+template <typename T>
+T CompactInstruction::Get() const {
+  static_assert(sizeof(T) <= sizeof(payload_), "Immediate too large");
+  T result;
+  std::memcpy(&result, payload_, sizeof(T));
+  return result;
+}
+
+template <typename T>
+void CompactInstruction::Set(const T& value) {
+  static_assert(sizeof(T) <= sizeof(payload_), "Immediate too large");
+  std::memcpy(payload_, &value, sizeof(T));
+}
+
+inline BlockType CompactInstruction::block_type_immediate() const {
+  return Get<BlockType>();
+}
+
+inline Index CompactInstruction::index_immediate() const {
+  return payload_[0];
+}
+
+inline CallIndirectImmediate CompactInstruction::call_indirect_immediate()
+    const {
+  return CallIndirectImmediate{payload_[0], small_};
+}
+
+inline BrOnExnImmediate CompactInstruction::br_on_exn_immediate() const {
+  return BrOnExnImmediate{payload_[0], payload_[1]};
+}
+
+inline u8 CompactInstruction::u8_immediate() const {
+  return small_;
+}
+
+inline MemArgImmediate CompactInstruction::mem_arg_immediate() const {
+  return MemArgImmediate{payload_[0], payload_[1]};
+}
+
+inline s32 CompactInstruction::s32_immediate() const {
+  return Get<s32>();
+}
+
+inline s64 CompactInstruction::s64_immediate() const {
+  return Get<s64>();
+}
+
+inline f32 CompactInstruction::f32_immediate() const {
+  return Get<f32>();
+}
+
+inline f64 CompactInstruction::f64_immediate() const {
+  return Get<f64>();
+}
+
+inline InitImmediate CompactInstruction::init_immediate() const {
+  return InitImmediate{payload_[0], small_};
+}
+
+inline CopyImmediate CompactInstruction::copy_immediate() const {
+  return CopyImmediate{small_, static_cast<u8>(payload_[0])};
+}
+
+// br_table: payload_[0] is the arena offset of the targets, followed by the
+// default target; payload_[1] is the number of targets.
+inline span<const Index> CompactInstruction::br_table_targets(
+    const CompactExpression& expr) const {
+  return span<const Index>{expr.arena.data() + payload_[0],
+                           static_cast<span<const Index>::index_type>(
+                               payload_[1])};
+}
+
+inline Index CompactInstruction::br_table_default_target(
+    const CompactExpression& expr) const {
+  return expr.arena[payload_[0] + payload_[1]];
+}
+
+// v128 and shuffle: payload_[0] is the arena offset of four u32 values.
+inline v128 CompactInstruction::v128_immediate(
+    const CompactExpression& expr) const {
+  const u32* data = expr.arena.data() + payload_[0];
+  return v128{u32x4{{data[0], data[1], data[2], data[3]}}};
+}
+
+inline ShuffleImmediate CompactInstruction::shuffle_immediate(
+    const CompactExpression& expr) const {
+  ShuffleImmediate result;
+  std::memcpy(result.data(), expr.arena.data() + payload_[0], result.size());
+  return result;
+}
+
+}  // namespace binary
+}  // namespace wasp
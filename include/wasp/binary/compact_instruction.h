@@ -0,0 +1,141 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_COMPACT_INSTRUCTION_H_
+#define WASP_BINARY_COMPACT_INSTRUCTION_H_
+
+#include <vector>
+
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+#include "wasp/base/v128.h"
+#include "wasp/binary/block_type.h"
+#include "wasp/binary/br_on_exn_immediate.h"
+#include "wasp/binary/call_indirect_immediate.h"
+#include "wasp/binary/copy_immediate.h"
+#include "wasp/binary/expression.h"
+#include "wasp/binary/init_immediate.h"
+#include "wasp/binary/instruction.h"
+#include "wasp/binary/mem_arg_immediate.h"
+#include "wasp/binary/opcode.h"
+#include "wasp/binary/shuffle_immediate.h"
+
+namespace wasp {
+
+class Features;
+
+namespace binary {
+
+class Errors;
+struct CompactExpression;
+
+// Matches the order of the alternatives in Instruction::immediate.
+enum class CompactImmediateKind : u8 {
+  Empty,
+  BlockType,
+  Index,
+  CallIndirect,
+  BrTable,
+  BrOnExn,
+  U8,
+  MemArg,
+  S32,
+  S64,
+  F32,
+  F64,
+  V128,
+  Init,
+  Copy,
+  Shuffle,
+};
+
+/// ---
+// A fixed-size, trivially copyable alternative to Instruction. Immediates of
+// up to 8 bytes are stored inline; br_table targets, v128 values and shuffle
+// lanes are stored in the arena of the CompactExpression that holds the
+// instruction.
+class CompactInstruction {
+ public:
+  Opcode opcode() const { return opcode_; }
+  CompactImmediateKind kind() const { return kind_; }
+
+  BlockType block_type_immediate() const;
+  Index index_immediate() const;
+  CallIndirectImmediate call_indirect_immediate() const;
+  BrOnExnImmediate br_on_exn_immediate() const;
+  u8 u8_immediate() const;
+  MemArgImmediate mem_arg_immediate() const;
+  s32 s32_immediate() const;
+  s64 s64_immediate() const;
+  f32 f32_immediate() const;
+  f64 f64_immediate() const;
+  InitImmediate init_immediate() const;
+  CopyImmediate copy_immediate() const;
+
+  // Immediates stored out of line.
+  span<const Index> br_table_targets(const CompactExpression&) const;
+  Index br_table_default_target(const CompactExpression&) const;
+  v128 v128_immediate(const CompactExpression&) const;
+  ShuffleImmediate shuffle_immediate(const CompactExpression&) const;
+
+ private:
+  friend struct CompactExpression;
+
+  template <typename T>
+  T Get() const;
+  template <typename T>
+  void Set(const T&);
+
+  Opcode opcode_;
+  CompactImmediateKind kind_;
+  u8 small_;  // u8 immediates and reserved bytes.
+  u16 unused_;
+  u32 payload_[2];
+};
+
+static_assert(sizeof(CompactInstruction) <= 16,
+              "CompactInstruction should fit in 16 bytes");
+
+/// ---
+// The decoded instructions of one function body. The vectors are reused when
+// the expression is cleared, so decoding many functions into the same
+// CompactExpression only allocates when a body is larger than any before it.
+struct CompactExpression {
+  void clear();
+  void Append(const Instruction&);
+
+  // Converts back to an Instruction. A br_table's targets are encoded into
+  // |br_table_buffer|, which must outlive the returned Instruction.
+  Instruction ToInstruction(const CompactInstruction&,
+                            BrTableTargetsBuffer* br_table_buffer) const;
+
+  std::vector<CompactInstruction> instructions;
+  std::vector<u32> arena;
+};
+
+// Decodes all instructions of |expression| into |out|, replacing its previous
+// contents. Returns false if an instruction could not be read.
+bool ReadCompactExpression(Expression expression,
+                           const Features&,
+                           Errors&,
+                           CompactExpression* out);
+
+}  // namespace binary
+}  // namespace wasp
+
+#include "wasp/binary/compact_instruction-inl.h"
+
+#endif  // WASP_BINARY_COMPACT_INSTRUCTION_H_
@@ -67,13 +67,13 @@ inline bool Opcode::IsPrefixByte(u8 code, const Features& features) {
 // static
 inline EncodedOpcode Opcode::Encode(::wasp::binary::Opcode decoded) {
   switch (decoded) {
-#define WASP_V(prefix, code, Name, str) \
-  case ::wasp::binary::Opcode::Name:    \
+#define WASP_V(prefix, code, Name, str, ...) \
+  case ::wasp::binary::Opcode::Name:         \
     return {code, {}};
-#define WASP_FEATURE_V(prefix, code, Name, str, feature) \
-  WASP_V(prefix, code, Name, str)
-#define WASP_PREFIX_V(prefix, code, Name, str, feature) \
-  case ::wasp::binary::Opcode::Name:                    \
+#define WASP_FEATURE_V(prefix, code, Name, str, feature, ...) \
+  WASP_V(prefix, code, Name, str, feature)
+#define WASP_PREFIX_V(prefix, code, Name, str, feature, ...) \
+  case ::wasp::binary::Opcode::Name:                         \
     return {prefix, code};
 #include "wasp/binary/opcode.def"
 #undef WASP_V
@@ -89,14 +89,14 @@ inline optional<::wasp::binary::Opcode> Opcode::Decode(
     u8 code,
     const Features& features) {
   switch (code) {
-#define WASP_V(prefix, code, Name, str) \
-  case code:                            \
+#define WASP_V(prefix, code, Name, str, ...) \
+  case code:                                 \
     return ::wasp::binary::Opcode::Name;
-#define WASP_FEATURE_V(prefix, code, Name, str, feature) \
-  case code:                                             \
-    if (features.feature##_enabled()) {                  \
-      return ::wasp::binary::Opcode::Name;               \
-    }                                                    \
+#define WASP_FEATURE_V(prefix, code, Name, str, feature, ...) \
+  case code:                                                  \
+    if (features.feature##_enabled()) {                       \
+      return ::wasp::binary::Opcode::Name;                    \
+    }                                                         \
     break;
 #define WASP_PREFIX_V(...) /* Invalid. */
 #include "wasp/binary/opcode.def"
@@ -125,11 +125,11 @@ inline optional<::wasp::binary::Opcode> Opcode::Decode(
   switch (MakePrefixCode(prefix, code)) {
 #define WASP_V(...) /* Invalid. */
 #define WASP_FEATURE_V(...) /* Invalid. */
-#define WASP_PREFIX_V(prefix, code, Name, str, feature) \
-  case MakePrefixCode(prefix, code):                    \
-    if (features.feature##_enabled()) {                 \
-      return ::wasp::binary::Opcode::Name;              \
-    }                                                   \
+#define WASP_PREFIX_V(prefix, code, Name, str, feature, ...) \
+  case MakePrefixCode(prefix, code):                         \
+    if (features.feature##_enabled()) {                      \
+      return ::wasp::binary::Opcode::Name;                   \
+    }                                                        \
     break;
 #include "wasp/binary/opcode.def"
 #undef WASP_V
@@ -18,15 +18,30 @@ namespace wasp {
 namespace binary {
 
 inline void Errors::PushContext(SpanU8 pos, string_view desc) {
-  HandlePushContext(pos, desc);
+  if (!discards_) {
+    HandlePushContext(pos, desc);
+  }
 }
 
 inline void Errors::PopContext() {
-  HandlePopContext();
+  if (!discards_) {
+    HandlePopContext();
+  }
 }
 
 inline void Errors::OnError(SpanU8 pos, string_view message) {
-  HandleOnError(pos, message);
+  if (!discards_) {
+    HandleOnError(pos, message);
+  }
+}
+
+template <typename... Args>
+void Errors::OnError(SpanU8 pos, string_view format_str, const Args&... args) {
+  if (!discards_) {
+    HandleOnError(pos, vformat(fmt::string_view{format_str.data(),
+                                                format_str.size()},
+                               make_format_args(args...)));
+  }
 }
 
 }  // namespace binary
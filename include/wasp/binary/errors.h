@@ -17,6 +17,7 @@
 #ifndef WASP_BINARY_ERRORS_H_
 #define WASP_BINARY_ERRORS_H_
 
+#include "wasp/base/format.h"
 #include "wasp/base/span.h"
 #include "wasp/base/string_view.h"
 
@@ -25,15 +26,41 @@ namespace binary {
 
 class Errors {
  public:
+  Errors() = default;
   virtual ~Errors() {}
+
+  // True if context and errors are thrown away without reaching the
+  // handlers. Readers can skip work that only produces diagnostics.
+  bool discards() const { return discards_; }
+
   void PushContext(SpanU8 pos, string_view desc);
   void PopContext();
   void OnError(SpanU8 pos, string_view message);
 
+  // Reports an error whose message is |format_str| formatted with |args|.
+  // The message is only formatted when it will reach the handler.
+  template <typename... Args>
+  void OnError(SpanU8 pos, string_view format_str, const Args&... args);
+
  protected:
+  struct Discard {};
+
+  // An Errors that discards everything. PushContext, PopContext and OnError
+  // reduce to an inlined branch, instead of a virtual call per read.
+  //
+  // This is a runtime flag by design, not a template or tag parameter on the
+  // readers. The readers are compiled once in read.cc against Errors&; making
+  // the policy compile-time would move all of them into header templates
+  // instantiated per Errors type. The branch that remains is well predicted,
+  // since the flag never changes for a given Errors.
+  explicit Errors(Discard) : discards_{true} {}
+
   virtual void HandlePushContext(SpanU8 pos, string_view desc) = 0;
   virtual void HandlePopContext() = 0;
   virtual void HandleOnError(SpanU8 pos, string_view message) = 0;
+
+ private:
+  bool discards_ = false;
 };
 
 }  // namespace binary
@@ -22,7 +22,10 @@
 namespace wasp {
 namespace binary {
 
-class ErrorsNop : public Errors {
+class ErrorsNop final : public Errors {
+ public:
+  ErrorsNop() : Errors{Discard{}} {}
+
  protected:
   void HandlePushContext(SpanU8 pos, string_view desc) override {}
   void HandlePopContext() override {}
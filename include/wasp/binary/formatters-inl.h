@@ -410,6 +410,21 @@ typename Ctx::iterator formatter<::wasp::binary::CallIndirectImmediate>::format(
   return formatter<string_view>::format(to_string_view(buf), ctx);
 }
 
+template <typename Ctx>
+typename Ctx::iterator formatter<::wasp::binary::BrTableTargets>::format(
+    const ::wasp::binary::BrTableTargets& self,
+    Ctx& ctx) {
+  memory_buffer buf;
+  string_view space = "";
+  format_to(buf, "[");
+  for (auto target : self) {
+    format_to(buf, "{}{}", space, target);
+    space = " ";
+  }
+  format_to(buf, "]");
+  return formatter<string_view>::format(to_string_view(buf), ctx);
+}
+
 template <typename Ctx>
 typename Ctx::iterator formatter<::wasp::binary::BrTableImmediate>::format(
     const ::wasp::binary::BrTableImmediate& self,
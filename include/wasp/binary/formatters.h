@@ -91,6 +91,7 @@ WASP_DEFINE_FORMATTER(ConstantExpression);
 WASP_DEFINE_FORMATTER(ElementExpression);
 WASP_DEFINE_FORMATTER(Opcode);
 WASP_DEFINE_FORMATTER(CallIndirectImmediate);
+WASP_DEFINE_FORMATTER(BrTableTargets);
 WASP_DEFINE_FORMATTER(BrTableImmediate);
 WASP_DEFINE_FORMATTER(BrOnExnImmediate);
 WASP_DEFINE_FORMATTER(InitImmediate);
@@ -0,0 +1,81 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_FUNCTION_TYPE_INTERNER_H_
+#define WASP_BINARY_FUNCTION_TYPE_INTERNER_H_
+
+#include <vector>
+
+#include "wasp/base/optional.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/function_type.h"
+#include "wasp/binary/value_types.h"
+
+namespace wasp {
+namespace binary {
+
+/// ---
+// Gives every distinct function signature a small integer id, so that two
+// signatures can be compared by comparing their ids. Structurally equal
+// signatures (e.g. the duplicate type entries that many toolchains emit) get
+// the same id.
+//
+// The value types of all signatures are stored back to back in one vector,
+// and are returned as spans into it. Interning a new signature may reallocate
+// that vector, so spans must not be held across calls to Intern.
+class FunctionTypeInterner {
+ public:
+  // Returns the id of the signature, adding it if it is new. Ids are
+  // assigned in order starting at 0.
+  Index Intern(ValueTypeSpan param_types, ValueTypeSpan result_types);
+  Index Intern(const FunctionType&);
+
+  optional<Index> Find(ValueTypeSpan param_types,
+                       ValueTypeSpan result_types) const;
+
+  // The number of distinct signatures.
+  Index size() const { return entries_.size(); }
+
+  ValueTypeSpan param_types(Index id) const;
+  ValueTypeSpan result_types(Index id) const;
+
+ private:
+  struct Entry {
+    u32 begin;  // Offset of the param types in types_.
+    u32 param_count;
+    u32 result_count;  // The result types follow the param types.
+    u32 hash;
+  };
+
+  static u32 Hash(ValueTypeSpan param_types, ValueTypeSpan result_types);
+  // Returns the slot that holds the signature, or the empty slot where it
+  // would be inserted.
+  size_t FindSlot(ValueTypeSpan param_types,
+                  ValueTypeSpan result_types,
+                  u32 hash) const;
+  void Grow();
+
+  static constexpr Index kEmptySlot = ~Index{0};
+
+  std::vector<ValueType> types_;
+  std::vector<Entry> entries_;
+  std::vector<Index> slots_;  // Open-addressed table of ids.
+};
+
+}  // namespace binary
+}  // namespace wasp
+
+#endif  // WASP_BINARY_FUNCTION_TYPE_INTERNER_H_
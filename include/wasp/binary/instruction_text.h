@@ -0,0 +1,45 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_INSTRUCTION_TEXT_H_
+#define WASP_BINARY_INSTRUCTION_TEXT_H_
+
+#include "wasp/base/string_view.h"
+#include "wasp/binary/block_type.h"
+#include "wasp/binary/instruction.h"
+#include "wasp/binary/opcode.h"
+
+namespace wasp {
+
+class TextBuffer;
+
+namespace binary {
+
+// Returns the text name of the opcode, e.g. "i32.add", or an empty string for
+// an unknown opcode. The names come from the table in opcode_info.h.
+string_view GetOpcodeName(Opcode);
+
+// Returns the text of the block type, e.g. "[i32]".
+string_view GetBlockTypeName(BlockType);
+
+// Appends the instruction to |buffer|. The text is the same as
+// format("{}", instr), but is written without parsing any format strings.
+void AppendInstruction(TextBuffer& buffer, const Instruction&);
+
+}  // namespace binary
+}  // namespace wasp
+
+#endif  // WASP_BINARY_INSTRUCTION_TEXT_H_
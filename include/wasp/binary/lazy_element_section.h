@@ -21,6 +21,7 @@
 #include "wasp/base/span.h"
 #include "wasp/binary/element_segment.h"
 #include "wasp/binary/known_section.h"
+#include "wasp/binary/lazy_section.h"
 #include "wasp/binary/read/read_element_segment.h"
 
 namespace wasp {
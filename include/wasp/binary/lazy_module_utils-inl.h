@@ -29,43 +29,39 @@ void ForEachFunctionName(LazyModule& module,
                          F&& f,
                          const Features& features,
                          Errors& errors) {
-  Index imported_function_count = 0;
-  for (auto section : module.sections) {
-    if (section.is_known()) {
-      auto known = section.known();
-      switch (known.id) {
-        case SectionId::Import:
-          for (auto import :
-               ReadImportSection(known, features, errors).sequence) {
-            if (import.kind() == ExternalKind::Function) {
-              f(IndexNamePair{imported_function_count++, import.name});
-            }
-          }
-          break;
+  ForEachFunctionName(SectionIndex{module}, std::forward<F>(f), features,
+                      errors);
+}
 
-        case SectionId::Export:
-          for (auto export_ :
-               ReadExportSection(known, features, errors).sequence) {
-            if (export_.kind == ExternalKind::Function) {
-              f(IndexNamePair{export_.index, export_.name});
-            }
-          }
-          break;
+template <typename F>
+void ForEachFunctionName(const SectionIndex& index,
+                         F&& f,
+                         const Features& features,
+                         Errors& errors) {
+  if (auto known = index.GetKnownSection(SectionId::Import)) {
+    Index imported_function_count = 0;
+    for (auto import : ReadImportSection(*known, features, errors).sequence) {
+      if (import.kind() == ExternalKind::Function) {
+        f(IndexNamePair{imported_function_count++, import.name});
+      }
+    }
+  }
 
-        default:
-          break;
+  if (auto known = index.GetKnownSection(SectionId::Export)) {
+    for (auto export_ : ReadExportSection(*known, features, errors).sequence) {
+      if (export_.kind == ExternalKind::Function) {
+        f(IndexNamePair{export_.index, export_.name});
       }
-    } else if (section.is_custom()) {
-      auto custom = section.custom();
-      if (custom.name == "name") {
-        for (auto subsection : ReadNameSection(custom, features, errors)) {
-          if (subsection.id == NameSubsectionId::FunctionNames) {
-            for (auto name_assoc :
-                 ReadFunctionNamesSubsection(subsection, features, errors)
-                     .sequence) {
-              f(IndexNamePair{name_assoc.index, name_assoc.name});
-            }
-          }
+    }
+  }
+
+  if (auto custom = index.GetCustomSection("name")) {
+    for (auto subsection : ReadNameSection(*custom, features, errors)) {
+      if (subsection.id == NameSubsectionId::FunctionNames) {
+        for (auto name_assoc :
+             ReadFunctionNamesSubsection(subsection, features, errors)
+                 .sequence) {
+          f(IndexNamePair{name_assoc.index, name_assoc.name});
         }
       }
     }
@@ -77,7 +73,15 @@ Iterator CopyFunctionNames(LazyModule& module,
                            Iterator out,
                            const Features& features,
                            Errors& errors) {
-  ForEachFunctionName(module,
+  return CopyFunctionNames(SectionIndex{module}, out, features, errors);
+}
+
+template <typename Iterator>
+Iterator CopyFunctionNames(const SectionIndex& index,
+                           Iterator out,
+                           const Features& features,
+                           Errors& errors) {
+  ForEachFunctionName(index,
                       [&out](const IndexNamePair& pair) { *out++ = pair; },
                       features, errors);
   return out;
@@ -87,17 +91,18 @@ inline Index GetImportCount(LazyModule& module,
                             ExternalKind kind,
                             const Features& features,
                             Errors& errors) {
+  return GetImportCount(SectionIndex{module}, kind, features, errors);
+}
+
+inline Index GetImportCount(const SectionIndex& index,
+                            ExternalKind kind,
+                            const Features& features,
+                            Errors& errors) {
   Index count = 0;
-  for (auto section : module.sections) {
-    if (section.is_known()) {
-      auto known = section.known();
-      if (known.id == SectionId::Import) {
-        for (auto import :
-             ReadImportSection(known, features, errors).sequence) {
-          if (import.kind() == kind) {
-            count++;
-          }
-        }
+  if (auto known = index.GetKnownSection(SectionId::Import)) {
+    for (auto import : ReadImportSection(*known, features, errors).sequence) {
+      if (import.kind() == kind) {
+        count++;
       }
     }
   }
@@ -22,6 +22,7 @@
 #include "wasp/base/features.h"
 #include "wasp/binary/external_kind.h"
 #include "wasp/binary/lazy_module.h"
+#include "wasp/binary/section_index.h"
 
 namespace wasp {
 namespace binary {
@@ -30,13 +31,27 @@ class Errors;
 
 using IndexNamePair = std::pair<Index, string_view>;
 
+// The SectionIndex overloads look up the import, export and "name" sections
+// directly; the LazyModule overloads build a SectionIndex first.
+
 template <typename F>
 void ForEachFunctionName(LazyModule&, F&&, const Features&, Errors&);
+template <typename F>
+void ForEachFunctionName(const SectionIndex&, F&&, const Features&, Errors&);
 
 template <typename Iterator>
 Iterator CopyFunctionNames(LazyModule&, Iterator out, const Features&, Errors&);
+template <typename Iterator>
+Iterator CopyFunctionNames(const SectionIndex&,
+                           Iterator out,
+                           const Features&,
+                           Errors&);
 
 Index GetImportCount(LazyModule&, ExternalKind, const Features&, Errors&);
+Index GetImportCount(const SectionIndex&,
+                     ExternalKind,
+                     const Features&,
+                     Errors&);
 
 }  // namespace binary
 }  // namespace wasp
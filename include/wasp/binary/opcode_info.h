@@ -0,0 +1,100 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_OPCODE_INFO_H_
+#define WASP_BINARY_OPCODE_INFO_H_
+
+#include "wasp/base/features.h"
+#include "wasp/base/string_view.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/opcode.h"
+#include "wasp/binary/value_type.h"
+#include "wasp/binary/value_types.h"
+
+namespace wasp {
+namespace binary {
+
+// How the immediate that follows an opcode is encoded; this is the last
+// column of opcode.def. Unlike CompactImmediateKind, reserved bytes and lane
+// indexes are distinct kinds, even though both decode to a u8.
+enum class ImmediateKind : u8 {
+  Empty,
+  BlockType,
+  Index,
+  BrOnExn,
+  BrTable,
+  CallIndirect,
+  MemArg,
+  Reserved,
+  S32,
+  S64,
+  F32,
+  F64,
+  V128,
+  Init,
+  Copy,
+  Shuffle,
+  U8,
+};
+
+/// ---
+// The types an instruction pops and pushes, for opcodes whose stack effect
+// depends only on the opcode; this is the last column of opcode.def. Types
+// are listed bottom to top, so the last param is on top of the stack.
+struct StackSignature {
+  ValueTypeSpan param_types() const {
+    return ValueTypeSpan{params, param_count};
+  }
+  ValueTypeSpan result_types() const {
+    return ValueTypeSpan{results, result_count};
+  }
+
+  u8 param_count;
+  u8 result_count;
+  ValueType params[3];
+  ValueType results[1];
+};
+
+/// ---
+// The static description of an opcode, built at compile time from
+// opcode.def.
+struct OpcodeInfo {
+  using FeatureEnabled = bool (Features::*)() const;
+
+  Opcode opcode;
+  u8 prefix;  // 0 for single-byte opcodes.
+  u32 code;
+  ImmediateKind immediate;
+  FeatureEnabled feature;  // nullptr if the opcode is always available.
+  string_view name;
+  // nullptr if the stack effect depends on the immediate or the context, as
+  // for calls, locals and control instructions.
+  const StackSignature* stack_signature;
+};
+
+// Returns the info for |opcode|, or nullptr if it is not a known opcode.
+const OpcodeInfo* GetOpcodeInfo(Opcode);
+
+// Decode an opcode with two table lookups instead of a switch: a 256-entry
+// table for single-byte opcodes, and a dense table per prefix byte. Returns
+// nullptr if the opcode is unknown or its feature is disabled.
+const OpcodeInfo* DecodeOpcode(u8 code, const Features&);
+const OpcodeInfo* DecodeOpcode(u8 prefix, u32 code, const Features&);
+
+}  // namespace binary
+}  // namespace wasp
+
+#endif  // WASP_BINARY_OPCODE_INFO_H_
@@ -0,0 +1,98 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_OPCODE_SCANNER_H_
+#define WASP_BINARY_OPCODE_SCANNER_H_
+
+#include <initializer_list>
+#include <vector>
+
+#include "wasp/base/optional.h"
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/errors_nop.h"
+#include "wasp/binary/instruction.h"
+#include "wasp/binary/opcode.h"
+#include "wasp/binary/opcode_info.h"
+
+namespace wasp {
+
+class Features;
+
+namespace binary {
+
+class Errors;
+
+/// ---
+// The opcodes an OpcodeScanner stops at.
+class OpcodeSet {
+ public:
+  OpcodeSet() = default;
+  OpcodeSet(std::initializer_list<Opcode>);
+
+  void Add(Opcode);
+  bool Contains(Opcode) const;
+
+ private:
+  std::vector<bool> opcodes_;
+};
+
+struct ScannedInstruction {
+  u32 offset;  // From the start of the scanned data.
+  Instruction instruction;
+};
+
+/// ---
+// Finds the instructions in a function body whose opcodes are in an
+// OpcodeSet. Every other instruction is stepped over using only the length
+// rules for its immediate kind: LEB128 values are skipped without computing
+// their value, and fixed-size immediates are not read at all. Only the
+// matching instructions are decoded.
+//
+// Skipped instructions are only checked as far as needed to find the next
+// instruction, so e.g. an out-of-range LEB128 value or a non-zero reserved
+// byte is not reported. Unknown opcodes and truncated immediates are
+// reported to |errors|, with the same messages as Read<Instruction>.
+class OpcodeScanner {
+ public:
+  explicit OpcodeScanner(SpanU8 data,
+                         const OpcodeSet&,
+                         const Features&,
+                         Errors&);
+
+  // Returns the next matching instruction, or nullopt at the end of the data
+  // or on the first error.
+  optional<ScannedInstruction> Next();
+
+ private:
+  const u8* SkipImmediate(ImmediateKind, const u8* pos);
+  template <typename T>
+  const u8* SkipVarInt(const u8* pos);
+  const u8* SkipBytes(const u8* pos, SpanU8::index_type count);
+  optional<ScannedInstruction> Fail(const u8* instruction);
+
+  const u8* begin_;
+  SpanU8 data_;
+  const OpcodeSet& opcodes_;
+  const Features& features_;
+  Errors& errors_;
+  ErrorsNop nop_errors_;
+};
+
+}  // namespace binary
+}  // namespace wasp
+
+#endif  // WASP_BINARY_OPCODE_SCANNER_H_
@@ -34,11 +34,11 @@
   WASP_TRY_READ(var, call);                            \
   guard_##var.PopContext() /* No semicolon. */
 
-#define WASP_TRY_DECODE(out_var, in_var, Type, name)               \
-  auto out_var = encoding::Type::Decode(in_var);                   \
-  if (!out_var) {                                                  \
-    errors.OnError(*data, format("Unknown " name ": {}", in_var)); \
-    return nullopt;                                                \
+#define WASP_TRY_DECODE(out_var, in_var, Type, name)       \
+  auto out_var = encoding::Type::Decode(in_var);           \
+  if (!out_var) {                                          \
+    errors.OnError(*data, "Unknown " name ": {}", in_var); \
+    return nullopt;                                        \
   }
 
 #endif  // WASP_BINARY_MACROS_H_
@@ -41,11 +41,14 @@ S SignExtend(typename std::make_unsigned<S>::type x, int N) {
   return static_cast<S>(x << (kNumBits - N - 1)) >> (kNumBits - N - 1);
 }
 
+// Reads a LEB128-encoded value one byte at a time, checking bounds and
+// reporting errors as it goes. Used when the fast path below can't be taken,
+// e.g. near the end of |data| or when the encoding is invalid.
 template <typename T>
-optional<T> ReadVarInt(SpanU8* data,
-                       const Features& features,
-                       Errors& errors,
-                       string_view desc) {
+optional<T> ReadVarIntSlow(SpanU8* data,
+                           const Features& features,
+                           Errors& errors,
+                           string_view desc) {
   using U = typename std::make_unsigned<T>::type;
   constexpr bool is_signed = std::is_signed<T>::value;
   constexpr int kByteMask = VarInt<T>::kByteMask;
@@ -71,14 +74,15 @@ optional<T> ReadVarInt(SpanU8* data,
       const u8 zero_ext = byte & ~kLastByteMask & kByteMask;
       const u8 one_ext = (byte | kLastByteOnes) & kByteMask;
       if (is_signed) {
-        errors.OnError(
-            *data, format("Last byte of {} must be sign "
-                          "extension: expected {:#2x} or {:#2x}, got {:#2x}",
-                          desc, zero_ext, one_ext, byte));
+        errors.OnError(*data,
+                       "Last byte of {} must be sign extension: expected "
+                       "{:#2x} or {:#2x}, got {:#2x}",
+                       desc, zero_ext, one_ext, byte);
       } else {
-        errors.OnError(*data, format("Last byte of {} must be zero "
-                                     "extension: expected {:#2x}, got {:#2x}",
-                                     desc, zero_ext, byte));
+        errors.OnError(*data,
+                       "Last byte of {} must be zero extension: expected "
+                       "{:#2x}, got {:#2x}",
+                       desc, zero_ext, byte);
       }
       return nullopt;
     } else if ((byte & VarInt<T>::kExtendBit) == 0) {
@@ -87,6 +91,46 @@ optional<T> ReadVarInt(SpanU8* data,
   }
 }
 
+template <typename T>
+optional<T> ReadVarInt(SpanU8* data,
+                       const Features& features,
+                       Errors& errors,
+                       string_view desc) {
+  using U = typename std::make_unsigned<T>::type;
+  constexpr bool is_signed = std::is_signed<T>::value;
+  constexpr int kByteMask = VarInt<T>::kByteMask;
+  constexpr int kLastByteMaskBits =
+      VarInt<T>::kUsedBitsInLastByte - (is_signed ? 1 : 0);
+  constexpr u8 kLastByteMask = ~((1 << kLastByteMaskBits) - 1);
+  constexpr u8 kLastByteOnes = kLastByteMask & kByteMask;
+
+  // Fast path: if the longest encoding fits in |data|, no byte needs its own
+  // bounds check, and no error context is needed unless decoding fails.
+  if (data->size() >= VarInt<T>::kMaxBytes) {
+    const u8* p = data->data();
+    U result{};
+    for (int i = 0; i < VarInt<T>::kMaxBytes;) {
+      const u8 byte = p[i];
+      const int shift = i * 7;
+      result |= U(byte & kByteMask) << shift;
+
+      if (++i == VarInt<T>::kMaxBytes) {
+        if ((byte & kLastByteMask) == 0 ||
+            (is_signed && (byte & kLastByteMask) == kLastByteOnes)) {
+          remove_prefix(data, i);
+          return static_cast<T>(result);
+        }
+      } else if ((byte & VarInt<T>::kExtendBit) == 0) {
+        remove_prefix(data, i);
+        return is_signed ? SignExtend<T>(result, 6 + shift) : result;
+      }
+    }
+    // Invalid last byte; fall through so the error is reported.
+  }
+
+  return ReadVarIntSlow<T>(data, features, errors, desc);
+}
+
 }  // namespace binary
 }  // namespace wasp
 
@@ -0,0 +1,52 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_READ_READ_VAR_U32S_H_
+#define WASP_BINARY_READ_READ_VAR_U32S_H_
+
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+
+namespace wasp {
+
+class Features;
+
+namespace binary {
+
+class Errors;
+
+// Decodes up to |count| consecutive LEB128-encoded u32 values from the front
+// of |data| into |out|, and advances |data| past them. Stops early at the first
+// value that is truncated or malformed, without reporting an error. Returns the
+// number of values decoded.
+//
+// Runs of single-byte values are decoded with SSE2 or AVX2 when the compiler
+// targets them.
+Index DecodeVarU32s(SpanU8* data, u32* out, Index count);
+
+// Like calling Read<u32> |count| times, but uses DecodeVarU32s. If a value
+// can't be decoded, it is read again with Read<u32> so the error is reported
+// the same way. |out| must have room for |count| values.
+bool ReadVarU32s(SpanU8* data,
+                 u32* out,
+                 Index count,
+                 const Features&,
+                 Errors&);
+
+}  // namespace binary
+}  // namespace wasp
+
+#endif  // WASP_BINARY_READ_READ_VAR_U32S_H_
@@ -0,0 +1,78 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_RELOCATION_INDEX_H_
+#define WASP_BINARY_RELOCATION_INDEX_H_
+
+#include <vector>
+
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/relocation_entry.h"
+#include "wasp/binary/relocation_section.h"
+
+namespace wasp {
+namespace binary {
+
+using RelocationEntrySpan = span<const RelocationEntry>;
+
+/// ---
+// The entries of a relocation section, read once and sorted by offset.
+//
+// Look up the entries for a range of the target section with Find, or walk
+// them in offset order with a Cursor, e.g. while disassembling a function.
+// Neither copies the entries.
+class RelocationIndex {
+ public:
+  class Cursor;
+
+  RelocationIndex() = default;
+  explicit RelocationIndex(RelocationSection&);
+
+  RelocationEntrySpan entries() const { return entries_; }
+
+  // Returns the entries whose offset is in [begin, end).
+  RelocationEntrySpan Find(u32 begin, u32 end) const;
+
+  // Returns a cursor at the first entry whose offset is at least |offset|.
+  Cursor GetCursor(u32 offset) const;
+
+ private:
+  std::vector<RelocationEntry> entries_;
+};
+
+class RelocationIndex::Cursor {
+ public:
+  Cursor() = default;
+
+  // Returns the entries from the cursor up to, but not including, the first
+  // entry whose offset is at least |offset|, and moves past them.
+  RelocationEntrySpan AdvanceTo(u32 offset);
+
+  bool done() const { return entries_.empty(); }
+
+ private:
+  friend class RelocationIndex;
+
+  explicit Cursor(RelocationEntrySpan entries) : entries_{entries} {}
+
+  RelocationEntrySpan entries_;
+};
+
+}  // namespace binary
+}  // namespace wasp
+
+#endif  // WASP_BINARY_RELOCATION_INDEX_H_
@@ -0,0 +1,66 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_REWRITE_MODULE_H_
+#define WASP_BINARY_REWRITE_MODULE_H_
+
+#include <functional>
+
+#include "wasp/base/span.h"
+#include "wasp/binary/section.h"
+#include "wasp/binary/write/write_buffer.h"
+
+namespace wasp {
+namespace binary {
+
+class LazyModule;
+
+enum class SectionAction {
+  Keep,     // Copy the section's original bytes.
+  Drop,     // Leave the section out.
+  Replace,  // Write the bytes given in the replacement buffer instead.
+};
+
+// Called once for each section, in order. To replace a section, write the
+// complete encoded section (id, size and contents, e.g. with
+// write/write_section.h) to |replacement| and return SectionAction::Replace.
+// The buffer is empty on each call.
+using SectionRewriter =
+    std::function<SectionAction(const Section&, WriteBuffer& replacement)>;
+
+// Receives the rewritten module as a sequence of spans, in order. Spans of
+// kept sections point into the original module data; others are only valid
+// for the duration of the call.
+using RewriteSink = std::function<void(SpanU8)>;
+
+// Writes a copy of |module| to |sink|, asking |rewriter| what to do with each
+// section. Kept sections are never decoded past their headers or re-encoded:
+// each run of consecutive kept sections (including the module header) is
+// passed to |sink| as one span of the original bytes, so a sink that writes
+// to a file does a few large writes, much like copying the file.
+//
+// Returns false if the module is malformed, i.e. the header is missing or a
+// section could not be read; the error is reported to the Errors object the
+// module was read with. The output is incomplete in that case.
+bool RewriteModule(LazyModule&, const SectionRewriter&, const RewriteSink&);
+
+// As above, appending the rewritten module to |out|.
+bool RewriteModule(LazyModule&, const SectionRewriter&, WriteBuffer& out);
+
+}  // namespace binary
+}  // namespace wasp
+
+#endif  // WASP_BINARY_REWRITE_MODULE_H_
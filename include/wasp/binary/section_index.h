@@ -0,0 +1,79 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_SECTION_INDEX_H_
+#define WASP_BINARY_SECTION_INDEX_H_
+
+#include <array>
+#include <map>
+#include <vector>
+
+#include "wasp/base/optional.h"
+#include "wasp/base/span.h"
+#include "wasp/base/string_view.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/custom_section.h"
+#include "wasp/binary/known_section.h"
+#include "wasp/binary/section.h"
+#include "wasp/binary/section_id.h"
+
+namespace wasp {
+namespace binary {
+
+class LazyModule;
+
+struct SectionIndexEntry {
+  SectionId id;      // SectionId::Custom for custom sections.
+  string_view name;  // Empty for known sections.
+  u32 offset;        // Offset of the section contents in the module.
+  u32 length;        // Length of the section contents.
+};
+
+/// ---
+// Records the location of every section in a module in a single pass, so
+// later lookups don't have to walk the section headers again.
+//
+// The SectionIndex refers to the module data, which must outlive it.
+class SectionIndex {
+ public:
+  SectionIndex() = default;
+  explicit SectionIndex(LazyModule&);
+
+  const std::vector<SectionIndexEntry>& entries() const { return entries_; }
+
+  Section GetSection(const SectionIndexEntry&) const;
+
+  // Returns the first section with the given id or name.
+  optional<KnownSection> GetKnownSection(SectionId) const;
+  optional<CustomSection> GetCustomSection(string_view name) const;
+
+ private:
+  static constexpr u32 kSectionIdCount = 0
+#define WASP_V(val, Name, str) +1
+#include "wasp/binary/section_id.def"
+#undef WASP_V
+      ;
+
+  SpanU8 data_;
+  std::vector<SectionIndexEntry> entries_;
+  std::array<optional<Index>, kSectionIdCount> known_{};
+  std::map<string_view, Index> custom_;
+};
+
+}  // namespace binary
+}  // namespace wasp
+
+#endif  // WASP_BINARY_SECTION_INDEX_H_
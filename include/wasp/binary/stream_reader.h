@@ -0,0 +1,101 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_STREAM_READER_H_
+#define WASP_BINARY_STREAM_READER_H_
+
+#include <vector>
+
+#include "wasp/base/features.h"
+#include "wasp/base/optional.h"
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/code.h"
+#include "wasp/binary/section.h"
+
+namespace wasp {
+namespace binary {
+
+class Errors;
+
+/// ---
+// Receives the parts of a module from a StreamReader as soon as they are
+// complete. The spans in each item are only valid until the callback returns,
+// since they may point into the reader's buffer.
+class StreamReaderCallbacks {
+ public:
+  virtual ~StreamReaderCallbacks() {}
+
+  // Called for every section except the code section.
+  virtual void OnSection(const Section&) {}
+
+  // The code section is not delivered as a whole. Instead OnCodeSectionStart
+  // is called with the function body count, then OnCode for each body as it
+  // arrives, then OnCodeSectionEnd.
+  virtual void OnCodeSectionStart(Index count) {}
+  virtual void OnCode(Index code_index, const Code&) {}
+  virtual void OnCodeSectionEnd() {}
+};
+
+/// ---
+// Reads a module that arrives in chunks, e.g. over the network, calling
+// |callbacks| for each section and function body as soon as it is complete.
+//
+// Only an item that is split across chunks is copied; complete items are read
+// directly from the chunk. Items are read with the same Read functions as
+// ReadModule, so errors are reported the same way, though error positions
+// point into the reader's buffer for items that were copied.
+class StreamReader {
+ public:
+  explicit StreamReader(StreamReaderCallbacks&, const Features&, Errors&);
+
+  // Reads as much of |chunk| as possible, and buffers the rest. Returns false
+  // if an error has been reported; later chunks are then ignored.
+  bool Append(SpanU8 chunk);
+
+  // Signals that there is no more data. Reports an error and returns false if
+  // the module ends in the middle of an item.
+  bool Finish();
+
+  bool ok() const { return state_ != State::Error; }
+
+ private:
+  enum class State {
+    Header,     // Before the magic and version.
+    Section,    // Before a section.
+    CodeCount,  // Before the function body count of the code section.
+    Code,       // Before a function body.
+    Error,
+  };
+
+  optional<SpanU8::index_type> ItemSize(SpanU8) const;
+  void ReadItem(SpanU8);
+  void CheckCodeSectionEnd(SpanU8);
+
+  StreamReaderCallbacks& callbacks_;
+  Features features_;
+  Errors& errors_;
+  State state_ = State::Header;
+  std::vector<u8> buffer_;  // An incomplete item, copied from earlier chunks.
+  u32 code_remaining_ = 0;  // Bytes left in the code section.
+  Index code_count_ = 0;    // Function bodies declared by the code section.
+  Index code_index_ = 0;
+};
+
+}  // namespace binary
+}  // namespace wasp
+
+#endif  // WASP_BINARY_STREAM_READER_H_
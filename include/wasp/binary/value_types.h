@@ -19,12 +19,14 @@
 
 #include <vector>
 
+#include "wasp/base/span.h"
 #include "wasp/binary/value_type.h"
 
 namespace wasp {
 namespace binary {
 
 using ValueTypes = std::vector<ValueType>;
+using ValueTypeSpan = span<const ValueType>;
 
 }  // namespace binary
 }  // namespace wasp
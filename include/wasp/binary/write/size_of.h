@@ -0,0 +1,80 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_WRITE_SIZE_OF_H_
+#define WASP_BINARY_WRITE_SIZE_OF_H_
+
+#include <cstddef>
+#include <iterator>
+
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/write/write_bytes.h"
+#include "wasp/binary/write/write_vector.h"
+
+namespace wasp {
+namespace binary {
+
+/// ---
+// An output iterator that counts the bytes written to it, and discards
+// them. Spans passed to WriteBytes are counted without being visited.
+class SizeCounter {
+ public:
+  using iterator_category = std::output_iterator_tag;
+  using value_type = void;
+  using difference_type = void;
+  using pointer = void;
+  using reference = void;
+
+  SizeCounter& operator=(u8) {
+    ++size_;
+    return *this;
+  }
+
+  SizeCounter& operator*() { return *this; }
+  SizeCounter& operator++() { return *this; }
+  SizeCounter& operator++(int) { return *this; }
+
+  void Add(size_t size) { size_ += size; }
+  size_t size() const { return size_; }
+
+ private:
+  size_t size_ = 0;
+};
+
+inline SizeCounter WriteBytes(SpanU8 value, SizeCounter out) {
+  out.Add(value.size());
+  return out;
+}
+
+// Returns the number of bytes that Write(value, out) would write. This lets
+// a length prefix be written before its contents without encoding them into
+// a temporary buffer first.
+template <typename T>
+size_t SizeOf(const T& value) {
+  return Write(value, SizeCounter{}).size();
+}
+
+// Returns the number of bytes that WriteVector(begin, end, out) would write.
+template <typename InputIterator>
+size_t SizeOfVector(InputIterator begin, InputIterator end) {
+  return WriteVector(begin, end, SizeCounter{}).size();
+}
+
+}  // namespace binary
+}  // namespace wasp
+
+#endif  // WASP_BINARY_WRITE_SIZE_OF_H_
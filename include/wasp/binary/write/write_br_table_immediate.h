@@ -20,14 +20,18 @@
 #include "wasp/binary/br_table_immediate.h"
 #include "wasp/binary/write/write_index.h"
 #include "wasp/binary/write/write_u32.h"
-#include "wasp/binary/write/write_vector.h"
 
 namespace wasp {
 namespace binary {
 
 template <typename Iterator>
 Iterator Write(const BrTableImmediate& immediate, Iterator out) {
-  out = WriteVector(immediate.targets.begin(), immediate.targets.end(), out);
+  // Use the stored count rather than WriteVector, which would decode the
+  // targets twice to find their distance.
+  out = Write(immediate.targets.size(), out);
+  for (auto target : immediate.targets) {
+    out = WriteIndex(target, out);
+  }
   out = WriteIndex(immediate.default_target, out);
   return out;
 }
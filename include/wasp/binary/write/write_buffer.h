@@ -0,0 +1,115 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_WRITE_WRITE_BUFFER_H_
+#define WASP_BINARY_WRITE_WRITE_BUFFER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/write/write_bytes.h"
+
+namespace wasp {
+namespace binary {
+
+/// ---
+// A contiguous byte buffer for the Write functions. Use output() to get an
+// output iterator that appends to the buffer:
+//
+//   WriteBuffer buffer;
+//   auto out = buffer.output();
+//   out = Write(value, out);
+//
+// The buffer grows geometrically, and WriteBytes copies spans (strings, data
+// segment contents, section and expression bytes) with a single memcpy
+// rather than one byte at a time.
+class WriteBuffer {
+ public:
+  class iterator;
+
+  WriteBuffer() = default;
+  explicit WriteBuffer(size_t capacity) { data_.reserve(capacity); }
+
+  iterator output();
+
+  void Append(u8 value) { data_.push_back(value); }
+  void Append(SpanU8 value) {
+    size_t needed = data_.size() + value.size();
+    if (needed > data_.capacity()) {
+      data_.reserve(std::max(needed, data_.capacity() * 2));
+    }
+    data_.insert(data_.end(), value.begin(), value.end());
+  }
+
+  void reserve(size_t capacity) { data_.reserve(capacity); }
+  void clear() { data_.clear(); }
+
+  bool empty() const { return data_.empty(); }
+  size_t size() const { return data_.size(); }
+  size_t capacity() const { return data_.capacity(); }
+  SpanU8 data() const { return SpanU8{data_}; }
+
+  // Moves the contents out of the buffer, leaving it empty.
+  std::vector<u8> Release() { return std::move(data_); }
+
+ private:
+  std::vector<u8> data_;
+};
+
+class WriteBuffer::iterator {
+ public:
+  using iterator_category = std::output_iterator_tag;
+  using value_type = void;
+  using difference_type = void;
+  using pointer = void;
+  using reference = void;
+
+  explicit iterator(WriteBuffer* buffer) : buffer_{buffer} {}
+
+  iterator& operator=(u8 value) {
+    buffer_->Append(value);
+    return *this;
+  }
+
+  iterator& operator*() { return *this; }
+  iterator& operator++() { return *this; }
+  iterator& operator++(int) { return *this; }
+
+  WriteBuffer* buffer() const { return buffer_; }
+
+ private:
+  WriteBuffer* buffer_;
+};
+
+inline WriteBuffer::iterator WriteBuffer::output() {
+  return iterator{this};
+}
+
+inline WriteBuffer::iterator WriteBytes(SpanU8 value,
+                                        WriteBuffer::iterator out) {
+  out.buffer()->Append(value);
+  return out;
+}
+
+}  // namespace binary
+}  // namespace wasp
+
+#endif  // WASP_BINARY_WRITE_WRITE_BUFFER_H_
@@ -0,0 +1,46 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_WRITE_WRITE_CODE_H_
+#define WASP_BINARY_WRITE_WRITE_CODE_H_
+
+#include <cassert>
+#include <limits>
+
+#include "wasp/binary/code.h"
+#include "wasp/binary/write/size_of.h"
+#include "wasp/binary/write/write_expression.h"
+#include "wasp/binary/write/write_locals.h"
+#include "wasp/binary/write/write_u32.h"
+#include "wasp/binary/write/write_vector.h"
+
+namespace wasp {
+namespace binary {
+
+template <typename Iterator>
+Iterator Write(const Code& value, Iterator out) {
+  size_t size = SizeOfVector(value.locals.begin(), value.locals.end()) +
+                value.body.data.size();
+  assert(size < std::numeric_limits<u32>::max());
+  out = Write(static_cast<u32>(size), out);
+  out = WriteVector(value.locals.begin(), value.locals.end(), out);
+  return Write(value.body, out);
+}
+
+}  // namespace binary
+}  // namespace wasp
+
+#endif  // WASP_BINARY_WRITE_WRITE_CODE_H_
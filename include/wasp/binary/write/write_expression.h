@@ -0,0 +1,35 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_WRITE_WRITE_EXPRESSION_H_
+#define WASP_BINARY_WRITE_WRITE_EXPRESSION_H_
+
+#include "wasp/binary/expression.h"
+#include "wasp/binary/write/write_bytes.h"
+
+namespace wasp {
+namespace binary {
+
+// The expression is already encoded, so it is copied as-is.
+template <typename Iterator>
+Iterator Write(const Expression& value, Iterator out) {
+  return WriteBytes(value.data, out);
+}
+
+}  // namespace binary
+}  // namespace wasp
+
+#endif  // WASP_BINARY_WRITE_WRITE_EXPRESSION_H_
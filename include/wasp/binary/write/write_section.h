@@ -0,0 +1,68 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_WRITE_WRITE_SECTION_H_
+#define WASP_BINARY_WRITE_WRITE_SECTION_H_
+
+#include <cassert>
+#include <limits>
+
+#include "wasp/base/macros.h"
+#include "wasp/binary/custom_section.h"
+#include "wasp/binary/known_section.h"
+#include "wasp/binary/section.h"
+#include "wasp/binary/write/size_of.h"
+#include "wasp/binary/write/write_bytes.h"
+#include "wasp/binary/write/write_section_id.h"
+#include "wasp/binary/write/write_string.h"
+#include "wasp/binary/write/write_u32.h"
+
+namespace wasp {
+namespace binary {
+
+template <typename Iterator>
+Iterator Write(const KnownSection& value, Iterator out) {
+  assert(value.data.size() < std::numeric_limits<u32>::max());
+  out = Write(value.id, out);
+  out = Write(static_cast<u32>(value.data.size()), out);
+  return WriteBytes(value.data, out);
+}
+
+template <typename Iterator>
+Iterator Write(const CustomSection& value, Iterator out) {
+  size_t size = SizeOf(value.name) + value.data.size();
+  assert(size < std::numeric_limits<u32>::max());
+  out = Write(SectionId::Custom, out);
+  out = Write(static_cast<u32>(size), out);
+  out = Write(value.name, out);
+  return WriteBytes(value.data, out);
+}
+
+template <typename Iterator>
+Iterator Write(const Section& value, Iterator out) {
+  if (value.is_known()) {
+    return Write(value.known(), out);
+  } else if (value.is_custom()) {
+    return Write(value.custom(), out);
+  } else {
+    WASP_UNREACHABLE();
+  }
+}
+
+}  // namespace binary
+}  // namespace wasp
+
+#endif  // WASP_BINARY_WRITE_WRITE_SECTION_H_
@@ -22,6 +22,7 @@
 #include "wasp/base/span.h"
 #include "wasp/base/string_view.h"
 #include "wasp/base/types.h"
+#include "wasp/binary/write/write_bytes.h"
 #include "wasp/binary/write/write_u32.h"
 
 namespace wasp {
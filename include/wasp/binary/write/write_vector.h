@@ -17,18 +17,24 @@
 #ifndef WASP_BINARY_WRITE_WRITE_VECTOR_H_
 #define WASP_BINARY_WRITE_WRITE_VECTOR_H_
 
+#include <cassert>
+#include <cstddef>
 #include <iterator>
+#include <limits>
+#include <vector>
 
 #include "wasp/binary/write/write_u32.h"
 
 namespace wasp {
 namespace binary {
 
+// Writes the |count| elements in [in_begin, in_end), prefixed by |count|. Use
+// this when the count is already known, e.g. from a LazySequence.
 template <typename InputIterator, typename OutputIterator>
 OutputIterator WriteVector(InputIterator in_begin,
                            InputIterator in_end,
-                           OutputIterator out) {
-  size_t count = std::distance(in_begin, in_end);
+                           OutputIterator out,
+                           size_t count) {
   assert(count < std::numeric_limits<u32>::max());
   out = Write(static_cast<u32>(count), out);
   for (auto it = in_begin; it != in_end; ++it) {
@@ -37,6 +43,40 @@ OutputIterator WriteVector(InputIterator in_begin,
   return out;
 }
 
+namespace internal {
+
+template <typename InputIterator, typename OutputIterator>
+OutputIterator WriteVector(InputIterator in_begin,
+                           InputIterator in_end,
+                           OutputIterator out,
+                           std::random_access_iterator_tag) {
+  return binary::WriteVector(in_begin, in_end, out, in_end - in_begin);
+}
+
+// Calling std::distance on a lazy range would decode every element twice, so
+// the elements are read once into a vector instead.
+template <typename InputIterator, typename OutputIterator>
+OutputIterator WriteVector(InputIterator in_begin,
+                           InputIterator in_end,
+                           OutputIterator out,
+                           std::input_iterator_tag) {
+  using T = typename std::iterator_traits<InputIterator>::value_type;
+  std::vector<T> elements(in_begin, in_end);
+  return binary::WriteVector(elements.begin(), elements.end(), out,
+                             elements.size());
+}
+
+}  // namespace internal
+
+template <typename InputIterator, typename OutputIterator>
+OutputIterator WriteVector(InputIterator in_begin,
+                           InputIterator in_end,
+                           OutputIterator out) {
+  return internal::WriteVector(
+      in_begin, in_end, out,
+      typename std::iterator_traits<InputIterator>::iterator_category{});
+}
+
 }  // namespace binary
 }  // namespace wasp
 
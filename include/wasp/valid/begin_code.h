@@ -27,35 +27,49 @@
 namespace wasp {
 namespace valid {
 
-inline bool BeginCode(Context& context,
+inline bool BeginCode(Index func_index,
+                      const ModuleContext& module,
+                      FunctionContext& function,
                       const Features& features,
                       Errors& errors) {
-  Index func_index = context.imported_function_count + context.code_count;
-  if (func_index >= context.functions.size()) {
+  // Clear the previous function's state first, so a context that is reused
+  // (e.g. per thread) never validates against a stale frame.
+  function.type_stack.clear();
+  function.label_stack.clear();
+  function.label_types.clear();
+  function.locals.Reset();
+  if (func_index >= module.functions.size()) {
     errors.OnError(format("Unexpected code index {}, function count is {}",
-                          func_index, context.functions.size()));
+                          func_index, module.functions.size()));
     return false;
   }
-  context.code_count++;
-  const binary::Function& function = context.functions[func_index];
-  context.type_stack.clear();
-  context.label_stack.clear();
+  const binary::Function& func = module.functions[func_index];
   // Don't validate the index, should have already been validated at this point.
-  if (function.type_index < context.types.size()) {
-    const binary::TypeEntry& type_entry = context.types[function.type_index];
-    context.locals = type_entry.type.param_types;
-    context.label_stack.push_back(Label{LabelType::Function,
-                                        type_entry.type.param_types,
-                                        type_entry.type.result_types, 0});
+  if (func.type_index < module.types.size()) {
+    const binary::TypeEntry& type_entry = module.types[func.type_index];
+    for (auto param_type : type_entry.type.param_types) {
+      function.locals.Append(1, param_type);
+    }
+    function.PushLabel(LabelType::Function, type_entry.type.param_types,
+                       type_entry.type.result_types);
     return true;
   } else {
     // Not valid, but try to continue anyway.
-    context.locals.clear();
-    context.label_stack.push_back(Label{LabelType::Function, {}, {}, 0});
+    function.PushLabel(LabelType::Function, {}, {});
     return false;
   }
 }
 
+inline bool BeginCode(Context& context,
+                      const Features& features,
+                      Errors& errors) {
+  Index func_index = context.imported_function_count + context.code_count;
+  if (func_index < context.functions.size()) {
+    context.code_count++;
+  }
+  return BeginCode(func_index, context, context, features, errors);
+}
+
 }  // namespace valid
 }  // namespace wasp
 
@@ -27,6 +27,7 @@
 #include "wasp/binary/table_type.h"
 #include "wasp/binary/type_entry.h"
 #include "wasp/binary/value_types.h"
+#include "wasp/valid/local_types.h"
 
 namespace wasp {
 namespace valid {
@@ -40,24 +41,28 @@ enum class LabelType {
   Try,
 };
 
+// A label's parameter and result types are stored in
+// FunctionContext::label_types rather than in the label itself, so pushing a
+// label never allocates once the function context has warmed up.
 struct Label {
   Label(LabelType,
-        const binary::ValueTypes& param_types,
-        const binary::ValueTypes& result_types,
+        Index types_begin,
+        Index param_count,
+        Index result_count,
         Index type_stack_limit);
 
-  const binary::ValueTypes& br_types() const {
-    return label_type == LabelType::Loop ? param_types : result_types;
-  }
-
   LabelType label_type;
-  binary::ValueTypes param_types;
-  binary::ValueTypes result_types;
+  Index types_begin;  // Offset of the param types in label_types.
+  Index param_count;
+  Index result_count;  // The result types follow the param types.
   Index type_stack_limit;
   bool unreachable;
 };
 
-struct Context {
+// Module-level state, gathered while validating the sections before the code
+// section. It is not modified while validating function bodies, so it can be
+// shared by several threads.
+struct ModuleContext {
   std::vector<binary::TypeEntry> types;
   std::vector<binary::Function> functions;
   std::vector<binary::TableType> tables;
@@ -67,10 +72,31 @@ struct Context {
   Index imported_function_count = 0;
   Index imported_global_count = 0;
   Index data_segment_count = 0;
-  Index code_count = 0;
-  std::vector<binary::ValueType> locals;
+};
+
+// Per-function scratch state, reset by BeginCode. The vectors keep their
+// capacity when reset, so a FunctionContext that is reused for many functions
+// stops allocating once it has seen the deepest nesting.
+struct FunctionContext {
+  void PushLabel(LabelType,
+                 binary::ValueTypeSpan param_types,
+                 binary::ValueTypeSpan result_types);
+  void PopLabel();
+
+  binary::ValueTypeSpan param_types(const Label&) const;
+  binary::ValueTypeSpan result_types(const Label&) const;
+  // The types a branch to the label must provide.
+  binary::ValueTypeSpan br_types(const Label&) const;
+
+  LocalTypes locals;
   std::vector<binary::ValueType> type_stack;
   std::vector<Label> label_stack;
+  // The param and result types of each label on label_stack, back to back.
+  std::vector<binary::ValueType> label_types;
+};
+
+struct Context : ModuleContext, FunctionContext {
+  Index code_count = 0;
 };
 
 }  // namespace valid
@@ -0,0 +1,56 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_VALID_LOCAL_TYPES_H_
+#define WASP_VALID_LOCAL_TYPES_H_
+
+#include <vector>
+
+#include "wasp/base/optional.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/value_type.h"
+
+namespace wasp {
+namespace valid {
+
+/// ---
+// The types of a function's params and locals, stored as runs of locals with
+// the same type. Memory and time scale with the number of local declarations,
+// not the number of locals, so `(local i32 x 0x7fffffff)` is as cheap as
+// `(local i32)`.
+class LocalTypes {
+ public:
+  // Removes all locals, keeping the allocated capacity.
+  void Reset();
+
+  // Appends |count| locals of the given type. Returns false, and leaves the
+  // locals unchanged, if the total count would not fit in an Index.
+  bool Append(Index count, binary::ValueType);
+
+  Index GetCount() const { return ends_.empty() ? 0 : ends_.back(); }
+  optional<binary::ValueType> GetType(Index) const;
+
+ private:
+  // ends_[i] is the index one past the last local of run i, so it is sorted
+  // and can be binary searched.
+  std::vector<Index> ends_;
+  std::vector<binary::ValueType> types_;
+};
+
+}  // namespace valid
+}  // namespace wasp
+
+#endif  // WASP_VALID_LOCAL_TYPES_H_
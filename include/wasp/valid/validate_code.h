@@ -0,0 +1,49 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_VALID_VALIDATE_CODE_H_
+#define WASP_VALID_VALIDATE_CODE_H_
+
+#include "wasp/base/types.h"
+#include "wasp/binary/code.h"
+
+namespace wasp {
+
+class Features;
+
+namespace valid {
+
+struct Context;
+struct FunctionContext;
+struct ModuleContext;
+class Errors;
+
+// Validates the next function body in the code section, using the same
+// bookkeeping as BeginCode.
+bool Validate(const binary::Code&, Context&, const Features&, Errors&);
+
+// Validates the body of function |func_index|. Only |function| is modified.
+bool Validate(const binary::Code&,
+              Index func_index,
+              const ModuleContext& module,
+              FunctionContext& function,
+              const Features&,
+              Errors&);
+
+}  // namespace valid
+}  // namespace wasp
+
+#endif  // WASP_VALID_VALIDATE_CODE_H_
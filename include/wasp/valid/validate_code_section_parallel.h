@@ -0,0 +1,49 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_VALID_VALIDATE_CODE_SECTION_PARALLEL_H_
+#define WASP_VALID_VALIDATE_CODE_SECTION_PARALLEL_H_
+
+#include <vector>
+
+#include "wasp/binary/code.h"
+
+namespace wasp {
+
+class Features;
+
+namespace valid {
+
+struct Context;
+class Errors;
+
+// Validates |codes|, the remaining function bodies of the code section, on up
+// to |thread_count| threads (0 means one per hardware thread). The
+// module-level part of |context| is shared between the threads; each thread
+// has its own per-function state.
+//
+// Errors are buffered per function and reported to |errors| in function
+// order, so the output is the same as validating the bodies one at a time.
+bool ValidateCodeSectionParallel(const std::vector<binary::Code>& codes,
+                                 Context&,
+                                 const Features&,
+                                 Errors&,
+                                 unsigned thread_count = 0);
+
+}  // namespace valid
+}  // namespace wasp
+
+#endif  // WASP_VALID_VALIDATE_CODE_SECTION_PARALLEL_H_
@@ -26,10 +26,18 @@ class Features;
 namespace valid {
 
 struct Context;
+struct FunctionContext;
+struct ModuleContext;
 class Errors;
 
 bool Validate(const binary::Instruction&, Context&, const Features&, Errors&);
 
+bool Validate(const binary::Instruction&,
+              const ModuleContext&,
+              FunctionContext&,
+              const Features&,
+              Errors&);
+
 }  // namespace valid
 }  // namespace wasp
 
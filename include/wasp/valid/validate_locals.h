@@ -25,10 +25,13 @@ class Features;
 
 namespace valid {
 
-struct Context;
+struct FunctionContext;
 class Errors;
 
-bool Validate(const binary::Locals&, Context&, const Features&, Errors&);
+bool Validate(const binary::Locals&,
+              FunctionContext&,
+              const Features&,
+              Errors&);
 
 }  // namespace valid
 }  // namespace wasp
@@ -0,0 +1,344 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/analysis/call_graph.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <iterator>
+#include <thread>
+#include <utility>
+
+#include "wasp/base/features.h"
+#include "wasp/binary/code_section_index.h"
+#include "wasp/binary/errors.h"
+#include "wasp/binary/errors_nop.h"
+#include "wasp/binary/function_type_interner.h"
+#include "wasp/binary/lazy_element_section.h"
+#include "wasp/binary/lazy_function_section.h"
+#include "wasp/binary/lazy_import_section.h"
+#include "wasp/binary/lazy_table_section.h"
+#include "wasp/binary/lazy_type_section.h"
+#include "wasp/binary/opcode_scanner.h"
+#include "wasp/binary/section_index.h"
+
+namespace wasp {
+namespace analysis {
+
+using namespace ::wasp::binary;
+
+namespace {
+
+// Function bodies are handed out to the threads in chunks, so each thread
+// appends to its own buffers and the chunks can be joined in function order.
+constexpr Index kFunctionsPerChunk = 64;
+
+constexpr Index kInvalidSignature = ~0;
+
+using SignatureFunctionPair = std::pair<Index, Index>;
+
+// The possible callees of `call_indirect`, for each table, sorted by
+// signature. Function types that are structurally equal share a signature.
+// Active segments for a table past |table_count| are ignored.
+class IndirectTargets {
+ public:
+  explicit IndirectTargets(std::vector<Index> type_signatures,
+                           const std::vector<Index>& function_types,
+                           Index table_count,
+                           const std::vector<ElementSegment>&);
+
+  // Appends the functions that a call through |table_index| with type
+  // |type_index| can reach.
+  void Append(Index table_index,
+              Index type_index,
+              std::vector<Index>* out) const;
+
+ private:
+  Index GetFunctionSignature(Index func_index) const;
+  static void Append(const std::vector<SignatureFunctionPair>&,
+                     Index signature,
+                     std::vector<Index>* out);
+
+  std::vector<Index> type_signatures_;
+  const std::vector<Index>& function_types_;
+  std::vector<std::vector<SignatureFunctionPair>> tables_;
+  std::vector<SignatureFunctionPair> passive_;
+};
+
+IndirectTargets::IndirectTargets(std::vector<Index> type_signatures,
+                                 const std::vector<Index>& function_types,
+                                 Index table_count,
+                                 const std::vector<ElementSegment>& segments)
+    : type_signatures_{std::move(type_signatures)},
+      function_types_{function_types},
+      tables_(table_count) {
+  auto add = [&](std::vector<SignatureFunctionPair>& table, Index func_index) {
+    auto signature = GetFunctionSignature(func_index);
+    if (signature != kInvalidSignature) {
+      table.emplace_back(signature, func_index);
+    }
+  };
+
+  for (const auto& segment : segments) {
+    if (segment.is_active()) {
+      const auto& active = segment.active();
+      if (active.table_index >= tables_.size()) {
+        continue;
+      }
+      for (Index func_index : active.init) {
+        add(tables_[active.table_index], func_index);
+      }
+    } else {
+      for (const auto& expr : segment.passive().init) {
+        if (expr.instruction.opcode == Opcode::RefFunc) {
+          add(passive_, expr.instruction.index_immediate());
+        }
+      }
+    }
+  }
+
+  auto sort_unique = [](std::vector<SignatureFunctionPair>& table) {
+    std::sort(table.begin(), table.end());
+    table.erase(std::unique(table.begin(), table.end()), table.end());
+  };
+  for (auto& table : tables_) {
+    sort_unique(table);
+  }
+  sort_unique(passive_);
+}
+
+void IndirectTargets::Append(Index table_index,
+                             Index type_index,
+                             std::vector<Index>* out) const {
+  if (type_index >= type_signatures_.size()) {
+    return;
+  }
+  Index signature = type_signatures_[type_index];
+  if (table_index < tables_.size()) {
+    Append(tables_[table_index], signature, out);
+  }
+  Append(passive_, signature, out);
+}
+
+Index IndirectTargets::GetFunctionSignature(Index func_index) const {
+  if (func_index >= function_types_.size()) {
+    return kInvalidSignature;
+  }
+  Index type_index = function_types_[func_index];
+  if (type_index >= type_signatures_.size()) {
+    return kInvalidSignature;
+  }
+  return type_signatures_[type_index];
+}
+
+// static
+void IndirectTargets::Append(const std::vector<SignatureFunctionPair>& table,
+                             Index signature,
+                             std::vector<Index>* out) {
+  auto iter = std::lower_bound(table.begin(), table.end(),
+                               SignatureFunctionPair{signature, 0});
+  for (; iter != table.end() && iter->first == signature; ++iter) {
+    out->push_back(iter->second);
+  }
+}
+
+struct Chunk {
+  std::vector<Index> offsets;
+  std::vector<Index> callees;
+};
+
+// Appends the sorted, unique callees of one function body to |chunk|.
+void AddCallees(SpanU8 body,
+                Index function_count,
+                const IndirectTargets& indirect_targets,
+                const Features& features,
+                std::vector<Index>& scratch,
+                Chunk& chunk) {
+  static const OpcodeSet kCallOpcodes{Opcode::Call, Opcode::ReturnCall,
+                                      Opcode::CallIndirect,
+                                      Opcode::ReturnCallIndirect};
+  ErrorsNop errors;
+  scratch.clear();
+  OpcodeScanner scanner{body, kCallOpcodes, features, errors};
+  while (auto scanned = scanner.Next()) {
+    const auto& instr = scanned->instruction;
+    switch (instr.opcode) {
+      case Opcode::Call:
+      case Opcode::ReturnCall:
+        if (instr.index_immediate() < function_count) {
+          scratch.push_back(instr.index_immediate());
+        }
+        break;
+
+      case Opcode::CallIndirect:
+      case Opcode::ReturnCallIndirect: {
+        const auto& immediate = instr.call_indirect_immediate();
+        indirect_targets.Append(immediate.reserved, immediate.index,
+                                &scratch);
+        break;
+      }
+
+      default:
+        break;
+    }
+  }
+
+  std::sort(scratch.begin(), scratch.end());
+  auto end = std::unique(scratch.begin(), scratch.end());
+  chunk.callees.insert(chunk.callees.end(), scratch.begin(), end);
+  chunk.offsets.push_back(chunk.callees.size());
+}
+
+}  // namespace
+
+IndexSpan CallGraph::callees(Index caller) const {
+  assert(caller < function_count());
+  return IndexSpan{callees_.data() + callee_offsets_[caller],
+                   callees_.data() + callee_offsets_[caller + 1]};
+}
+
+IndexSpan CallGraph::callers(Index callee) const {
+  assert(callee < function_count());
+  return IndexSpan{callers_.data() + caller_offsets_[callee],
+                   callers_.data() + caller_offsets_[callee + 1]};
+}
+
+CallGraph BuildCallGraph(const SectionIndex& section_index,
+                         const Features& features,
+                         Errors& errors,
+                         unsigned thread_count) {
+  // The signature of each type entry. Structurally equal function types
+  // share a signature.
+  std::vector<Index> type_signatures;
+  if (auto known = section_index.GetKnownSection(SectionId::Type)) {
+    FunctionTypeInterner signatures;
+    for (auto entry : ReadTypeSection(*known, features, errors).sequence) {
+      type_signatures.push_back(signatures.Intern(entry.type));
+    }
+  }
+
+  // The type index of each function, including imports.
+  std::vector<Index> function_types;
+  Index table_count = 0;
+  if (auto known = section_index.GetKnownSection(SectionId::Import)) {
+    for (auto import : ReadImportSection(*known, features, errors).sequence) {
+      if (import.kind() == ExternalKind::Function) {
+        function_types.push_back(import.index());
+      } else if (import.kind() == ExternalKind::Table) {
+        ++table_count;
+      }
+    }
+  }
+  const Index imported_function_count = function_types.size();
+  if (auto known = section_index.GetKnownSection(SectionId::Function)) {
+    for (auto func : ReadFunctionSection(*known, features, errors).sequence) {
+      function_types.push_back(func.type_index);
+    }
+  }
+  const Index function_count = function_types.size();
+
+  // Element segments name their table with an unvalidated index, so only
+  // tables that are declared get a list of targets.
+  if (auto known = section_index.GetKnownSection(SectionId::Table)) {
+    auto seq = ReadTableSection(*known, features, errors).sequence;
+    table_count += std::distance(seq.begin(), seq.end());
+  }
+
+  std::vector<ElementSegment> segments;
+  if (auto known = section_index.GetKnownSection(SectionId::Element)) {
+    auto seq = ReadElementSection(*known, features, errors).sequence;
+    std::copy(seq.begin(), seq.end(), std::back_inserter(segments));
+  }
+  IndirectTargets indirect_targets{std::move(type_signatures), function_types,
+                                   table_count, segments};
+
+  CodeSectionIndex code_index;
+  if (auto known = section_index.GetKnownSection(SectionId::Code)) {
+    code_index = CodeSectionIndex{*known, features, errors};
+  }
+  const auto& entries = code_index.entries();
+  const Index code_count = std::min<Index>(
+      entries.size(), function_count - imported_function_count);
+
+  // Decode the bodies in parallel.
+  const Index chunk_count =
+      (code_count + kFunctionsPerChunk - 1) / kFunctionsPerChunk;
+  std::vector<Chunk> chunks(chunk_count);
+  std::atomic<Index> next_chunk{0};
+  auto worker = [&]() {
+    std::vector<Index> scratch;
+    for (Index c; (c = next_chunk++) < chunk_count;) {
+      Index begin = c * kFunctionsPerChunk;
+      Index end = std::min(begin + kFunctionsPerChunk, code_count);
+      for (Index i = begin; i < end; ++i) {
+        AddCallees(entries[i].body, function_count, indirect_targets,
+                   features, scratch, chunks[c]);
+      }
+    }
+  };
+
+  if (thread_count == 0) {
+    thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  thread_count = static_cast<unsigned>(
+      std::max<Index>(std::min<Index>(thread_count, chunk_count), 1));
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < thread_count; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Join the chunks into the forward graph. Imported functions, and
+  // functions without a body, have no callees.
+  CallGraph graph;
+  graph.callee_offsets_.reserve(function_count + 1);
+  graph.callee_offsets_.resize(imported_function_count + 1, 0);
+  for (const auto& chunk : chunks) {
+    const Index base = graph.callees_.size();
+    for (Index offset : chunk.offsets) {
+      graph.callee_offsets_.push_back(base + offset);
+    }
+    graph.callees_.insert(graph.callees_.end(), chunk.callees.begin(),
+                          chunk.callees.end());
+  }
+  graph.callee_offsets_.resize(function_count + 1, graph.callees_.size());
+
+  // Counting sort the edges by callee for the reverse graph. The callers
+  // are visited in order, so each list of callers is sorted too.
+  graph.caller_offsets_.assign(function_count + 1, 0);
+  for (Index callee : graph.callees_) {
+    ++graph.caller_offsets_[callee + 1];
+  }
+  for (Index i = 0; i < function_count; ++i) {
+    graph.caller_offsets_[i + 1] += graph.caller_offsets_[i];
+  }
+  graph.callers_.resize(graph.callees_.size());
+  std::vector<Index> pos{graph.caller_offsets_.begin(),
+                         graph.caller_offsets_.end() - 1};
+  for (Index caller = 0; caller < function_count; ++caller) {
+    for (Index callee : graph.callees(caller)) {
+      graph.callers_[pos[callee]++] = caller;
+    }
+  }
+  return graph;
+}
+
+}  // namespace analysis
+}  // namespace wasp
@@ -0,0 +1,382 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/analysis/cfg.h"
+
+#include <cassert>
+
+#include "wasp/base/features.h"
+#include "wasp/base/format.h"
+#include "wasp/binary/errors.h"
+#include "wasp/binary/instruction.h"
+#include "wasp/binary/read/read.h"
+#include "wasp/binary/read/read_instruction.h"
+
+namespace wasp {
+namespace analysis {
+
+using namespace ::wasp::binary;
+
+bool IsExtraneousInstruction(const Instruction& instr) {
+  auto opcode = instr.opcode;
+  return opcode == Opcode::Block || opcode == Opcode::Else ||
+         opcode == Opcode::End || opcode == Opcode::Br;
+}
+
+SpanU8 Cfg::code(BBID bbid) const {
+  assert(bbid < code_.size());
+  return code_[bbid];
+}
+
+CfgEdgeSpan Cfg::successors(BBID bbid) const {
+  assert(bbid < code_.size());
+  return CfgEdgeSpan{successors_.data() + successor_offsets_[bbid],
+                     successors_.data() + successor_offsets_[bbid + 1]};
+}
+
+BBIDSpan Cfg::predecessors(BBID bbid) const {
+  assert(bbid < code_.size());
+  return BBIDSpan{predecessors_.data() + predecessor_offsets_[bbid],
+                  predecessors_.data() + predecessor_offsets_[bbid + 1]};
+}
+
+class CfgBuilder {
+ public:
+  explicit CfgBuilder(const Features&, Errors&);
+
+  Cfg Build(const Code&);
+
+ private:
+  struct Label {
+    Opcode opcode;
+    BBID parent;
+    BBID br;
+    BBID next;
+  };
+
+  struct Block {
+    const u8* begin;
+    const u8* end;
+    bool has_code;
+  };
+
+  struct Edge {
+    BBID from;
+    BBID to;
+    CfgEdgeKind kind;
+  };
+
+  void DoInstruction(const Instruction&, const u8* prev_ptr, const u8* ptr);
+  void PushLabel(Opcode, BBID br, BBID next);
+  Label PopLabel();
+  BBID NewBlock();
+  void StartBlock(BBID, const u8*);
+  void EndBlock(const u8*);
+  void MarkUnreachable(const u8*);
+  void AddSuccessor(BBID, CfgEdgeKind = CfgEdgeKind::Unconditional);
+  void AddSuccessor(BBID from, BBID to, CfgEdgeKind);
+  void Br(Index, CfgEdgeKind = CfgEdgeKind::Unconditional);
+  std::vector<BBID> MapEmptyBlocks(const std::vector<BBID>& first_successor);
+  Cfg Finish();
+
+  const Features& features_;
+  Errors& errors_;
+  SpanU8 instr_pos_;
+  std::vector<Label> labels_;
+  std::vector<Block> blocks_;
+  std::vector<Edge> edges_;
+  BBID start_bbid_ = InvalidBBID;
+  BBID current_bbid_ = InvalidBBID;
+};
+
+CfgBuilder::CfgBuilder(const Features& features, Errors& errors)
+    : features_{features}, errors_{errors} {}
+
+Cfg CfgBuilder::Build(const Code& code) {
+  SpanU8 data = code.body.data;
+  const u8* ptr = data.data();
+  PushLabel(Opcode::Return, InvalidBBID, InvalidBBID);
+  start_bbid_ = NewBlock();
+  StartBlock(start_bbid_, ptr);
+
+  while (!data.empty()) {
+    const u8* prev_ptr = ptr;
+    auto instr = Read<Instruction>(&data, features_, errors_);
+    if (!instr) {
+      break;
+    }
+    ptr = data.data();
+    instr_pos_ = SpanU8{prev_ptr, ptr};
+    DoInstruction(*instr, prev_ptr, ptr);
+  }
+
+  if (current_bbid_ != InvalidBBID) {
+    EndBlock(ptr);
+  }
+  return Finish();
+}
+
+void CfgBuilder::DoInstruction(const Instruction& instr,
+                               const u8* prev_ptr,
+                               const u8* ptr) {
+  // A `loop` is the first instruction of the loop's block, every other
+  // instruction belongs to the current block.
+  if (current_bbid_ != InvalidBBID && instr.opcode != Opcode::Loop &&
+      !IsExtraneousInstruction(instr)) {
+    blocks_[current_bbid_].has_code = true;
+  }
+
+  switch (instr.opcode) {
+    case Opcode::Unreachable:
+      MarkUnreachable(ptr);
+      break;
+
+    case Opcode::Block: {
+      auto next = NewBlock();
+      PushLabel(instr.opcode, next, next);
+      break;
+    }
+
+    case Opcode::Loop: {
+      auto loop = NewBlock();
+      auto next = NewBlock();
+      AddSuccessor(loop);
+      PushLabel(instr.opcode, loop, next);
+      StartBlock(loop, prev_ptr);
+      blocks_[loop].has_code = true;
+      break;
+    }
+
+    case Opcode::If: {
+      auto true_ = NewBlock();
+      auto next = NewBlock();
+      AddSuccessor(true_, CfgEdgeKind::True);
+      PushLabel(instr.opcode, next, next);
+      StartBlock(true_, ptr);
+      break;
+    }
+
+    case Opcode::Else: {
+      if (labels_.size() <= 1) {
+        errors_.OnError(instr_pos_, "Unexpected else instruction");
+        break;
+      }
+      auto top = PopLabel();
+      AddSuccessor(top.next);
+      auto false_ = NewBlock();
+      AddSuccessor(top.parent, false_, CfgEdgeKind::False);
+      PushLabel(instr.opcode, top.next, top.next);
+      StartBlock(false_, ptr);
+      break;
+    }
+
+    case Opcode::End: {
+      if (labels_.empty()) {
+        errors_.OnError(instr_pos_, "Unexpected end instruction");
+        break;
+      }
+      auto top = PopLabel();
+      AddSuccessor(top.next);
+      if (top.opcode == Opcode::If) {
+        AddSuccessor(top.parent, top.next, CfgEdgeKind::False);
+      }
+      StartBlock(top.next, ptr);
+      break;
+    }
+
+    case Opcode::Br:
+      Br(instr.index_immediate());
+      MarkUnreachable(ptr);
+      break;
+
+    case Opcode::BrIf: {
+      Br(instr.index_immediate(), CfgEdgeKind::True);
+      auto next = NewBlock();
+      AddSuccessor(next, CfgEdgeKind::False);
+      StartBlock(next, ptr);
+      break;
+    }
+
+    case Opcode::BrTable: {
+      const auto& immediate = instr.br_table_immediate();
+      for (const auto& target : immediate.targets) {
+        Br(target, CfgEdgeKind::Case);
+      }
+      Br(immediate.default_target, CfgEdgeKind::Default);
+      MarkUnreachable(ptr);
+      break;
+    }
+
+    case Opcode::Return:
+    case Opcode::ReturnCall:
+    case Opcode::ReturnCallIndirect:
+      // Branch to the function's label, which leaves the function.
+      Br(labels_.size() - 1);
+      MarkUnreachable(ptr);
+      break;
+
+    default:
+      break;
+  }
+}
+
+void CfgBuilder::PushLabel(Opcode opcode, BBID br, BBID next) {
+  labels_.push_back({opcode, current_bbid_, br, next});
+}
+
+auto CfgBuilder::PopLabel() -> Label {
+  assert(!labels_.empty());
+  Label top = labels_.back();
+  labels_.pop_back();
+  return top;
+}
+
+BBID CfgBuilder::NewBlock() {
+  blocks_.push_back(Block{nullptr, nullptr, false});
+  return static_cast<BBID>(blocks_.size() - 1);
+}
+
+void CfgBuilder::StartBlock(BBID bbid, const u8* start) {
+  if (current_bbid_ != InvalidBBID) {
+    EndBlock(start);
+  }
+  current_bbid_ = bbid;
+  if (current_bbid_ != InvalidBBID) {
+    blocks_[current_bbid_] = Block{start, start, false};
+  }
+}
+
+void CfgBuilder::EndBlock(const u8* end) {
+  blocks_[current_bbid_].end = end;
+}
+
+void CfgBuilder::MarkUnreachable(const u8* ptr) {
+  StartBlock(NewBlock(), ptr);
+}
+
+void CfgBuilder::AddSuccessor(BBID bbid, CfgEdgeKind kind) {
+  AddSuccessor(current_bbid_, bbid, kind);
+}
+
+void CfgBuilder::AddSuccessor(BBID from, BBID to, CfgEdgeKind kind) {
+  if (from != InvalidBBID) {
+    edges_.push_back(Edge{from, to, kind});
+  }
+}
+
+void CfgBuilder::Br(Index index, CfgEdgeKind kind) {
+  if (index < labels_.size()) {
+    AddSuccessor(labels_[labels_.size() - index - 1].br, kind);
+  } else {
+    errors_.OnError(instr_pos_, format("Invalid branch depth: {}", index));
+  }
+}
+
+// Returns the new id of each block. A block without code is replaced by the
+// block its first successor resolves to, or InvalidBBID if there is none.
+std::vector<BBID> CfgBuilder::MapEmptyBlocks(
+    const std::vector<BBID>& first_successor) {
+  const BBID kUnresolved = InvalidBBID - 1;
+  std::vector<BBID> new_ids(blocks_.size(), kUnresolved);
+  BBID next_id = 0;
+  for (BBID bbid = 0; bbid < blocks_.size(); ++bbid) {
+    if (blocks_[bbid].has_code) {
+      new_ids[bbid] = next_id++;
+    }
+  }
+
+  std::vector<BBID> chain;
+  for (BBID bbid = 0; bbid < blocks_.size(); ++bbid) {
+    // Follow the chain of empty blocks to the first non-empty one (or
+    // InvalidBBID), then point every block in the chain at it. A chain that
+    // loops back on itself never reaches code, so it maps to InvalidBBID.
+    BBID last = bbid;
+    while (last != InvalidBBID && new_ids[last] == kUnresolved) {
+      chain.push_back(last);
+      new_ids[last] = InvalidBBID;
+      last = first_successor[last];
+    }
+    BBID resolved = last == InvalidBBID ? InvalidBBID : new_ids[last];
+    for (BBID empty : chain) {
+      new_ids[empty] = resolved;
+    }
+    chain.clear();
+  }
+  return new_ids;
+}
+
+Cfg CfgBuilder::Finish() {
+  std::vector<BBID> first_successor(blocks_.size(), InvalidBBID);
+  for (auto iter = edges_.rbegin(); iter != edges_.rend(); ++iter) {
+    first_successor[iter->from] = iter->to;
+  }
+  auto new_ids = MapEmptyBlocks(first_successor);
+  auto map_id = [&](BBID bbid) {
+    return bbid == InvalidBBID ? InvalidBBID : new_ids[bbid];
+  };
+
+  Cfg cfg;
+  cfg.start_ = map_id(start_bbid_);
+  for (const auto& block : blocks_) {
+    if (block.has_code) {
+      cfg.code_.push_back(SpanU8{block.begin, block.end});
+    }
+  }
+
+  // Counting sort the edges by source, then by target. Both sorts are
+  // stable, so successors keep the order they were added in.
+  const Index block_count = cfg.code_.size();
+  cfg.successor_offsets_.assign(block_count + 1, 0);
+  cfg.predecessor_offsets_.assign(block_count + 1, 0);
+  for (const auto& edge : edges_) {
+    if (blocks_[edge.from].has_code) {
+      ++cfg.successor_offsets_[new_ids[edge.from] + 1];
+      BBID to = map_id(edge.to);
+      if (to != InvalidBBID) {
+        ++cfg.predecessor_offsets_[to + 1];
+      }
+    }
+  }
+  for (Index i = 0; i < block_count; ++i) {
+    cfg.successor_offsets_[i + 1] += cfg.successor_offsets_[i];
+    cfg.predecessor_offsets_[i + 1] += cfg.predecessor_offsets_[i];
+  }
+
+  cfg.successors_.resize(cfg.successor_offsets_[block_count]);
+  cfg.predecessors_.resize(cfg.predecessor_offsets_[block_count]);
+  std::vector<Index> succ_pos{cfg.successor_offsets_.begin(),
+                              cfg.successor_offsets_.end() - 1};
+  std::vector<Index> pred_pos{cfg.predecessor_offsets_.begin(),
+                              cfg.predecessor_offsets_.end() - 1};
+  for (const auto& edge : edges_) {
+    if (blocks_[edge.from].has_code) {
+      BBID from = new_ids[edge.from];
+      BBID to = map_id(edge.to);
+      cfg.successors_[succ_pos[from]++] = CfgEdge{to, edge.kind};
+      if (to != InvalidBBID) {
+        cfg.predecessors_[pred_pos[to]++] = from;
+      }
+    }
+  }
+  return cfg;
+}
+
+Cfg BuildCfg(const Code& code, const Features& features, Errors& errors) {
+  return CfgBuilder{features, errors}.Build(code);
+}
+
+}  // namespace analysis
+}  // namespace wasp
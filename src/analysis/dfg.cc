@@ -0,0 +1,800 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "wasp/analysis/dfg.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#include "wasp/base/features.h"
+#include "wasp/base/format.h"
+#include "wasp/base/macros.h"
+#include "wasp/binary/errors.h"
+#include "wasp/binary/formatters.h"
+#include "wasp/binary/opcode_info.h"
+#include "wasp/binary/read/read.h"
+#include "wasp/binary/read/read_instruction.h"
+
+namespace wasp {
+namespace analysis {
+
+using namespace ::wasp::binary;
+
+namespace {
+
+constexpr Index kMinTableCapacity = 64;
+constexpr u64 kEmptyKey = ~u64{0};
+
+int Log2(Index capacity) {
+  int result = 0;
+  while ((Index{1} << result) < capacity) {
+    ++result;
+  }
+  return result;
+}
+
+// The instruction that produces the value a local of type |type| starts with.
+Instruction ZeroValue(ValueType type) {
+  switch (type) {
+    case ValueType::I32: return Instruction{Opcode::I32Const, s32{0}};
+    case ValueType::F32: return Instruction{Opcode::F32Const, f32{0}};
+    case ValueType::I64: return Instruction{Opcode::I64Const, s64{0}};
+    case ValueType::F64: return Instruction{Opcode::F64Const, f64{0}};
+    case ValueType::V128: return Instruction{Opcode::V128Const, v128{}};
+    case ValueType::Anyref: return Instruction{Opcode::RefNull};
+  }
+  WASP_UNREACHABLE();
+}
+
+}  // namespace
+
+DefinitionTable::DefinitionTable() {
+  Resize(kMinTableCapacity);
+}
+
+void DefinitionTable::Clear() {
+  // Size the table for the last function, so a single large function doesn't
+  // make clearing expensive for all of the small ones after it.
+  Index capacity = std::max(kMinTableCapacity, Index{1} << Log2(size_ * 2));
+  if (capacity * 4 <= slots_.size()) {
+    Resize(capacity);
+  } else {
+    std::fill(slots_.begin(), slots_.end(), Slot{kEmptyKey, InvalidValueID});
+  }
+  size_ = 0;
+}
+
+ValueID DefinitionTable::Find(VarID var, BBID bbid) const {
+  return slots_[FindSlot(MakeKey(var, bbid))].value;
+}
+
+void DefinitionTable::Insert(VarID var, BBID bbid, ValueID value) {
+  u64 key = MakeKey(var, bbid);
+  Index index = FindSlot(key);
+  if (slots_[index].key == kEmptyKey) {
+    // Keep the load factor at or below 1/2.
+    if ((size_ + 1) * 2 > slots_.size()) {
+      Resize(slots_.size() * 2);
+      index = FindSlot(key);
+    }
+    slots_[index].key = key;
+    ++size_;
+  }
+  slots_[index].value = value;
+}
+
+// static
+u64 DefinitionTable::MakeKey(VarID var, BBID bbid) {
+  return (u64{var} << 32) | bbid;
+}
+
+Index DefinitionTable::FindSlot(u64 key) const {
+  const Index mask = slots_.size() - 1;
+  Index index = (key * 0x9e3779b97f4a7c15ull) >> shift_;
+  while (slots_[index].key != key && slots_[index].key != kEmptyKey) {
+    index = (index + 1) & mask;
+  }
+  return index;
+}
+
+void DefinitionTable::Resize(Index capacity) {
+  std::vector<Slot> old_slots(capacity, Slot{kEmptyKey, InvalidValueID});
+  std::swap(slots_, old_slots);
+  shift_ = 64 - Log2(capacity);
+  for (const auto& slot : old_slots) {
+    if (slot.key != kEmptyKey) {
+      slots_[FindSlot(slot.key)] = slot;
+    }
+  }
+}
+
+DfgBuilder::DfgBuilder(const std::vector<TypeEntry>& type_entries,
+                       const std::vector<Function>& functions,
+                       const Features& features,
+                       Errors& errors)
+    : type_entries_{type_entries},
+      functions_{functions},
+      features_{features},
+      errors_{errors} {}
+
+void DfgBuilder::Reset() {
+  labels_.clear();
+  bbs_.clear();
+  values_.clear();
+  current_def_.Clear();
+  value_stack_size_ = 0;
+  start_bbid_ = InvalidBBID;
+  current_bbid_ = InvalidBBID;
+  undef_ = InvalidValueID;
+  phi_operands_.clear();
+  local_runs_.clear();
+  failed_ = false;
+}
+
+void DfgBuilder::OnError(string_view message) {
+  errors_.OnError(instr_pos_, message);
+}
+
+void DfgBuilder::Fail(string_view message) {
+  OnError(message);
+  failed_ = true;
+}
+
+void DfgBuilder::OnUnsupported(const Instruction& instr) {
+  Fail(format("`{}` is not supported", instr));
+}
+
+optional<FunctionType> DfgBuilder::GetFunctionType(Index func_index) const {
+  if (func_index >= functions_.size()) {
+    return nullopt;
+  }
+  Index type_index = functions_[func_index].type_index;
+  if (type_index >= type_entries_.size()) {
+    return nullopt;
+  }
+  return type_entries_[type_index].type;
+}
+
+bool DfgBuilder::Build(const FunctionType& type, const Code& code) {
+  Reset();
+  instr_pos_ = code.body.data.first(0);
+
+  // Create start block and label.
+  start_bbid_ = NewBlock();
+  StartBlock(start_bbid_);
+
+  // Add params.
+  for (u32 i = 0; i < type.param_types.size(); ++i) {
+    PushValue(NewValue(Instruction{Opcode::LocalGet, u32{i}}));
+  }
+
+  // Locals are given their zero value when they are first read (see
+  // LookupVariable), so only their types are kept here.
+  locals_begin_ = type.param_types.size();
+  Index local_end = locals_begin_;
+  for (const auto& locals : code.locals) {
+    if (locals.count > std::numeric_limits<Index>::max() - local_end) {
+      Fail("Too many locals");
+      return false;
+    }
+    local_end += locals.count;
+    local_runs_.push_back(LocalRun{local_end, locals.type});
+  }
+  value_stack_size_ = local_end;
+
+  // Push a dummy label so the return value is still accessible after the final
+  // `end` instruction is reached.
+  PushLabel(Opcode::End, InvalidBBID, InvalidBBID);
+
+  BBID return_bbid = NewBlock(type.result_types.size());
+  PushUndefValues(type.result_types.size());
+  PushLabel(Opcode::Return, return_bbid, return_bbid);
+
+  SpanU8 data = code.body.data;
+  while (!data.empty()) {
+    SpanU8 pos = data;
+    auto instr = Read<Instruction>(&data, features_, errors_);
+    if (!instr) {
+      // The reader has already reported the error.
+      failed_ = true;
+      return false;
+    }
+    instr_pos_ = pos.first(pos.size() - data.size());
+    DoInstruction(*instr);
+    if (failed_) {
+      return false;
+    }
+  }
+
+  BasicInstruction(Instruction{Opcode::Return}, type.result_types.size(), 0);
+  SealBlock(return_bbid);
+  return true;
+}
+
+void DfgBuilder::DoInstruction(const Instruction& instr) {
+  const auto* signature = GetOpcodeInfo(instr.opcode)->stack_signature;
+  if (signature) {
+    // An instruction that neither pops nor pushes (e.g. nop, data.drop) has
+    // no value to add to the graph.
+    if (signature->param_count != 0 || signature->result_count != 0) {
+      BasicInstruction(instr, signature->param_count, signature->result_count);
+    }
+    return;
+  }
+
+  switch (instr.opcode) {
+    case Opcode::Unreachable:
+      MarkUnreachable();
+      break;
+
+    case Opcode::Block: {
+      auto value_count = BlockTypeToValueCount(instr.block_type_immediate());
+      auto next = NewBlock(value_count);
+      PushUndefValues(value_count);
+      PushLabel(instr.opcode, next, next);
+      break;
+    }
+
+    case Opcode::Loop: {
+      auto value_count = BlockTypeToValueCount(instr.block_type_immediate());
+      auto loop = NewBlock(0, true);
+      auto next = NewBlock(value_count);
+      AddPred(loop);
+      PushUndefValues(value_count);
+      PushLabel(instr.opcode, loop, next);
+      StartBlock(loop);
+      break;
+    }
+
+    case Opcode::If: {
+      auto value_count = BlockTypeToValueCount(instr.block_type_immediate());
+      auto true_ = NewBlock();
+      auto next = NewBlock(value_count);
+      AddPred(true_);
+      BasicInstruction(instr, 1, 0);
+      PushUndefValues(value_count);
+      PushLabel(instr.opcode, next, next);
+      StartBlock(true_);
+      break;
+    }
+
+    case Opcode::Else: {
+      if (labels_.size() <= 1) {
+        Fail("Unexpected else instruction");
+        break;
+      }
+      auto top = PopLabel();
+      auto false_ = NewBlock();
+      AddPred(false_, top.parent);
+      PushLabel(instr.opcode, top.next, top.next);
+      StartBlock(false_);
+      break;
+    }
+
+    case Opcode::End: {
+      if (labels_.size() <= 1) {
+        Fail("Unexpected end instruction");
+        break;
+      }
+      auto top = PopLabel();
+      if (top.opcode == Opcode::If) {
+        AddPred(top.next, top.parent);
+      }
+      StartBlock(top.next);
+      break;
+    }
+
+    case Opcode::Br:
+      Br(instr.index_immediate());
+      MarkUnreachable();
+      break;
+
+    case Opcode::BrIf: {
+      BasicInstruction(instr, 1, 0);
+      Br(instr.index_immediate());
+      auto next = NewBlock();
+      AddPred(next);
+      StartBlock(next);
+      break;
+    }
+
+    case Opcode::BrTable: {
+      const auto& immediate = instr.br_table_immediate();
+      BasicInstruction(instr, 1, 0);
+      for (const auto& target : immediate.targets) {
+        Br(target);
+      }
+      Br(immediate.default_target);
+      MarkUnreachable();
+      break;
+    }
+
+    case Opcode::Return:
+      Return();
+      MarkUnreachable();
+      break;
+
+    case Opcode::Call:
+    case Opcode::ReturnCall: {
+      auto func_type_opt = GetFunctionType(instr.index_immediate());
+      if (func_type_opt) {
+        BasicInstruction(instr, func_type_opt->param_types.size(),
+                         func_type_opt->result_types.size());
+      } else {
+        OnError(format("`{}` with unknown function", instr));
+      }
+      if (instr.opcode == Opcode::ReturnCall) {
+        Return();
+        MarkUnreachable();
+      }
+      break;
+    }
+
+    case Opcode::CallIndirect:
+    case Opcode::ReturnCallIndirect: {
+      auto type_index = instr.call_indirect_immediate().index;
+      if (type_index < type_entries_.size()) {
+        const auto& func_type = type_entries_[type_index].type;
+        BasicInstruction(instr, func_type.param_types.size() + 1,
+                         func_type.result_types.size());
+      } else {
+        OnError(format("`{}` with unknown type", instr));
+      }
+      if (instr.opcode == Opcode::ReturnCallIndirect) {
+        Return();
+        MarkUnreachable();
+      }
+      break;
+    }
+
+    case Opcode::LocalGet:
+      PushValue(ReadVariable(instr.index_immediate(), current_bbid_));
+      break;
+
+    case Opcode::LocalSet:
+    case Opcode::LocalTee: {
+      auto value = PopValue();
+      if (value == InvalidValueID) {
+        Fail(format("`{}` with an empty value stack", instr));
+        break;
+      }
+      WriteVariable(instr.index_immediate(), current_bbid_, value);
+      if (instr.opcode == Opcode::LocalTee) {
+        PushValue(value);
+      }
+      break;
+    }
+
+    case Opcode::Drop:
+    case Opcode::GlobalSet:
+      BasicInstruction(instr, 1, 0);
+      break;
+
+    case Opcode::Select:
+      BasicInstruction(instr, 3, 1);
+      break;
+
+    case Opcode::GlobalGet:
+    case Opcode::RefNull:
+    case Opcode::RefFunc:
+      BasicInstruction(instr, 0, 1);
+      break;
+
+    case Opcode::RefIsNull:
+      BasicInstruction(instr, 1, 1);
+      break;
+
+    case Opcode::TableGet:
+      BasicInstruction(instr, 1, 1);
+      break;
+
+    case Opcode::TableSet:
+      BasicInstruction(instr, 2, 0);
+      break;
+
+    case Opcode::TableGrow:
+      BasicInstruction(instr, 2, 1);
+      break;
+
+    case Opcode::TableSize:
+      BasicInstruction(instr, 0, 1);
+      break;
+
+    case Opcode::Try:
+    case Opcode::Catch:
+    case Opcode::Throw:
+    case Opcode::Rethrow:
+    case Opcode::BrOnExn:
+      // Exception handling edges aren't modeled.
+      OnUnsupported(instr);
+      break;
+
+    default:
+      // Every other opcode has a stack signature.
+      WASP_UNREACHABLE();
+  }
+}
+
+// static
+Index DfgBuilder::BlockTypeToValueCount(BlockType type) {
+  return type == BlockType::Void ? 0 : 1;
+}
+
+void DfgBuilder::PushLabel(Opcode opcode, BBID br, BBID next) {
+  labels_.push_back(
+      {opcode, current_bbid_, br, next, value_stack_size_, false});
+}
+
+auto DfgBuilder::PopLabel() -> Label {
+  auto top = labels_.back();
+  if (!top.unreachable) {
+    ForwardValues(top, top.next);
+    AddPred(top.next);
+  }
+  labels_.pop_back();
+  value_stack_size_ = top.value_stack_size;
+  if (top.opcode == Opcode::Loop) {
+    SealBlock(top.br);
+  }
+  return top;
+}
+
+BBID DfgBuilder::NewBlock(Index value_count, bool is_loop_header) {
+  bbs_.push_back(Block{{}, {}, value_count, is_loop_header, false});
+  return static_cast<BBID>(bbs_.size() - 1);
+}
+
+void DfgBuilder::StartBlock(BBID bbid) {
+  if (current_bbid_ != InvalidBBID &&
+      !GetBlock(current_bbid_).is_loop_header) {
+    SealBlock(current_bbid_);
+  }
+  current_bbid_ = bbid;
+}
+
+auto DfgBuilder::GetBlock(BBID bbid) -> Block& {
+  assert(bbid < bbs_.size());
+  return bbs_[bbid];
+}
+
+void DfgBuilder::MarkUnreachable() {
+  assert(!labels_.empty());
+  labels_.back().unreachable = true;
+  StartBlock(NewBlock());
+}
+
+void DfgBuilder::AddPred(BBID bbid) {
+  AddPred(bbid, current_bbid_);
+}
+
+void DfgBuilder::AddPred(BBID bbid, BBID pred) {
+  if (bbid != InvalidBBID) {
+    GetBlock(bbid).preds.emplace_back(pred);
+  }
+}
+
+void DfgBuilder::Br(Index index) {
+  if (index < labels_.size()) {
+    const auto& label = labels_[labels_.size() - index - 1];
+    auto target = label.br;
+    AddPred(target);
+    ForwardValues(label, target);
+  } else {
+    OnError(format("Invalid br depth {}", index));
+  }
+}
+
+void DfgBuilder::Return() {
+  Br(labels_.size() - 2);
+}
+
+ValueID DfgBuilder::NewValue(const Instruction& instr, Index operand_count) {
+  values_.push_back(DfgValue{current_bbid_, instr, {}});
+  auto value = static_cast<ValueID>(values_.size() - 1);
+  ValueIDs operands;
+  CopyValues(operand_count, operands);
+  GetValue(value).operands = std::move(operands);
+  return value;
+}
+
+ValueID DfgBuilder::NewPhi(BBID bbid) {
+  values_.push_back(DfgValue{bbid, nullopt, {}});
+  auto value = static_cast<ValueID>(values_.size() - 1);
+  return value;
+}
+
+ValueID DfgBuilder::NewLocalDefault(VarID var) {
+  auto iter = std::upper_bound(
+      local_runs_.begin(), local_runs_.end(), var,
+      [](VarID index, const LocalRun& run) { return index < run.end; });
+  assert(iter != local_runs_.end());
+
+  values_.push_back(DfgValue{start_bbid_, ZeroValue(iter->type), {}});
+  return static_cast<ValueID>(values_.size() - 1);
+}
+
+bool DfgBuilder::IsLocal(VarID var) const {
+  return var >= locals_begin_ && !local_runs_.empty() &&
+         var < local_runs_.back().end;
+}
+
+ValueID DfgBuilder::Undef() {
+  if (undef_ == InvalidValueID) {
+    undef_ = NewValue(Instruction{Opcode::Unreachable});
+  }
+  return undef_;
+}
+
+Index DfgBuilder::GetStackSize() const {
+  if (labels_.empty()) {
+    return 0;
+  }
+  return value_stack_size_ - labels_.back().value_stack_size;
+}
+
+DfgValue& DfgBuilder::GetValue(ValueID id) {
+  assert(id < values_.size());
+  return values_[id];
+}
+
+void DfgBuilder::CopyValues(Index count, ValueIDs& out) {
+  if (count <= GetStackSize()) {
+    out.resize(count);
+    for (Index i = 0; i < count; ++i) {
+      out[i] = ReadVariable(value_stack_size_ - count + i, current_bbid_);
+    }
+  } else {
+    OnError(format("CopyValues({}) past bottom of stack {}", count,
+                   GetStackSize()));
+  }
+}
+
+void DfgBuilder::ForwardValues(const Label& label, BBID bbid) {
+  const auto& block = GetBlock(bbid);
+  for (Index i = 0; i < block.value_count; ++i) {
+    auto value =
+        ReadVariable(value_stack_size_ - block.value_count + i, current_bbid_);
+    WriteVariable(label.value_stack_size - block.value_count + i, current_bbid_,
+                  value);
+  }
+}
+
+void DfgBuilder::PushValue(ValueID value) {
+  WriteVariable(value_stack_size_++, current_bbid_, value);
+}
+
+void DfgBuilder::PushUndefValues(Index count) {
+  auto undef = Undef();
+  for (Index i = 0; i < count; ++i) {
+    WriteVariable(value_stack_size_++, current_bbid_, undef);
+  }
+}
+
+ValueID DfgBuilder::PopValue() {
+  if (GetStackSize() == 0) {
+    return InvalidValueID;
+  }
+
+  return ReadVariable(--value_stack_size_, current_bbid_);
+}
+
+void DfgBuilder::PopValues(Index count) {
+  auto stack_size = GetStackSize();
+  if (count <= stack_size) {
+    value_stack_size_ -= count;
+  } else {
+    OnError(format("PopValues({}) past bottom of stack {}", count,
+                   GetStackSize()));
+    value_stack_size_ -= stack_size;
+  }
+}
+
+void DfgBuilder::BasicInstruction(const Instruction& instr,
+                                  Index operand_count,
+                                  Index result_count) {
+  if (result_count > 1) {
+    // A value is a single result; multi-value results aren't modeled.
+    OnUnsupported(instr);
+    return;
+  }
+  auto value = NewValue(instr, operand_count);
+  PopValues(operand_count);
+  if (result_count > 0) {
+    PushValue(value);
+  }
+}
+
+// Implementation of SSA construction from
+// https://pp.info.uni-karlsruhe.de/uploads/publikationen/braun13cc.pdf
+
+void DfgBuilder::WriteVariable(VarID var, BBID bbid, ValueID value) {
+  assert(value != InvalidValueID);
+  current_def_.Insert(var, bbid, value);
+}
+
+ValueID DfgBuilder::ReadVariable(VarID var, BBID bbid) {
+  auto value = LookupVariable(var, bbid);
+  FillPhiOperands();
+  return value;
+}
+
+ValueID DfgBuilder::LookupVariable(VarID var, BBID bbid) {
+  auto value = current_def_.Find(var, bbid);
+  if (value != InvalidValueID) {
+    return value;
+  }
+
+  // Walk up chains of sealed blocks with one predecessor, since the chains
+  // can be as long as the function. A join ends the walk with a new phi, whose
+  // operands are queued rather than read here; the phi is the value either
+  // way. Every block on the way gets the definition that is found.
+  assert(read_chain_.empty());
+  for (;;) {
+    read_chain_.push_back(bbid);
+    auto& block = GetBlock(bbid);
+    if (bbid == start_bbid_ && IsLocal(var)) {
+      // A local that isn't written before this read still has its zero value.
+      value = NewLocalDefault(var);
+      break;
+    }
+    if (!block.sealed) {
+      // Incomplete CFG.
+      value = NewPhi(bbid);
+      block.incomplete_phis.emplace_back(var, value);
+      break;
+    }
+    if (block.preds.size() != 1) {
+      // The phi is written before its operands are read, which breaks
+      // potential cycles.
+      value = NewPhi(bbid);
+      QueuePhiOperands(var, value);
+      break;
+    }
+    bbid = block.preds[0];
+    value = current_def_.Find(var, bbid);
+    if (value != InvalidValueID) {
+      break;
+    }
+  }
+  for (auto chain_bbid : read_chain_) {
+    WriteVariable(var, chain_bbid, value);
+  }
+  read_chain_.clear();
+  return value;
+}
+
+void DfgBuilder::QueuePhiOperands(VarID var, ValueID phi) {
+  Index count = GetBlock(GetValue(phi).block).preds.size();
+  GetValue(phi).operands.assign(count, InvalidValueID);
+  // Pushed in reverse, so the operands are read in predecessor order.
+  for (Index i = count; i > 0; --i) {
+    phi_operands_.push_back(PhiOperand{var, phi, i - 1});
+  }
+}
+
+void DfgBuilder::FillPhiOperands() {
+  // A worklist instead of recursion, so the depth doesn't grow with the
+  // number of joins between a read and the definition it finds.
+  while (!phi_operands_.empty()) {
+    auto operand = phi_operands_.back();
+    phi_operands_.pop_back();
+    BBID pred = GetBlock(GetValue(operand.phi).block).preds[operand.index];
+    auto value = LookupVariable(operand.var, pred);
+    GetValue(operand.phi).operands[operand.index] = value;
+  }
+}
+
+void DfgBuilder::AddPhiOperands(VarID var, ValueID phi) {
+  QueuePhiOperands(var, phi);
+  FillPhiOperands();
+}
+
+void DfgBuilder::SealBlock(BBID bbid) {
+  assert(!GetBlock(bbid).sealed);
+  std::vector<std::pair<VarID, ValueID>> incomplete_phis;
+  while (!GetBlock(bbid).incomplete_phis.empty()) {
+    std::swap(incomplete_phis, GetBlock(bbid).incomplete_phis);
+    // A variable only gets one incomplete phi per block; add the operands in
+    // variable order so value ids don't depend on the order of the reads.
+    std::sort(incomplete_phis.begin(), incomplete_phis.end());
+    for (auto pair : incomplete_phis) {
+      AddPhiOperands(pair.first, pair.second);
+    }
+    incomplete_phis.clear();
+  }
+  GetBlock(bbid).sealed = true;
+}
+
+optional<ValueID> DfgBuilder::GetTrivialPhiOperand(ValueID vid) const {
+  const auto& value = values_[vid];
+  if (value.is_phi()) {
+    optional<ValueID> same;
+    for (auto op : value.operands) {
+      if (op == same || op == vid) {
+        continue;  // Unique value of self-reference.
+      }
+      if (same) {
+        return nullopt;  // The phi merges at least two values: not trivial.
+      }
+      same = op;
+    }
+    // This phi is trivial and can be replaced by same.
+    return same;
+  }
+  return nullopt;
+}
+
+void DfgBuilder::RemoveTrivialPhis() {
+  // users_[x] lists the values that have x as an operand.
+  users_.clear();
+  users_.resize(values_.size());
+  std::vector<bool> trivial_phis(values_.size());
+  ValueIDs phis;
+  ValueID vid = 0;
+  for (const auto& value : values_) {
+    if (value.is_phi()) {
+      phis.emplace_back(vid);
+    }
+    for (auto op : value.operands) {
+      users_[op].push_back(vid);
+    }
+    ++vid;
+  }
+
+  ValueIDs new_phis;
+  while (!phis.empty()) {
+    new_phis.clear();
+    for (auto phi : phis) {
+      auto same = GetTrivialPhiOperand(phi);
+      if (same) {
+        // The operands of this phi are all |same| (or the phi itself), so
+        // their user lists keep this phi. That entry is harmless: the phi has
+        // no operands left to replace, and it is skipped as trivial. Rewriting
+        // the lists instead would cost the length of |same|'s users for every
+        // phi in a chain of joins.
+        GetValue(phi).operands.clear();
+
+        // For all users of this phi: replace any operands that point to this
+        // phi with same.
+        ValueIDs phi_users;
+        std::swap(phi_users, users_[phi]);
+        for (auto user : phi_users) {
+          if (user != phi && !trivial_phis[user]) {
+            auto& operands = GetValue(user).operands;
+            std::replace(operands.begin(), operands.end(), phi, *same);
+            users_[*same].push_back(user);
+            if (GetValue(user).is_phi()) {
+              // Perform another pass with any users that may have become
+              // trivial by the removal of phi.
+              new_phis.push_back(user);
+            }
+          }
+        }
+
+        trivial_phis[phi] = true;
+      }
+    }
+    auto&& is_trivial = [&](ValueID x) { return trivial_phis[x]; };
+    auto new_end = std::remove_if(new_phis.begin(), new_phis.end(), is_trivial);
+    std::sort(new_phis.begin(), new_end);
+    new_end = std::unique(new_phis.begin(), new_end);
+    new_phis.erase(new_end, new_phis.end());
+    std::swap(phis, new_phis);
+  }
+}
+
+}  // namespace analysis
+}  // namespace wasp
@@ -0,0 +1,304 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/analysis/dominator_tree.h"
+
+#include <cassert>
+#include <utility>
+
+namespace wasp {
+namespace analysis {
+
+namespace {
+
+constexpr Index kNone = ~0;
+
+// A graph in compressed-sparse-row form.
+struct Graph {
+  explicit Graph(Index node_count) : offsets(node_count + 1, 0) {}
+
+  Index size() const { return offsets.size() - 1; }
+  const BBID* begin(BBID node) const { return edges.data() + offsets[node]; }
+  const BBID* end(BBID node) const { return edges.data() + offsets[node + 1]; }
+
+  // Call once for each node, in order.
+  void FinishNode(BBID node) { offsets[node + 1] = edges.size(); }
+
+  std::vector<Index> offsets;
+  std::vector<BBID> edges;
+};
+
+class LengauerTarjan {
+ public:
+  explicit LengauerTarjan(const Graph& succs, const Graph& preds);
+
+  std::vector<BBID> Run(BBID root);
+
+ private:
+  void NumberNodes(BBID root);
+  Index Eval(Index);
+  void Compress(Index);
+
+  const Graph& succs_;
+  const Graph& preds_;
+
+  // Indexed by node.
+  std::vector<Index> dfnum_;
+
+  // Indexed by DFS number.
+  std::vector<BBID> vertex_;
+  std::vector<Index> parent_;
+  std::vector<Index> semi_;
+  std::vector<Index> idom_;
+  std::vector<Index> ancestor_;
+  std::vector<Index> label_;
+  std::vector<Index> bucket_head_;
+  std::vector<Index> bucket_next_;
+  std::vector<Index> path_;
+};
+
+LengauerTarjan::LengauerTarjan(const Graph& succs, const Graph& preds)
+    : succs_{succs}, preds_{preds} {}
+
+std::vector<BBID> LengauerTarjan::Run(BBID root) {
+  std::vector<BBID> result(succs_.size(), InvalidBBID);
+  if (root == InvalidBBID) {
+    return result;
+  }
+
+  NumberNodes(root);
+  const Index count = vertex_.size();
+  semi_.resize(count);
+  idom_.assign(count, kNone);
+  ancestor_.assign(count, kNone);
+  label_.resize(count);
+  bucket_head_.assign(count, kNone);
+  bucket_next_.assign(count, kNone);
+  for (Index i = 0; i < count; ++i) {
+    semi_[i] = label_[i] = i;
+  }
+
+  for (Index w = count - 1; w > 0; --w) {
+    // Find the semidominator of w.
+    BBID node = vertex_[w];
+    for (auto pred = preds_.begin(node); pred != preds_.end(node); ++pred) {
+      if (dfnum_[*pred] != kNone) {
+        Index u = Eval(dfnum_[*pred]);
+        if (semi_[u] < semi_[w]) {
+          semi_[w] = semi_[u];
+        }
+      }
+    }
+    bucket_next_[w] = bucket_head_[semi_[w]];
+    bucket_head_[semi_[w]] = w;
+    ancestor_[w] = parent_[w];
+
+    // Implicitly compute the immediate dominators of the nodes that have
+    // parent(w) as their semidominator.
+    Index parent = parent_[w];
+    for (Index v = bucket_head_[parent]; v != kNone; v = bucket_next_[v]) {
+      Index u = Eval(v);
+      idom_[v] = semi_[u] < semi_[v] ? u : parent;
+    }
+    bucket_head_[parent] = kNone;
+  }
+
+  // Make the immediate dominators explicit.
+  for (Index w = 1; w < count; ++w) {
+    if (idom_[w] != semi_[w]) {
+      idom_[w] = idom_[idom_[w]];
+    }
+    result[vertex_[w]] = vertex_[idom_[w]];
+  }
+  return result;
+}
+
+// Numbers the nodes reachable from root in DFS preorder, without recursing.
+void LengauerTarjan::NumberNodes(BBID root) {
+  dfnum_.assign(succs_.size(), kNone);
+  vertex_.clear();
+  parent_.clear();
+
+  std::vector<std::pair<BBID, const BBID*>> stack;
+  dfnum_[root] = 0;
+  vertex_.push_back(root);
+  parent_.push_back(kNone);
+  stack.emplace_back(root, succs_.begin(root));
+  while (!stack.empty()) {
+    BBID node = stack.back().first;
+    const BBID*& next = stack.back().second;
+    if (next == succs_.end(node)) {
+      stack.pop_back();
+      continue;
+    }
+    BBID succ = *next++;
+    if (dfnum_[succ] == kNone) {
+      dfnum_[succ] = vertex_.size();
+      vertex_.push_back(succ);
+      parent_.push_back(dfnum_[node]);
+      stack.emplace_back(succ, succs_.begin(succ));
+    }
+  }
+}
+
+Index LengauerTarjan::Eval(Index v) {
+  if (ancestor_[v] == kNone) {
+    return v;
+  }
+  Compress(v);
+  return label_[v];
+}
+
+// Points every node on the path from v to the root of its forest tree
+// directly at that root, keeping the label with the smallest semidominator.
+void LengauerTarjan::Compress(Index v) {
+  path_.clear();
+  for (Index x = v; ancestor_[ancestor_[x]] != kNone; x = ancestor_[x]) {
+    path_.push_back(x);
+  }
+  for (auto iter = path_.rbegin(); iter != path_.rend(); ++iter) {
+    Index x = *iter;
+    Index a = ancestor_[x];
+    if (semi_[label_[a]] < semi_[label_[x]]) {
+      label_[x] = label_[a];
+    }
+    ancestor_[x] = ancestor_[a];
+  }
+}
+
+}  // namespace
+
+DominatorTree::DominatorTree(BBID root, std::vector<BBID> idom)
+    : root_{root},
+      idom_{std::move(idom)},
+      child_offsets_(idom_.size() + 1, 0),
+      preorder_(idom_.size(), kNone),
+      postorder_(idom_.size(), kNone) {
+  const Index count = idom_.size();
+  for (BBID parent : idom_) {
+    if (parent != InvalidBBID) {
+      ++child_offsets_[parent + 1];
+    }
+  }
+  for (Index i = 0; i < count; ++i) {
+    child_offsets_[i + 1] += child_offsets_[i];
+  }
+  children_.resize(child_offsets_[count]);
+  std::vector<Index> pos{child_offsets_.begin(), child_offsets_.end() - 1};
+  for (BBID node = 0; node < count; ++node) {
+    if (idom_[node] != InvalidBBID) {
+      children_[pos[idom_[node]]++] = node;
+    }
+  }
+
+  if (root_ == InvalidBBID) {
+    return;
+  }
+
+  Index pre = 0;
+  Index post = 0;
+  std::vector<std::pair<BBID, Index>> stack;
+  preorder_[root_] = pre++;
+  stack.emplace_back(root_, child_offsets_[root_]);
+  while (!stack.empty()) {
+    BBID node = stack.back().first;
+    Index& next = stack.back().second;
+    if (next == child_offsets_[node + 1]) {
+      postorder_[node] = post++;
+      stack.pop_back();
+      continue;
+    }
+    BBID child = children_[next++];
+    preorder_[child] = pre++;
+    stack.emplace_back(child, child_offsets_[child]);
+  }
+}
+
+BBID DominatorTree::idom(BBID bbid) const {
+  assert(bbid < idom_.size());
+  return idom_[bbid];
+}
+
+bool DominatorTree::reachable(BBID bbid) const {
+  assert(bbid < idom_.size());
+  return preorder_[bbid] != kNone;
+}
+
+bool DominatorTree::Dominates(BBID a, BBID b) const {
+  return reachable(a) && reachable(b) && preorder_[a] <= preorder_[b] &&
+         postorder_[b] <= postorder_[a];
+}
+
+BBIDSpan DominatorTree::children(BBID bbid) const {
+  assert(bbid < idom_.size());
+  return BBIDSpan{children_.data() + child_offsets_[bbid],
+                  children_.data() + child_offsets_[bbid + 1]};
+}
+
+DominatorTree ComputeDominators(const Cfg& cfg) {
+  const Index count = cfg.block_count();
+  Graph succs{count};
+  Graph preds{count};
+  for (BBID bbid = 0; bbid < count; ++bbid) {
+    for (const auto& edge : cfg.successors(bbid)) {
+      if (edge.target != InvalidBBID) {
+        succs.edges.push_back(edge.target);
+      }
+    }
+    succs.FinishNode(bbid);
+    for (BBID pred : cfg.predecessors(bbid)) {
+      preds.edges.push_back(pred);
+    }
+    preds.FinishNode(bbid);
+  }
+
+  return DominatorTree{cfg.start(),
+                       LengauerTarjan{succs, preds}.Run(cfg.start())};
+}
+
+DominatorTree ComputePostDominators(const Cfg& cfg) {
+  // Walk the reversed graph, starting from an extra node for the function
+  // exit.
+  const Index count = cfg.block_count();
+  const BBID exit = count;
+  Graph succs{count + 1};
+  Graph preds{count + 1};
+  for (BBID bbid = 0; bbid < count; ++bbid) {
+    for (BBID pred : cfg.predecessors(bbid)) {
+      succs.edges.push_back(pred);
+    }
+    succs.FinishNode(bbid);
+    for (const auto& edge : cfg.successors(bbid)) {
+      preds.edges.push_back(edge.target == InvalidBBID ? exit : edge.target);
+    }
+    preds.FinishNode(bbid);
+  }
+  for (BBID bbid = 0; bbid < count; ++bbid) {
+    for (const auto& edge : cfg.successors(bbid)) {
+      if (edge.target == InvalidBBID) {
+        succs.edges.push_back(bbid);
+        break;
+      }
+    }
+  }
+  succs.FinishNode(exit);
+  preds.FinishNode(exit);
+
+  return DominatorTree{exit, LengauerTarjan{succs, preds}.Run(exit)};
+}
+
+}  // namespace analysis
+}  // namespace wasp
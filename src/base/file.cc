@@ -18,6 +18,18 @@
 
 #include <fstream>
 #include <string>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WASP_HAS_MMAP 1
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define WASP_HAS_MMAP 0
+#endif
 
 namespace wasp {
 
@@ -39,4 +51,125 @@ optional<std::vector<u8>> ReadFile(string_view filename) {
   return buffer;
 }
 
+MappedFile::MappedFile(std::vector<u8>&& buffer) : buffer_{std::move(buffer)} {}
+
+MappedFile::MappedFile(void* addr, std::size_t size)
+    : addr_{addr}, size_{size} {}
+
+MappedFile::MappedFile(MappedFile&& other)
+    : addr_{other.addr_},
+      size_{other.size_},
+      buffer_{std::move(other.buffer_)} {
+  other.addr_ = nullptr;
+  other.size_ = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+  if (this != &other) {
+    Unmap();
+    addr_ = other.addr_;
+    size_ = other.size_;
+    buffer_ = std::move(other.buffer_);
+    other.addr_ = nullptr;
+    other.size_ = 0;
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  Unmap();
+}
+
+SpanU8 MappedFile::data() const {
+  if (is_mapped()) {
+    return SpanU8{static_cast<const u8*>(addr_),
+                  static_cast<SpanU8::index_type>(size_)};
+  }
+  return SpanU8{buffer_};
+}
+
+void MappedFile::Unmap() {
+#if WASP_HAS_MMAP
+  if (addr_) {
+    munmap(addr_, size_);
+  }
+#endif
+  addr_ = nullptr;
+  size_ = 0;
+}
+
+#if WASP_HAS_MMAP
+
+namespace {
+
+optional<std::vector<u8>> ReadFd(int fd) {
+  std::vector<u8> buffer;
+  const std::size_t kChunkSize = 64 * 1024;
+  std::size_t size = 0;
+  for (;;) {
+    buffer.resize(size + kChunkSize);
+    ssize_t count = read(fd, buffer.data() + size, kChunkSize);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return nullopt;
+    } else if (count == 0) {
+      break;
+    }
+    size += count;
+  }
+  buffer.resize(size);
+  return buffer;
+}
+
+}  // namespace
+
+optional<MappedFile> MapFile(string_view filename) {
+  if (filename == "-") {
+    auto optbuf = ReadFd(STDIN_FILENO);
+    if (!optbuf) {
+      return nullopt;
+    }
+    return MappedFile{std::move(*optbuf)};
+  }
+
+  int fd = open(filename.to_string().c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullopt;
+  }
+
+  optional<MappedFile> result;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    std::size_t size = st.st_size;
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED) {
+      result = MappedFile{addr, size};
+    }
+  }
+
+  if (!result) {
+    auto optbuf = ReadFd(fd);
+    if (optbuf) {
+      result = MappedFile{std::move(*optbuf)};
+    }
+  }
+
+  close(fd);
+  return result;
+}
+
+#else
+
+optional<MappedFile> MapFile(string_view filename) {
+  auto optbuf = ReadFile(filename);
+  if (!optbuf) {
+    return nullopt;
+  }
+  return MappedFile{std::move(*optbuf)};
+}
+
+#endif
+
 }  // namespace wasp
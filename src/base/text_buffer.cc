@@ -0,0 +1,104 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/text_buffer.h"
+
+#include <ostream>
+
+namespace wasp {
+
+// static
+constexpr size_t TextBuffer::kDefaultFlushSize;
+
+TextBuffer::TextBuffer(std::ostream& stream, size_t flush_size)
+    : stream_(stream), flush_size_{flush_size} {
+  // Leave room for the line that crosses the flush threshold, so the buffer
+  // is only allocated once.
+  buffer_.reserve(flush_size_ + flush_size_ / 4);
+}
+
+TextBuffer::~TextBuffer() {
+  Flush();
+}
+
+void TextBuffer::Append(char c) {
+  buffer_ += c;
+  MaybeFlush();
+}
+
+void TextBuffer::Append(string_view s) {
+  buffer_.append(s.data(), s.size());
+  MaybeFlush();
+}
+
+void TextBuffer::AppendSpaces(size_t count) {
+  buffer_.append(count, ' ');
+  MaybeFlush();
+}
+
+void TextBuffer::AppendUnsigned(u64 value) {
+  char digits[20];
+  char* end = digits + sizeof(digits);
+  char* p = end;
+  do {
+    *--p = '0' + value % 10;
+    value /= 10;
+  } while (value != 0);
+  buffer_.append(p, end);
+  MaybeFlush();
+}
+
+void TextBuffer::AppendSigned(s64 value) {
+  if (value < 0) {
+    buffer_ += '-';
+    // Negate as unsigned, so the minimum value doesn't overflow.
+    AppendUnsigned(u64{0} - static_cast<u64>(value));
+  } else {
+    AppendUnsigned(static_cast<u64>(value));
+  }
+}
+
+void TextBuffer::AppendHex(u64 value, int width) {
+  static const char kHexDigits[] = "0123456789abcdef";
+  char digits[16];
+  char* end = digits + sizeof(digits);
+  char* p = end;
+  do {
+    *--p = kHexDigits[value & 0xf];
+    value >>= 4;
+  } while (value != 0);
+  if (end - p < width) {
+    buffer_.append(width - (end - p), '0');
+  }
+  buffer_.append(p, end);
+  MaybeFlush();
+}
+
+void TextBuffer::Flush() {
+  if (!buffer_.empty()) {
+    stream_.write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+  }
+  stream_.flush();
+}
+
+void TextBuffer::MaybeFlush() {
+  if (buffer_.size() >= flush_size_) {
+    Flush();
+  }
+}
+
+}  // namespace wasp
@@ -16,11 +16,114 @@
 
 #include "wasp/binary/br_table_immediate.h"
 
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
 #include "src/base/operator_eq_ne_macros.h"
+#include "wasp/binary/write/write_index.h"
 
 namespace wasp {
 namespace binary {
 
+namespace {
+
+// Returns true if |data| holds exactly |count| LEB128-encoded u32 values.
+bool IsEncodedTargets(Index count, SpanU8 data) {
+  auto iter = data.begin();
+  for (Index i = 0; i < count; ++i) {
+    for (int length = 1;; ++length) {
+      if (iter == data.end() || length > 5) {
+        return false;
+      }
+      u8 byte = *iter++;
+      if (length == 5 && (byte & 0xf0) != 0) {
+        return false;
+      }
+      if ((byte & 0x80) == 0) {
+        break;
+      }
+    }
+  }
+  return iter == data.end();
+}
+
+}  // namespace
+
+BrTableTargets::BrTableTargets(Index count, SpanU8 data)
+    : data_{data}, count_{count} {
+  assert(IsEncodedTargets(count, data));
+}
+
+BrTableTargets::const_iterator BrTableTargets::begin() const {
+  return const_iterator{data_.data(), 0, count_};
+}
+
+BrTableTargets::const_iterator BrTableTargets::end() const {
+  return const_iterator{data_.data(), count_, count_};
+}
+
+BrTableTargets::const_iterator::const_iterator(const u8* data,
+                                               Index index,
+                                               Index count)
+    : data_{data}, index_{index}, count_{count}, value_{0} {
+  if (index_ < count_) {
+    Load();
+  }
+}
+
+void BrTableTargets::const_iterator::Load() {
+  // The encoding was checked when the targets were constructed, so the value
+  // can be decoded without bounds or overflow checks.
+  u32 value = 0;
+  int shift = 0;
+  u8 byte;
+  do {
+    byte = *data_++;
+    value |= static_cast<u32>(byte & 0x7f) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  value_ = value;
+}
+
+auto BrTableTargets::const_iterator::operator++() -> const_iterator& {
+  if (++index_ < count_) {
+    Load();
+  }
+  return *this;
+}
+
+auto BrTableTargets::const_iterator::operator++(int) -> const_iterator {
+  auto temp = *this;
+  operator++();
+  return temp;
+}
+
+bool operator==(const BrTableTargets& lhs, const BrTableTargets& rhs) {
+  return lhs.size() == rhs.size() &&
+         std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+bool operator!=(const BrTableTargets& lhs, const BrTableTargets& rhs) {
+  return !(lhs == rhs);
+}
+
+BrTableTargetsBuffer::BrTableTargetsBuffer(
+    std::initializer_list<Index> targets)
+    : BrTableTargetsBuffer{targets.begin(), targets.end()} {}
+
+BrTableTargetsBuffer::BrTableTargetsBuffer(const std::vector<Index>& targets)
+    : BrTableTargetsBuffer{targets.begin(), targets.end()} {}
+
+void BrTableTargetsBuffer::push_back(Index target) {
+  WriteIndex(target, std::back_inserter(data_));
+  ++count_;
+}
+
+BrTableTargets BrTableTargetsBuffer::targets() const {
+  return BrTableTargets{count_, SpanU8{data_}};
+}
+
 WASP_OPERATOR_EQ_NE_2(BrTableImmediate, targets, default_target)
 
 }  // namespace binary
@@ -0,0 +1,92 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/code_section_index.h"
+
+#include "wasp/base/macros.h"
+#include "wasp/binary/errors_context_guard.h"
+#include "wasp/binary/read/read_bytes.h"
+#include "wasp/binary/read/read_count.h"
+#include "wasp/binary/read/read_length.h"
+#include "wasp/binary/read/read_locals.h"
+#include "wasp/binary/read/read_u32.h"
+#include "wasp/binary/read/read_value_type.h"
+#include "wasp/binary/read/read_vector.h"
+
+namespace wasp {
+namespace binary {
+
+namespace {
+
+optional<CodeIndexEntry> ReadCodeIndexEntry(SpanU8* data,
+                                            const Features& features,
+                                            Errors& errors) {
+  ErrorsContextGuard guard{errors, *data, "code"};
+  WASP_TRY_READ(body_size, ReadLength(data, features, errors));
+  WASP_TRY_READ(body, ReadBytes(data, body_size, features, errors));
+
+  // Skip over the locals declarations without building a vector of Locals.
+  SpanU8 locals = body;
+  ErrorsContextGuard locals_guard{errors, body, "locals vector"};
+  WASP_TRY_READ(count, ReadCount(&body, features, errors));
+  for (Index i = 0; i < count; ++i) {
+    WASP_TRY_READ(locals_count, Read<u32>(&body, features, errors));
+    WASP_TRY_READ(type, Read<ValueType>(&body, features, errors));
+    WASP_USE(locals_count);
+    WASP_USE(type);
+  }
+  locals = locals.subspan(0, body.begin() - locals.begin());
+  return CodeIndexEntry{locals, body};
+}
+
+}  // namespace
+
+CodeSectionIndex::CodeSectionIndex(SpanU8 data,
+                                   const Features& features,
+                                   Errors& errors) {
+  auto count = ReadCount(&data, features, errors);
+  if (!count) {
+    return;
+  }
+  entries_.reserve(*count);
+  for (Index i = 0; i < *count; ++i) {
+    auto entry = ReadCodeIndexEntry(&data, features, errors);
+    if (!entry) {
+      break;
+    }
+    entries_.push_back(*entry);
+  }
+}
+
+CodeSectionIndex::CodeSectionIndex(KnownSection known,
+                                   const Features& features,
+                                   Errors& errors)
+    : CodeSectionIndex{known.data, features, errors} {}
+
+optional<Code> CodeSectionIndex::GetCode(Index index,
+                                         const Features& features,
+                                         Errors& errors) const {
+  if (index >= entries_.size()) {
+    return nullopt;
+  }
+  SpanU8 locals_data = entries_[index].locals;
+  WASP_TRY_READ(locals, ReadVector<Locals>(&locals_data, features, errors,
+                                           "locals vector"));
+  return Code{std::move(locals), Expression{entries_[index].body}};
+}
+
+}  // namespace binary
+}  // namespace wasp
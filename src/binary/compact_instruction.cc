@@ -0,0 +1,267 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/compact_instruction.h"
+
+#include <cstring>
+#include <type_traits>
+
+#include "wasp/base/macros.h"
+#include "wasp/binary/read/read_instruction.h"
+
+namespace wasp {
+namespace binary {
+
+namespace {
+
+using ImmediateVariant = decltype(Instruction::immediate);
+
+// CompactImmediateKind is derived from the variant index of an Instruction's
+// immediate, so each enumerator must name the alternative at its position.
+template <CompactImmediateKind kind, typename T>
+constexpr bool IsAlternative() {
+  return std::is_same<
+      variant_alternative_t<static_cast<size_t>(kind), ImmediateVariant>,
+      T>::value;
+}
+
+static_assert(IsAlternative<CompactImmediateKind::Empty, EmptyImmediate>(),
+              "Empty");
+static_assert(IsAlternative<CompactImmediateKind::BlockType, BlockType>(),
+              "BlockType");
+static_assert(IsAlternative<CompactImmediateKind::Index, Index>(), "Index");
+static_assert(IsAlternative<CompactImmediateKind::CallIndirect,
+                            CallIndirectImmediate>(),
+              "CallIndirect");
+static_assert(IsAlternative<CompactImmediateKind::BrTable,
+                            BrTableImmediate>(),
+              "BrTable");
+static_assert(IsAlternative<CompactImmediateKind::BrOnExn,
+                            BrOnExnImmediate>(),
+              "BrOnExn");
+static_assert(IsAlternative<CompactImmediateKind::U8, u8>(), "U8");
+static_assert(IsAlternative<CompactImmediateKind::MemArg, MemArgImmediate>(),
+              "MemArg");
+static_assert(IsAlternative<CompactImmediateKind::S32, s32>(), "S32");
+static_assert(IsAlternative<CompactImmediateKind::S64, s64>(), "S64");
+static_assert(IsAlternative<CompactImmediateKind::F32, f32>(), "F32");
+static_assert(IsAlternative<CompactImmediateKind::F64, f64>(), "F64");
+static_assert(IsAlternative<CompactImmediateKind::V128, v128>(), "V128");
+static_assert(IsAlternative<CompactImmediateKind::Init, InitImmediate>(),
+              "Init");
+static_assert(IsAlternative<CompactImmediateKind::Copy, CopyImmediate>(),
+              "Copy");
+static_assert(IsAlternative<CompactImmediateKind::Shuffle,
+                            ShuffleImmediate>(),
+              "Shuffle");
+static_assert(static_cast<size_t>(CompactImmediateKind::Shuffle) + 1 ==
+                  variant_size<ImmediateVariant>::value,
+              "CompactImmediateKind must cover every immediate type");
+
+}  // namespace
+
+void CompactExpression::clear() {
+  instructions.clear();
+  arena.clear();
+}
+
+void CompactExpression::Append(const Instruction& instruction) {
+  CompactInstruction compact;
+  compact.opcode_ = instruction.opcode;
+  compact.kind_ =
+      static_cast<CompactImmediateKind>(instruction.immediate.index());
+  compact.small_ = 0;
+  compact.unused_ = 0;
+  compact.payload_[0] = compact.payload_[1] = 0;
+
+  switch (compact.kind_) {
+    case CompactImmediateKind::Empty:
+      break;
+
+    case CompactImmediateKind::BlockType:
+      compact.Set(instruction.block_type_immediate());
+      break;
+
+    case CompactImmediateKind::Index:
+      compact.payload_[0] = instruction.index_immediate();
+      break;
+
+    case CompactImmediateKind::CallIndirect: {
+      const auto& immediate = instruction.call_indirect_immediate();
+      compact.payload_[0] = immediate.index;
+      compact.small_ = immediate.reserved;
+      break;
+    }
+
+    case CompactImmediateKind::BrTable: {
+      const auto& immediate = instruction.br_table_immediate();
+      compact.payload_[0] = arena.size();
+      compact.payload_[1] = immediate.targets.size();
+      arena.reserve(arena.size() + immediate.targets.size() + 1);
+      for (auto target : immediate.targets) {
+        arena.push_back(target);
+      }
+      arena.push_back(immediate.default_target);
+      break;
+    }
+
+    case CompactImmediateKind::BrOnExn: {
+      const auto& immediate = instruction.br_on_exn_immediate();
+      compact.payload_[0] = immediate.target;
+      compact.payload_[1] = immediate.exception_index;
+      break;
+    }
+
+    case CompactImmediateKind::U8:
+      compact.small_ = instruction.u8_immediate();
+      break;
+
+    case CompactImmediateKind::MemArg: {
+      const auto& immediate = instruction.mem_arg_immediate();
+      compact.payload_[0] = immediate.align_log2;
+      compact.payload_[1] = immediate.offset;
+      break;
+    }
+
+    case CompactImmediateKind::S32:
+      compact.Set(instruction.s32_immediate());
+      break;
+
+    case CompactImmediateKind::S64:
+      compact.Set(instruction.s64_immediate());
+      break;
+
+    case CompactImmediateKind::F32:
+      compact.Set(instruction.f32_immediate());
+      break;
+
+    case CompactImmediateKind::F64:
+      compact.Set(instruction.f64_immediate());
+      break;
+
+    case CompactImmediateKind::V128: {
+      auto lanes = instruction.v128_immediate().as<u32x4>();
+      compact.payload_[0] = arena.size();
+      arena.insert(arena.end(), lanes.begin(), lanes.end());
+      break;
+    }
+
+    case CompactImmediateKind::Init: {
+      const auto& immediate = instruction.init_immediate();
+      compact.payload_[0] = immediate.segment_index;
+      compact.small_ = immediate.reserved;
+      break;
+    }
+
+    case CompactImmediateKind::Copy: {
+      const auto& immediate = instruction.copy_immediate();
+      compact.small_ = immediate.src_reserved;
+      compact.payload_[0] = immediate.dst_reserved;
+      break;
+    }
+
+    case CompactImmediateKind::Shuffle: {
+      const auto& immediate = instruction.shuffle_immediate();
+      compact.payload_[0] = arena.size();
+      arena.resize(arena.size() + immediate.size() / sizeof(u32));
+      std::memcpy(arena.data() + compact.payload_[0], immediate.data(),
+                  immediate.size());
+      break;
+    }
+  }
+
+  instructions.push_back(compact);
+}
+
+Instruction CompactExpression::ToInstruction(
+    const CompactInstruction& compact,
+    BrTableTargetsBuffer* br_table_buffer) const {
+  Opcode opcode = compact.opcode();
+  switch (compact.kind()) {
+    case CompactImmediateKind::Empty:
+      return Instruction{opcode};
+
+    case CompactImmediateKind::BlockType:
+      return Instruction{opcode, compact.block_type_immediate()};
+
+    case CompactImmediateKind::Index:
+      return Instruction{opcode, compact.index_immediate()};
+
+    case CompactImmediateKind::CallIndirect:
+      return Instruction{opcode, compact.call_indirect_immediate()};
+
+    case CompactImmediateKind::BrTable: {
+      auto targets = compact.br_table_targets(*this);
+      *br_table_buffer = BrTableTargetsBuffer{targets.begin(), targets.end()};
+      return Instruction{
+          opcode, BrTableImmediate{br_table_buffer->targets(),
+                                   compact.br_table_default_target(*this)}};
+    }
+
+    case CompactImmediateKind::BrOnExn:
+      return Instruction{opcode, compact.br_on_exn_immediate()};
+
+    case CompactImmediateKind::U8:
+      return Instruction{opcode, compact.u8_immediate()};
+
+    case CompactImmediateKind::MemArg:
+      return Instruction{opcode, compact.mem_arg_immediate()};
+
+    case CompactImmediateKind::S32:
+      return Instruction{opcode, compact.s32_immediate()};
+
+    case CompactImmediateKind::S64:
+      return Instruction{opcode, compact.s64_immediate()};
+
+    case CompactImmediateKind::F32:
+      return Instruction{opcode, compact.f32_immediate()};
+
+    case CompactImmediateKind::F64:
+      return Instruction{opcode, compact.f64_immediate()};
+
+    case CompactImmediateKind::V128:
+      return Instruction{opcode, compact.v128_immediate(*this)};
+
+    case CompactImmediateKind::Init:
+      return Instruction{opcode, compact.init_immediate()};
+
+    case CompactImmediateKind::Copy:
+      return Instruction{opcode, compact.copy_immediate()};
+
+    case CompactImmediateKind::Shuffle:
+      return Instruction{opcode, compact.shuffle_immediate(*this)};
+  }
+  WASP_UNREACHABLE();
+}
+
+bool ReadCompactExpression(Expression expression,
+                           const Features& features,
+                           Errors& errors,
+                           CompactExpression* out) {
+  out->clear();
+  SpanU8 data = expression.data;
+  while (!data.empty()) {
+    auto instruction = Read<Instruction>(&data, features, errors);
+    if (!instruction) {
+      return false;
+    }
+    out->Append(*instruction);
+  }
+  return true;
+}
+
+}  // namespace binary
+}  // namespace wasp
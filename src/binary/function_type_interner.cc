@@ -0,0 +1,137 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/function_type_interner.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace wasp {
+namespace binary {
+
+constexpr Index FunctionTypeInterner::kEmptySlot;
+
+Index FunctionTypeInterner::Intern(ValueTypeSpan param_types,
+                                   ValueTypeSpan result_types) {
+  if (slots_.empty()) {
+    Grow();
+  }
+
+  u32 hash = Hash(param_types, result_types);
+  size_t slot = FindSlot(param_types, result_types, hash);
+  if (slots_[slot] != kEmptySlot) {
+    return slots_[slot];
+  }
+
+  // Only a new entry can grow the table, so interning a type that is already
+  // present never allocates. Keep the table at most half full.
+  if ((entries_.size() + 1) * 2 > slots_.size()) {
+    Grow();
+    slot = FindSlot(param_types, result_types, hash);
+  }
+
+  Index id = entries_.size();
+  entries_.push_back(Entry{static_cast<u32>(types_.size()),
+                           static_cast<u32>(param_types.size()),
+                           static_cast<u32>(result_types.size()), hash});
+  types_.insert(types_.end(), param_types.begin(), param_types.end());
+  types_.insert(types_.end(), result_types.begin(), result_types.end());
+  slots_[slot] = id;
+  return id;
+}
+
+Index FunctionTypeInterner::Intern(const FunctionType& type) {
+  return Intern(type.param_types, type.result_types);
+}
+
+optional<Index> FunctionTypeInterner::Find(ValueTypeSpan param_types,
+                                           ValueTypeSpan result_types) const {
+  if (slots_.empty()) {
+    return nullopt;
+  }
+  size_t slot =
+      FindSlot(param_types, result_types, Hash(param_types, result_types));
+  if (slots_[slot] == kEmptySlot) {
+    return nullopt;
+  }
+  return slots_[slot];
+}
+
+ValueTypeSpan FunctionTypeInterner::param_types(Index id) const {
+  assert(id < entries_.size());
+  const Entry& entry = entries_[id];
+  return ValueTypeSpan{types_}.subspan(entry.begin, entry.param_count);
+}
+
+ValueTypeSpan FunctionTypeInterner::result_types(Index id) const {
+  assert(id < entries_.size());
+  const Entry& entry = entries_[id];
+  return ValueTypeSpan{types_}.subspan(entry.begin + entry.param_count,
+                                       entry.result_count);
+}
+
+// static
+u32 FunctionTypeInterner::Hash(ValueTypeSpan param_types,
+                               ValueTypeSpan result_types) {
+  // FNV-1a over the value types, with the param count mixed in so that
+  // (i32) -> () and () -> (i32) differ.
+  u32 hash = 2166136261u;
+  auto mix = [&](u32 value) {
+    hash ^= value;
+    hash *= 16777619u;
+  };
+  mix(static_cast<u32>(param_types.size()));
+  for (auto type : param_types) {
+    mix(static_cast<u32>(type));
+  }
+  for (auto type : result_types) {
+    mix(static_cast<u32>(type));
+  }
+  return hash;
+}
+
+size_t FunctionTypeInterner::FindSlot(ValueTypeSpan param_types,
+                                      ValueTypeSpan result_types,
+                                      u32 hash) const {
+  assert(!slots_.empty());
+  const size_t mask = slots_.size() - 1;
+  for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+    Index id = slots_[slot];
+    if (id == kEmptySlot) {
+      return slot;
+    }
+    if (entries_[id].hash == hash && this->param_types(id) == param_types &&
+        this->result_types(id) == result_types) {
+      return slot;
+    }
+  }
+}
+
+void FunctionTypeInterner::Grow() {
+  size_t new_size = std::max<size_t>(slots_.size() * 2, 16);
+  slots_.assign(new_size, kEmptySlot);
+  const size_t mask = new_size - 1;
+  for (Index id = 0; id < entries_.size(); ++id) {
+    size_t slot = entries_[id].hash & mask;
+    while (slots_[slot] != kEmptySlot) {
+      slot = (slot + 1) & mask;
+    }
+    slots_[slot] = id;
+  }
+}
+
+}  // namespace binary
+}  // namespace wasp
@@ -0,0 +1,136 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/instruction_text.h"
+
+#include <cstddef>
+
+#include "wasp/base/format.h"
+#include "wasp/base/text_buffer.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/opcode_info.h"
+
+namespace wasp {
+namespace binary {
+
+namespace {
+
+// BlockType enumerators are numbered sequentially in .def order, so the enum
+// value can be used directly as a table index.
+const string_view kBlockTypeNames[] = {
+#define WASP_V(val, Name, str, ...) "[" str "]",
+#define WASP_FEATURE_V(...) WASP_V(__VA_ARGS__)
+#include "wasp/binary/block_type.def"
+#undef WASP_V
+#undef WASP_FEATURE_V
+};
+
+}  // namespace
+
+string_view GetOpcodeName(Opcode opcode) {
+  auto info = GetOpcodeInfo(opcode);
+  return info ? info->name : string_view{};
+}
+
+string_view GetBlockTypeName(BlockType block_type) {
+  auto index = static_cast<size_t>(block_type);
+  if (index >= sizeof(kBlockTypeNames) / sizeof(kBlockTypeNames[0])) {
+    return {};
+  }
+  return kBlockTypeNames[index];
+}
+
+void AppendInstruction(TextBuffer& buffer, const Instruction& instr) {
+  auto name = GetOpcodeName(instr.opcode);
+  if (!name.empty()) {
+    buffer.Append(name);
+  } else {
+    buffer.Append("<unknown:");
+    buffer.AppendUnsigned(static_cast<u32>(instr.opcode));
+    buffer.Append('>');
+  }
+
+  if (instr.has_empty_immediate()) {
+    // Nothing.
+  } else if (instr.has_block_type_immediate()) {
+    buffer.Append(' ');
+    buffer.Append(GetBlockTypeName(instr.block_type_immediate()));
+  } else if (instr.has_index_immediate()) {
+    buffer.Append(' ');
+    buffer.AppendUnsigned(instr.index_immediate());
+  } else if (instr.has_call_indirect_immediate()) {
+    const auto& immediate = instr.call_indirect_immediate();
+    buffer.Append(' ');
+    buffer.AppendUnsigned(immediate.index);
+    buffer.Append(' ');
+    buffer.AppendUnsigned(immediate.reserved);
+  } else if (instr.has_br_table_immediate()) {
+    const auto& immediate = instr.br_table_immediate();
+    buffer.Append(" [");
+    bool first = true;
+    for (auto target : immediate.targets) {
+      if (!first) {
+        buffer.Append(' ');
+      }
+      buffer.AppendUnsigned(target);
+      first = false;
+    }
+    buffer.Append("] ");
+    buffer.AppendUnsigned(immediate.default_target);
+  } else if (instr.has_u8_immediate()) {
+    buffer.Append(' ');
+    buffer.AppendUnsigned(instr.u8_immediate());
+  } else if (instr.has_mem_arg_immediate()) {
+    const auto& immediate = instr.mem_arg_immediate();
+    buffer.Append(" {align ");
+    buffer.AppendUnsigned(immediate.align_log2);
+    buffer.Append(", offset ");
+    buffer.AppendUnsigned(immediate.offset);
+    buffer.Append('}');
+  } else if (instr.has_s32_immediate()) {
+    buffer.Append(' ');
+    buffer.AppendSigned(instr.s32_immediate());
+  } else if (instr.has_s64_immediate()) {
+    buffer.Append(' ');
+    buffer.AppendSigned(instr.s64_immediate());
+  } else if (instr.has_f32_immediate()) {
+    // Floats are rare enough that it isn't worth duplicating fmt's
+    // formatting.
+    buffer.Print(" {:f}", instr.f32_immediate());
+  } else if (instr.has_f64_immediate()) {
+    buffer.Print(" {:f}", instr.f64_immediate());
+  } else if (instr.has_init_immediate()) {
+    const auto& immediate = instr.init_immediate();
+    buffer.Append(' ');
+    buffer.AppendUnsigned(immediate.segment_index);
+    buffer.Append(' ');
+    buffer.AppendUnsigned(immediate.reserved);
+  } else if (instr.has_copy_immediate()) {
+    const auto& immediate = instr.copy_immediate();
+    buffer.Append(' ');
+    buffer.AppendUnsigned(immediate.src_reserved);
+    buffer.Append(' ');
+    buffer.AppendUnsigned(immediate.dst_reserved);
+  } else if (instr.has_shuffle_immediate()) {
+    for (auto byte : instr.shuffle_immediate()) {
+      buffer.Append(' ');
+      buffer.AppendUnsigned(byte);
+    }
+  }
+}
+
+}  // namespace binary
+}  // namespace wasp
@@ -0,0 +1,216 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/opcode_info.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include "wasp/binary/encoding/opcode_encoding.h"
+
+namespace wasp {
+namespace binary {
+
+namespace {
+
+#define I32 ValueType::I32
+#define I64 ValueType::I64
+#define F32 ValueType::F32
+#define F64 ValueType::F64
+#define V128 ValueType::V128
+
+// Every stack signature named in opcode.def. kSig_special marks the opcodes
+// that don't have one.
+constexpr StackSignature kSig_special = {0, 0, {}, {}};
+constexpr StackSignature kSig_void_to_void = {0, 0, {}, {}};
+constexpr StackSignature kSig_void_to_f32 = {0, 1, {}, {F32}};
+constexpr StackSignature kSig_void_to_f64 = {0, 1, {}, {F64}};
+constexpr StackSignature kSig_void_to_i32 = {0, 1, {}, {I32}};
+constexpr StackSignature kSig_void_to_i64 = {0, 1, {}, {I64}};
+constexpr StackSignature kSig_void_to_v128 = {0, 1, {}, {V128}};
+constexpr StackSignature kSig_f32_to_f32 = {1, 1, {F32}, {F32}};
+constexpr StackSignature kSig_f32_to_f64 = {1, 1, {F32}, {F64}};
+constexpr StackSignature kSig_f32_to_i32 = {1, 1, {F32}, {I32}};
+constexpr StackSignature kSig_f32_to_i64 = {1, 1, {F32}, {I64}};
+constexpr StackSignature kSig_f32_to_v128 = {1, 1, {F32}, {V128}};
+constexpr StackSignature kSig_f64_to_f32 = {1, 1, {F64}, {F32}};
+constexpr StackSignature kSig_f64_to_f64 = {1, 1, {F64}, {F64}};
+constexpr StackSignature kSig_f64_to_i32 = {1, 1, {F64}, {I32}};
+constexpr StackSignature kSig_f64_to_i64 = {1, 1, {F64}, {I64}};
+constexpr StackSignature kSig_f64_to_v128 = {1, 1, {F64}, {V128}};
+constexpr StackSignature kSig_i32_to_f32 = {1, 1, {I32}, {F32}};
+constexpr StackSignature kSig_i32_to_f64 = {1, 1, {I32}, {F64}};
+constexpr StackSignature kSig_i32_to_i32 = {1, 1, {I32}, {I32}};
+constexpr StackSignature kSig_i32_to_i64 = {1, 1, {I32}, {I64}};
+constexpr StackSignature kSig_i32_to_v128 = {1, 1, {I32}, {V128}};
+constexpr StackSignature kSig_i64_to_f32 = {1, 1, {I64}, {F32}};
+constexpr StackSignature kSig_i64_to_f64 = {1, 1, {I64}, {F64}};
+constexpr StackSignature kSig_i64_to_i32 = {1, 1, {I64}, {I32}};
+constexpr StackSignature kSig_i64_to_i64 = {1, 1, {I64}, {I64}};
+constexpr StackSignature kSig_i64_to_v128 = {1, 1, {I64}, {V128}};
+constexpr StackSignature kSig_v128_to_f32 = {1, 1, {V128}, {F32}};
+constexpr StackSignature kSig_v128_to_f64 = {1, 1, {V128}, {F64}};
+constexpr StackSignature kSig_v128_to_i32 = {1, 1, {V128}, {I32}};
+constexpr StackSignature kSig_v128_to_i64 = {1, 1, {V128}, {I64}};
+constexpr StackSignature kSig_v128_to_v128 = {1, 1, {V128}, {V128}};
+constexpr StackSignature kSig_i32_f32_to_void = {2, 0, {I32, F32}, {}};
+constexpr StackSignature kSig_i32_f64_to_void = {2, 0, {I32, F64}, {}};
+constexpr StackSignature kSig_i32_i32_to_void = {2, 0, {I32, I32}, {}};
+constexpr StackSignature kSig_i32_i64_to_void = {2, 0, {I32, I64}, {}};
+constexpr StackSignature kSig_i32_v128_to_void = {2, 0, {I32, V128}, {}};
+constexpr StackSignature kSig_f32_f32_to_f32 = {2, 1, {F32, F32}, {F32}};
+constexpr StackSignature kSig_f32_f32_to_i32 = {2, 1, {F32, F32}, {I32}};
+constexpr StackSignature kSig_f64_f64_to_f64 = {2, 1, {F64, F64}, {F64}};
+constexpr StackSignature kSig_f64_f64_to_i32 = {2, 1, {F64, F64}, {I32}};
+constexpr StackSignature kSig_i32_i32_to_i32 = {2, 1, {I32, I32}, {I32}};
+constexpr StackSignature kSig_i32_i64_to_i64 = {2, 1, {I32, I64}, {I64}};
+constexpr StackSignature kSig_i64_i64_to_i32 = {2, 1, {I64, I64}, {I32}};
+constexpr StackSignature kSig_i64_i64_to_i64 = {2, 1, {I64, I64}, {I64}};
+constexpr StackSignature kSig_v128_f32_to_v128 = {2, 1, {V128, F32}, {V128}};
+constexpr StackSignature kSig_v128_f64_to_v128 = {2, 1, {V128, F64}, {V128}};
+constexpr StackSignature kSig_v128_i32_to_v128 = {2, 1, {V128, I32}, {V128}};
+constexpr StackSignature kSig_v128_i64_to_v128 = {2, 1, {V128, I64}, {V128}};
+constexpr StackSignature kSig_v128_v128_to_v128 = {2, 1, {V128, V128}, {V128}};
+constexpr StackSignature kSig_i32_i32_i32_to_void = {3, 0, {I32, I32, I32}, {}};
+constexpr StackSignature kSig_i32_i32_i32_to_i32 = {
+    3, 1, {I32, I32, I32}, {I32}};
+constexpr StackSignature kSig_i32_i32_i64_to_i32 = {
+    3, 1, {I32, I32, I64}, {I32}};
+constexpr StackSignature kSig_i32_i64_i64_to_i32 = {
+    3, 1, {I32, I64, I64}, {I32}};
+constexpr StackSignature kSig_i32_i64_i64_to_i64 = {
+    3, 1, {I32, I64, I64}, {I64}};
+constexpr StackSignature kSig_v128_v128_v128_to_v128 = {
+    3, 1, {V128, V128, V128}, {V128}};
+
+#undef I32
+#undef I64
+#undef F32
+#undef F64
+#undef V128
+
+constexpr const StackSignature* GetStackSignature(
+    const StackSignature& signature) {
+  return &signature == &kSig_special ? nullptr : &signature;
+}
+
+constexpr OpcodeInfo kOpcodeInfos[] = {
+#define WASP_V(prefix, code, Name, str, immediate, signature)                 \
+  {Opcode::Name, prefix, code, ImmediateKind::immediate, nullptr,             \
+   string_view{str, sizeof(str) - 1}, GetStackSignature(kSig_##signature)},
+#define WASP_FEATURE_V(prefix, code, Name, str, feature, immediate,           \
+                       signature)                                             \
+  {Opcode::Name, prefix, code, ImmediateKind::immediate,                      \
+   &Features::feature##_enabled, string_view{str, sizeof(str) - 1},           \
+   GetStackSignature(kSig_##signature)},
+#define WASP_PREFIX_V(...) WASP_FEATURE_V(__VA_ARGS__)
+#include "wasp/binary/opcode.def"
+#undef WASP_V
+#undef WASP_FEATURE_V
+#undef WASP_PREFIX_V
+};
+
+constexpr size_t kOpcodeCount = sizeof(kOpcodeInfos) / sizeof(kOpcodeInfos[0]);
+
+// Opcode enumerators are numbered sequentially in .def order, so the enum
+// value is the index into kOpcodeInfos. Checks [begin, end) by halves, so the
+// recursion depth stays well under the compiler's constexpr limit.
+constexpr bool IsInOpcodeOrder(size_t begin, size_t end) {
+  return end - begin == 1
+             ? kOpcodeInfos[begin].opcode == static_cast<Opcode>(begin)
+             : IsInOpcodeOrder(begin, begin + (end - begin) / 2) &&
+                   IsInOpcodeOrder(begin + (end - begin) / 2, end);
+}
+
+static_assert(IsInOpcodeOrder(0, kOpcodeCount),
+              "kOpcodeInfos must be in Opcode order");
+
+constexpr u16 kNoOpcode = 0xffff;
+constexpr u8 kFirstPrefix = encoding::Opcode::MiscPrefix;
+constexpr u8 kLastPrefix = encoding::Opcode::ThreadsPrefix;
+
+static_assert(kOpcodeCount < kNoOpcode, "Opcode index must fit in a u16");
+
+// Maps encoded opcodes to indexes into kOpcodeInfos. Built once, on first
+// use, by walking kOpcodeInfos.
+struct DecodeTables {
+  DecodeTables();
+
+  u16 single[256];
+  std::vector<u16> prefixed[kLastPrefix - kFirstPrefix + 1];
+};
+
+DecodeTables::DecodeTables() {
+  std::fill(std::begin(single), std::end(single), kNoOpcode);
+  for (size_t index = 0; index < kOpcodeCount; ++index) {
+    const auto& info = kOpcodeInfos[index];
+    if (info.prefix == 0) {
+      single[info.code] = static_cast<u16>(index);
+    } else {
+      auto& table = prefixed[info.prefix - kFirstPrefix];
+      if (info.code >= table.size()) {
+        table.resize(info.code + 1, kNoOpcode);
+      }
+      table[info.code] = static_cast<u16>(index);
+    }
+  }
+}
+
+const DecodeTables& GetDecodeTables() {
+  static const DecodeTables tables;
+  return tables;
+}
+
+const OpcodeInfo* GetEnabledInfo(u16 index, const Features& features) {
+  if (index == kNoOpcode) {
+    return nullptr;
+  }
+  const OpcodeInfo* info = &kOpcodeInfos[index];
+  if (info->feature && !(features.*info->feature)()) {
+    return nullptr;
+  }
+  return info;
+}
+
+}  // namespace
+
+const OpcodeInfo* GetOpcodeInfo(Opcode opcode) {
+  auto index = static_cast<size_t>(opcode);
+  if (index >= kOpcodeCount) {
+    return nullptr;
+  }
+  return &kOpcodeInfos[index];
+}
+
+const OpcodeInfo* DecodeOpcode(u8 code, const Features& features) {
+  return GetEnabledInfo(GetDecodeTables().single[code], features);
+}
+
+const OpcodeInfo* DecodeOpcode(u8 prefix, u32 code, const Features& features) {
+  if (prefix < kFirstPrefix || prefix > kLastPrefix) {
+    return nullptr;
+  }
+  const auto& table = GetDecodeTables().prefixed[prefix - kFirstPrefix];
+  if (code >= table.size()) {
+    return nullptr;
+  }
+  return GetEnabledInfo(table[code], features);
+}
+
+}  // namespace binary
+}  // namespace wasp
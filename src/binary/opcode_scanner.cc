@@ -0,0 +1,182 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/opcode_scanner.h"
+
+#include "wasp/base/features.h"
+#include "wasp/base/macros.h"
+#include "wasp/binary/encoding/opcode_encoding.h"
+#include "wasp/binary/errors.h"
+#include "wasp/binary/read/read_instruction.h"
+#include "wasp/binary/read/read_var_int.h"
+#include "wasp/binary/var_int.h"
+
+namespace wasp {
+namespace binary {
+
+OpcodeSet::OpcodeSet(std::initializer_list<Opcode> opcodes) {
+  for (auto opcode : opcodes) {
+    Add(opcode);
+  }
+}
+
+void OpcodeSet::Add(Opcode opcode) {
+  auto index = static_cast<size_t>(opcode);
+  if (index >= opcodes_.size()) {
+    opcodes_.resize(index + 1);
+  }
+  opcodes_[index] = true;
+}
+
+bool OpcodeSet::Contains(Opcode opcode) const {
+  auto index = static_cast<size_t>(opcode);
+  return index < opcodes_.size() && opcodes_[index];
+}
+
+OpcodeScanner::OpcodeScanner(SpanU8 data,
+                             const OpcodeSet& opcodes,
+                             const Features& features,
+                             Errors& errors)
+    : begin_{data.data()},
+      data_{data},
+      opcodes_{opcodes},
+      features_{features},
+      errors_{errors} {}
+
+optional<ScannedInstruction> OpcodeScanner::Next() {
+  while (!data_.empty()) {
+    const u8* instruction = data_.data();
+    SpanU8 rest = data_.subspan(1);
+    const u8 byte = data_[0];
+
+    const OpcodeInfo* info;
+    if (encoding::Opcode::IsPrefixByte(byte, features_)) {
+      auto code = ReadVarInt<u32>(&rest, features_, nop_errors_, "opcode");
+      if (!code) {
+        return Fail(instruction);
+      }
+      info = DecodeOpcode(byte, *code, features_);
+    } else {
+      info = DecodeOpcode(byte, features_);
+    }
+    if (!info) {
+      return Fail(instruction);
+    }
+
+    if (opcodes_.Contains(info->opcode)) {
+      auto instr = Read<Instruction>(&data_, features_, errors_);
+      if (!instr) {
+        data_ = {};
+        return nullopt;
+      }
+      return ScannedInstruction{static_cast<u32>(instruction - begin_),
+                                std::move(*instr)};
+    }
+
+    const u8* next = SkipImmediate(info->immediate, rest.data());
+    if (!next) {
+      return Fail(instruction);
+    }
+    data_ = SpanU8{next, data_.data() + data_.size()};
+  }
+  return nullopt;
+}
+
+const u8* OpcodeScanner::SkipImmediate(ImmediateKind kind, const u8* pos) {
+  switch (kind) {
+    case ImmediateKind::Empty:
+      return pos;
+
+    case ImmediateKind::BlockType:
+    case ImmediateKind::Reserved:
+    case ImmediateKind::U8:
+      return SkipBytes(pos, 1);
+
+    case ImmediateKind::Index:
+    case ImmediateKind::S32:
+      return SkipVarInt<u32>(pos);
+
+    case ImmediateKind::S64:
+      return SkipVarInt<u64>(pos);
+
+    case ImmediateKind::BrOnExn:
+    case ImmediateKind::MemArg:
+      pos = SkipVarInt<u32>(pos);
+      return pos ? SkipVarInt<u32>(pos) : nullptr;
+
+    case ImmediateKind::CallIndirect:
+    case ImmediateKind::Init:
+      pos = SkipVarInt<u32>(pos);
+      return pos ? SkipBytes(pos, 1) : nullptr;
+
+    case ImmediateKind::Copy:
+      return SkipBytes(pos, 2);
+
+    case ImmediateKind::F32:
+      return SkipBytes(pos, 4);
+
+    case ImmediateKind::F64:
+      return SkipBytes(pos, 8);
+
+    case ImmediateKind::V128:
+    case ImmediateKind::Shuffle:
+      return SkipBytes(pos, 16);
+
+    case ImmediateKind::BrTable: {
+      // The target count is the only value that must be decoded; the targets
+      // and the default target are skipped.
+      SpanU8 rest{pos, data_.data() + data_.size()};
+      auto count = ReadVarInt<u32>(&rest, features_, nop_errors_, "count");
+      if (!count) {
+        return nullptr;
+      }
+      pos = rest.data();
+      for (u32 i = 0; i <= *count && pos; ++i) {
+        pos = SkipVarInt<u32>(pos);
+      }
+      return pos;
+    }
+  }
+  WASP_UNREACHABLE();
+}
+
+template <typename T>
+const u8* OpcodeScanner::SkipVarInt(const u8* pos) {
+  const u8* end = data_.data() + data_.size();
+  for (int i = 0; i < VarInt<T>::kMaxBytes && pos < end; ++i) {
+    if ((*pos++ & VarInt<T>::kExtendBit) == 0) {
+      return pos;
+    }
+  }
+  return nullptr;
+}
+
+const u8* OpcodeScanner::SkipBytes(const u8* pos, SpanU8::index_type count) {
+  const u8* end = data_.data() + data_.size();
+  return end - pos >= count ? pos + count : nullptr;
+}
+
+optional<ScannedInstruction> OpcodeScanner::Fail(const u8* instruction) {
+  // Decode the instruction properly so the error is reported the same way
+  // Read<Instruction> reports it.
+  SpanU8 rest{instruction, data_.data() + data_.size()};
+  Read<Instruction>(&rest, features_, errors_);
+  data_ = {};
+  return nullopt;
+}
+
+}  // namespace binary
+}  // namespace wasp
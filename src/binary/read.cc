@@ -16,6 +16,9 @@
 
 #include "wasp/binary/read/read.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "wasp/base/optional.h"
 #include "wasp/base/span.h"
 #include "wasp/binary/read/read.h"
@@ -41,6 +44,7 @@
 #include "wasp/binary/errors.h"
 #include "wasp/binary/errors_context_guard.h"
 #include "wasp/binary/formatters.h"
+#include "wasp/binary/opcode_info.h"
 #include "wasp/binary/read/macros.h"
 #include "wasp/binary/read/read.h"
 #include "wasp/binary/read/read_block_type.h"
@@ -108,6 +112,7 @@
 #include "wasp/binary/read/read_v128.h"
 #include "wasp/binary/read/read_value_type.h"
 #include "wasp/binary/read/read_var_int.h"
+#include "wasp/binary/read/read_var_u32s.h"
 #include "wasp/binary/read/read_vector.h"
 #include "wasp/binary/value_type.h"
 
@@ -122,7 +127,7 @@ optional<BlockType> Read(SpanU8* data,
   WASP_TRY_READ(val, Read<u8>(data, features, errors));
   auto decoded = encoding::BlockType::Decode(val, features);
   if (!decoded) {
-    errors.OnError(*data, format("Unknown block type: {}", val));
+    errors.OnError(*data, "Unknown block type: {}", val);
     return nullopt;
   }
   return decoded;
@@ -144,10 +149,26 @@ optional<BrTableImmediate> Read(SpanU8* data,
                                 Errors& errors,
                                 Tag<BrTableImmediate>) {
   ErrorsContextGuard guard{errors, *data, "br_table"};
-  WASP_TRY_READ(targets, ReadVector<Index>(data, features, errors, "targets"));
+  // Check the targets here, but only keep a view of their encoded bytes; they
+  // are decoded again when iterated.
+  optional<BrTableTargets> targets;
+  {
+    ErrorsContextGuard guard{errors, *data, "targets"};
+    WASP_TRY_READ(count, ReadCount(data, features, errors));
+    const u8* begin = data->begin();
+    u32 scratch[64];
+    for (Index i = 0; i < count;) {
+      Index n = std::min<Index>(count - i, 64);
+      if (!ReadVarU32s(data, scratch, n, features, errors)) {
+        return nullopt;
+      }
+      i += n;
+    }
+    targets = BrTableTargets{count, SpanU8{begin, data->begin()}};
+  }
   WASP_TRY_READ(default_target,
                 ReadIndex(data, features, errors, "default target"));
-  return BrTableImmediate{std::move(targets), default_target};
+  return BrTableImmediate{std::move(*targets), default_target};
 }
 
 optional<SpanU8> ReadBytes(SpanU8* data,
@@ -155,7 +176,7 @@ optional<SpanU8> ReadBytes(SpanU8* data,
                            const Features& features,
                            Errors& errors) {
   if (data->size() < N) {
-    errors.OnError(*data, format("Unable to read {} bytes", N));
+    errors.OnError(*data, "Unable to read {} bytes", N);
     return nullopt;
   }
 
@@ -173,8 +194,7 @@ optional<SpanU8> ReadBytesExpected(SpanU8* data,
 
   auto actual = ReadBytes(data, expected.size(), features, errors);
   if (actual && actual != expected) {
-    errors.OnError(*data,
-                   format("Mismatch: expected {}, got {}", expected, *actual));
+    errors.OnError(*data, "Mismatch: expected {}, got {}", expected, *actual);
   }
   return actual;
 }
@@ -199,8 +219,8 @@ optional<Index> ReadCheckLength(SpanU8* data,
   // There should be at least one byte per count, so if the data is smaller
   // than that, the module must be malformed.
   if (count > data->size()) {
-    errors.OnError(*data, format("{} extends past end: {} > {}", error_name,
-                                 count, data->size()));
+    errors.OnError(*data, "{} extends past end: {} > {}", error_name, count,
+                   data->size());
     return nullopt;
   }
 
@@ -267,9 +287,8 @@ optional<ConstantExpression> Read(SpanU8* data,
       break;
 
     default:
-      errors.OnError(
-          *data,
-          format("Illegal instruction in constant expression: {}", instr));
+      errors.OnError(*data, "Illegal instruction in constant expression: {}",
+                     instr);
       return nullopt;
   }
 
@@ -361,9 +380,8 @@ optional<ElementExpression> Read(SpanU8* data,
       break;
 
     default:
-      errors.OnError(
-          *data,
-          format("Illegal instruction in element expression: {}", instr));
+      errors.OnError(*data, "Illegal instruction in element expression: {}",
+                     instr);
       return nullopt;
   }
 
@@ -397,8 +415,15 @@ optional<ElementSegment> Read(SpanU8* data,
   if (decoded.segment_type == SegmentType::Active) {
     WASP_TRY_READ_CONTEXT(
         offset, Read<ConstantExpression>(data, features, errors), "offset");
-    WASP_TRY_READ(init,
-                  ReadVector<Index>(data, features, errors, "initializers"));
+    std::vector<Index> init;
+    {
+      ErrorsContextGuard guard{errors, *data, "initializers"};
+      WASP_TRY_READ(count, ReadCount(data, features, errors));
+      init.resize(count);
+      if (!ReadVarU32s(data, init.data(), count, features, errors)) {
+        return nullopt;
+      }
+    }
     return ElementSegment{table_index, offset, init};
   } else {
     WASP_TRY_READ(element_type, Read<ElementType>(data, features, errors));
@@ -573,507 +598,137 @@ optional<InitImmediate> Read(SpanU8* data,
   return InitImmediate{segment_index, reserved};
 }
 
+namespace {
+
+// Reads an opcode, with the same errors as Read<Opcode>, and returns its
+// entry in the opcode table.
+const OpcodeInfo* ReadOpcodeInfo(SpanU8* data,
+                                 const Features& features,
+                                 Errors& errors) {
+  ErrorsContextGuard guard{errors, *data, "opcode"};
+  auto val = Read<u8>(data, features, errors);
+  if (!val) {
+    return nullptr;
+  }
+
+  if (encoding::Opcode::IsPrefixByte(*val, features)) {
+    auto code = Read<u32>(data, features, errors);
+    if (!code) {
+      return nullptr;
+    }
+    auto info = DecodeOpcode(*val, *code, features);
+    if (!info) {
+      errors.OnError(*data, "Unknown opcode: {} {}", *val, *code);
+    }
+    return info;
+  } else {
+    auto info = DecodeOpcode(*val, features);
+    if (!info) {
+      errors.OnError(*data, "Unknown opcode: {}", *val);
+    }
+    return info;
+  }
+}
+
+}  // namespace
+
 optional<Instruction> Read(SpanU8* data,
                            const Features& features,
                            Errors& errors,
                            Tag<Instruction>) {
-  WASP_TRY_READ(opcode, Read<Opcode>(data, features, errors));
-  switch (opcode) {
-    // No immediates:
-    case Opcode::Unreachable:
-    case Opcode::Nop:
-    case Opcode::Else:
-    case Opcode::Catch:
-    case Opcode::Rethrow:
-    case Opcode::End:
-    case Opcode::Return:
-    case Opcode::Drop:
-    case Opcode::Select:
-    case Opcode::I32Eqz:
-    case Opcode::I32Eq:
-    case Opcode::I32Ne:
-    case Opcode::I32LtS:
-    case Opcode::I32LeS:
-    case Opcode::I32LtU:
-    case Opcode::I32LeU:
-    case Opcode::I32GtS:
-    case Opcode::I32GeS:
-    case Opcode::I32GtU:
-    case Opcode::I32GeU:
-    case Opcode::I64Eqz:
-    case Opcode::I64Eq:
-    case Opcode::I64Ne:
-    case Opcode::I64LtS:
-    case Opcode::I64LeS:
-    case Opcode::I64LtU:
-    case Opcode::I64LeU:
-    case Opcode::I64GtS:
-    case Opcode::I64GeS:
-    case Opcode::I64GtU:
-    case Opcode::I64GeU:
-    case Opcode::F32Eq:
-    case Opcode::F32Ne:
-    case Opcode::F32Lt:
-    case Opcode::F32Le:
-    case Opcode::F32Gt:
-    case Opcode::F32Ge:
-    case Opcode::F64Eq:
-    case Opcode::F64Ne:
-    case Opcode::F64Lt:
-    case Opcode::F64Le:
-    case Opcode::F64Gt:
-    case Opcode::F64Ge:
-    case Opcode::I32Clz:
-    case Opcode::I32Ctz:
-    case Opcode::I32Popcnt:
-    case Opcode::I32Add:
-    case Opcode::I32Sub:
-    case Opcode::I32Mul:
-    case Opcode::I32DivS:
-    case Opcode::I32DivU:
-    case Opcode::I32RemS:
-    case Opcode::I32RemU:
-    case Opcode::I32And:
-    case Opcode::I32Or:
-    case Opcode::I32Xor:
-    case Opcode::I32Shl:
-    case Opcode::I32ShrS:
-    case Opcode::I32ShrU:
-    case Opcode::I32Rotl:
-    case Opcode::I32Rotr:
-    case Opcode::I64Clz:
-    case Opcode::I64Ctz:
-    case Opcode::I64Popcnt:
-    case Opcode::I64Add:
-    case Opcode::I64Sub:
-    case Opcode::I64Mul:
-    case Opcode::I64DivS:
-    case Opcode::I64DivU:
-    case Opcode::I64RemS:
-    case Opcode::I64RemU:
-    case Opcode::I64And:
-    case Opcode::I64Or:
-    case Opcode::I64Xor:
-    case Opcode::I64Shl:
-    case Opcode::I64ShrS:
-    case Opcode::I64ShrU:
-    case Opcode::I64Rotl:
-    case Opcode::I64Rotr:
-    case Opcode::F32Abs:
-    case Opcode::F32Neg:
-    case Opcode::F32Ceil:
-    case Opcode::F32Floor:
-    case Opcode::F32Trunc:
-    case Opcode::F32Nearest:
-    case Opcode::F32Sqrt:
-    case Opcode::F32Add:
-    case Opcode::F32Sub:
-    case Opcode::F32Mul:
-    case Opcode::F32Div:
-    case Opcode::F32Min:
-    case Opcode::F32Max:
-    case Opcode::F32Copysign:
-    case Opcode::F64Abs:
-    case Opcode::F64Neg:
-    case Opcode::F64Ceil:
-    case Opcode::F64Floor:
-    case Opcode::F64Trunc:
-    case Opcode::F64Nearest:
-    case Opcode::F64Sqrt:
-    case Opcode::F64Add:
-    case Opcode::F64Sub:
-    case Opcode::F64Mul:
-    case Opcode::F64Div:
-    case Opcode::F64Min:
-    case Opcode::F64Max:
-    case Opcode::F64Copysign:
-    case Opcode::I32WrapI64:
-    case Opcode::I32TruncF32S:
-    case Opcode::I32TruncF32U:
-    case Opcode::I32TruncF64S:
-    case Opcode::I32TruncF64U:
-    case Opcode::I64ExtendI32S:
-    case Opcode::I64ExtendI32U:
-    case Opcode::I64TruncF32S:
-    case Opcode::I64TruncF32U:
-    case Opcode::I64TruncF64S:
-    case Opcode::I64TruncF64U:
-    case Opcode::F32ConvertI32S:
-    case Opcode::F32ConvertI32U:
-    case Opcode::F32ConvertI64S:
-    case Opcode::F32ConvertI64U:
-    case Opcode::F32DemoteF64:
-    case Opcode::F64ConvertI32S:
-    case Opcode::F64ConvertI32U:
-    case Opcode::F64ConvertI64S:
-    case Opcode::F64ConvertI64U:
-    case Opcode::F64PromoteF32:
-    case Opcode::I32ReinterpretF32:
-    case Opcode::I64ReinterpretF64:
-    case Opcode::F32ReinterpretI32:
-    case Opcode::F64ReinterpretI64:
-    case Opcode::I32Extend8S:
-    case Opcode::I32Extend16S:
-    case Opcode::I64Extend8S:
-    case Opcode::I64Extend16S:
-    case Opcode::I64Extend32S:
-    case Opcode::RefNull:
-    case Opcode::RefIsNull:
-    case Opcode::I32TruncSatF32S:
-    case Opcode::I32TruncSatF32U:
-    case Opcode::I32TruncSatF64S:
-    case Opcode::I32TruncSatF64U:
-    case Opcode::I64TruncSatF32S:
-    case Opcode::I64TruncSatF32U:
-    case Opcode::I64TruncSatF64S:
-    case Opcode::I64TruncSatF64U:
-    case Opcode::I8X16Add:
-    case Opcode::I16X8Add:
-    case Opcode::I32X4Add:
-    case Opcode::I64X2Add:
-    case Opcode::I8X16Sub:
-    case Opcode::I16X8Sub:
-    case Opcode::I32X4Sub:
-    case Opcode::I64X2Sub:
-    case Opcode::I8X16Mul:
-    case Opcode::I16X8Mul:
-    case Opcode::I32X4Mul:
-    case Opcode::I8X16AddSaturateS:
-    case Opcode::I8X16AddSaturateU:
-    case Opcode::I16X8AddSaturateS:
-    case Opcode::I16X8AddSaturateU:
-    case Opcode::I8X16SubSaturateS:
-    case Opcode::I8X16SubSaturateU:
-    case Opcode::I16X8SubSaturateS:
-    case Opcode::I16X8SubSaturateU:
-    case Opcode::I8X16Shl:
-    case Opcode::I16X8Shl:
-    case Opcode::I32X4Shl:
-    case Opcode::I64X2Shl:
-    case Opcode::I8X16ShrS:
-    case Opcode::I8X16ShrU:
-    case Opcode::I16X8ShrS:
-    case Opcode::I16X8ShrU:
-    case Opcode::I32X4ShrS:
-    case Opcode::I32X4ShrU:
-    case Opcode::I64X2ShrS:
-    case Opcode::I64X2ShrU:
-    case Opcode::V128And:
-    case Opcode::V128Or:
-    case Opcode::V128Xor:
-    case Opcode::F32X4Min:
-    case Opcode::F64X2Min:
-    case Opcode::F32X4Max:
-    case Opcode::F64X2Max:
-    case Opcode::F32X4Add:
-    case Opcode::F64X2Add:
-    case Opcode::F32X4Sub:
-    case Opcode::F64X2Sub:
-    case Opcode::F32X4Div:
-    case Opcode::F64X2Div:
-    case Opcode::F32X4Mul:
-    case Opcode::F64X2Mul:
-    case Opcode::I8X16Eq:
-    case Opcode::I16X8Eq:
-    case Opcode::I32X4Eq:
-    case Opcode::F32X4Eq:
-    case Opcode::F64X2Eq:
-    case Opcode::I8X16Ne:
-    case Opcode::I16X8Ne:
-    case Opcode::I32X4Ne:
-    case Opcode::F32X4Ne:
-    case Opcode::F64X2Ne:
-    case Opcode::I8X16LtS:
-    case Opcode::I8X16LtU:
-    case Opcode::I16X8LtS:
-    case Opcode::I16X8LtU:
-    case Opcode::I32X4LtS:
-    case Opcode::I32X4LtU:
-    case Opcode::F32X4Lt:
-    case Opcode::F64X2Lt:
-    case Opcode::I8X16LeS:
-    case Opcode::I8X16LeU:
-    case Opcode::I16X8LeS:
-    case Opcode::I16X8LeU:
-    case Opcode::I32X4LeS:
-    case Opcode::I32X4LeU:
-    case Opcode::F32X4Le:
-    case Opcode::F64X2Le:
-    case Opcode::I8X16GtS:
-    case Opcode::I8X16GtU:
-    case Opcode::I16X8GtS:
-    case Opcode::I16X8GtU:
-    case Opcode::I32X4GtS:
-    case Opcode::I32X4GtU:
-    case Opcode::F32X4Gt:
-    case Opcode::F64X2Gt:
-    case Opcode::I8X16GeS:
-    case Opcode::I8X16GeU:
-    case Opcode::I16X8GeS:
-    case Opcode::I16X8GeU:
-    case Opcode::I32X4GeS:
-    case Opcode::I32X4GeU:
-    case Opcode::F32X4Ge:
-    case Opcode::F64X2Ge:
-    case Opcode::I8X16Splat:
-    case Opcode::I16X8Splat:
-    case Opcode::I32X4Splat:
-    case Opcode::I64X2Splat:
-    case Opcode::F32X4Splat:
-    case Opcode::F64X2Splat:
-    case Opcode::I8X16Neg:
-    case Opcode::I16X8Neg:
-    case Opcode::I32X4Neg:
-    case Opcode::I64X2Neg:
-    case Opcode::V128Not:
-    case Opcode::I8X16AnyTrue:
-    case Opcode::I16X8AnyTrue:
-    case Opcode::I32X4AnyTrue:
-    case Opcode::I64X2AnyTrue:
-    case Opcode::I8X16AllTrue:
-    case Opcode::I16X8AllTrue:
-    case Opcode::I32X4AllTrue:
-    case Opcode::I64X2AllTrue:
-    case Opcode::F32X4Neg:
-    case Opcode::F64X2Neg:
-    case Opcode::F32X4Abs:
-    case Opcode::F64X2Abs:
-    case Opcode::F32X4Sqrt:
-    case Opcode::F64X2Sqrt:
-    case Opcode::V128BitSelect:
-    case Opcode::F32X4ConvertI32X4S:
-    case Opcode::F32X4ConvertI32X4U:
-    case Opcode::F64X2ConvertI64X2S:
-    case Opcode::F64X2ConvertI64X2U:
-    case Opcode::I32X4TruncSatF32X4S:
-    case Opcode::I32X4TruncSatF32X4U:
-    case Opcode::I64X2TruncSatF64X2S:
-    case Opcode::I64X2TruncSatF64X2U:
-      return Instruction{Opcode{opcode}};
-
-    // Type immediate.
-    case Opcode::Block:
-    case Opcode::Loop:
-    case Opcode::If:
-    case Opcode::Try: {
+  auto info = ReadOpcodeInfo(data, features, errors);
+  if (!info) {
+    return nullopt;
+  }
+  Opcode opcode = info->opcode;
+  switch (info->immediate) {
+    case ImmediateKind::Empty:
+      return Instruction{opcode};
+
+    case ImmediateKind::BlockType: {
       WASP_TRY_READ(type, Read<BlockType>(data, features, errors));
-      return Instruction{Opcode{opcode}, type};
+      return Instruction{opcode, type};
     }
 
-    // Index immediate.
-    case Opcode::Throw:
-    case Opcode::Br:
-    case Opcode::BrIf:
-    case Opcode::Call:
-    case Opcode::ReturnCall:
-    case Opcode::LocalGet:
-    case Opcode::LocalSet:
-    case Opcode::LocalTee:
-    case Opcode::GlobalGet:
-    case Opcode::GlobalSet:
-    case Opcode::TableGet:
-    case Opcode::TableSet:
-    case Opcode::RefFunc:
-    case Opcode::DataDrop:
-    case Opcode::ElemDrop:
-    case Opcode::TableGrow:
-    case Opcode::TableSize: {
+    case ImmediateKind::Index: {
       WASP_TRY_READ(index, ReadIndex(data, features, errors, "index"));
-      return Instruction{Opcode{opcode}, index};
+      return Instruction{opcode, index};
     }
 
-    // Index, Index immediates.
-    case Opcode::BrOnExn: {
+    case ImmediateKind::BrOnExn: {
       WASP_TRY_READ(immediate, Read<BrOnExnImmediate>(data, features, errors));
-      return Instruction{Opcode{opcode}, immediate};
+      return Instruction{opcode, immediate};
     }
 
-    // Index* immediates.
-    case Opcode::BrTable: {
+    case ImmediateKind::BrTable: {
       WASP_TRY_READ(immediate, Read<BrTableImmediate>(data, features, errors));
-      return Instruction{Opcode{opcode}, std::move(immediate)};
+      return Instruction{opcode, std::move(immediate)};
     }
 
-    // Index, reserved immediates.
-    case Opcode::CallIndirect:
-    case Opcode::ReturnCallIndirect: {
+    case ImmediateKind::CallIndirect: {
       WASP_TRY_READ(immediate,
                     Read<CallIndirectImmediate>(data, features, errors));
-      return Instruction{Opcode{opcode}, immediate};
+      return Instruction{opcode, immediate};
     }
 
-    // Memarg (alignment, offset) immediates.
-    case Opcode::I32Load:
-    case Opcode::I64Load:
-    case Opcode::F32Load:
-    case Opcode::F64Load:
-    case Opcode::I32Load8S:
-    case Opcode::I32Load8U:
-    case Opcode::I32Load16S:
-    case Opcode::I32Load16U:
-    case Opcode::I64Load8S:
-    case Opcode::I64Load8U:
-    case Opcode::I64Load16S:
-    case Opcode::I64Load16U:
-    case Opcode::I64Load32S:
-    case Opcode::I64Load32U:
-    case Opcode::V128Load:
-    case Opcode::I32Store:
-    case Opcode::I64Store:
-    case Opcode::F32Store:
-    case Opcode::F64Store:
-    case Opcode::I32Store8:
-    case Opcode::I32Store16:
-    case Opcode::I64Store8:
-    case Opcode::I64Store16:
-    case Opcode::I64Store32:
-    case Opcode::V128Store:
-    case Opcode::AtomicNotify:
-    case Opcode::I32AtomicWait:
-    case Opcode::I64AtomicWait:
-    case Opcode::I32AtomicLoad:
-    case Opcode::I64AtomicLoad:
-    case Opcode::I32AtomicLoad8U:
-    case Opcode::I32AtomicLoad16U:
-    case Opcode::I64AtomicLoad8U:
-    case Opcode::I64AtomicLoad16U:
-    case Opcode::I64AtomicLoad32U:
-    case Opcode::I32AtomicStore:
-    case Opcode::I64AtomicStore:
-    case Opcode::I32AtomicStore8:
-    case Opcode::I32AtomicStore16:
-    case Opcode::I64AtomicStore8:
-    case Opcode::I64AtomicStore16:
-    case Opcode::I64AtomicStore32:
-    case Opcode::I32AtomicRmwAdd:
-    case Opcode::I64AtomicRmwAdd:
-    case Opcode::I32AtomicRmw8AddU:
-    case Opcode::I32AtomicRmw16AddU:
-    case Opcode::I64AtomicRmw8AddU:
-    case Opcode::I64AtomicRmw16AddU:
-    case Opcode::I64AtomicRmw32AddU:
-    case Opcode::I32AtomicRmwSub:
-    case Opcode::I64AtomicRmwSub:
-    case Opcode::I32AtomicRmw8SubU:
-    case Opcode::I32AtomicRmw16SubU:
-    case Opcode::I64AtomicRmw8SubU:
-    case Opcode::I64AtomicRmw16SubU:
-    case Opcode::I64AtomicRmw32SubU:
-    case Opcode::I32AtomicRmwAnd:
-    case Opcode::I64AtomicRmwAnd:
-    case Opcode::I32AtomicRmw8AndU:
-    case Opcode::I32AtomicRmw16AndU:
-    case Opcode::I64AtomicRmw8AndU:
-    case Opcode::I64AtomicRmw16AndU:
-    case Opcode::I64AtomicRmw32AndU:
-    case Opcode::I32AtomicRmwOr:
-    case Opcode::I64AtomicRmwOr:
-    case Opcode::I32AtomicRmw8OrU:
-    case Opcode::I32AtomicRmw16OrU:
-    case Opcode::I64AtomicRmw8OrU:
-    case Opcode::I64AtomicRmw16OrU:
-    case Opcode::I64AtomicRmw32OrU:
-    case Opcode::I32AtomicRmwXor:
-    case Opcode::I64AtomicRmwXor:
-    case Opcode::I32AtomicRmw8XorU:
-    case Opcode::I32AtomicRmw16XorU:
-    case Opcode::I64AtomicRmw8XorU:
-    case Opcode::I64AtomicRmw16XorU:
-    case Opcode::I64AtomicRmw32XorU:
-    case Opcode::I32AtomicRmwXchg:
-    case Opcode::I64AtomicRmwXchg:
-    case Opcode::I32AtomicRmw8XchgU:
-    case Opcode::I32AtomicRmw16XchgU:
-    case Opcode::I64AtomicRmw8XchgU:
-    case Opcode::I64AtomicRmw16XchgU:
-    case Opcode::I64AtomicRmw32XchgU:
-    case Opcode::I32AtomicRmwCmpxchg:
-    case Opcode::I64AtomicRmwCmpxchg:
-    case Opcode::I32AtomicRmw8CmpxchgU:
-    case Opcode::I32AtomicRmw16CmpxchgU:
-    case Opcode::I64AtomicRmw8CmpxchgU:
-    case Opcode::I64AtomicRmw16CmpxchgU:
-    case Opcode::I64AtomicRmw32CmpxchgU: {
+    case ImmediateKind::MemArg: {
       WASP_TRY_READ(memarg, Read<MemArgImmediate>(data, features, errors));
-      return Instruction{Opcode{opcode}, memarg};
+      return Instruction{opcode, memarg};
     }
 
-    // Reserved immediates.
-    case Opcode::MemorySize:
-    case Opcode::MemoryGrow:
-    case Opcode::MemoryFill: {
+    case ImmediateKind::Reserved: {
       WASP_TRY_READ(reserved, ReadReserved(data, features, errors));
-      return Instruction{Opcode{opcode}, reserved};
+      return Instruction{opcode, reserved};
     }
 
-    // Const immediates.
-    case Opcode::I32Const: {
+    case ImmediateKind::S32: {
       WASP_TRY_READ_CONTEXT(value, Read<s32>(data, features, errors),
                             "i32 constant");
-      return Instruction{Opcode{opcode}, value};
+      return Instruction{opcode, value};
     }
 
-    case Opcode::I64Const: {
+    case ImmediateKind::S64: {
       WASP_TRY_READ_CONTEXT(value, Read<s64>(data, features, errors),
                             "i64 constant");
-      return Instruction{Opcode{opcode}, value};
+      return Instruction{opcode, value};
     }
 
-    case Opcode::F32Const: {
+    case ImmediateKind::F32: {
       WASP_TRY_READ_CONTEXT(value, Read<f32>(data, features, errors),
                             "f32 constant");
-      return Instruction{Opcode{opcode}, value};
+      return Instruction{opcode, value};
     }
 
-    case Opcode::F64Const: {
+    case ImmediateKind::F64: {
       WASP_TRY_READ_CONTEXT(value, Read<f64>(data, features, errors),
                             "f64 constant");
-      return Instruction{Opcode{opcode}, value};
+      return Instruction{opcode, value};
     }
 
-    case Opcode::V128Const: {
+    case ImmediateKind::V128: {
       WASP_TRY_READ_CONTEXT(value, Read<v128>(data, features, errors),
                             "v128 constant");
-      return Instruction{Opcode{opcode}, value};
+      return Instruction{opcode, value};
     }
 
-    // Reserved, Index immediates.
-    case Opcode::MemoryInit:
-    case Opcode::TableInit: {
+    case ImmediateKind::Init: {
       WASP_TRY_READ(immediate, Read<InitImmediate>(data, features, errors));
-      return Instruction{Opcode{opcode}, immediate};
+      return Instruction{opcode, immediate};
     }
 
-    // Reserved, reserved immediates.
-    case Opcode::MemoryCopy:
-    case Opcode::TableCopy: {
+    case ImmediateKind::Copy: {
       WASP_TRY_READ(immediate, Read<CopyImmediate>(data, features, errors));
-      return Instruction{Opcode{opcode}, immediate};
+      return Instruction{opcode, immediate};
     }
 
-    // Shuffle immediate.
-    case Opcode::V8X16Shuffle: {
+    case ImmediateKind::Shuffle: {
       WASP_TRY_READ(immediate, Read<ShuffleImmediate>(data, features, errors));
-      return Instruction{Opcode{opcode}, immediate};
+      return Instruction{opcode, immediate};
     }
 
-    // u8 immediate.
-    case Opcode::I8X16ExtractLaneS:
-    case Opcode::I8X16ExtractLaneU:
-    case Opcode::I16X8ExtractLaneS:
-    case Opcode::I16X8ExtractLaneU:
-    case Opcode::I32X4ExtractLane:
-    case Opcode::I64X2ExtractLane:
-    case Opcode::F32X4ExtractLane:
-    case Opcode::F64X2ExtractLane:
-    case Opcode::I8X16ReplaceLane:
-    case Opcode::I16X8ReplaceLane:
-    case Opcode::I32X4ReplaceLane:
-    case Opcode::I64X2ReplaceLane:
-    case Opcode::F32X4ReplaceLane:
-    case Opcode::F64X2ReplaceLane: {
+    case ImmediateKind::U8: {
       WASP_TRY_READ(lane, Read<u8>(data, features, errors));
-      return Instruction{Opcode{opcode}, u8{lane}};
+      return Instruction{opcode, u8{lane}};
     }
   }
   WASP_UNREACHABLE();
@@ -1093,7 +748,7 @@ optional<Limits> Read(SpanU8* data,
   WASP_TRY_READ_CONTEXT(flags, Read<u8>(data, features, errors), "flags");
   auto decoded = encoding::LimitsFlags::Decode(flags, features);
   if (!decoded) {
-    errors.OnError(*data, format("Invalid flags value: {}", flags));
+    errors.OnError(*data, "Invalid flags value: {}", flags);
     return nullopt;
   }
 
@@ -1211,25 +866,11 @@ optional<Opcode> Read(SpanU8* data,
                       const Features& features,
                       Errors& errors,
                       Tag<Opcode>) {
-  ErrorsContextGuard guard{errors, *data, "opcode"};
-  WASP_TRY_READ(val, Read<u8>(data, features, errors));
-
-  if (encoding::Opcode::IsPrefixByte(val, features)) {
-    WASP_TRY_READ(code, Read<u32>(data, features, errors));
-    auto decoded = encoding::Opcode::Decode(val, code, features);
-    if (!decoded) {
-      errors.OnError(*data, format("Unknown opcode: {} {}", val, code));
-      return nullopt;
-    }
-    return decoded;
-  } else {
-    auto decoded = encoding::Opcode::Decode(val, features);
-    if (!decoded) {
-      errors.OnError(*data, format("Unknown opcode: {}", val));
-      return nullopt;
-    }
-    return decoded;
+  auto info = ReadOpcodeInfo(data, features, errors);
+  if (!info) {
+    return nullopt;
   }
+  return info->opcode;
 }
 
 optional<RelocationEntry> Read(SpanU8* data,
@@ -1271,7 +912,7 @@ optional<u8> ReadReserved(SpanU8* data,
   ErrorsContextGuard guard{errors, *data, "reserved"};
   WASP_TRY_READ(reserved, Read<u8>(data, features, errors));
   if (reserved != 0) {
-    errors.OnError(*data, format("Expected reserved byte 0, got {}", reserved));
+    errors.OnError(*data, "Expected reserved byte 0, got {}", reserved);
     return nullopt;
   }
   return 0;
@@ -1444,7 +1085,7 @@ optional<TypeEntry> Read(SpanU8* data,
   WASP_TRY_READ_CONTEXT(form, Read<u8>(data, features, errors), "form");
 
   if (form != encoding::Type::Function) {
-    errors.OnError(*data, format("Unknown type form: {}", form));
+    errors.OnError(*data, "Unknown type form: {}", form);
     return nullopt;
   }
 
@@ -1493,7 +1134,7 @@ optional<ValueType> Read(SpanU8* data,
   WASP_TRY_READ(val, Read<u8>(data, features, errors));
   auto decoded = encoding::ValueType::Decode(val, features);
   if (!decoded) {
-    errors.OnError(*data, format("Unknown value type: {}", val));
+    errors.OnError(*data, "Unknown value type: {}", val);
     return nullopt;
   }
   return decoded;
@@ -144,8 +144,8 @@ LinkingSection::LinkingSection(SpanU8 data,
       subsections{data, features, errors} {
   constexpr u32 kVersion = 2;
   if (version && version != kVersion) {
-    errors.OnError(data, format("Expected linking section version: {}, got {}",
-                                kVersion, *version));
+    errors.OnError(data, "Expected linking section version: {}, got {}",
+                   kVersion, *version);
   }
 }
 
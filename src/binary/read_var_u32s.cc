@@ -0,0 +1,160 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/read/read_var_u32s.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "wasp/binary/read/read_u32.h"
+
+namespace wasp {
+namespace binary {
+
+namespace {
+
+#if defined(__AVX2__)
+constexpr int kChunkSize = 32;
+#elif defined(__SSE2__)
+constexpr int kChunkSize = 16;
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__)
+int CountTrailingZeros(u32 x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctz(x);
+#else
+  int result = 0;
+  for (; (x & 1) == 0; x >>= 1) {
+    ++result;
+  }
+  return result;
+#endif
+}
+
+// Returns a mask with bit N set if byte N of the chunk at |p| has its
+// continuation bit set.
+u32 ContinuationMask(const u8* p) {
+#if defined(__AVX2__)
+  __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  return static_cast<u32>(_mm256_movemask_epi8(bytes));
+#else
+  __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  return static_cast<u32>(_mm_movemask_epi8(bytes));
+#endif
+}
+
+// Zero-extends a chunk of single-byte values at |p| into |out|.
+void WidenChunk(const u8* p, u32* out) {
+#if defined(__AVX2__)
+  for (int i = 0; i < kChunkSize; i += 8) {
+    __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                        _mm256_cvtepu8_epi32(bytes));
+  }
+#else
+  const __m128i zero = _mm_setzero_si128();
+  __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+  __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+  __m128i* dst = reinterpret_cast<__m128i*>(out);
+  _mm_storeu_si128(dst + 0, _mm_unpacklo_epi16(lo, zero));
+  _mm_storeu_si128(dst + 1, _mm_unpackhi_epi16(lo, zero));
+  _mm_storeu_si128(dst + 2, _mm_unpacklo_epi16(hi, zero));
+  _mm_storeu_si128(dst + 3, _mm_unpackhi_epi16(hi, zero));
+#endif
+}
+#endif
+
+// Decodes one value from [p, end). Returns the number of bytes used, or 0 if
+// the value is truncated or malformed.
+int DecodeOne(const u8* p, const u8* end, u32* out) {
+  u32 result = 0;
+  for (int i = 0; i < 5 && p + i < end; ++i) {
+    const u8 byte = p[i];
+    result |= u32(byte & 0x7f) << (i * 7);
+    if ((byte & 0x80) == 0) {
+      // Only the low 4 bits of the fifth byte may be used.
+      if (i == 4 && (byte & 0xf0) != 0) {
+        return 0;
+      }
+      *out = result;
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+Index DecodeVarU32s(SpanU8* data, u32* out, Index count) {
+  const u8* p = data->data();
+  const u8* const end = p + data->size();
+  Index n = 0;
+  while (n < count) {
+#if defined(__AVX2__) || defined(__SSE2__)
+    if (count - n >= kChunkSize && end - p >= kChunkSize) {
+      u32 mask = ContinuationMask(p);
+      if (mask == 0) {
+        WidenChunk(p, out + n);
+        p += kChunkSize;
+        n += kChunkSize;
+        continue;
+      }
+      // Copy the single-byte values before the first multi-byte one.
+      const int run = CountTrailingZeros(mask);
+      for (int i = 0; i < run; ++i) {
+        out[n + i] = p[i];
+      }
+      p += run;
+      n += run;
+    }
+#endif
+    const int length = DecodeOne(p, end, out + n);
+    if (length == 0) {
+      break;
+    }
+    p += length;
+    ++n;
+  }
+  remove_prefix(data, p - data->data());
+  return n;
+}
+
+bool ReadVarU32s(SpanU8* data,
+                 u32* out,
+                 Index count,
+                 const Features& features,
+                 Errors& errors) {
+  Index n = DecodeVarU32s(data, out, count);
+  while (n < count) {
+    // DecodeVarU32s doesn't report errors, so read the value it stopped at
+    // again to report one.
+    auto value = Read<u32>(data, features, errors);
+    if (!value) {
+      return false;
+    }
+    out[n++] = *value;
+    n += DecodeVarU32s(data, out + n, count - n);
+  }
+  return true;
+}
+
+}  // namespace binary
+}  // namespace wasp
@@ -0,0 +1,79 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/relocation_index.h"
+
+#include <algorithm>
+
+namespace wasp {
+namespace binary {
+
+namespace {
+
+bool OffsetLess(const RelocationEntry& lhs, const RelocationEntry& rhs) {
+  return lhs.offset < rhs.offset;
+}
+
+// Returns the number of leading entries whose offset is less than |offset|.
+RelocationEntrySpan::index_type CountBefore(RelocationEntrySpan entries,
+                                            u32 offset) {
+  auto it = std::lower_bound(
+      entries.begin(), entries.end(), offset,
+      [](const RelocationEntry& entry, u32 offset) {
+        return entry.offset < offset;
+      });
+  return it - entries.begin();
+}
+
+}  // namespace
+
+RelocationIndex::RelocationIndex(RelocationSection& section) {
+  if (section.count) {
+    entries_.reserve(*section.count);
+  }
+  entries_.assign(section.entries.begin(), section.entries.end());
+  // Entries are usually already in order.
+  if (!std::is_sorted(entries_.begin(), entries_.end(), OffsetLess)) {
+    std::stable_sort(entries_.begin(), entries_.end(), OffsetLess);
+  }
+}
+
+RelocationEntrySpan RelocationIndex::Find(u32 begin, u32 end) const {
+  RelocationEntrySpan result = entries();
+  remove_prefix(&result, CountBefore(result, begin));
+  return result.first(CountBefore(result, end));
+}
+
+auto RelocationIndex::GetCursor(u32 offset) const -> Cursor {
+  RelocationEntrySpan result = entries();
+  remove_prefix(&result, CountBefore(result, offset));
+  return Cursor{result};
+}
+
+RelocationEntrySpan RelocationIndex::Cursor::AdvanceTo(u32 offset) {
+  // The cursor usually moves past only a few entries, so scan rather than
+  // binary search.
+  RelocationEntrySpan::index_type count = 0;
+  while (count < entries_.size() && entries_[count].offset < offset) {
+    ++count;
+  }
+  RelocationEntrySpan result = entries_.first(count);
+  remove_prefix(&entries_, count);
+  return result;
+}
+
+}  // namespace binary
+}  // namespace wasp
@@ -0,0 +1,70 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/rewrite_module.h"
+
+#include "wasp/binary/lazy_module.h"
+
+namespace wasp {
+namespace binary {
+
+bool RewriteModule(LazyModule& module,
+                   const SectionRewriter& rewriter,
+                   const RewriteSink& sink) {
+  if (!module.magic || !module.version) {
+    return false;
+  }
+
+  // [run_begin, pos) is the pending run of original bytes to copy. It always
+  // ends at a section boundary, since sections are laid out back to back.
+  const u8* run_begin = module.data.begin();
+  const u8* pos = module.version->end();
+  auto flush_run = [&]() {
+    if (pos != run_begin) {
+      sink(SpanU8{run_begin, pos});
+    }
+  };
+
+  WriteBuffer replacement;
+  for (auto section : module.sections) {
+    const u8* end = section.data().end();
+    replacement.clear();
+    SectionAction action = rewriter(section, replacement);
+    if (action != SectionAction::Keep) {
+      flush_run();
+      if (action == SectionAction::Replace && !replacement.empty()) {
+        sink(replacement.data());
+      }
+      run_begin = end;
+    }
+    pos = end;
+  }
+  flush_run();
+
+  // The section sequence stops early on a malformed section header.
+  return pos == module.data.end();
+}
+
+bool RewriteModule(LazyModule& module,
+                   const SectionRewriter& rewriter,
+                   WriteBuffer& out) {
+  out.reserve(out.size() + module.data.size());
+  return RewriteModule(module, rewriter,
+                       [&](SpanU8 data) { out.Append(data); });
+}
+
+}  // namespace binary
+}  // namespace wasp
@@ -0,0 +1,75 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/section_index.h"
+
+#include "wasp/binary/lazy_module.h"
+
+namespace wasp {
+namespace binary {
+
+constexpr u32 SectionIndex::kSectionIdCount;
+
+SectionIndex::SectionIndex(LazyModule& module) : data_{module.data} {
+  for (auto section : module.sections) {
+    SpanU8 data = section.data();
+    SectionIndexEntry entry{
+        SectionId::Custom, string_view{},
+        static_cast<u32>(data.begin() - data_.begin()),
+        static_cast<u32>(data.size())};
+    Index index = entries_.size();
+    if (section.is_known()) {
+      entry.id = section.known().id;
+      u32 id = static_cast<u32>(entry.id);
+      if (id < kSectionIdCount && !known_[id]) {
+        known_[id] = index;
+      }
+    } else {
+      entry.name = section.custom().name;
+      custom_.insert(std::make_pair(entry.name, index));
+    }
+    entries_.push_back(entry);
+  }
+}
+
+Section SectionIndex::GetSection(const SectionIndexEntry& entry) const {
+  SpanU8 data = data_.subspan(entry.offset, entry.length);
+  if (entry.id == SectionId::Custom) {
+    return Section{CustomSection{entry.name, data}};
+  } else {
+    return Section{KnownSection{entry.id, data}};
+  }
+}
+
+optional<KnownSection> SectionIndex::GetKnownSection(SectionId id) const {
+  u32 value = static_cast<u32>(id);
+  if (id == SectionId::Custom || value >= kSectionIdCount || !known_[value]) {
+    return nullopt;
+  }
+  return GetSection(entries_[*known_[value]]).known();
+}
+
+optional<CustomSection> SectionIndex::GetCustomSection(
+    string_view name) const {
+  auto iter = custom_.find(name);
+  if (iter == custom_.end()) {
+    return nullopt;
+  }
+  return GetSection(entries_[iter->second]).custom();
+}
+
+}  // namespace binary
+}  // namespace wasp
@@ -0,0 +1,256 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/stream_reader.h"
+
+#include <algorithm>
+
+#include "wasp/base/format.h"
+#include "wasp/binary/encoding.h"
+#include "wasp/binary/encoding/section_id_encoding.h"
+#include "wasp/binary/errors.h"
+#include "wasp/binary/errors_context_guard.h"
+#include "wasp/binary/read/read_bytes_expected.h"
+#include "wasp/binary/read/read_code.h"
+#include "wasp/binary/read/read_index.h"
+#include "wasp/binary/read/read_section.h"
+#include "wasp/binary/read/read_section_id.h"
+#include "wasp/binary/var_int.h"
+
+namespace wasp {
+namespace binary {
+
+namespace {
+
+constexpr SpanU8 kMagicSpan{encoding::Magic};
+constexpr SpanU8 kVersionSpan{encoding::Version};
+constexpr SpanU8::index_type kHeaderSize =
+    sizeof(encoding::Magic) + sizeof(encoding::Version);
+const u32 kCodeSectionId = encoding::SectionId::Encode(SectionId::Code);
+
+// Returns the length of the LEB128-encoded u32 at the start of |data|, and
+// stores its value in |value|, or returns 0 if it continues past the end of
+// |data|. A value that is too long is given its maximum length, so reading it
+// reports the error.
+SpanU8::index_type PeekVarU32(SpanU8 data, u32* value) {
+  *value = 0;
+  for (SpanU8::index_type i = 0; i < data.size(); ++i) {
+    *value |= u32(data[i] & 0x7f) << (i * 7);
+    if ((data[i] & 0x80) == 0 || i + 1 == VarInt<u32>::kMaxBytes) {
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+StreamReader::StreamReader(StreamReaderCallbacks& callbacks,
+                           const Features& features,
+                           Errors& errors)
+    : callbacks_{callbacks}, features_{features}, errors_{errors} {}
+
+bool StreamReader::Append(SpanU8 chunk) {
+  while (!chunk.empty() && ok()) {
+    if (!buffer_.empty()) {
+      // Complete the buffered item. Until its size is known, copy a byte at a
+      // time; the size is always in the first few bytes.
+      auto size = ItemSize(SpanU8{buffer_});
+      SpanU8::index_type count = 1;
+      if (size) {
+        count = std::min<SpanU8::index_type>(*size - buffer_.size(),
+                                             chunk.size());
+      }
+      buffer_.insert(buffer_.end(), chunk.begin(), chunk.begin() + count);
+      remove_prefix(&chunk, count);
+      if (size && buffer_.size() == static_cast<size_t>(*size)) {
+        ReadItem(SpanU8{buffer_});
+        buffer_.clear();
+      }
+      continue;
+    }
+
+    auto size = ItemSize(chunk);
+    if (!size || *size > chunk.size()) {
+      buffer_.assign(chunk.begin(), chunk.end());
+      break;
+    }
+    ReadItem(chunk.first(*size));
+    remove_prefix(&chunk, *size);
+  }
+  return ok();
+}
+
+bool StreamReader::Finish() {
+  // Reading the incomplete item reports the same error ReadModule would.
+  if (ok() && (state_ != State::Section || !buffer_.empty())) {
+    ReadItem(SpanU8{buffer_});
+    buffer_.clear();
+  }
+  return ok();
+}
+
+auto StreamReader::ItemSize(SpanU8 data) const
+    -> optional<SpanU8::index_type> {
+  u32 value;
+  switch (state_) {
+    case State::Header:
+      return kHeaderSize;
+
+    case State::Section: {
+      auto id_size = PeekVarU32(data, &value);
+      if (id_size == 0) {
+        return nullopt;
+      }
+      auto id = value;
+      remove_prefix(&data, id_size);
+      auto length_size = PeekVarU32(data, &value);
+      if (length_size == 0) {
+        return nullopt;
+      }
+      if (id == kCodeSectionId) {
+        // Only the header; the function bodies are read one at a time.
+        return id_size + length_size;
+      }
+      return id_size + length_size + value;
+    }
+
+    case State::CodeCount:
+    case State::Code: {
+      // Items can't extend past the end of the code section. If they seem
+      // to, read what is there so the error is reported.
+      auto size = PeekVarU32(data, &value);
+      if (size != 0 && state_ == State::Code) {
+        size += value;
+      }
+      if (size == 0 || size > code_remaining_) {
+        if (data.size() >= code_remaining_) {
+          return code_remaining_;
+        }
+        return nullopt;
+      }
+      return size;
+    }
+
+    case State::Error:
+      break;
+  }
+  return nullopt;
+}
+
+void StreamReader::ReadItem(SpanU8 data) {
+  const auto orig_size = data.size();
+  switch (state_) {
+    case State::Header: {
+      // Unlike ReadModule, stop at a bad magic or version rather than trying
+      // to read the rest of the stream.
+      auto magic =
+          ReadBytesExpected(&data, kMagicSpan, features_, errors_, "magic");
+      auto version =
+          ReadBytesExpected(&data, kVersionSpan, features_, errors_, "version");
+      if (magic != kMagicSpan || version != kVersionSpan) {
+        state_ = State::Error;
+        return;
+      }
+      state_ = State::Section;
+      break;
+    }
+
+    case State::Section: {
+      u32 id;
+      if (PeekVarU32(data, &id) != 0 && id == kCodeSectionId) {
+        ErrorsContextGuard guard{errors_, data, "section"};
+        Read<SectionId>(&data, features_, errors_);
+        auto length = ReadIndex(&data, features_, errors_, "length");
+        if (!length) {
+          state_ = State::Error;
+          return;
+        }
+        code_remaining_ = *length;
+        code_count_ = 0;
+        code_index_ = 0;
+        state_ = State::CodeCount;
+        return;
+      }
+
+      auto section = Read<Section>(&data, features_, errors_);
+      if (!section) {
+        state_ = State::Error;
+        return;
+      }
+      callbacks_.OnSection(*section);
+      break;
+    }
+
+    case State::CodeCount: {
+      auto count = ReadIndex(&data, features_, errors_, "count");
+      if (!count) {
+        state_ = State::Error;
+        return;
+      }
+      // As in ReadCount, each function body needs at least one byte.
+      code_remaining_ -= orig_size - data.size();
+      if (*count > code_remaining_) {
+        errors_.OnError(data, "Count extends past end: {} > {}", *count,
+                        code_remaining_);
+        state_ = State::Error;
+        return;
+      }
+      callbacks_.OnCodeSectionStart(*count);
+      code_count_ = *count;
+      state_ = State::Code;
+      CheckCodeSectionEnd(data);
+      break;
+    }
+
+    case State::Code: {
+      auto code = Read<Code>(&data, features_, errors_);
+      if (!code) {
+        state_ = State::Error;
+        return;
+      }
+      code_remaining_ -= orig_size - data.size();
+      callbacks_.OnCode(code_index_++, *code);
+      CheckCodeSectionEnd(data);
+      break;
+    }
+
+    case State::Error:
+      break;
+  }
+}
+
+void StreamReader::CheckCodeSectionEnd(SpanU8 data) {
+  // The code section must end exactly after its last function body.
+  if (code_remaining_ == 0 && code_index_ != code_count_) {
+    errors_.OnError(data, "Expected {} function bodies, got {}", code_count_,
+                    code_index_);
+    state_ = State::Error;
+    return;
+  }
+  if (code_remaining_ != 0 && code_index_ == code_count_) {
+    errors_.OnError(data, "Expected {} function bodies, got more", code_count_);
+    state_ = State::Error;
+    return;
+  }
+  if (code_remaining_ == 0) {
+    callbacks_.OnCodeSectionEnd();
+    state_ = State::Section;
+  }
+}
+
+}  // namespace binary
+}  // namespace wasp
@@ -0,0 +1,48 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/tools/args.h"
+
+#include <iostream>
+
+#include "wasp/base/format.h"
+#include "wasp/base/formatters.h"
+
+namespace wasp {
+namespace tools {
+
+OptionValues::OptionValues(int argc, char** argv, int& i)
+    : argc_{argc}, argv_{argv}, i_{i} {}
+
+string_view OptionValues::Next() {
+  if (i_ + 1 >= argc_) {
+    missing_ = true;
+    return {};
+  }
+  return argv_[++i_];
+}
+
+bool OptionValues::CheckMissing(string_view option, std::ostream& err) {
+  if (!missing_) {
+    return false;
+  }
+  print(err, "Missing value for {}\n", option);
+  missing_ = false;
+  return true;
+}
+
+}  // namespace tools
+}  // namespace wasp
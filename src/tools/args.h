@@ -0,0 +1,53 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_TOOLS_ARGS_H_
+#define WASP_TOOLS_ARGS_H_
+
+#include <iosfwd>
+
+#include "wasp/base/string_view.h"
+
+namespace wasp {
+namespace tools {
+
+/// ---
+// Reads the values of options that take one, e.g. `-o <file>`. |i| is the
+// index of the current argument in the tool's argument loop; Next() moves it
+// to the value, without reading past the end of |argv|.
+class OptionValues {
+ public:
+  explicit OptionValues(int argc, char** argv, int& i);
+
+  // Returns the argument after the current one and moves past it. If there
+  // is none, returns an empty string and remembers that it was missing.
+  string_view Next();
+
+  // Returns true, after printing an error for |option|, if a call to Next()
+  // since the last check had no argument to return.
+  bool CheckMissing(string_view option, std::ostream& err);
+
+ private:
+  int argc_;
+  char** argv_;
+  int& i_;
+  bool missing_ = false;
+};
+
+}  // namespace tools
+}  // namespace wasp
+
+#endif  // WASP_TOOLS_ARGS_H_
@@ -0,0 +1,421 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/tools/batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "src/tools/args.h"
+#include "src/tools/callgraph.h"
+#include "src/tools/cfg.h"
+#include "src/tools/dfg.h"
+#include "src/tools/dump.h"
+
+#include "wasp/base/format.h"
+#include "wasp/base/str_to_u32.h"
+#include "wasp/base/string_view.h"
+#include "wasp/base/types.h"
+
+namespace wasp {
+namespace tools {
+namespace batch {
+
+using Command = int (*)(int argc,
+                        char** argv,
+                        std::ostream& out,
+                        std::ostream& err);
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  unsigned jobs = 0;
+  bool print_timing = false;
+};
+
+// The output of running the command on one input. Workers fill these in out
+// of order; the main thread writes them to stdout/stderr in input order.
+struct Result {
+  std::string out;
+  std::string err;
+  int status = 0;
+  u64 size = 0;
+  double seconds = 0;
+  bool done = false;
+};
+
+struct Tool {
+  explicit Tool(Command,
+                std::vector<char*> command_args,
+                std::vector<std::string> filenames,
+                Options);
+
+  int Run();
+  void Worker();
+  void RunOne(size_t index);
+  void Emit(size_t index);
+  void PrintTotals(double seconds);
+
+  Command command;
+  std::vector<char*> command_args;
+  std::vector<std::string> filenames;
+  Options options;
+  std::vector<Result> results;
+
+  // Workers may only start an input that is less than |window| past the
+  // next input to be emitted. This bounds the amount of buffered output.
+  size_t window;
+  size_t next = 0;
+  size_t emitted = 0;
+  std::mutex mutex;
+  std::condition_variable ready;
+  std::condition_variable space;
+};
+
+Command GetCommand(string_view name) {
+  if (name == "dump") {
+    return dump::Main;
+  } else if (name == "callgraph") {
+    return callgraph::Main;
+  } else if (name == "cfg") {
+    return cfg::Main;
+  } else if (name == "dfg") {
+    return dfg::Main;
+  }
+  return nullptr;
+}
+
+bool EndsWith(string_view s, string_view suffix) {
+  return s.size() >= suffix.size() &&
+         s.substr(s.size() - suffix.size()) == suffix;
+}
+
+// Appends |path| to |filenames|. Directories are searched recursively for
+// .wasm files, which are added in sorted order so the output doesn't depend
+// on the order that the filesystem returns directory entries.
+void AddPath(const std::string& path, std::vector<std::string>* filenames) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+    filenames->push_back(path);
+    return;
+  }
+
+  DIR* dir = opendir(path.c_str());
+  if (!dir) {
+    filenames->push_back(path);
+    return;
+  }
+
+  std::vector<std::string> entries;
+  while (struct dirent* entry = readdir(dir)) {
+    string_view name = entry->d_name;
+    if (name == "." || name == "..") {
+      continue;
+    }
+    entries.push_back(name.to_string());
+  }
+  closedir(dir);
+  std::sort(entries.begin(), entries.end());
+
+  for (const auto& name : entries) {
+    std::string child = path;
+    if (child.back() != '/') {
+      child += '/';
+    }
+    child += name;
+    if (stat(child.c_str(), &st) != 0) {
+      continue;
+    }
+    if (S_ISDIR(st.st_mode)) {
+      AddPath(child, filenames);
+    } else if (S_ISREG(st.st_mode) && EndsWith(name, ".wasm")) {
+      filenames->push_back(child);
+    }
+  }
+}
+
+bool AddListFile(string_view list_filename,
+                 std::vector<std::string>* filenames) {
+  std::ifstream fstream;
+  std::istream* stream = &std::cin;
+  if (list_filename != "-") {
+    fstream.open(list_filename.to_string());
+    if (!fstream) {
+      return false;
+    }
+    stream = &fstream;
+  }
+
+  std::string line;
+  while (std::getline(*stream, line)) {
+    if (!line.empty()) {
+      AddPath(line, filenames);
+    }
+  }
+  return true;
+}
+
+int Main(int argc, char** argv) {
+  Options options;
+  Command command = nullptr;
+  std::vector<char*> command_args;
+  std::vector<std::string> filenames;
+  string_view jobs;
+  bool has_list = false;
+
+  int i = 0;
+  OptionValues values{argc, argv, i};
+
+  for (; i < argc; ++i) {
+    string_view arg = argv[i];
+    if (arg.size() > 1 && arg[0] == '-') {
+      string_view value;
+      switch (arg[1]) {
+        case 'j': jobs = values.Next(); break;
+        case 'l': value = values.Next(); break;
+        case 't': options.print_timing = true; break;
+        case '-':
+          if (arg == "--jobs") {
+            jobs = values.Next();
+          } else if (arg == "--list") {
+            value = values.Next();
+          } else if (arg == "--timing") {
+            options.print_timing = true;
+          } else {
+            print(stderr, "Unknown long argument {}\n", arg);
+          }
+          break;
+        default:
+          print(stderr, "Unknown short argument {}\n", arg[0]);
+          break;
+      }
+
+      if (values.CheckMissing(arg, std::cerr)) {
+        return 1;
+      }
+
+      if (!value.empty()) {
+        if (!AddListFile(value, &filenames)) {
+          print(stderr, "Error reading list file {}.\n", value);
+          return 1;
+        }
+        has_list = true;
+      }
+    } else {
+      command = GetCommand(arg);
+      if (!command) {
+        print(stderr, "Unknown command \"{}\"\n", arg);
+        return 1;
+      }
+      ++i;
+      break;
+    }
+  }
+
+  if (!command) {
+    print(stderr, "No command given.\n");
+    return 1;
+  }
+
+  if (!jobs.empty()) {
+    auto jobs_opt = StrToU32(jobs);
+    if (!jobs_opt) {
+      print(stderr, "Invalid job count {}\n", jobs);
+      return 1;
+    }
+    options.jobs = *jobs_opt;
+  }
+
+  // Everything up to "--" is passed to the command; everything after it is an
+  // input file or directory.
+  for (; i < argc; ++i) {
+    if (string_view{argv[i]} == "--") {
+      ++i;
+      break;
+    }
+    command_args.push_back(argv[i]);
+  }
+
+  for (; i < argc; ++i) {
+    AddPath(argv[i], &filenames);
+  }
+
+  if (filenames.empty()) {
+    if (!has_list) {
+      print(stderr, "No filenames given.\n");
+    }
+    return has_list ? 0 : 1;
+  }
+
+  if (options.jobs == 0) {
+    options.jobs = std::max(1u, std::thread::hardware_concurrency());
+  }
+  // More jobs than inputs would only start idle threads.
+  options.jobs = static_cast<unsigned>(
+      std::min(static_cast<size_t>(options.jobs), filenames.size()));
+
+  Tool tool{command, std::move(command_args), std::move(filenames), options};
+  return tool.Run();
+}
+
+Tool::Tool(Command command,
+           std::vector<char*> command_args,
+           std::vector<std::string> filenames,
+           Options options)
+    : command{command},
+      command_args{std::move(command_args)},
+      filenames{std::move(filenames)},
+      options{options},
+      results(this->filenames.size()),
+      window{std::max<size_t>(1, static_cast<size_t>(options.jobs) * 4)} {}
+
+int Tool::Run() {
+  auto start = Clock::now();
+
+  size_t thread_count =
+      std::min(static_cast<size_t>(options.jobs), filenames.size());
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads.emplace_back(&Tool::Worker, this);
+  }
+
+  int status = 0;
+  for (size_t i = 0; i < results.size(); ++i) {
+    Emit(i);
+    if (results[i].status != 0) {
+      status = 1;
+    }
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  if (options.print_timing) {
+    PrintTotals(std::chrono::duration<double>(Clock::now() - start).count());
+  }
+  return status;
+}
+
+void Tool::Worker() {
+  for (;;) {
+    size_t index;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      space.wait(lock, [&]() { return next < emitted + window; });
+      if (next >= filenames.size()) {
+        return;
+      }
+      index = next++;
+    }
+    RunOne(index);
+  }
+}
+
+void Tool::RunOne(size_t index) {
+  Result result;
+  const std::string& filename = filenames[index];
+
+  struct stat st;
+  if (stat(filename.c_str(), &st) == 0) {
+    result.size = st.st_size;
+  }
+
+  // The command may keep pointers into its arguments, so the filename copy
+  // must outlive the call.
+  std::string filename_arg = filename;
+  std::vector<char*> argv = command_args;
+  argv.push_back(&filename_arg[0]);
+
+  std::ostringstream out;
+  std::ostringstream err;
+  auto start = Clock::now();
+  result.status = command(static_cast<int>(argv.size()), argv.data(), out, err);
+  result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  result.out = out.str();
+  result.err = err.str();
+  result.done = true;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    results[index] = std::move(result);
+  }
+  ready.notify_all();
+}
+
+void Tool::Emit(size_t index) {
+  Result& result = results[index];
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    ready.wait(lock, [&]() { return result.done; });
+  }
+
+  std::cout.write(result.out.data(), result.out.size());
+  std::cout.flush();
+  std::cerr.write(result.err.data(), result.err.size());
+  if (options.print_timing) {
+    print(stderr, "{}: {:.3f} ms, {} bytes{}\n", filenames[index],
+          result.seconds * 1000, result.size,
+          result.status != 0 ? " (failed)" : "");
+  }
+
+  // Release the buffered output; only the status is needed from here on.
+  std::string().swap(result.out);
+  std::string().swap(result.err);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++emitted;
+  }
+  space.notify_all();
+}
+
+void Tool::PrintTotals(double seconds) {
+  u64 total_size = 0;
+  size_t failed = 0;
+  for (const auto& result : results) {
+    total_size += result.size;
+    if (result.status != 0) {
+      ++failed;
+    }
+  }
+
+  double mb = total_size / (1024.0 * 1024.0);
+  print(stderr, "total: {} files ({} failed), {} bytes in {:.3f} s",
+        results.size(), failed, total_size, seconds);
+  if (seconds > 0) {
+    print(stderr, ", {:.2f} MiB/s, {:.1f} files/s", mb / seconds,
+          results.size() / seconds);
+  }
+  print(stderr, " ({} jobs)\n", options.jobs);
+}
+
+}  // namespace batch
+}  // namespace tools
+}  // namespace wasp
@@ -14,15 +14,17 @@
 // limitations under the License.
 //
 
+#include "src/tools/callgraph.h"
+
 #include <fstream>
 #include <iostream>
 #include <iterator>
 #include <map>
-#include <set>
 #include <string>
 #include <vector>
 
-#include "wasp/base/enumerate.h"
+#include "src/tools/args.h"
+#include "wasp/analysis/call_graph.h"
 #include "wasp/base/features.h"
 #include "wasp/base/file.h"
 #include "wasp/base/format.h"
@@ -30,20 +32,20 @@
 #include "wasp/base/optional.h"
 #include "wasp/base/string_view.h"
 #include "wasp/binary/errors_nop.h"
-#include "wasp/binary/lazy_code_section.h"
 #include "wasp/binary/lazy_export_section.h"
-#include "wasp/binary/lazy_expression.h"
 #include "wasp/binary/lazy_function_names_subsection.h"
 #include "wasp/binary/lazy_function_section.h"
 #include "wasp/binary/lazy_import_section.h"
 #include "wasp/binary/lazy_module.h"
 #include "wasp/binary/lazy_module_utils.h"
 #include "wasp/binary/lazy_name_section.h"
+#include "wasp/binary/section_index.h"
 
 namespace wasp {
 namespace tools {
 namespace callgraph {
 
+using namespace ::wasp::analysis;
 using namespace ::wasp::binary;
 
 struct Options {
@@ -52,111 +54,105 @@ struct Options {
 };
 
 struct Tool {
-  explicit Tool(SpanU8 data, Options);
+  explicit Tool(SpanU8 data, Options, std::ostream& out, std::ostream& err);
 
   void Run();
   void DoPrepass();
-  void CalculateCallGraph();
   void WriteDotFile();
 
   optional<string_view> GetFunctionName(Index) const;
 
+  std::ostream& out;
+  std::ostream& err;
   ErrorsNop errors;
   Options options;
   LazyModule module;
+  SectionIndex section_index;
   std::map<Index, string_view> function_names;
-  Index imported_function_count = 0;
-  std::set<std::pair<Index, Index>> call_graph;
+  CallGraph call_graph;
 };
 
 int Main(int argc, char** argv) {
+  return Main(argc, argv, std::cout, std::cerr);
+}
+
+int Main(int argc, char** argv, std::ostream& out, std::ostream& err) {
   string_view filename;
   Options options;
   options.features.EnableAll();
 
-  for (int i = 0; i < argc; ++i) {
+  int i = 0;
+  OptionValues values{argc, argv, i};
+
+  for (; i < argc; ++i) {
     string_view arg = argv[i];
-    if (arg[0] == '-') {
+    if (arg.size() > 1 && arg[0] == '-') {
       switch (arg[1]) {
-        case 'o': options.output_filename = argv[++i]; break;
+        case 'o': options.output_filename = values.Next(); break;
         case '-':
           if (arg == "--output") {
-            options.output_filename = argv[++i];
+            options.output_filename = values.Next();
           } else {
-            print(stderr, "Unknown long argument {}\n", arg);
+            print(err, "Unknown long argument {}\n", arg);
           }
           break;
         default:
-          print(stderr, "Unknown short argument {}\n", arg[0]);
+          print(err, "Unknown short argument {}\n", arg[0]);
           break;
       }
+
+      if (values.CheckMissing(arg, err)) {
+        return 1;
+      }
     } else {
       if (filename.empty()) {
         filename = arg;
       } else {
-        print(stderr, "Filename already given\n");
+        print(err, "Filename already given\n");
       }
     }
   }
 
   if (filename.empty()) {
-    print(stderr, "No filenames given.\n");
+    print(err, "No filenames given.\n");
     return 1;
   }
 
-  auto optbuf = ReadFile(filename);
-  if (!optbuf) {
-    print(stderr, "Error reading file {}.\n", filename);
+  auto optfile = MapFile(filename);
+  if (!optfile) {
+    print(err, "Error reading file {}.\n", filename);
     return 1;
   }
 
-  SpanU8 data{*optbuf};
-  Tool tool{data, options};
+  SpanU8 data = optfile->data();
+  Tool tool{data, options, out, err};
   tool.Run();
 
   return 0;
 }
 
-Tool::Tool(SpanU8 data, Options options)
-    : options{options}, module{ReadModule(data, options.features, errors)} {}
+Tool::Tool(SpanU8 data, Options options, std::ostream& out, std::ostream& err)
+    : out(out),
+      err(err),
+      options{options},
+      module{ReadModule(data, options.features, errors)},
+      section_index{module} {}
 
 void Tool::Run() {
   DoPrepass();
-  CalculateCallGraph();
+  call_graph = BuildCallGraph(section_index, options.features, errors);
   WriteDotFile();
 }
 
 void Tool::DoPrepass() {
-  CopyFunctionNames(module, std::inserter(function_names, function_names.end()),
+  CopyFunctionNames(section_index,
+                    std::inserter(function_names, function_names.end()),
                     options.features, errors);
-  imported_function_count =
-      GetImportCount(module, ExternalKind::Function, options.features, errors);
-}
-
-void Tool::CalculateCallGraph() {
-  for (auto section : module.sections) {
-    if (section.is_known()) {
-      auto known = section.known();
-      if (known.id == SectionId::Code) {
-        auto section = ReadCodeSection(known, options.features, errors);
-        for (auto code : enumerate(section.sequence, imported_function_count)) {
-          for (const auto& instr :
-               ReadExpression(code.value.body, options.features, errors)) {
-            if (instr.opcode == Opcode::Call) {
-              assert(instr.has_index_immediate());
-              auto callee_index = instr.index_immediate();
-              call_graph.insert(std::make_pair(code.index, callee_index));
-            }
-          }
-        }
-      }
-    }
-  }
 }
 
 void Tool::WriteDotFile() {
   std::ofstream fstream;
-  std::ostream* stream = &std::cout;
+  std::ostream* stream = &out;
   if (!options.output_filename.empty()) {
     fstream = std::ofstream{options.output_filename.to_string()};
     if (fstream) {
@@ -168,13 +164,12 @@ void Tool::WriteDotFile() {
   print(*stream, "  rankdir = LR;\n");
 
   // Write nodes.
-  std::set<Index> functions;
-  for (auto pair : call_graph) {
-    functions.insert(pair.first);
-    functions.insert(pair.second);
-  }
-
-  for (auto function : functions) {
+  for (Index function = 0; function < call_graph.function_count();
+       ++function) {
+    if (call_graph.callees(function).empty() &&
+        call_graph.callers(function).empty()) {
+      continue;
+    }
     print(*stream, "  {}", function);
     auto name = GetFunctionName(function);
     if (name) {
@@ -186,10 +181,10 @@ void Tool::WriteDotFile() {
   }
 
   // Write edges.
-  for (auto pair : call_graph) {
-    Index caller = pair.first;
-    Index callee = pair.second;
-    print(*stream, "  {} -> {};\n", caller, callee);
+  for (Index caller = 0; caller < call_graph.function_count(); ++caller) {
+    for (Index callee : call_graph.callees(caller)) {
+      print(*stream, "  {} -> {};\n", caller, callee);
+    }
   }
 
   print(*stream, "}}\n");
@@ -17,11 +17,14 @@
 #ifndef WASP_TOOLS_CALLGRAPH_H_
 #define WASP_TOOLS_CALLGRAPH_H_
 
+#include <iosfwd>
+
 namespace wasp {
 namespace tools {
 namespace callgraph {
 
 int Main(int argc, char** argv);
+int Main(int argc, char** argv, std::ostream& out, std::ostream& err);
 
 }  // namespace callgraph
 }  // namespace tools
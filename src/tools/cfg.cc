@@ -14,6 +14,8 @@
 // limitations under the License.
 //
 
+#include "src/tools/cfg.h"
+
 #include <algorithm>
 #include <fstream>
 #include <iostream>
@@ -21,6 +23,8 @@
 #include <string>
 #include <vector>
 
+#include "src/tools/args.h"
+#include "wasp/analysis/cfg.h"
 #include "wasp/base/enumerate.h"
 #include "wasp/base/features.h"
 #include "wasp/base/file.h"
@@ -29,9 +33,9 @@
 #include "wasp/base/optional.h"
 #include "wasp/base/str_to_u32.h"
 #include "wasp/base/string_view.h"
+#include "wasp/binary/code_section_index.h"
 #include "wasp/binary/errors_nop.h"
 #include "wasp/binary/formatters.h"
-#include "wasp/binary/lazy_code_section.h"
 #include "wasp/binary/lazy_export_section.h"
 #include "wasp/binary/lazy_expression.h"
 #include "wasp/binary/lazy_function_names_subsection.h"
@@ -40,11 +44,13 @@
 #include "wasp/binary/lazy_module.h"
 #include "wasp/binary/lazy_module_utils.h"
 #include "wasp/binary/lazy_name_section.h"
+#include "wasp/binary/section_index.h"
 
 namespace wasp {
 namespace tools {
 namespace cfg {
 
+using namespace ::wasp::analysis;
 using namespace ::wasp::binary;
 
 struct Options {
@@ -53,145 +59,142 @@ struct Options {
   string_view output_filename;
 };
 
-using BBID = u32;
-constexpr BBID InvalidBBID = ~0;
-
-struct Successor {
-  std::string name;
-  BBID bbid;
-};
-
-struct BasicBlock {
-  bool empty() const { return code.empty(); }
+class ErrorsStderr : public Errors {
+ public:
+  explicit ErrorsStderr(std::ostream& err) : err(err) {}
 
-  SpanU8 code;
-  std::vector<Successor> successors;
-};
+ protected:
+  void HandlePushContext(SpanU8 pos, string_view desc) override {}
+  void HandlePopContext() override {}
+  void HandleOnError(SpanU8 pos, string_view message) override {
+    print(err, "{}\n", message);
+  }
 
-struct Label {
-  Opcode opcode;
-  BBID parent;
-  BBID br;
-  BBID next;
+  std::ostream& err;
 };
 
 struct Tool {
-  explicit Tool(SpanU8 data, Options);
+  explicit Tool(SpanU8 data, Options, std::ostream& out, std::ostream& err);
 
   int Run();
   void DoPrepass();
   optional<Index> GetFunctionIndex();
   optional<Code> GetCode(Index);
-  void CalculateCFG(Code);
-  void RemoveEmptyBasicBlocks();
-  void WriteDotFile();
-
-  void PushLabel(Opcode, BBID br, BBID next);
-  Label PopLabel();
-  BBID NewBasicBlock();
-  BasicBlock& GetBasicBlock(BBID);
-  void StartBasicBlock(BBID, const u8*);
-  void EndBasicBlock(const u8*);
-  void MarkUnreachable(const u8*);
-  void AddSuccessor(BBID, const std::string& name = std::string{});
-  void AddSuccessor(BBID, BBID, const std::string& name = std::string{});
-  void Br(Index, const std::string& name = std::string{});
+  void WriteDotFile(const Cfg&);
 
+  std::ostream& out;
+  std::ostream& err;
   ErrorsNop errors;
+  ErrorsStderr cfg_errors;
   Options options;
   LazyModule module;
+  SectionIndex section_index;
+  CodeSectionIndex code_index;
   std::map<string_view, Index> name_to_function;
   Index imported_function_count = 0;
-  std::vector<Label> labels;
-  std::vector<BasicBlock> cfg;
-  BBID start_bbid = InvalidBBID;
-  BBID current_bbid = InvalidBBID;
 };
 
 int Main(int argc, char** argv) {
+  return Main(argc, argv, std::cout, std::cerr);
+}
+
+int Main(int argc, char** argv, std::ostream& out, std::ostream& err) {
   string_view filename;
   Options options;
   options.features.EnableAll();
 
-  for (int i = 0; i < argc; ++i) {
+  int i = 0;
+  OptionValues values{argc, argv, i};
+  for (; i < argc; ++i) {
     string_view arg = argv[i];
-    if (arg[0] == '-') {
+    if (arg.size() > 1 && arg[0] == '-') {
       switch (arg[1]) {
-        case 'o': options.output_filename = argv[++i]; break;
-        case 'f': options.function = argv[++i]; break;
+        case 'o': options.output_filename = values.Next(); break;
+        case 'f': options.function = values.Next(); break;
         case '-':
           if (arg == "--output") {
-            options.output_filename = argv[++i];
+            options.output_filename = values.Next();
           } else if (arg == "--function") {
-            options.function = argv[++i];
+            options.function = values.Next();
           } else {
-            print(stderr, "Unknown long argument {}\n", arg);
+            print(err, "Unknown long argument {}\n", arg);
           }
           break;
         default:
-          print(stderr, "Unknown short argument {}\n", arg[0]);
+          print(err, "Unknown short argument {}\n", arg[0]);
           break;
       }
+
+      if (values.CheckMissing(arg, err)) {
+        return 1;
+      }
     } else {
       if (filename.empty()) {
         filename = arg;
       } else {
-        print(stderr, "Filename already given\n");
+        print(err, "Filename already given\n");
       }
     }
   }
 
   if (filename.empty()) {
-    print(stderr, "No filenames given.\n");
+    print(err, "No filenames given.\n");
     return 1;
   }
 
   if (options.function.empty()) {
-    print(stderr, "No function given.\n");
+    print(err, "No function given.\n");
     return 1;
   }
 
-  auto optbuf = ReadFile(filename);
-  if (!optbuf) {
-    print(stderr, "Error reading file {}.\n", filename);
+  auto optfile = MapFile(filename);
+  if (!optfile) {
+    print(err, "Error reading file {}.\n", filename);
     return 1;
   }
 
-  SpanU8 data{*optbuf};
-  Tool tool{data, options};
+  SpanU8 data = optfile->data();
+  Tool tool{data, options, out, err};
   return tool.Run();
 }
 
-Tool::Tool(SpanU8 data, Options options)
-    : options{options}, module{ReadModule(data, options.features, errors)} {}
+Tool::Tool(SpanU8 data, Options options, std::ostream& out, std::ostream& err)
+    : out(out),
+      err(err),
+      cfg_errors{err},
+      options{options},
+      module{ReadModule(data, options.features, errors)},
+      section_index{module} {}
 
 int Tool::Run() {
   DoPrepass();
   auto index_opt = GetFunctionIndex();
   if (!index_opt) {
-    print(stderr, "Unknown function {}\n", options.function);
+    print(err, "Unknown function {}\n", options.function);
     return 1;
   }
   auto code_opt = GetCode(*index_opt);
   if (!code_opt) {
-    print(stderr, "Invalid function index {}\n", *index_opt);
+    print(err, "Invalid function index {}\n", *index_opt);
     return 1;
   }
-  CalculateCFG(*code_opt);
-  RemoveEmptyBasicBlocks();
-  WriteDotFile();
+  WriteDotFile(BuildCfg(*code_opt, options.features, cfg_errors));
   return 0;
 }
 
 void Tool::DoPrepass() {
   ForEachFunctionName(
-      module,
+      section_index,
       [this](const IndexNamePair& pair) {
         name_to_function.insert(std::make_pair(pair.second, pair.first));
       },
       options.features, errors);
   imported_function_count =
-      GetImportCount(module, ExternalKind::Function, options.features, errors);
+      GetImportCount(section_index, ExternalKind::Function, options.features,
+                     errors);
+  if (auto known = section_index.GetKnownSection(SectionId::Code)) {
+    code_index = CodeSectionIndex{*known, options.features, errors};
+  }
 }
 
 optional<Index> Tool::GetFunctionIndex() {
@@ -206,177 +209,33 @@ optional<Index> Tool::GetFunctionIndex() {
 }
 
 optional<Code> Tool::GetCode(Index find_index) {
-  for (auto section : module.sections) {
-    if (section.is_known()) {
-      auto known = section.known();
-      if (known.id == SectionId::Code) {
-        auto section = ReadCodeSection(known, options.features, errors);
-        for (auto code : enumerate(section.sequence, imported_function_count)) {
-          if (code.index == find_index) {
-            return code.value;
-          }
-        }
-      }
-    }
+  if (find_index < imported_function_count) {
+    return nullopt;
   }
-  return nullopt;
+  return code_index.GetCode(find_index - imported_function_count,
+                            options.features, errors);
 }
 
-void Tool::CalculateCFG(Code code) {
-  const u8* ptr = code.body.data.data();
-  PushLabel(Opcode::Return, InvalidBBID, InvalidBBID);
-  start_bbid = NewBasicBlock();
-  StartBasicBlock(start_bbid, ptr);
-
-  const u8* prev_ptr = ptr;
-  auto instrs = ReadExpression(code.body, options.features, errors);
-  for (auto it = instrs.begin(), end = instrs.end(); it != end;
-       ++it, prev_ptr = ptr) {
-    const auto& instr = *it;
-    ptr = it.data().data();
-    switch (instr.opcode) {
-      case Opcode::Unreachable:
-        MarkUnreachable(ptr);
-        break;
-
-      case Opcode::Block: {
-        auto next = NewBasicBlock();
-        PushLabel(instr.opcode, next, next);
-        break;
-      }
-
-      case Opcode::Loop: {
-        auto loop = NewBasicBlock();
-        auto next = NewBasicBlock();
-        AddSuccessor(loop);
-        PushLabel(instr.opcode, loop, next);
-        StartBasicBlock(loop, prev_ptr);
-        break;
-      }
-
-      case Opcode::If: {
-        auto true_ = NewBasicBlock();
-        auto next = NewBasicBlock();
-        AddSuccessor(true_, "T");
-        PushLabel(instr.opcode, next, next);
-        StartBasicBlock(true_, ptr);
-        break;
-      }
-
-      case Opcode::Else: {
-        auto top = PopLabel();
-        AddSuccessor(top.next);
-        auto false_ = NewBasicBlock();
-        AddSuccessor(top.parent, false_, "F");
-        PushLabel(instr.opcode, top.next, top.next);
-        StartBasicBlock(false_, ptr);
-        break;
-      }
-
-      case Opcode::End: {
-        auto top = PopLabel();
-        AddSuccessor(top.next);
-        if (top.opcode == Opcode::If) {
-          AddSuccessor(top.parent, top.next, "F");
-        }
-        StartBasicBlock(top.next, ptr);
-        break;
-      }
-
-      case Opcode::Br:
-        Br(instr.index_immediate());
-        MarkUnreachable(ptr);
-        break;
-
-      case Opcode::BrIf: {
-        Br(instr.index_immediate(), "T");
-        auto next = NewBasicBlock();
-        AddSuccessor(next, "F");
-        StartBasicBlock(next, ptr);
-        break;
-      }
-
-      case Opcode::BrTable: {
-        const auto& immediate = instr.br_table_immediate();
-        u32 value = 0;
-        for (const auto& target : immediate.targets) {
-          Br(target, format("{}", value++));
-        }
-        Br(immediate.default_target, "default");
-        MarkUnreachable(ptr);
-        break;
-      }
-
-      case Opcode::Return:
-      case Opcode::ReturnCall:
-      case Opcode::ReturnCallIndirect:
-        MarkUnreachable(ptr);
-        break;
+namespace {
 
-      default:
-        break;
-    }
+std::string GetEdgeName(CfgEdgeKind kind, Index index) {
+  switch (kind) {
+    case CfgEdgeKind::Unconditional: return "";
+    case CfgEdgeKind::True:          return "T";
+    case CfgEdgeKind::False:         return "F";
+    case CfgEdgeKind::Case:          return format("{}", index);
+    case CfgEdgeKind::Default:       return "default";
   }
+  return "";
 }
 
-void Tool::RemoveEmptyBasicBlocks() {
-  std::map<BBID, BBID> empty_map;
-  // Map each empty bb to its successor.
-  for (const auto& bb: enumerate(cfg)) {
-    if (bb.value.empty()) {
-      BBID next = bb.value.successors.empty() ? InvalidBBID
-                                              : bb.value.successors[0].bbid;
-      empty_map.emplace(bb.index, next);
-    }
-  }
-
-  for (auto& pair: empty_map) {
-    // Follow the chain of empty bbs to the first non-empty one (or
-    // InvalidBBID).
-    BBID last = pair.second;
-    auto it = empty_map.find(last);
-    if (it != empty_map.end()) {
-      while (it != empty_map.end()) {
-        last = it->second;
-        it = empty_map.find(last);
-      }
-
-      // Replace all successors in the chain with `last`.
-      BBID next = pair.second;
-      pair.second = last;
-      it = empty_map.find(next);
-      while (it != empty_map.end()) {
-        next = it->second;
-        it->second = last;
-        it = empty_map.find(next);
-      }
-    }
-  }
-
-  // Update all non-empty bbs that have empty successors.
-  for (auto& bb: cfg) {
-    if (!bb.empty()) {
-      for (auto& succ: bb.successors) {
-        auto it = empty_map.find(succ.bbid);
-        if (it != empty_map.end()) {
-          succ.bbid = it->second;
-        }
-      }
-    }
-  }
-}
+}  // namespace
 
-bool IsExtraneousInstruction(const Instruction& instr) {
-  auto opcode = instr.opcode;
-  return opcode == Opcode::Block || opcode == Opcode::Else ||
-         opcode == Opcode::End || opcode == Opcode::Br;
-}
-
-void Tool::WriteDotFile() {
+void Tool::WriteDotFile(const Cfg& cfg) {
   const int kMaxSuccessors = 64;
 
   std::ofstream fstream;
-  std::ostream* stream = &std::cout;
+  std::ostream* stream = &out;
   if (!options.output_filename.empty()) {
     fstream = std::ofstream{options.output_filename.to_string()};
     if (fstream) {
@@ -387,70 +246,73 @@ void Tool::WriteDotFile() {
   print(*stream, "strict digraph {{\n");
 
   // Write nodes.
-  for (const auto& bb: enumerate(cfg)) {
-    if (!bb.value.empty()) {
-      auto colspan = std::max<int>(
-          1, std::min<int>(bb.value.successors.size(), kMaxSuccessors));
-      print(*stream,
-            "  {} [shape=none;margin=0;label=<"
-            "<TABLE BORDER=\"1\" CELLBORDER=\"1\" CELLSPACING=\"0\"><TR>"
-            "<TD BORDER=\"0\" ALIGN=\"LEFT\" COLSPAN=\"{}\">",
-            bb.index, colspan);
-      auto instrs = ReadExpression(bb.value.code, options.features, errors);
-      for (const auto& instr: instrs) {
-        if (IsExtraneousInstruction(instr)) {
-          continue;
-        } else if (instr.opcode == Opcode::BrTable) {
-          print(*stream, "{}...", instr.opcode);
-        } else {
-          print(*stream, "{}", instr);
-        }
-        print(*stream, "<BR ALIGN=\"LEFT\"/>");
+  for (BBID bbid = 0; bbid < cfg.block_count(); ++bbid) {
+    auto successors = cfg.successors(bbid);
+    auto colspan =
+        std::max<int>(1, std::min<int>(successors.size(), kMaxSuccessors));
+    print(*stream,
+          "  {} [shape=none;margin=0;label=<"
+          "<TABLE BORDER=\"1\" CELLBORDER=\"1\" CELLSPACING=\"0\"><TR>"
+          "<TD BORDER=\"0\" ALIGN=\"LEFT\" COLSPAN=\"{}\">",
+          bbid, colspan);
+    auto instrs = ReadExpression(cfg.code(bbid), options.features, errors);
+    for (const auto& instr: instrs) {
+      if (IsExtraneousInstruction(instr)) {
+        continue;
+      } else if (instr.opcode == Opcode::BrTable) {
+        print(*stream, "{}...", instr.opcode);
+      } else {
+        print(*stream, "{}", instr);
       }
-      print(*stream, "</TD></TR>");
-      // Add ports.
-      if (bb.value.successors.size() > 1) {
-        print(*stream, "<TR>");
-        string_view sides = "T";
-        for (const auto& succ: enumerate(bb.value.successors)) {
-          if (succ.index < kMaxSuccessors) {
-            assert(!succ.value.name.empty());
-            print(*stream, "<TD PORT=\"{}\" SIDES=\"{}\">{}</TD>",
-                  succ.value.name, sides, succ.value.name);
-          } else {
-            print(*stream, "<TD PORT=\"trunc\" SIDES=\"TL\">...</TD>");
-            break;
-          }
-          sides = "TL";
+      print(*stream, "<BR ALIGN=\"LEFT\"/>");
+    }
+    print(*stream, "</TD></TR>");
+    // Add ports.
+    if (successors.size() > 1) {
+      print(*stream, "<TR>");
+      string_view sides = "T";
+      for (const auto& succ: enumerate(successors)) {
+        if (succ.index < kMaxSuccessors) {
+          auto name = GetEdgeName(succ.value.kind, succ.index);
+          assert(!name.empty());
+          print(*stream, "<TD PORT=\"{}\" SIDES=\"{}\">{}</TD>", name,
+                sides, name);
+        } else {
+          print(*stream, "<TD PORT=\"trunc\" SIDES=\"TL\">...</TD>");
+          break;
         }
-        print(*stream, "</TR>");
+        sides = "TL";
       }
-      print(*stream, "</TABLE>>]\n");
+      print(*stream, "</TR>");
     }
+    print(*stream, "</TABLE>>]\n");
   }
 
   // Write edges.
-  print(*stream, "  start -> {}\n", start_bbid);
-  for (const auto& bb: enumerate(cfg)) {
-    if (!bb.value.empty()) {
-      for (const auto& succ : enumerate(bb.value.successors)) {
-        if (succ.value.bbid == InvalidBBID) {
-          print(*stream, "  {} -> end", bb.index);
-        } else {
-          print(*stream, "  {}", bb.index);
-          if (!succ.value.name.empty()) {
-            if (succ.index < kMaxSuccessors) {
-              print(*stream, ":{}", succ.value.name);
-            } else {
-              print(*stream, ":trunc");
-            }
-          }
-          print(*stream, " -> {}", succ.value.bbid);
-          if (succ.index >= kMaxSuccessors && !succ.value.name.empty()) {
-            print(*stream, " [headlabel=\"{}\"]", succ.value.name);
+  if (cfg.start() == InvalidBBID) {
+    print(*stream, "  start -> end\n");
+  } else {
+    print(*stream, "  start -> {}\n", cfg.start());
+  }
+  for (BBID bbid = 0; bbid < cfg.block_count(); ++bbid) {
+    for (const auto& succ : enumerate(cfg.successors(bbid))) {
+      if (succ.value.target == InvalidBBID) {
+        print(*stream, "  {} -> end\n", bbid);
+      } else {
+        auto name = GetEdgeName(succ.value.kind, succ.index);
+        print(*stream, "  {}", bbid);
+        if (!name.empty()) {
+          if (succ.index < kMaxSuccessors) {
+            print(*stream, ":{}", name);
+          } else {
+            print(*stream, ":trunc");
           }
-          print(*stream, "\n");
         }
+        print(*stream, " -> {}", succ.value.target);
+        if (succ.index >= kMaxSuccessors && !name.empty()) {
+          print(*stream, " [headlabel=\"{}\"]", name);
+        }
+        print(*stream, "\n");
       }
     }
   }
@@ -459,68 +321,6 @@ void Tool::WriteDotFile() {
   stream->flush();
 }
 
-void Tool::PushLabel(Opcode opcode, BBID br, BBID next) {
-  labels.push_back({opcode, current_bbid, br, next});
-}
-
-Label Tool::PopLabel() {
-  assert(!labels.empty());
-  Label top = labels.back();
-  labels.pop_back();
-  return top;
-}
-
-BBID Tool::NewBasicBlock() {
-  cfg.emplace_back();
-  return static_cast<BBID>(cfg.size() - 1);
-}
-
-BasicBlock& Tool::GetBasicBlock(BBID bbid) {
-  assert(bbid < cfg.size());
-  return cfg[bbid];
-}
-
-void Tool::StartBasicBlock(BBID bbid, const u8* start) {
-  if (current_bbid != InvalidBBID) {
-    EndBasicBlock(start);
-  }
-  current_bbid = bbid;
-  if (current_bbid != InvalidBBID) {
-    GetBasicBlock(current_bbid).code = SpanU8{start, start};
-  }
-}
-
-void Tool::EndBasicBlock(const u8* end) {
-  auto& bb = GetBasicBlock(current_bbid);
-  const u8* start = bb.code.data();
-  bb.code = SpanU8{start, end};
-
-  auto instrs = ReadExpression(bb.code, options.features, errors);
-  if (std::all_of(instrs.begin(), instrs.end(), IsExtraneousInstruction)) {
-    bb.code = SpanU8{};
-  }
-}
-
-void Tool::MarkUnreachable(const u8* ptr) {
-  StartBasicBlock(NewBasicBlock(), ptr);
-}
-
-void Tool::AddSuccessor(BBID bbid, const std::string& name) {
-  AddSuccessor(current_bbid, bbid, name);
-}
-
-void Tool::AddSuccessor(BBID from, BBID to, const std::string& name) {
-  GetBasicBlock(from).successors.push_back({name, to});
-}
-
-void Tool::Br(Index index, const std::string& name) {
-  if (index < labels.size()) {
-    AddSuccessor(labels[labels.size() - index - 1].br, name);
-  } else {
-    print(stderr, "Invalid branch depth: {}\n", index);
-  }
-}
-
 }  // namespace cfg
 }  // namespace tools
 }  // namespace wasp
@@ -17,11 +17,14 @@
 #ifndef WASP_TOOLS_DFG_H_
 #define WASP_TOOLS_DFG_H_
 
+#include <iosfwd>
+
 namespace wasp {
 namespace tools {
 namespace dfg {
 
 int Main(int argc, char** argv);
+int Main(int argc, char** argv, std::ostream& out, std::ostream& err);
 
 }  // namespace dfg
 }  // namespace tools
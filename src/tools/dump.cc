@@ -14,22 +14,31 @@
 // limitations under the License.
 //
 
+#include "src/tools/dump.h"
+
 #include <algorithm>
 #include <cctype>
+#include <iostream>
 #include <map>
 #include <string>
 #include <vector>
 
+#include "src/tools/args.h"
 #include "wasp/base/enumerate.h"
 #include "wasp/base/features.h"
 #include "wasp/base/file.h"
 #include "wasp/base/formatters.h"
 #include "wasp/base/macros.h"
+#include "wasp/base/str_to_u32.h"
 #include "wasp/base/string_view.h"
+#include "wasp/base/text_buffer.h"
 #include "wasp/base/types.h"
+#include "wasp/binary/code_section_index.h"
 #include "wasp/binary/data_count_section.h"
 #include "wasp/binary/errors.h"
 #include "wasp/binary/formatters.h"
+#include "wasp/binary/function_type_interner.h"
+#include "wasp/binary/instruction_text.h"
 #include "wasp/binary/lazy_code_section.h"
 #include "wasp/binary/lazy_comdat_subsection.h"
 #include "wasp/binary/lazy_data_section.h"
@@ -51,6 +60,7 @@
 #include "wasp/binary/lazy_table_section.h"
 #include "wasp/binary/lazy_type_section.h"
 #include "wasp/binary/linking_section.h"
+#include "wasp/binary/relocation_index.h"
 #include "wasp/binary/relocation_section.h"
 #include "wasp/binary/start_section.h"
 
@@ -69,16 +79,18 @@ enum class Pass {
 
 class ErrorsBasic : public Errors {
  public:
-  explicit ErrorsBasic(SpanU8 data) : data{data} {}
+  explicit ErrorsBasic(SpanU8 data, TextBuffer& out)
+      : data{data}, out(out) {}
 
  protected:
   void HandlePushContext(SpanU8 pos, string_view desc) override {}
   void HandlePopContext() override {}
   void HandleOnError(SpanU8 pos, string_view message) override {
-    print("{:08x}: {}\n", pos.data() - data.data(), message);
+    out.Print("{:08x}: {}\n", pos.data() - data.data(), message);
   }
 
   SpanU8 data;
+  TextBuffer& out;
 };
 
 struct Options {
@@ -88,15 +100,17 @@ struct Options {
   bool print_disassembly = false;
   bool print_raw_data = false;
   string_view section_name;
+  string_view function;
 };
 
 struct Tool {
-  explicit Tool(string_view filename, SpanU8 data, Options);
+  explicit Tool(string_view filename, SpanU8 data, Options, std::ostream&);
 
   using SectionIndex = u32;
 
-  void Run();
+  bool Run();
   void DoPrepass();
+  optional<Index> GetFunctionIndex() const;
   void DoPass(Pass);
   bool SectionMatches(Section) const;
   void DoSectionHeader(Pass, Section);
@@ -125,15 +139,14 @@ struct Tool {
 
   void InsertFunctionName(Index, string_view name);
   void InsertGlobalName(Index, string_view name);
-  optional<FunctionType> GetFunctionType(Index) const;
+  optional<Index> GetFunctionTypeId(Index) const;
   optional<string_view> GetFunctionName(Index) const;
   optional<string_view> GetGlobalName(Index) const;
   optional<string_view> GetSectionName(Index) const;
   optional<string_view> GetSymbolName(Index) const;
   optional<Index> GetI32Value(const ConstantExpression&);
 
-  using RelocationEntries = std::vector<RelocationEntry>;
-  optional<RelocationEntries> GetRelocationEntries(SectionIndex);
+  const RelocationIndex* GetRelocationIndex(SectionIndex) const;
 
   enum class PrintChars { No, Yes };
 
@@ -168,40 +181,51 @@ struct Tool {
   std::string filename;
   Options options;
   SpanU8 data;
+  TextBuffer out;
   ErrorsBasic errors;
   LazyModule module;
-  std::vector<TypeEntry> type_entries;
+  FunctionTypeInterner function_types;
+  std::vector<Index> type_ids;  // The interned id of each type entry.
   std::vector<Function> functions;
   std::map<Index, string_view> function_names;
   std::map<Index, string_view> global_names;
   std::map<Index, Symbol> symbol_table;
   std::map<SectionIndex, std::string> section_names;
   std::map<SectionIndex, size_t> section_starts;
-  std::map<SectionIndex, RelocationEntries> section_relocations;
+  std::map<SectionIndex, RelocationIndex> section_relocations;
   bool should_print_details = true;
   Index imported_function_count = 0;
   Index imported_table_count = 0;
   Index imported_memory_count = 0;
   Index imported_global_count = 0;
+  optional<Index> function_index;
+  CodeSectionIndex code_index;
 };
 
 // static
 constexpr int Tool::max_octets_per_line;
 
 int Main(int argc, char** argv) {
+  return Main(argc, argv, std::cout, std::cerr);
+}
+
+int Main(int argc, char** argv, std::ostream& out, std::ostream& err) {
   std::vector<string_view> filenames;
   Options options;
   options.features.EnableAll();
 
-  for (int i = 0; i < argc; ++i) {
+  int i = 0;
+  OptionValues values{argc, argv, i};
+  for (; i < argc; ++i) {
     string_view arg = argv[i];
-    if (arg[0] == '-') {
+    if (arg.size() > 1 && arg[0] == '-') {
       switch (arg[1]) {
         case 'h': options.print_headers = true; break;
         case 'd': options.print_disassembly = true; break;
         case 'x': options.print_details = true; break;
         case 's': options.print_raw_data = true; break;
-        case 'j': options.section_name = argv[++i]; break;
+        case 'j': options.section_name = values.Next(); break;
+        case 'f': options.function = values.Next(); break;
         case '-':
           if (arg == "--headers") {
             options.print_headers = true;
@@ -212,64 +236,93 @@ int Main(int argc, char** argv) {
           } else if (arg == "--full-contents") {
             options.print_raw_data = true;
           } else if (arg == "--section") {
-            options.section_name = argv[++i];
+            options.section_name = values.Next();
+          } else if (arg == "--function") {
+            options.function = values.Next();
           } else {
-            print("Unknown long argument {}\n", arg);
+            print(out, "Unknown long argument {}\n", arg);
           }
           break;
         default:
-          print("Unknown short argument {}\n", arg[0]);
+          print(out, "Unknown short argument {}\n", arg[0]);
           break;
       }
+
+      if (values.CheckMissing(arg, out)) {
+        return 1;
+      }
     } else {
       filenames.push_back(arg);
     }
   }
 
   if (filenames.empty()) {
-    print("No filenames given.\n");
+    print(out, "No filenames given.\n");
     return 1;
   }
 
   if (!(options.print_headers || options.print_disassembly ||
         options.print_details || options.print_raw_data)) {
-    print("At least one of the following switches must be given:\n");
-    print(" -d/--disassemble\n");
-    print(" -h/--headers\n");
-    print(" -x/--details\n");
-    print(" -s/--full-contents\n");
+    print(out, "At least one of the following switches must be given:\n");
+    print(out, " -d/--disassemble\n");
+    print(out, " -h/--headers\n");
+    print(out, " -x/--details\n");
+    print(out, " -s/--full-contents\n");
     return 1;
   }
 
+  int result = 0;
   for (auto filename : filenames) {
-    auto optbuf = ReadFile(filename);
-    if (!optbuf) {
-      print("Error reading file {}.\n", filename);
+    auto optfile = MapFile(filename);
+    if (!optfile) {
+      print(out, "Error reading file {}.\n", filename);
+      result = 1;
       continue;
     }
 
-    SpanU8 data{*optbuf};
-    Tool tool{filename, data, options};
-    tool.Run();
+    SpanU8 data = optfile->data();
+    Tool tool{filename, data, options, out};
+    if (!tool.Run()) {
+      result = 1;
+    }
   }
 
-  return 0;
+  return result;
 }
 
-Tool::Tool(string_view filename, SpanU8 data, Options options)
+Tool::Tool(string_view filename,
+           SpanU8 data,
+           Options options,
+           std::ostream& stream)
     : filename(filename),
       options{options},
       data{data},
-      errors{data},
+      out{stream},
+      errors{data, out},
       module{ReadModule(data, options.features, errors)} {}
 
-void Tool::Run() {
+bool Tool::Run() {
   if (!(module.magic && module.version)) {
-    return;
+    return false;
   }
 
-  print("\n{}:\tfile format wasm {}\n", filename, *module.version);
+  out.Print("\n{}:\tfile format wasm {}\n", filename, *module.version);
   DoPrepass();
+  if (!options.function.empty()) {
+    function_index = GetFunctionIndex();
+    if (!function_index) {
+      out.Print("Unknown function {}\n", options.function);
+      return false;
+    }
+    if (*function_index < imported_function_count) {
+      out.Print("Function {} is imported\n", *function_index);
+      return false;
+    }
+    if (*function_index - imported_function_count >= code_index.size()) {
+      out.Print("Invalid function index {}\n", *function_index);
+      return false;
+    }
+  }
   if (options.print_headers) {
     DoPass(Pass::Headers);
   }
@@ -282,6 +335,7 @@ void Tool::Run() {
   if (options.print_raw_data) {
     DoPass(Pass::RawData);
   }
+  return true;
 }
 
 void Tool::DoPrepass() {
@@ -293,8 +347,9 @@ void Tool::DoPrepass() {
       section_names[section.index] = format("{}", known.id);
       switch (known.id) {
         case SectionId::Type: {
-          auto seq = ReadTypeSection(known, features, errors).sequence;
-          std::copy(seq.begin(), seq.end(), std::back_inserter(type_entries));
+          for (auto entry : ReadTypeSection(known, features, errors).sequence) {
+            type_ids.push_back(function_types.Intern(entry.type));
+          }
           break;
         }
 
@@ -332,6 +387,12 @@ void Tool::DoPrepass() {
           break;
         }
 
+        case SectionId::Code:
+          if (!options.function.empty()) {
+            code_index = CodeSectionIndex{known, features, errors};
+          }
+          break;
+
         case SectionId::Export: {
           for (auto export_ :
                ReadExportSection(known, features, errors).sequence) {
@@ -400,26 +461,37 @@ void Tool::DoPrepass() {
       } else if (custom.name.starts_with("reloc.")) {
         auto sec = ReadRelocationSection(custom, features, errors);
         if (sec.section_index) {
-          section_relocations[*sec.section_index] =
-              RelocationEntries{sec.entries.begin(), sec.entries.end()};
+          section_relocations[*sec.section_index] = RelocationIndex{sec};
         }
       }
     }
   }
 }
 
+optional<Index> Tool::GetFunctionIndex() const {
+  // Search by name.
+  for (const auto& pair : function_names) {
+    if (pair.second == options.function) {
+      return pair.first;
+    }
+  }
+
+  // Try to convert the string to an integer and search by index.
+  return StrToU32(options.function);
+}
+
 void Tool::DoPass(Pass pass) {
   switch (pass) {
     case Pass::Headers:
-      print("\nSections:\n\n");
+      out.Print("\nSections:\n\n");
       break;
 
     case Pass::Details:
-      print("\nSection Details:\n\n");
+      out.Print("\nSection Details:\n\n");
       break;
 
     case Pass::Disassemble:
-      print("\nCode Disassembly:\n\n");
+      out.Print("\nCode Disassembly:\n\n");
       break;
 
     case Pass::RawData:
@@ -545,11 +617,11 @@ void Tool::DoCustomSection(Pass pass,
   const Features& features = options.features;
   switch (pass) {
     case Pass::Headers:
-      print("\"{}\"\n", custom.name);
+      out.Print("\"{}\"\n", custom.name);
       break;
 
     case Pass::Details:
-      print(":\n - name: \"{}\"\n", custom.name);
+      out.Print(":\n - name: \"{}\"\n", custom.name);
       if (custom.name == "name") {
         DoNameSection(pass, section_index,
                       ReadNameSection(custom, features, errors));
@@ -575,13 +647,13 @@ void Tool::DoSectionHeader(Pass pass,
   auto size = data.size();
   switch (pass) {
     case Pass::Headers: {
-      print("{:>9} start={:#010x} end={:#010x} (size={:#010x}) ", id, offset,
-            offset + size, size);
+      out.Print("{:>9} start={:#010x} end={:#010x} (size={:#010x}) ", id,
+                offset, offset + size, size);
       break;
     }
 
     case Pass::Details:
-      print("{}", id);
+      out.Print("{}", id);
       break;
 
     case Pass::Disassemble:
@@ -589,9 +661,10 @@ void Tool::DoSectionHeader(Pass pass,
 
     case Pass::RawData: {
       if (section.is_custom()) {
-        print("\nContents of custom section ({}):\n", section.custom().name);
+        out.Print("\nContents of custom section ({}):\n",
+                  section.custom().name);
       } else {
-        print("\nContents of section {}:\n", id);
+        out.Print("\nContents of section {}:\n", id);
       }
       PrintMemory(data, offset, PrintChars::Yes);
       break;
@@ -606,7 +679,7 @@ void Tool::DoTypeSection(Pass pass,
   if (ShouldPrintDetails(pass)) {
     Index count = 0;
     for (auto type_entry : section.sequence) {
-      print(" - type[{}] {}\n", count++, type_entry);
+      out.Print(" - type[{}] {}\n", count++, type_entry);
     }
   }
 }
@@ -623,31 +696,31 @@ void Tool::DoImportSection(Pass pass,
     for (auto import : section.sequence) {
       switch (import.kind()) {
         case ExternalKind::Function: {
-          print(" - func[{}] sig={}", function_count, import.index());
+          out.Print(" - func[{}] sig={}", function_count, import.index());
           PrintFunctionName(function_count);
           ++function_count;
           break;
         }
 
         case ExternalKind::Table: {
-          print(" - table[{}] {}", table_count, import.table_type());
+          out.Print(" - table[{}] {}", table_count, import.table_type());
           ++table_count;
           break;
         }
 
         case ExternalKind::Memory: {
-          print(" - memory[{}] {}", memory_count, import.memory_type());
+          out.Print(" - memory[{}] {}", memory_count, import.memory_type());
           ++memory_count;
           break;
         }
 
         case ExternalKind::Global: {
-          print(" - global[{}] {}", global_count, import.global_type());
+          out.Print(" - global[{}] {}", global_count, import.global_type());
           ++global_count;
           break;
         }
       }
-      print(" <- {}.{}\n", import.module, import.name);
+      out.Print(" <- {}.{}\n", import.module, import.name);
     }
   }
 }
@@ -658,9 +731,9 @@ void Tool::DoFunctionSection(Pass pass,
   DoCount(pass, section.count);
   if (ShouldPrintDetails(pass)) {
     for (auto func : enumerate(section.sequence, imported_function_count)) {
-      print(" - func[{}] sig={}", func.index, func.value.type_index);
+      out.Print(" - func[{}] sig={}", func.index, func.value.type_index);
       PrintFunctionName(func.index);
-      print("\n");
+      out.Print("\n");
     }
   }
 }
@@ -671,7 +744,7 @@ void Tool::DoTableSection(Pass pass,
   DoCount(pass, section.count);
   if (ShouldPrintDetails(pass)) {
     for (auto table : enumerate(section.sequence, imported_table_count)) {
-      print(" - table[{}] {}\n", table.index, table.value.table_type);
+      out.Print(" - table[{}] {}\n", table.index, table.value.table_type);
     }
   }
 }
@@ -682,7 +755,7 @@ void Tool::DoMemorySection(Pass pass,
   DoCount(pass, section.count);
   if (ShouldPrintDetails(pass)) {
     for (auto memory : enumerate(section.sequence, imported_memory_count)) {
-      print(" - memory[{}] {}\n", memory.index, memory.value.memory_type);
+      out.Print(" - memory[{}] {}\n", memory.index, memory.value.memory_type);
     }
   }
 }
@@ -693,8 +766,8 @@ void Tool::DoGlobalSection(Pass pass,
   DoCount(pass, section.count);
   if (ShouldPrintDetails(pass)) {
     for (auto global : enumerate(section.sequence, imported_global_count)) {
-      print(" - global[{}] {} - {}\n", global.index, global.value.global_type,
-            global.value.init);
+      out.Print(" - global[{}] {} - {}\n", global.index,
+                global.value.global_type, global.value.init);
     }
   }
 }
@@ -705,11 +778,11 @@ void Tool::DoExportSection(Pass pass,
   DoCount(pass, section.count);
   if (ShouldPrintDetails(pass)) {
     for (auto export_ : section.sequence) {
-      print(" - {}[{}]", export_.kind, export_.index);
+      out.Print(" - {}[{}]", export_.kind, export_.index);
       if (export_.kind == ExternalKind::Function) {
         PrintFunctionName(export_.index);
       }
-      print(" -> \"{}\"\n", export_.name);
+      out.Print(" -> \"{}\"\n", export_.name);
     }
   }
 }
@@ -720,7 +793,7 @@ void Tool::DoStartSection(Pass pass,
   if (section) {
     auto start = *section;
     if (pass == Pass::Headers) {
-      print("start: {}\n", start.func_index);
+      out.Print("start: {}\n", start.func_index);
     } else {
       PrintDetails(pass, " - start function: {}\n", start.func_index);
     }
@@ -736,21 +809,23 @@ void Tool::DoElementSection(Pass pass,
       Index offset = 0;
       if (segment.value.is_active()) {
         const auto& active = segment.value.active();
-        print(" - segment[{}] table={} count={} - init {}\n", segment.index,
-              active.table_index, active.init.size(), active.offset);
+        out.Print(" - segment[{}] table={} count={} - init {}\n",
+                  segment.index, active.table_index, active.init.size(),
+                  active.offset);
         offset = GetI32Value(active.offset).value_or(0);
         for (auto element : enumerate(active.init)) {
-          print("  - elem[{}] = func[{}]", offset + element.index,
-                element.value);
+          out.Print("  - elem[{}] = func[{}]", offset + element.index,
+                    element.value);
           PrintFunctionName(element.value);
-          print("\n");
+          out.Print("\n");
         }
       } else {
         const auto& passive = segment.value.passive();
-        print(" - segment[{}] count={} element_type={} passive\n",
-              segment.index, passive.element_type, passive.init.size());
+        out.Print(" - segment[{}] count={} element_type={} passive\n",
+                  segment.index, passive.element_type, passive.init.size());
         for (auto element : enumerate(passive.init)) {
-          print("  - elem[{}] = {}\n", offset + element.index, element.value);
+          out.Print("  - elem[{}] = {}\n", offset + element.index,
+                    element.value);
         }
       }
     }
@@ -763,9 +838,19 @@ void Tool::DoCodeSection(Pass pass,
   DoCount(pass, section.count);
   if (ShouldPrintDetails(pass)) {
     for (auto code : enumerate(section.sequence, imported_function_count)) {
-      print(" - func[{}] size={}\n", code.index, code.value.body.data.size());
+      out.Print(" - func[{}] size={}\n", code.index,
+                code.value.body.data.size());
     }
   } else if (pass == Pass::Disassemble) {
+    if (function_index) {
+      // Run has already checked that the index names a defined function.
+      auto code = code_index.GetCode(*function_index - imported_function_count,
+                                     options.features, errors);
+      if (code) {
+        Disassemble(section_index, *function_index, *code);
+      }
+      return;
+    }
     for (auto code : enumerate(section.sequence, imported_function_count)) {
       Disassemble(section_index, code.index, code.value);
     }
@@ -781,12 +866,13 @@ void Tool::DoDataSection(Pass pass,
       Index offset = 0;
       if (segment.value.is_active()) {
         const auto& active = segment.value.active();
-        print(" - segment[{}] memory={} size={} - init {}\n", segment.index,
-              active.memory_index, segment.value.init.size(), active.offset);
+        out.Print(" - segment[{}] memory={} size={} - init {}\n",
+                  segment.index, active.memory_index,
+                  segment.value.init.size(), active.offset);
         offset = GetI32Value(active.offset).value_or(0);
       } else {
-        print(" - segment[{}] size={} passive\n", segment.index,
-              segment.value.init.size());
+        out.Print(" - segment[{}] size={} passive\n", segment.index,
+                  segment.value.init.size());
       }
       PrintMemory(segment.value.init, offset, PrintChars::Yes, "  - ");
     }
@@ -799,7 +885,7 @@ void Tool::DoDataCountSection(Pass pass,
   if (section) {
     auto data_count = *section;
     if (pass == Pass::Headers) {
-      print("count: {}\n", data_count.count);
+      out.Print("count: {}\n", data_count.count);
     } else {
       PrintDetails(pass, " - data count: {}\n", data_count.count);
     }
@@ -815,18 +901,18 @@ void Tool::DoNameSection(Pass pass,
       case NameSubsectionId::ModuleName: {
         auto module_name =
             ReadModuleNameSubsection(subsection.data, features, errors);
-        print("  module name: {}\n", module_name.value_or(""));
+        out.Print("  module name: {}\n", module_name.value_or(""));
         break;
       }
 
       case NameSubsectionId::FunctionNames: {
         auto function_names_subsection =
             ReadFunctionNamesSubsection(subsection.data, features, errors);
-        print("  function names[{}]:\n",
-              function_names_subsection.count.value_or(0));
+        out.Print("  function names[{}]:\n",
+                  function_names_subsection.count.value_or(0));
         for (auto name_assoc : enumerate(function_names_subsection.sequence)) {
-          print("   - [{}]: func[{}] name=\"{}\"\n", name_assoc.index,
-                name_assoc.value.index, name_assoc.value.name);
+          out.Print("   - [{}]: func[{}] name=\"{}\"\n", name_assoc.index,
+                    name_assoc.value.index, name_assoc.value.name);
         }
         break;
       }
@@ -834,16 +920,17 @@ void Tool::DoNameSection(Pass pass,
       case NameSubsectionId::LocalNames: {
         auto local_names_subsection =
             ReadLocalNamesSubsection(subsection.data, features, errors);
-        print("  local names[{}]:\n", local_names_subsection.count.value_or(0));
+        out.Print("  local names[{}]:\n",
+                  local_names_subsection.count.value_or(0));
         for (auto indirect_name_assoc :
              enumerate(local_names_subsection.sequence)) {
-          print("   - [{}]: func[{}] count={}\n", indirect_name_assoc.index,
-                indirect_name_assoc.value.index,
-                indirect_name_assoc.value.name_map.size());
+          out.Print("   - [{}]: func[{}] count={}\n",
+                    indirect_name_assoc.index, indirect_name_assoc.value.index,
+                    indirect_name_assoc.value.name_map.size());
           for (auto name_assoc :
                enumerate(indirect_name_assoc.value.name_map)) {
-            print("     - [{}]: local[{}] name=\"{}\"\n", name_assoc.index,
-                  name_assoc.value.index, name_assoc.value.name);
+            out.Print("     - [{}]: local[{}] name=\"{}\"\n", name_assoc.index,
+                      name_assoc.value.index, name_assoc.value.name);
           }
         }
         break;
@@ -862,12 +949,12 @@ void Tool::DoLinkingSection(Pass pass,
         if (ShouldPrintDetails(pass)) {
           auto segment_infos =
               ReadSegmentInfoSubsection(subsection.data, features, errors);
-          print(" - segment info [count={}]\n",
-                segment_infos.count.value_or(0));
+          out.Print(" - segment info [count={}]\n",
+                    segment_infos.count.value_or(0));
           for (auto segment_info : enumerate(segment_infos.sequence)) {
-            print("  - {}: {} p2align={} flags={:#x}\n", segment_info.index,
-                  segment_info.value.name, segment_info.value.align_log2,
-                  segment_info.value.flags);
+            out.Print("  - {}: {} p2align={} flags={:#x}\n",
+                      segment_info.index, segment_info.value.name,
+                      segment_info.value.align_log2, segment_info.value.flags);
           }
         }
         break;
@@ -877,11 +964,11 @@ void Tool::DoLinkingSection(Pass pass,
         if (ShouldPrintDetails(pass)) {
           auto init_functions =
               ReadInitFunctionsSubsection(subsection.data, features, errors);
-          print(" - init functions [count={}]\n",
-                init_functions.count.value_or(0));
+          out.Print(" - init functions [count={}]\n",
+                    init_functions.count.value_or(0));
           for (auto init_function : init_functions.sequence) {
-            print("  - {}: priority={}\n", init_function.index,
-                  init_function.priority);
+            out.Print("  - {}: priority={}\n", init_function.index,
+                      init_function.priority);
           }
         }
         break;
@@ -891,14 +978,14 @@ void Tool::DoLinkingSection(Pass pass,
         if (ShouldPrintDetails(pass)) {
           auto comdats =
               ReadComdatSubsection(subsection.data, features, errors);
-          print(" - comdat [count={}]\n", comdats.count.value_or(0));
+          out.Print(" - comdat [count={}]\n", comdats.count.value_or(0));
           for (auto comdat : enumerate(comdats.sequence)) {
-            print("  - {}: \"{}\" flags={:#x} [count={}]\n", comdat.index,
-                  comdat.value.name, comdat.value.flags,
-                  comdat.value.symbols.size());
+            out.Print("  - {}: \"{}\" flags={:#x} [count={}]\n", comdat.index,
+                      comdat.value.name, comdat.value.flags,
+                      comdat.value.symbols.size());
             for (auto symbol : enumerate(comdat.value.symbols)) {
-              print("   - {}: {} index={}\n", symbol.index, symbol.value.kind,
-                    symbol.value.index);
+              out.Print("   - {}: {} index={}\n", symbol.index,
+                        symbol.value.kind, symbol.value.index);
             }
           }
         }
@@ -909,33 +996,33 @@ void Tool::DoLinkingSection(Pass pass,
         if (ShouldPrintDetails(pass)) {
           auto print_symbol_flags = [&](SymbolInfo::Flags flags) {
             if (flags.undefined == SymbolInfo::Flags::Undefined::Yes) {
-              print(" {}", flags.undefined);
+              out.Print(" {}", flags.undefined);
             }
-            print(" binding={} vis={}", flags.binding, flags.visibility);
+            out.Print(" binding={} vis={}", flags.binding, flags.visibility);
             if (flags.explicit_name == SymbolInfo::Flags::ExplicitName::Yes) {
-              print(" {}", flags.explicit_name);
+              out.Print(" {}", flags.explicit_name);
             }
           };
 
           auto symbol_table =
               ReadSymbolTableSubsection(subsection.data, features, errors);
-          print(" - symbol table [count={}]\n",
-                symbol_table.count.value_or(0));
+          out.Print(" - symbol table [count={}]\n",
+                    symbol_table.count.value_or(0));
           for (auto symbol : enumerate(symbol_table.sequence)) {
             switch (symbol.value.kind()) {
               case SymbolInfoKind::Function: {
                 const auto& base = symbol.value.base();
-                print("  - {}: F <{}> func={}", symbol.index,
-                      base.name.value_or(
-                          GetFunctionName(base.index).value_or("")),
-                      base.index);
+                out.Print("  - {}: F <{}> func={}", symbol.index,
+                          base.name.value_or(
+                              GetFunctionName(base.index).value_or("")),
+                          base.index);
                 print_symbol_flags(symbol.value.flags);
                 break;
               }
 
               case SymbolInfoKind::Global: {
                 const auto& base = symbol.value.base();
-                print(
+                out.Print(
                     "  - {}: G <{}> global={}", symbol.index,
                     base.name.value_or(GetGlobalName(base.index).value_or("")),
                     base.index);
@@ -946,18 +1033,19 @@ void Tool::DoLinkingSection(Pass pass,
               case SymbolInfoKind::Event: {
                 const auto& base = symbol.value.base();
                 // TODO GetEventName.
-                print("  - {}: E <{}> event={}", symbol.index,
-                      base.name.value_or(""), base.index);
+                out.Print("  - {}: E <{}> event={}", symbol.index,
+                          base.name.value_or(""), base.index);
                 print_symbol_flags(symbol.value.flags);
                 break;
               }
 
               case SymbolInfoKind::Data: {
                 const auto& data = symbol.value.data();
-                print("  - {}: D <{}>", symbol.index, data.name);
+                out.Print("  - {}: D <{}>", symbol.index, data.name);
                 if (data.defined) {
-                  print(" segment={} offset={} size={}", data.defined->index,
-                        data.defined->offset, data.defined->size);
+                  out.Print(" segment={} offset={} size={}",
+                            data.defined->index, data.defined->offset,
+                            data.defined->size);
                 }
                 print_symbol_flags(symbol.value.flags);
                 break;
@@ -965,14 +1053,14 @@ void Tool::DoLinkingSection(Pass pass,
 
               case SymbolInfoKind::Section: {
                 auto section_index = symbol.value.section().section;
-                print("  - {}: S <{}> section={}", symbol.index,
-                      GetSectionName(section_index).value_or(""),
-                      section_index);
+                out.Print("  - {}: S <{}> section={}", symbol.index,
+                          GetSectionName(section_index).value_or(""),
+                          section_index);
                 print_symbol_flags(symbol.value.flags);
                 break;
               }
             }
-            print("\n");
+            out.Print("\n");
           }
         }
         break;
@@ -997,25 +1085,25 @@ void Tool::DoRelocationSection(Pass pass,
       total_offset += start->second;
     }
     if (ShouldPrintDetails(pass)) {
-      print("   - {:18s} offset={:#08x}(file={:#08x}) ", entry.type,
-            entry.offset, total_offset);
+      out.Print("   - {:18s} offset={:#08x}(file={:#08x}) ", entry.type,
+                entry.offset, total_offset);
       if (entry.type == RelocationType::TypeIndexLEB) {
-        print("type={}", entry.index);
+        out.Print("type={}", entry.index);
       } else {
-        print("symbol={} <{}>", entry.index,
-              GetSymbolName(entry.index).value_or(""));
+        out.Print("symbol={} <{}>", entry.index,
+                  GetSymbolName(entry.index).value_or(""));
       }
       if (entry.addend && *entry.addend != 0) {
-        print("{:+#x}", *entry.addend);
+        out.Print("{:+#x}", *entry.addend);
       }
-      print("\n");
+      out.Print("\n");
     }
   }
 }
 
 void Tool::DoCount(Pass pass, optional<Index> count) {
   if (pass == Pass::Headers) {
-    print("count: {}\n", count.value_or(0));
+    out.Print("count: {}\n", count.value_or(0));
   } else {
     PrintDetails(pass, "[{}]:\n", count.value_or(0));
   }
@@ -1031,13 +1119,10 @@ void Tool::Disassemble(SectionIndex section_index,
     return file_offset(data) - section_start;
   };
   auto last_data = code.body.data;
-  auto relocs =
-      GetRelocationEntries(section_index).value_or(RelocationEntries{});
-  auto reloc_it =
-      std::lower_bound(relocs.begin(), relocs.end(), section_offset(last_data),
-                       [&](const RelocationEntry& lhs, size_t offset) {
-                         return lhs.offset < offset;
-                       });
+  RelocationIndex::Cursor relocs;
+  if (auto* index = GetRelocationIndex(section_index)) {
+    relocs = index->GetCursor(section_offset(last_data));
+  }
   auto instrs = ReadExpression(code.body, options.features, errors);
   for (auto it = instrs.begin(), end = instrs.end(); it != end; ++it) {
     const auto& instr = *it;
@@ -1047,10 +1132,8 @@ void Tool::Disassemble(SectionIndex section_index,
     }
     PrintInstruction(instr, last_data, it.data(), indent);
     last_data = it.data();
-    for (; reloc_it < relocs.end() &&
-           reloc_it->offset < section_offset(it.data());
-         ++reloc_it) {
-      PrintRelocation(*reloc_it, section_start + reloc_it->offset);
+    for (const auto& entry : relocs.AdvanceTo(section_offset(it.data()))) {
+      PrintRelocation(entry, section_start + entry.offset);
     }
     if (opcode == Opcode::Block || opcode == Opcode::If ||
         opcode == Opcode::Loop || opcode == Opcode::Else) {
@@ -1067,12 +1150,12 @@ void Tool::InsertGlobalName(Index index, string_view name) {
   global_names.insert(std::make_pair(index, name));
 }
 
-optional<FunctionType> Tool::GetFunctionType(Index func_index) const {
+optional<Index> Tool::GetFunctionTypeId(Index func_index) const {
   if (func_index >= functions.size() ||
-      functions[func_index].type_index >= type_entries.size()) {
+      functions[func_index].type_index >= type_ids.size()) {
     return nullopt;
   }
-  return type_entries[functions[func_index].type_index].type;
+  return type_ids[functions[func_index].type_index];
 }
 
 optional<string_view> Tool::GetFunctionName(Index index) const {
@@ -1137,13 +1220,13 @@ optional<Index> Tool::GetI32Value(const ConstantExpression& expr) {
   }
 }
 
-optional<Tool::RelocationEntries> Tool::GetRelocationEntries(
-    SectionIndex section_index) {
+const RelocationIndex* Tool::GetRelocationIndex(
+    SectionIndex section_index) const {
   auto it = section_relocations.find(section_index);
   if (it != section_relocations.end()) {
-    return it->second;
+    return &it->second;
   } else {
-    return nullopt;
+    return nullptr;
   }
 }
 
@@ -1154,19 +1237,23 @@ bool Tool::ShouldPrintDetails(Pass pass) const {
 template <typename... Args>
 void Tool::PrintDetails(Pass pass, const char* format, const Args&... args) {
   if (ShouldPrintDetails(pass)) {
-    vprint(format, make_format_args(args...));
+    out.Print(format, args...);
   }
 }
 
 void Tool::PrintFunctionName(Index func_index) {
   if (auto name = GetFunctionName(func_index)) {
-    print(" <{}>", *name);
+    out.Append(" <");
+    out.Append(*name);
+    out.Append('>');
   }
 }
 
 void Tool::PrintGlobalName(Index func_index) {
   if (auto name = GetGlobalName(func_index)) {
-    print(" <{}>", *name);
+    out.Append(" <");
+    out.Append(*name);
+    out.Append('>');
   }
 }
 
@@ -1180,49 +1267,53 @@ void Tool::PrintMemory(SpanU8 start,
   while (!data.empty()) {
     auto line_size = std::min<size_t>(data.size(), octets_per_line);
     const SpanU8 line = data.subspan(0, line_size);
-    print("{}", prefix);
-    print("{:07x}: ", (line.begin() - start.begin()) + offset);
+    out.Append(prefix);
+    out.AppendHex((line.begin() - start.begin()) + offset, 7);
+    out.Append(": ");
     for (int i = 0; i < octets_per_line;) {
       for (int j = 0; j < octets_per_group; ++j, ++i) {
         if (i < line.size()) {
-          print("{:02x}", line[i]);
+          out.AppendHex(line[i], 2);
         } else {
-          print("  ");
+          out.Append("  ");
         }
       }
-      print(" ");
+      out.Append(' ');
     }
 
     if (print_chars == PrintChars::Yes) {
-      print(" ");
+      out.Append(' ');
       for (int c : line) {
-        print("{:c}", isprint(c) ? static_cast<char>(c) : '.');
+        out.Append(isprint(c) ? static_cast<char>(c) : '.');
       }
     }
-    print("\n");
+    out.Append('\n');
     remove_prefix(&data, line_size);
   }
 }
 
 void Tool::PrintFunctionHeader(Index func_index, Code code) {
-  auto func_type = GetFunctionType(func_index);
+  auto type_id = GetFunctionTypeId(func_index);
   size_t param_count = 0;
-  print("func[{}]", func_index);
+  out.Print("func[{}]", func_index);
   PrintFunctionName(func_index);
-  print(":");
-  if (func_type) {
-    print(" {}\n", *func_type);
-    param_count = func_type->param_types.size();
+  out.Print(":");
+  if (type_id) {
+    auto param_types = function_types.param_types(*type_id);
+    out.Print(" {} -> {}\n", param_types,
+              function_types.result_types(*type_id));
+    param_count = param_types.size();
   } else {
-    print("\n");
+    out.Print("\n");
   }
   size_t local_count = param_count;
   for (auto locals : code.locals) {
-    print(" {:{}s} | locals[{}", "", 7 + max_octets_per_line * 3, local_count);
+    out.Print(" {:{}s} | locals[{}", "", 7 + max_octets_per_line * 3,
+              local_count);
     if (locals.count != 1) {
-      print("..{}", local_count + locals.count - 1);
+      out.Print("..{}", local_count + locals.count - 1);
     }
-    print("] type={}\n", locals.type);
+    out.Print("] type={}\n", locals.type);
     local_count += locals.count;
   }
 }
@@ -1233,17 +1324,22 @@ void Tool::PrintInstruction(const Instruction& instr,
                             int indent) {
   bool first_line = true;
   while (data.begin() < post_data.begin()) {
-    print(" {:06x}:", file_offset(data));
+    out.Append(' ');
+    out.AppendHex(file_offset(data), 6);
+    out.Append(':');
     int line_octets =
         std::min<int>(max_octets_per_line, post_data.begin() - data.begin());
     for (int i = 0; i < line_octets; ++i) {
-      print(" {:02x}", data[i]);
+      out.Append(' ');
+      out.AppendHex(data[i], 2);
     }
     remove_prefix(&data, line_octets);
-    print("{:{}s} |", "", (max_octets_per_line - line_octets) * 3);
+    out.AppendSpaces((max_octets_per_line - line_octets) * 3);
+    out.Append(" |");
     if (first_line) {
       first_line = false;
-      print(" {:{}s}{}", "", indent, instr);
+      out.AppendSpaces(1 + indent);
+      AppendInstruction(out, instr);
       if (instr.opcode == Opcode::Call) {
         PrintFunctionName(instr.index_immediate());
       } else if (instr.opcode == Opcode::GlobalGet ||
@@ -1251,19 +1347,20 @@ void Tool::PrintInstruction(const Instruction& instr,
         PrintGlobalName(instr.index_immediate());
       }
     }
-    print("\n");
+    out.Append('\n');
   }
 }
 
 void Tool::PrintRelocation(const RelocationEntry& entry, size_t file_offset) {
-  print("           {:06x}: {:18s} {}", file_offset, entry.type, entry.index);
+  out.Print("           {:06x}: {:18s} {}", file_offset, entry.type,
+            entry.index);
   if (entry.addend && *entry.addend) {
-    print(" {:+d}", *entry.addend);
+    out.Print(" {:+d}", *entry.addend);
   }
   if (entry.type != RelocationType::TypeIndexLEB) {
-    print(" <{}>", GetSymbolName(entry.index).value_or(""));
+    out.Print(" <{}>", GetSymbolName(entry.index).value_or(""));
   }
-  print("\n");
+  out.Print("\n");
 }
 
 size_t Tool::file_offset(SpanU8 data) {
@@ -17,11 +17,14 @@
 #ifndef WASP_TOOLS_DUMP_H_
 #define WASP_TOOLS_DUMP_H_
 
+#include <iosfwd>
+
 namespace wasp {
 namespace tools {
 namespace dump {
 
 int Main(int argc, char** argv);
+int Main(int argc, char** argv, std::ostream& out, std::ostream& err);
 
 }  // namespace dump
 }  // namespace tools
@@ -0,0 +1,295 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/tools/strip.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WASP_HAS_POSIX_FILES 1
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define WASP_HAS_POSIX_FILES 0
+#endif
+
+#include "src/tools/args.h"
+#include "wasp/base/features.h"
+#include "wasp/base/file.h"
+#include "wasp/base/format.h"
+#include "wasp/base/formatters.h"
+#include "wasp/base/string_view.h"
+#include "wasp/binary/errors.h"
+#include "wasp/binary/formatters.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/rewrite_module.h"
+
+namespace wasp {
+namespace tools {
+namespace strip {
+
+using namespace ::wasp::binary;
+
+struct Options {
+  Features features;
+  string_view output_filename;
+  // Sections to remove. Empty means all custom sections.
+  std::vector<string_view> sections;
+};
+
+class ErrorsStderr : public Errors {
+ protected:
+  void HandlePushContext(SpanU8 pos, string_view desc) override {}
+  void HandlePopContext() override {}
+  void HandleOnError(SpanU8 pos, string_view message) override {
+    print(std::cerr, "*** Error: {}\n", message);
+  }
+};
+
+struct Tool {
+  explicit Tool(string_view filename, SpanU8 data, Options);
+
+  int Run();
+  bool Write(std::ostream&);
+  int WriteInPlace(const std::string& output_filename);
+  bool ShouldStrip(const Section&) const;
+
+  ErrorsStderr errors;
+  string_view filename;
+  Options options;
+  LazyModule module;
+};
+
+int Main(int argc, char** argv) {
+  string_view filename;
+  Options options;
+  options.features.EnableAll();
+
+  int i = 0;
+  OptionValues values{argc, argv, i};
+
+  for (; i < argc; ++i) {
+    string_view arg = argv[i];
+    if (arg.size() > 1 && arg[0] == '-') {
+      switch (arg[1]) {
+        case 'o': options.output_filename = values.Next(); break;
+        case 's': options.sections.push_back(values.Next()); break;
+        case '-':
+          if (arg == "--output") {
+            options.output_filename = values.Next();
+          } else if (arg == "--section") {
+            options.sections.push_back(values.Next());
+          } else {
+            print(std::cerr, "Unknown long argument {}\n", arg);
+          }
+          break;
+        default:
+          print(std::cerr, "Unknown short argument {}\n", arg[0]);
+          break;
+      }
+
+      if (values.CheckMissing(arg, std::cerr)) {
+        return 1;
+      }
+    } else {
+      if (filename.empty()) {
+        filename = arg;
+      } else {
+        print(std::cerr, "Filename already given\n");
+      }
+    }
+  }
+
+  if (filename.empty()) {
+    print(std::cerr, "No filenames given.\n");
+    return 1;
+  }
+
+  if (options.output_filename.empty()) {
+    print(std::cerr, "No output filename given.\n");
+    return 1;
+  }
+
+  auto optfile = MapFile(filename);
+  if (!optfile) {
+    print(std::cerr, "Error reading file {}.\n", filename);
+    return 1;
+  }
+
+  SpanU8 data = optfile->data();
+  Tool tool{filename, data, options};
+  return tool.Run();
+}
+
+Tool::Tool(string_view filename, SpanU8 data, Options options)
+    : filename{filename},
+      options{options},
+      module{ReadModule(data, options.features, errors)} {}
+
+namespace {
+
+#if WASP_HAS_POSIX_FILES
+
+// Returns true if |output| names the same regular file as |input|, so that
+// opening it for writing would truncate the mapped input.
+bool IsSameRegularFile(const std::string& input, const std::string& output) {
+  struct stat input_st, output_st;
+  return stat(input.c_str(), &input_st) == 0 &&
+         stat(output.c_str(), &output_st) == 0 &&
+         S_ISREG(output_st.st_mode) && input_st.st_dev == output_st.st_dev &&
+         input_st.st_ino == output_st.st_ino;
+}
+
+#else
+
+bool IsSameRegularFile(const std::string&, const std::string&) {
+  return false;
+}
+
+#endif
+
+}  // namespace
+
+int Tool::Run() {
+  const std::string output_filename = options.output_filename.to_string();
+  if (IsSameRegularFile(filename.to_string(), output_filename)) {
+    return WriteInPlace(output_filename);
+  }
+
+  std::ofstream stream{output_filename, std::ios::out | std::ios::binary};
+  if (!stream) {
+    print(std::cerr, "Error opening file {}.\n", output_filename);
+    return 1;
+  }
+  bool ok = Write(stream);
+  stream.close();
+  if (!stream) {
+    print(std::cerr, "Error writing file {}.\n", output_filename);
+    return 1;
+  }
+  return ok ? 0 : 1;
+}
+
+bool Tool::Write(std::ostream& stream) {
+  return RewriteModule(
+      module,
+      [this](const Section& section, WriteBuffer&) {
+        return ShouldStrip(section) ? SectionAction::Drop
+                                    : SectionAction::Keep;
+      },
+      [&](SpanU8 span) {
+        stream.write(reinterpret_cast<const char*>(span.data()),
+                     static_cast<std::streamsize>(span.size()));
+      });
+}
+
+#if WASP_HAS_POSIX_FILES
+
+// The input is still mapped while the output is written, so write to a new
+// temporary file next to it and rename that over the input. The temporary
+// file takes the input's mode and (where permitted) its owner.
+int Tool::WriteInPlace(const std::string& output_filename) {
+  struct stat st;
+  if (stat(output_filename.c_str(), &st) != 0) {
+    print(std::cerr, "Error opening file {}.\n", output_filename);
+    return 1;
+  }
+
+  std::string temp_filename = output_filename + ".XXXXXX";
+  int fd = mkstemp(&temp_filename[0]);
+  if (fd < 0) {
+    print(std::cerr, "Error creating temporary file for {}.\n",
+          output_filename);
+    return 1;
+  }
+  if (fchown(fd, st.st_uid, st.st_gid) != 0) {
+    // Only the owner's group or root may change ownership; keep our own.
+  }
+  fchmod(fd, st.st_mode & 07777);
+  close(fd);
+
+  std::ofstream stream{temp_filename, std::ios::out | std::ios::binary};
+  bool ok = stream && Write(stream);
+  stream.close();
+  if (!stream) {
+    print(std::cerr, "Error writing file {}.\n", temp_filename);
+    ok = false;
+  }
+  if (ok && std::rename(temp_filename.c_str(), output_filename.c_str()) != 0) {
+    print(std::cerr, "Error writing file {}.\n", output_filename);
+    ok = false;
+  }
+  if (!ok) {
+    std::remove(temp_filename.c_str());
+    return 1;
+  }
+  return 0;
+}
+
+#else
+
+int Tool::WriteInPlace(const std::string& output_filename) {
+  print(std::cerr, "Cannot strip {} in place on this platform.\n",
+        output_filename);
+  return 1;
+}
+
+#endif
+
+namespace {
+
+// Matches |name| against |pattern|, where a trailing '*' in the pattern
+// matches any suffix (e.g. "reloc.*").
+bool MatchName(string_view pattern, string_view name) {
+  if (!pattern.empty() && pattern.back() == '*') {
+    pattern.remove_suffix(1);
+    return name.substr(0, pattern.size()) == pattern;
+  }
+  return name == pattern;
+}
+
+}  // namespace
+
+bool Tool::ShouldStrip(const Section& section) const {
+  if (options.sections.empty()) {
+    return section.is_custom();
+  }
+
+  std::string known_name;
+  string_view name;
+  if (section.is_custom()) {
+    name = section.custom().name;
+  } else {
+    known_name = format("{}", section.known().id);
+    name = known_name;
+  }
+
+  for (auto pattern : options.sections) {
+    if (MatchName(pattern, name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace strip
+}  // namespace tools
+}  // namespace wasp
@@ -14,10 +14,12 @@
 // limitations under the License.
 //
 
+#include "src/tools/batch.h"
 #include "src/tools/callgraph.h"
 #include "src/tools/cfg.h"
 #include "src/tools/dfg.h"
 #include "src/tools/dump.h"
+#include "src/tools/strip.h"
 
 #include "wasp/base/format.h"
 #include "wasp/base/formatters.h"
@@ -46,12 +48,16 @@ int main(int argc, char** argv) {
 
       if (arg == "dump") {
         command = wasp::tools::dump::Main;
+      } else if (arg == "batch") {
+        command = wasp::tools::batch::Main;
       } else if (arg == "callgraph") {
         command = wasp::tools::callgraph::Main;
       } else if (arg == "cfg") {
         command = wasp::tools::cfg::Main;
       } else if (arg == "dfg") {
         command = wasp::tools::dfg::Main;
+      } else if (arg == "strip") {
+        command = wasp::tools::strip::Main;
       } else {
         print("Unknown command \"{}\"\n", arg);
         return 1;
@@ -73,4 +79,6 @@ void PrintHelp() {
   print("  callgraph   Generate DOT file for the function call graph.\n");
   print("  cfg         Generate DOT file of a function's control flow graph.\n");
   print("  dfg         Generate DOT file of a function's data flow graph.\n");
+  print("  strip       Remove sections from a WebAssembly file.\n");
+  print("  batch       Run a command on many files in parallel.\n");
 }
@@ -16,18 +16,55 @@
 
 #include "wasp/valid/context.h"
 
+#include <cassert>
+
 namespace wasp {
 namespace valid {
 
 Label::Label(LabelType label_type,
-             const binary::ValueTypes& param_types,
-             const binary::ValueTypes& result_types,
+             Index types_begin,
+             Index param_count,
+             Index result_count,
              Index type_stack_limit)
     : label_type{label_type},
-      param_types{param_types},
-      result_types{result_types},
+      types_begin{types_begin},
+      param_count{param_count},
+      result_count{result_count},
       type_stack_limit{type_stack_limit},
       unreachable{false} {}
 
+void FunctionContext::PushLabel(LabelType label_type,
+                                binary::ValueTypeSpan param_types,
+                                binary::ValueTypeSpan result_types) {
+  Index types_begin = label_types.size();
+  label_types.insert(label_types.end(), param_types.begin(),
+                     param_types.end());
+  label_types.insert(label_types.end(), result_types.begin(),
+                     result_types.end());
+  label_stack.emplace_back(label_type, types_begin, param_types.size(),
+                           result_types.size(), type_stack.size());
+}
+
+void FunctionContext::PopLabel() {
+  assert(!label_stack.empty());
+  label_types.resize(label_stack.back().types_begin);
+  label_stack.pop_back();
+}
+
+binary::ValueTypeSpan FunctionContext::param_types(const Label& label) const {
+  return binary::ValueTypeSpan{label_types}.subspan(label.types_begin,
+                                                    label.param_count);
+}
+
+binary::ValueTypeSpan FunctionContext::result_types(const Label& label) const {
+  return binary::ValueTypeSpan{label_types}.subspan(
+      label.types_begin + label.param_count, label.result_count);
+}
+
+binary::ValueTypeSpan FunctionContext::br_types(const Label& label) const {
+  return label.label_type == LabelType::Loop ? param_types(label)
+                                             : result_types(label);
+}
+
 }  // namespace valid
 }  // namespace wasp
@@ -0,0 +1,56 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/local_types.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace wasp {
+namespace valid {
+
+void LocalTypes::Reset() {
+  ends_.clear();
+  types_.clear();
+}
+
+bool LocalTypes::Append(Index count, binary::ValueType type) {
+  const Index old_count = GetCount();
+  if (count > std::numeric_limits<Index>::max() - old_count) {
+    return false;
+  }
+  if (count == 0) {
+    return true;
+  }
+  if (!types_.empty() && types_.back() == type) {
+    ends_.back() += count;
+  } else {
+    ends_.push_back(old_count + count);
+    types_.push_back(type);
+  }
+  return true;
+}
+
+optional<binary::ValueType> LocalTypes::GetType(Index index) const {
+  auto iter = std::upper_bound(ends_.begin(), ends_.end(), index);
+  if (iter == ends_.end()) {
+    return nullopt;
+  }
+  return types_[iter - ends_.begin()];
+}
+
+}  // namespace valid
+}  // namespace wasp
@@ -0,0 +1,175 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/validate_code.h"
+#include "wasp/valid/validate_code_section_parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "wasp/base/features.h"
+#include "wasp/base/string_view.h"
+#include "wasp/binary/errors_nop.h"
+#include "wasp/binary/lazy_expression.h"
+#include "wasp/valid/begin_code.h"
+#include "wasp/valid/context.h"
+#include "wasp/valid/errors.h"
+#include "wasp/valid/errors_context_guard.h"
+#include "wasp/valid/validate_code_fused.h"
+#include "wasp/valid/validate_instruction.h"
+#include "wasp/valid/validate_locals.h"
+
+namespace wasp {
+namespace valid {
+
+namespace {
+
+// Collects the errors reported while validating one function, along with the
+// error context at the time, so they can be replayed later in order.
+class BufferedErrors : public Errors {
+ public:
+  void Replay(Errors& errors) const {
+    for (const auto& error : errors_) {
+      for (const auto& desc : error.context) {
+        errors.PushContext(desc);
+      }
+      errors.OnError(error.message);
+      for (size_t i = 0; i < error.context.size(); ++i) {
+        errors.PopContext();
+      }
+    }
+  }
+
+ protected:
+  void HandlePushContext(string_view desc) override {
+    context_.push_back(desc);
+  }
+
+  void HandlePopContext() override { context_.pop_back(); }
+
+  void HandleOnError(string_view message) override {
+    Error error;
+    for (auto desc : context_) {
+      error.context.push_back(desc.to_string());
+    }
+    error.message = message.to_string();
+    errors_.push_back(std::move(error));
+  }
+
+ private:
+  struct Error {
+    std::vector<std::string> context;
+    std::string message;
+  };
+
+  std::vector<string_view> context_;
+  std::vector<Error> errors_;
+};
+
+}  // namespace
+
+bool Validate(const binary::Code& value,
+              Context& context,
+              const Features& features,
+              Errors& errors) {
+  Index func_index = context.imported_function_count + context.code_count;
+  if (func_index < context.functions.size()) {
+    context.code_count++;
+  }
+  return Validate(value, func_index, context, context, features, errors);
+}
+
+bool Validate(const binary::Code& value,
+              Index func_index,
+              const ModuleContext& module,
+              FunctionContext& function,
+              const Features& features,
+              Errors& errors) {
+  ErrorsContextGuard guard{errors, "code"};
+  bool valid = BeginCode(func_index, module, function, features, errors);
+  if (function.label_stack.empty()) {
+    return false;
+  }
+  for (const auto& locals : value.locals) {
+    valid &= Validate(locals, function, features, errors);
+  }
+  // Malformed instructions are reported when the module is read, so they only
+  // end the function early here.
+  binary::ErrorsNop read_errors;
+  for (const auto& instruction :
+       binary::ReadExpression(value.body, features, read_errors)) {
+    valid &= Validate(instruction, module, function, features, errors);
+  }
+  if (!function.label_stack.empty()) {
+    errors.OnError("Expected end of function");
+    valid = false;
+  }
+  return valid;
+}
+
+bool ValidateCodeSectionParallel(const std::vector<binary::Code>& codes,
+                                 Context& context,
+                                 const Features& features,
+                                 Errors& errors,
+                                 unsigned thread_count) {
+  if (thread_count == 0) {
+    thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  thread_count =
+      static_cast<unsigned>(std::min<size_t>(thread_count, codes.size()));
+
+  const ModuleContext& module = context;
+  const Index first_func_index =
+      context.imported_function_count + context.code_count;
+  std::vector<BufferedErrors> function_errors(codes.size());
+  // Not std::vector<bool>, since each element is written by a different
+  // thread.
+  std::vector<u8> results(codes.size());
+  std::atomic<size_t> next_code{0};
+
+  auto worker = [&]() {
+    FunctionContext function;
+    for (size_t i; (i = next_code++) < codes.size();) {
+      results[i] = ValidateFused(codes[i], first_func_index + i, module,
+                                 function, features, function_errors[i]);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < thread_count; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  bool valid = true;
+  for (size_t i = 0; i < codes.size(); ++i) {
+    if (first_func_index + i < context.functions.size()) {
+      context.code_count++;
+    }
+    function_errors[i].Replay(errors);
+    valid &= results[i] != 0;
+  }
+  return valid;
+}
+
+}  // namespace valid
+}  // namespace wasp
@@ -0,0 +1,492 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/validate_code_fused.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "wasp/base/features.h"
+#include "wasp/base/span.h"
+#include "wasp/binary/errors_nop.h"
+#include "wasp/binary/opcode_info.h"
+#include "wasp/binary/read/read_instruction.h"
+#include "wasp/binary/read/read_var_int.h"
+#include "wasp/valid/begin_code.h"
+#include "wasp/valid/context.h"
+#include "wasp/valid/errors_nop.h"
+#include "wasp/valid/validate_code.h"
+#include "wasp/valid/validate_instruction.h"
+#include "wasp/valid/validate_locals.h"
+
+namespace wasp {
+namespace valid {
+
+namespace {
+
+using namespace ::wasp::binary;
+
+const ValueType kBlockI32[] = {ValueType::I32};
+const ValueType kBlockI64[] = {ValueType::I64};
+const ValueType kBlockF32[] = {ValueType::F32};
+const ValueType kBlockF64[] = {ValueType::F64};
+
+// The stack signature of each single-byte MVP opcode that has no immediate,
+// or null if the opcode needs more than popping and pushing fixed types.
+// Opcodes added by features are left to the general validator, which checks
+// that the feature is enabled.
+const StackSignature* const* GetSignatureTable() {
+  static const StackSignature* const* table = []() {
+    static const StackSignature* signatures[256] = {};
+    const Features mvp_features;
+    for (int byte = 0; byte < 256; ++byte) {
+      const OpcodeInfo* info = DecodeOpcode(byte, mvp_features);
+      if (info && info->immediate == ImmediateKind::Empty) {
+        signatures[byte] = info->stack_signature;
+      }
+    }
+    return signatures;
+  }();
+  return table;
+}
+
+// The largest alignment allowed for each MVP load and store, indexed by
+// opcode byte - 0x28.
+const u8 kMaxAlign[] = {
+    2, 3, 2, 3, 0, 0, 1, 1, 0, 0, 1, 1, 2, 2,  // i32.load .. i64.load32_u
+    2, 3, 2, 3, 0, 1, 0, 1, 2,                 // i32.store .. i64.store32
+};
+
+// The type loaded or stored, indexed by opcode byte - 0x28.
+const ValueType kMemoryType[] = {
+    ValueType::I32, ValueType::I64, ValueType::F32, ValueType::F64,
+    ValueType::I32, ValueType::I32, ValueType::I32, ValueType::I32,
+    ValueType::I64, ValueType::I64, ValueType::I64, ValueType::I64,
+    ValueType::I64, ValueType::I64, ValueType::I32, ValueType::I64,
+    ValueType::F32, ValueType::F64, ValueType::I32, ValueType::I32,
+    ValueType::I64, ValueType::I64, ValueType::I64,
+};
+
+// Validates a body using the same rules as validate_instruction.cc, but
+// working directly on the encoded bytes. Run() returns false as soon as
+// anything is invalid or malformed; it doesn't report errors.
+class FusedValidator {
+ public:
+  FusedValidator(SpanU8 body,
+                 const ModuleContext& module,
+                 FunctionContext& function,
+                 const Features& features)
+      : data_{body},
+        module_{module},
+        function_{function},
+        type_stack_{function.type_stack},
+        label_stack_{function.label_stack},
+        features_{features} {}
+
+  bool Run();
+
+ private:
+  bool ValidateInstruction();
+  bool ValidateDecoded(SpanU8 start);
+
+  optional<u32> ReadU32() {
+    return ReadVarInt<u32>(&data_, features_, read_errors_, "u32");
+  }
+
+  Label& TopLabel() { return label_stack_.back(); }
+
+  void Push(ValueType type) { type_stack_.push_back(type); }
+
+  bool Pop(ValueType type) {
+    const Label& top = TopLabel();
+    if (type_stack_.size() > top.type_stack_limit) {
+      if (type_stack_.back() != type) {
+        return false;
+      }
+      type_stack_.pop_back();
+      return true;
+    }
+    return top.unreachable;
+  }
+
+  bool PopTypes(ValueTypeSpan types) {
+    for (auto iter = types.end(); iter != types.begin();) {
+      if (!Pop(*--iter)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void PushTypes(ValueTypeSpan types) {
+    type_stack_.insert(type_stack_.end(), types.begin(), types.end());
+  }
+
+  void SetUnreachable() {
+    Label& top = TopLabel();
+    top.unreachable = true;
+    type_stack_.resize(top.type_stack_limit);
+  }
+
+  bool BlockResults(ValueTypeSpan* out);
+  bool CheckEndTypes(const Label&, ValueTypeSpan results);
+  bool End();
+  bool Br(Index depth);
+  bool Call(Index function_index);
+  bool MemoryAccess(u8 opcode);
+
+  SpanU8 data_;
+  const ModuleContext& module_;
+  FunctionContext& function_;
+  std::vector<ValueType>& type_stack_;
+  std::vector<Label>& label_stack_;
+  const Features& features_;
+  binary::ErrorsNop read_errors_;
+  valid::ErrorsNop valid_errors_;
+};
+
+bool FusedValidator::Run() {
+  while (!data_.empty()) {
+    if (label_stack_.empty() || !ValidateInstruction()) {
+      return false;
+    }
+  }
+  return label_stack_.empty();
+}
+
+// Reads the block type of block, loop and if. Only the empty and single
+// value MVP types are handled here.
+bool FusedValidator::BlockResults(ValueTypeSpan* out) {
+  if (data_.empty()) {
+    return false;
+  }
+  switch (data_[0]) {
+    case 0x40: *out = ValueTypeSpan{}; break;
+    case 0x7f: *out = kBlockI32; break;
+    case 0x7e: *out = kBlockI64; break;
+    case 0x7d: *out = kBlockF32; break;
+    case 0x7c: *out = kBlockF64; break;
+    default:
+      return false;
+  }
+  remove_prefix(&data_, 1);
+  return true;
+}
+
+// Checks that the values above the label are exactly |results|, as the
+// `else` and `end` instructions require.
+bool FusedValidator::CheckEndTypes(const Label& label, ValueTypeSpan results) {
+  const size_t count = type_stack_.size() - label.type_stack_limit;
+  const size_t result_count = results.size();
+  if (count > result_count || (count < result_count && !label.unreachable)) {
+    return false;
+  }
+  return std::equal(type_stack_.end() - count, type_stack_.end(),
+                    results.end() - count);
+}
+
+bool FusedValidator::End() {
+  Label& top = TopLabel();
+  ValueTypeSpan results = function_.result_types(top);
+  if (top.label_type == LabelType::If) {
+    // An `if` without an `else` has an implicit empty `else`.
+    if (!CheckEndTypes(top, results)) {
+      return false;
+    }
+    type_stack_.resize(top.type_stack_limit);
+    PushTypes(function_.param_types(top));
+    top.label_type = LabelType::Else;
+    top.unreachable = false;
+  }
+  if (!CheckEndTypes(top, results)) {
+    return false;
+  }
+  type_stack_.resize(top.type_stack_limit);
+  PushTypes(results);
+  function_.PopLabel();
+  return true;
+}
+
+bool FusedValidator::Br(Index depth) {
+  if (depth >= label_stack_.size()) {
+    return false;
+  }
+  const Label& label = label_stack_[label_stack_.size() - depth - 1];
+  if (!PopTypes(function_.br_types(label))) {
+    return false;
+  }
+  SetUnreachable();
+  return true;
+}
+
+bool FusedValidator::Call(Index function_index) {
+  if (function_index >= module_.functions.size()) {
+    return false;
+  }
+  Index type_index = module_.functions[function_index].type_index;
+  if (type_index >= module_.types.size()) {
+    return false;
+  }
+  const FunctionType& type = module_.types[type_index].type;
+  if (!PopTypes(type.param_types)) {
+    return false;
+  }
+  PushTypes(type.result_types);
+  return true;
+}
+
+bool FusedValidator::MemoryAccess(u8 opcode) {
+  auto align_log2 = ReadU32();
+  auto offset = ReadU32();
+  if (!align_log2 || !offset || module_.memories.empty()) {
+    return false;
+  }
+  const int index = opcode - 0x28;
+  if (*align_log2 > kMaxAlign[index]) {
+    return false;
+  }
+  ValueType type = kMemoryType[index];
+  if (opcode <= 0x35) {
+    // Load.
+    if (!Pop(ValueType::I32)) {
+      return false;
+    }
+    Push(type);
+    return true;
+  } else {
+    // Store.
+    return Pop(type) && Pop(ValueType::I32);
+  }
+}
+
+bool FusedValidator::ValidateInstruction() {
+  const SpanU8 start = data_;
+  const u8 opcode = data_[0];
+  remove_prefix(&data_, 1);
+
+  if (const StackSignature* signature = GetSignatureTable()[opcode]) {
+    // Unrolled; a signature has at most three params, popped top first.
+    const u8 param_count = signature->param_count;
+    if ((param_count > 2 && !Pop(signature->params[2])) ||
+        (param_count > 1 && !Pop(signature->params[1])) ||
+        (param_count > 0 && !Pop(signature->params[0]))) {
+      return false;
+    }
+    if (signature->result_count != 0) {
+      Push(signature->results[0]);
+    }
+    return true;
+  }
+
+  switch (opcode) {
+    case 0x00:  // unreachable
+      SetUnreachable();
+      return true;
+
+    case 0x02:  // block
+    case 0x03:  // loop
+    case 0x04: {  // if
+      ValueTypeSpan results;
+      if (!BlockResults(&results)) {
+        break;
+      }
+      if (opcode == 0x04 && !Pop(ValueType::I32)) {
+        return false;
+      }
+      LabelType label_type = LabelType::If;
+      if (opcode == 0x02) {
+        label_type = LabelType::Block;
+      } else if (opcode == 0x03) {
+        label_type = LabelType::Loop;
+      }
+      function_.PushLabel(label_type, {}, results);
+      return true;
+    }
+
+    case 0x05: {  // else
+      Label& top = TopLabel();
+      if (top.label_type != LabelType::If ||
+          !CheckEndTypes(top, function_.result_types(top))) {
+        return false;
+      }
+      type_stack_.resize(top.type_stack_limit);
+      PushTypes(function_.param_types(top));
+      top.label_type = LabelType::Else;
+      top.unreachable = false;
+      return true;
+    }
+
+    case 0x0b:  // end
+      return End();
+
+    case 0x0c: {  // br
+      auto depth = ReadU32();
+      return depth && Br(*depth);
+    }
+
+    case 0x0d: {  // br_if
+      auto depth = ReadU32();
+      if (!depth || !Pop(ValueType::I32) || *depth >= label_stack_.size()) {
+        return false;
+      }
+      const Label& label = label_stack_[label_stack_.size() - *depth - 1];
+      ValueTypeSpan br_types = function_.br_types(label);
+      if (!PopTypes(br_types)) {
+        return false;
+      }
+      PushTypes(br_types);
+      return true;
+    }
+
+    case 0x0f:  // return
+      return Br(label_stack_.size() - 1);
+
+    case 0x10: {  // call
+      auto index = ReadU32();
+      return index && Call(*index);
+    }
+
+    case 0x1a: {  // drop
+      const Label& top = TopLabel();
+      if (type_stack_.size() > top.type_stack_limit) {
+        type_stack_.pop_back();
+        return true;
+      }
+      return top.unreachable;
+    }
+
+    case 0x20: {  // local.get
+      auto index = ReadU32();
+      auto type = index ? function_.locals.GetType(*index) : nullopt;
+      if (!type) {
+        return false;
+      }
+      Push(*type);
+      return true;
+    }
+
+    case 0x21:    // local.set
+    case 0x22: {  // local.tee
+      auto index = ReadU32();
+      auto type = index ? function_.locals.GetType(*index) : nullopt;
+      if (!type || !Pop(*type)) {
+        return false;
+      }
+      if (opcode == 0x22) {
+        Push(*type);
+      }
+      return true;
+    }
+
+    case 0x23: {  // global.get
+      auto index = ReadU32();
+      if (!index || *index >= module_.globals.size()) {
+        return false;
+      }
+      Push(module_.globals[*index].valtype);
+      return true;
+    }
+
+    case 0x24: {  // global.set
+      auto index = ReadU32();
+      if (!index || *index >= module_.globals.size()) {
+        return false;
+      }
+      const GlobalType& global = module_.globals[*index];
+      return global.mut == Mutability::Var && Pop(global.valtype);
+    }
+
+    case 0x28: case 0x29: case 0x2a: case 0x2b: case 0x2c: case 0x2d:
+    case 0x2e: case 0x2f: case 0x30: case 0x31: case 0x32: case 0x33:
+    case 0x34: case 0x35: case 0x36: case 0x37: case 0x38: case 0x39:
+    case 0x3a: case 0x3b: case 0x3c: case 0x3d: case 0x3e:
+      return MemoryAccess(opcode);
+
+    case 0x41:  // i32.const
+      if (!ReadVarInt<s32>(&data_, features_, read_errors_, "i32 constant")) {
+        return false;
+      }
+      Push(ValueType::I32);
+      return true;
+
+    case 0x42:  // i64.const
+      if (!ReadVarInt<s64>(&data_, features_, read_errors_, "i64 constant")) {
+        return false;
+      }
+      Push(ValueType::I64);
+      return true;
+
+    case 0x43:  // f32.const
+    case 0x44: {  // f64.const
+      const SpanU8::index_type size = opcode == 0x43 ? 4 : 8;
+      if (data_.size() < size) {
+        return false;
+      }
+      remove_prefix(&data_, size);
+      Push(opcode == 0x43 ? ValueType::F32 : ValueType::F64);
+      return true;
+    }
+
+    default:
+      break;
+  }
+
+  return ValidateDecoded(start);
+}
+
+// Decodes one instruction and validates it with the general validator. Used
+// for the instructions that the fast path above doesn't handle.
+bool FusedValidator::ValidateDecoded(SpanU8 start) {
+  data_ = start;
+  auto instruction = Read<Instruction>(&data_, features_, read_errors_);
+  return instruction && Validate(*instruction, module_, function_, features_,
+                                 valid_errors_);
+}
+
+}  // namespace
+
+bool ValidateFused(const binary::Code& value,
+                   Context& context,
+                   const Features& features,
+                   Errors& errors) {
+  Index func_index = context.imported_function_count + context.code_count;
+  if (func_index < context.functions.size()) {
+    context.code_count++;
+  }
+  return ValidateFused(value, func_index, context, context, features, errors);
+}
+
+bool ValidateFused(const binary::Code& value,
+                   Index func_index,
+                   const ModuleContext& module,
+                   FunctionContext& function,
+                   const Features& features,
+                   Errors& errors) {
+  valid::ErrorsNop errors_nop;
+  bool valid = BeginCode(func_index, module, function, features, errors_nop);
+  for (const auto& locals : value.locals) {
+    valid = valid && Validate(locals, function, features, errors_nop);
+  }
+  if (valid &&
+      FusedValidator{value.body.data, module, function, features}.Run()) {
+    return true;
+  }
+  // Validate again to report the errors.
+  return Validate(value, func_index, module, function, features, errors);
+}
+
+}  // namespace valid
+}  // namespace wasp
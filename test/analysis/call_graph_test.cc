@@ -0,0 +1,169 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/analysis/call_graph.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "test/binary/test_utils.h"
+#include "wasp/base/features.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/section_index.h"
+
+using namespace ::wasp;
+using namespace ::wasp::analysis;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+
+namespace {
+
+std::vector<Index> ToVector(IndexSpan span) {
+  return std::vector<Index>{span.begin(), span.end()};
+}
+
+void AppendU32(std::vector<u8>& data, u32 value) {
+  for (; value >= 0x80; value >>= 7) {
+    data.push_back(0x80 | (value & 0x7f));
+  }
+  data.push_back(value);
+}
+
+void AppendSection(std::vector<u8>& data, u8 id, const std::vector<u8>& body) {
+  data.push_back(id);
+  AppendU32(data, body.size());
+  data.insert(data.end(), body.begin(), body.end());
+}
+
+CallGraph BuildFromData(SpanU8 data, unsigned thread_count) {
+  Features features;
+  features.EnableAll();
+  TestErrors errors;
+  auto module = ReadModule(data, features, errors);
+  SectionIndex index{module};
+  auto graph = BuildCallGraph(index, features, errors, thread_count);
+  ExpectNoErrors(errors);
+  return graph;
+}
+
+}  // namespace
+
+TEST(CallGraphTest, DirectAndIndirect) {
+  auto data =
+      "\0asm\x01\0\0\0"_su8
+      // (type 0 (func)) (type 1 (func (param i32) (result i32)))
+      // (type 2 (func))
+      "\x01\x0c\x03\x60\x00\x00\x60\x01\x7f\x01\x7f\x60\x00\x00"
+      // (import "m" "f" (func 0 (type 0)))
+      "\x02\x07\x01\x01m\x01\x66\x00\x00"
+      // Functions 1 to 4 have types 0, 1, 2 and 1.
+      "\x03\x05\x04\x00\x01\x02\x01"
+      // (table 3 funcref)
+      "\x04\x04\x01\x70\x00\x03"
+      // (elem (i32.const 0) 2 3 4) (elem passive funcref (ref.func 0))
+      "\x09\x0f\x02\x00\x41\x00\x0b\x03\x02\x03\x04\x01\x70\x01\xd2\x00\x0b"
+      "\x0a\x21\x04"
+      // 1: call 0, call 0, call 2
+      "\x08\x00\x10\x00\x10\x00\x10\x02\x0b"
+      // 2: call_indirect (type 0): function 3 has the same signature, and
+      // function 0 is in a passive segment.
+      "\x09\x00\x41\x00\x11\x00\x00\x20\x00\x0b"
+      // 3: return_call 1
+      "\x04\x00\x12\x01\x0b"
+      // 4: call_indirect (type 1)
+      "\x07\x00\x41\x00\x11\x01\x00\x0b"_su8;
+
+  for (unsigned thread_count : {1, 4}) {
+    auto graph = BuildFromData(data, thread_count);
+    ASSERT_EQ(5u, graph.function_count());
+    EXPECT_EQ(7u, graph.edge_count());
+
+    EXPECT_EQ((std::vector<Index>{}), ToVector(graph.callees(0)));
+    EXPECT_EQ((std::vector<Index>{0, 2}), ToVector(graph.callees(1)));
+    EXPECT_EQ((std::vector<Index>{0, 3}), ToVector(graph.callees(2)));
+    EXPECT_EQ((std::vector<Index>{1}), ToVector(graph.callees(3)));
+    EXPECT_EQ((std::vector<Index>{2, 4}), ToVector(graph.callees(4)));
+
+    EXPECT_EQ((std::vector<Index>{1, 2}), ToVector(graph.callers(0)));
+    EXPECT_EQ((std::vector<Index>{3}), ToVector(graph.callers(1)));
+    EXPECT_EQ((std::vector<Index>{1, 4}), ToVector(graph.callers(2)));
+    EXPECT_EQ((std::vector<Index>{2}), ToVector(graph.callers(3)));
+    EXPECT_EQ((std::vector<Index>{4}), ToVector(graph.callers(4)));
+  }
+}
+
+TEST(CallGraphTest, ElementSegmentPastTables) {
+  auto data =
+      "\0asm\x01\0\0\0"_su8
+      // (type 0 (func))
+      "\x01\x04\x01\x60\x00\x00"
+      // Function 0 has type 0.
+      "\x03\x02\x01\x00"
+      // (table 1 funcref)
+      "\x04\x04\x01\x70\x00\x01"
+      // (elem (table 0xffffffff) (i32.const 0) func 0)
+      // (elem (table 0x0fffffff) (i32.const 0) func 0)
+      "\x09\x16\x02"
+      "\x02\xff\xff\xff\xff\x0f\x41\x00\x0b\x01\x00"
+      "\x02\xff\xff\xff\x7f\x41\x00\x0b\x01\x00"
+      // 0: call_indirect (type 0)
+      "\x0a\x09\x01\x07\x00\x41\x00\x11\x00\x00\x0b"_su8;
+
+  // The segments are ignored, rather than growing the list of tables.
+  auto graph = BuildFromData(data, 1);
+  ASSERT_EQ(1u, graph.function_count());
+  EXPECT_EQ(0u, graph.edge_count());
+}
+
+TEST(CallGraphTest, Empty) {
+  auto graph = BuildFromData("\0asm\x01\0\0\0"_su8, 0);
+  EXPECT_EQ(0u, graph.function_count());
+  EXPECT_EQ(0u, graph.edge_count());
+}
+
+TEST(CallGraphTest, ManyFunctions) {
+  // Function i calls function (i + 1) % kCount.
+  const Index kCount = 1000;
+  std::vector<u8> types{0x01, 0x60, 0x00, 0x00};
+  std::vector<u8> functions;
+  std::vector<u8> codes;
+  AppendU32(functions, kCount);
+  AppendU32(codes, kCount);
+  for (Index i = 0; i < kCount; ++i) {
+    functions.push_back(0);
+    std::vector<u8> body{0x00, 0x10};
+    AppendU32(body, (i + 1) % kCount);
+    body.push_back(0x0b);
+    AppendU32(codes, body.size());
+    codes.insert(codes.end(), body.begin(), body.end());
+  }
+
+  std::vector<u8> data{0, 'a', 's', 'm', 1, 0, 0, 0};
+  AppendSection(data, 1, types);
+  AppendSection(data, 3, functions);
+  AppendSection(data, 10, codes);
+
+  auto graph = BuildFromData(SpanU8{data}, 4);
+  ASSERT_EQ(kCount, graph.function_count());
+  EXPECT_EQ(kCount, graph.edge_count());
+  for (Index i = 0; i < kCount; ++i) {
+    EXPECT_EQ((std::vector<Index>{(i + 1) % kCount}),
+              ToVector(graph.callees(i)));
+    EXPECT_EQ((std::vector<Index>{(i + kCount - 1) % kCount}),
+              ToVector(graph.callers(i)));
+  }
+}
@@ -0,0 +1,167 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/analysis/cfg.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "test/binary/test_utils.h"
+#include "wasp/base/features.h"
+
+using namespace ::wasp;
+using namespace ::wasp::analysis;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+
+namespace {
+
+std::vector<BBID> Targets(CfgEdgeSpan edges) {
+  std::vector<BBID> result;
+  for (const auto& edge : edges) {
+    result.push_back(edge.target);
+  }
+  return result;
+}
+
+std::vector<CfgEdgeKind> Kinds(CfgEdgeSpan edges) {
+  std::vector<CfgEdgeKind> result;
+  for (const auto& edge : edges) {
+    result.push_back(edge.kind);
+  }
+  return result;
+}
+
+std::vector<BBID> ToVector(BBIDSpan span) {
+  return std::vector<BBID>{span.begin(), span.end()};
+}
+
+}  // namespace
+
+TEST(CfgTest, Empty) {
+  Features features;
+  TestErrors errors;
+  auto cfg = BuildCfg(Code{{}, "\x0b"_expr}, features, errors);
+  ExpectNoErrors(errors);
+  EXPECT_EQ(InvalidBBID, cfg.start());
+  EXPECT_EQ(0u, cfg.block_count());
+  EXPECT_EQ(0u, cfg.edge_count());
+}
+
+TEST(CfgTest, IfElse) {
+  Features features;
+  TestErrors errors;
+  // local.get 0
+  // if (result i32) i32.const 1 else i32.const 2 end
+  // i32.const 3; i32.add
+  auto body = "\x20\x00\x04\x7f\x41\x01\x05\x41\x02\x0b\x41\x03\x6a\x0b"_expr;
+  auto cfg = BuildCfg(Code{{}, body}, features, errors);
+  ExpectNoErrors(errors);
+
+  ASSERT_EQ(4u, cfg.block_count());
+  EXPECT_EQ(0u, cfg.start());
+  EXPECT_EQ((std::vector<BBID>{1, 3}), Targets(cfg.successors(0)));
+  EXPECT_EQ((std::vector<CfgEdgeKind>{CfgEdgeKind::True, CfgEdgeKind::False}),
+            Kinds(cfg.successors(0)));
+  EXPECT_EQ((std::vector<BBID>{2}), Targets(cfg.successors(1)));
+  EXPECT_EQ((std::vector<BBID>{InvalidBBID}), Targets(cfg.successors(2)));
+  EXPECT_EQ((std::vector<BBID>{2}), Targets(cfg.successors(3)));
+
+  EXPECT_EQ((std::vector<BBID>{}), ToVector(cfg.predecessors(0)));
+  EXPECT_EQ((std::vector<BBID>{0}), ToVector(cfg.predecessors(1)));
+  EXPECT_EQ((std::vector<BBID>{1, 3}), ToVector(cfg.predecessors(2)));
+  EXPECT_EQ((std::vector<BBID>{0}), ToVector(cfg.predecessors(3)));
+
+  // The instructions are spans of the body.
+  EXPECT_EQ(body.data.subspan(0, 4), cfg.code(0));
+  EXPECT_EQ(body.data.subspan(4, 3), cfg.code(1));
+  EXPECT_EQ(body.data.subspan(10, 4), cfg.code(2));
+  EXPECT_EQ(body.data.subspan(7, 3), cfg.code(3));
+}
+
+TEST(CfgTest, Loop) {
+  Features features;
+  TestErrors errors;
+  // loop local.get 0 br_if 0 end
+  // i32.const 0
+  auto body = "\x03\x40\x20\x00\x0d\x00\x0b\x41\x00\x0b"_expr;
+  auto cfg = BuildCfg(Code{{}, body}, features, errors);
+  ExpectNoErrors(errors);
+
+  // The empty blocks before the loop and after the br_if are removed.
+  ASSERT_EQ(2u, cfg.block_count());
+  EXPECT_EQ(0u, cfg.start());
+  EXPECT_EQ((std::vector<BBID>{0, 1}), Targets(cfg.successors(0)));
+  EXPECT_EQ((std::vector<CfgEdgeKind>{CfgEdgeKind::True, CfgEdgeKind::False}),
+            Kinds(cfg.successors(0)));
+  EXPECT_EQ((std::vector<BBID>{InvalidBBID}), Targets(cfg.successors(1)));
+  EXPECT_EQ((std::vector<BBID>{0}), ToVector(cfg.predecessors(0)));
+  EXPECT_EQ((std::vector<BBID>{0}), ToVector(cfg.predecessors(1)));
+
+  EXPECT_EQ(body.data.subspan(0, 6), cfg.code(0));
+  EXPECT_EQ(body.data.subspan(7, 3), cfg.code(1));
+}
+
+TEST(CfgTest, BrTable) {
+  Features features;
+  TestErrors errors;
+  // block local.get 0 br_table 0 1 0 end
+  // nop
+  auto cfg = BuildCfg(
+      Code{{}, "\x02\x40\x20\x00\x0e\x02\x00\x01\x00\x0b\x01\x0b"_expr},
+      features, errors);
+  ExpectNoErrors(errors);
+
+  ASSERT_EQ(2u, cfg.block_count());
+  EXPECT_EQ((std::vector<BBID>{1, InvalidBBID, 1}),
+            Targets(cfg.successors(0)));
+  EXPECT_EQ((std::vector<CfgEdgeKind>{CfgEdgeKind::Case, CfgEdgeKind::Case,
+                                      CfgEdgeKind::Default}),
+            Kinds(cfg.successors(0)));
+  EXPECT_EQ((std::vector<BBID>{0, 0}), ToVector(cfg.predecessors(1)));
+}
+
+TEST(CfgTest, Return) {
+  Features features;
+  TestErrors errors;
+  // local.get 0 return
+  auto cfg = BuildCfg(Code{{}, "\x20\x00\x0f\x0b"_expr}, features, errors);
+  ExpectNoErrors(errors);
+
+  ASSERT_EQ(1u, cfg.block_count());
+  EXPECT_EQ((std::vector<BBID>{InvalidBBID}), Targets(cfg.successors(0)));
+}
+
+TEST(CfgTest, InvalidBranchDepth) {
+  Features features;
+  TestErrors errors;
+  auto body = "\x0c\x05\x0b"_expr;
+  BuildCfg(Code{{}, body}, features, errors);
+  ExpectError({{0, "Invalid branch depth: 5"}}, errors, body.data);
+}
+
+TEST(CfgTest, IsExtraneousInstruction) {
+  EXPECT_TRUE(
+      IsExtraneousInstruction(Instruction{Opcode::Block, BlockType::Void}));
+  EXPECT_TRUE(IsExtraneousInstruction(Instruction{Opcode::Else}));
+  EXPECT_TRUE(IsExtraneousInstruction(Instruction{Opcode::End}));
+  EXPECT_TRUE(IsExtraneousInstruction(Instruction{Opcode::Br, Index{0}}));
+  EXPECT_FALSE(
+      IsExtraneousInstruction(Instruction{Opcode::Loop, BlockType::Void}));
+  EXPECT_FALSE(IsExtraneousInstruction(Instruction{Opcode::BrIf, Index{0}}));
+  EXPECT_FALSE(IsExtraneousInstruction(Instruction{Opcode::Nop}));
+}
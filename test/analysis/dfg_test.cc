@@ -0,0 +1,368 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "wasp/analysis/dfg.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "test/binary/test_utils.h"
+#include "wasp/base/features.h"
+
+using namespace ::wasp;
+using namespace ::wasp::analysis;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+
+namespace {
+
+const FunctionType kI32ToI32{{ValueType::I32}, {ValueType::I32}};
+
+// Returns the value returned by the implicit `return` at the end of the
+// function.
+ValueID ReturnOperand(const std::vector<DfgValue>& values) {
+  for (auto iter = values.rbegin(); iter != values.rend(); ++iter) {
+    if (iter->instr == Instruction{Opcode::Return}) {
+      EXPECT_EQ(1u, iter->operands.size());
+      return iter->operands.empty() ? InvalidValueID : iter->operands[0];
+    }
+  }
+  ADD_FAILURE() << "no return";
+  return InvalidValueID;
+}
+
+}  // namespace
+
+TEST(DfgTest, DefinitionTable) {
+  DefinitionTable table;
+  EXPECT_EQ(InvalidValueID, table.Find(0, 0));
+
+  for (u32 i = 0; i < 1000; ++i) {
+    table.Insert(i, i / 10, i * 2);
+  }
+  table.Insert(5, 0, 1);
+  EXPECT_EQ(1000u, table.size());
+  EXPECT_EQ(1u, table.Find(5, 0));
+  EXPECT_EQ(1998u, table.Find(999, 99));
+  EXPECT_EQ(InvalidValueID, table.Find(999, 98));
+
+  table.Clear();
+  EXPECT_EQ(0u, table.size());
+  EXPECT_EQ(InvalidValueID, table.Find(999, 99));
+}
+
+TEST(DfgTest, StraightLine) {
+  Features features;
+  TestErrors errors;
+  std::vector<TypeEntry> types{TypeEntry{kI32ToI32}};
+  std::vector<Function> functions{Function{0}};
+  DfgBuilder builder{types, functions, features, errors};
+
+  // local.get 0; i32.const 1; i32.add; end
+  builder.Build(kI32ToI32, Code{{}, "\x20\x00\x41\x01\x6a\x0b"_expr});
+  builder.RemoveTrivialPhis();
+  ExpectNoErrors(errors);
+
+  const auto& values = builder.values();
+  const auto& add = values[ReturnOperand(values)];
+  EXPECT_EQ(Instruction{Opcode::I32Add}, add.instr);
+  ASSERT_EQ(2u, add.operands.size());
+  EXPECT_EQ((Instruction{Opcode::LocalGet, Index{0}}),
+            values[add.operands[0]].instr);
+  EXPECT_EQ((Instruction{Opcode::I32Const, s32{1}}),
+            values[add.operands[1]].instr);
+}
+
+TEST(DfgTest, LoopPhi) {
+  Features features;
+  TestErrors errors;
+  std::vector<TypeEntry> types{TypeEntry{kI32ToI32}};
+  std::vector<Function> functions{Function{0}};
+  DfgBuilder builder{types, functions, features, errors};
+
+  // loop
+  //   local.get 0; i32.const 1; i32.sub; local.tee 0; br_if 0
+  // end
+  // local.get 0
+  auto body =
+      "\x03\x40\x20\x00\x41\x01\x6b\x22\x00\x0d\x00\x0b\x20\x00\x0b"_expr;
+  builder.Build(kI32ToI32, Code{{}, body});
+  builder.RemoveTrivialPhis();
+  ExpectNoErrors(errors);
+
+  const auto& values = builder.values();
+  const auto& sub = values[ReturnOperand(values)];
+  EXPECT_EQ(Instruction{Opcode::I32Sub}, sub.instr);
+  ASSERT_EQ(2u, sub.operands.size());
+
+  // The loop header merges the param and the result of the sub.
+  const auto& phi = values[sub.operands[0]];
+  EXPECT_TRUE(phi.is_phi());
+  ASSERT_EQ(2u, phi.operands.size());
+  EXPECT_EQ((Instruction{Opcode::LocalGet, Index{0}}),
+            values[phi.operands[0]].instr);
+  EXPECT_EQ(&sub, &values[phi.operands[1]]);
+}
+
+TEST(DfgTest, TrivialPhi) {
+  Features features;
+  TestErrors errors;
+  std::vector<TypeEntry> types{TypeEntry{kI32ToI32}};
+  std::vector<Function> functions{Function{0}};
+  DfgBuilder builder{types, functions, features, errors};
+
+  // loop
+  //   local.get 0; br_if 0
+  // end
+  // local.get 0
+  builder.Build(kI32ToI32,
+                Code{{}, "\x03\x40\x20\x00\x0d\x00\x0b\x20\x00\x0b"_expr});
+  builder.RemoveTrivialPhis();
+  ExpectNoErrors(errors);
+
+  // The local is never written in the loop, so its phi is removed.
+  const auto& values = builder.values();
+  EXPECT_EQ((Instruction{Opcode::LocalGet, Index{0}}),
+            values[ReturnOperand(values)].instr);
+  for (const auto& value : values) {
+    if (value.is_phi()) {
+      EXPECT_TRUE(value.operands.empty());
+    }
+  }
+}
+
+TEST(DfgTest, Call) {
+  Features features;
+  TestErrors errors;
+  std::vector<TypeEntry> types{TypeEntry{kI32ToI32}};
+  std::vector<Function> functions{Function{0}};
+  DfgBuilder builder{types, functions, features, errors};
+
+  // local.get 0; call 0; end
+  builder.Build(kI32ToI32, Code{{}, "\x20\x00\x10\x00\x0b"_expr});
+  builder.RemoveTrivialPhis();
+  ExpectNoErrors(errors);
+
+  const auto& values = builder.values();
+  const auto& call = values[ReturnOperand(values)];
+  EXPECT_EQ((Instruction{Opcode::Call, Index{0}}), call.instr);
+  EXPECT_EQ(1u, call.operands.size());
+}
+
+TEST(DfgTest, Errors) {
+  Features features;
+  TestErrors errors;
+  std::vector<TypeEntry> types{TypeEntry{kI32ToI32}};
+  std::vector<Function> functions{Function{0}};
+  DfgBuilder builder{types, functions, features, errors};
+
+  // br 5; end
+  auto body = "\x0c\x05\x0b"_expr;
+  builder.Build(kI32ToI32, Code{{}, body});
+  ExpectError({{0, "Invalid br depth 5"}}, errors, body.data);
+}
+
+TEST(DfgTest, TruncatedBody) {
+  Features features;
+  TestErrors errors;
+  std::vector<TypeEntry> types{TypeEntry{kI32ToI32}};
+  std::vector<Function> functions{Function{0}};
+  DfgBuilder builder{types, functions, features, errors};
+
+  // local.get 0; i32.const <missing>
+  auto body = "\x20\x00\x41"_expr;
+  EXPECT_FALSE(builder.Build(kI32ToI32, Code{{}, body}));
+  EXPECT_FALSE(errors.errors.empty());
+}
+
+TEST(DfgTest, LocalSetEmptyStack) {
+  Features features;
+  TestErrors errors;
+  std::vector<TypeEntry> types{TypeEntry{kI32ToI32}};
+  std::vector<Function> functions{Function{0}};
+  DfgBuilder builder{types, functions, features, errors};
+
+  // local.set 0; end
+  auto body = "\x21\x00\x0b"_expr;
+  EXPECT_FALSE(builder.Build(kI32ToI32, Code{{}, body}));
+  ExpectError({{0, "`local.set 0` with an empty value stack"}}, errors,
+              body.data);
+}
+
+TEST(DfgTest, LocalsAreLazy) {
+  Features features;
+  TestErrors errors;
+  std::vector<TypeEntry> types{TypeEntry{kI32ToI32}};
+  std::vector<Function> functions{Function{0}};
+  DfgBuilder builder{types, functions, features, errors};
+
+  // (local i64 0x7fffffff) (local f32 1)
+  // local.get 0x80000000; drop; local.get 0; end
+  auto body = "\x20\x80\x80\x80\x80\x08\x1a\x20\x00\x0b"_expr;
+  EXPECT_TRUE(builder.Build(kI32ToI32,
+                            Code{{Locals{0x7fffffff, ValueType::I64},
+                                  Locals{1, ValueType::F32}},
+                                 body}));
+  builder.RemoveTrivialPhis();
+  ExpectNoErrors(errors);
+
+  // Only the local that is read gets a value.
+  const auto& values = builder.values();
+  EXPECT_GT(100u, values.size());
+  auto drop = std::find_if(
+      values.begin(), values.end(), [](const DfgValue& value) {
+        return value.instr == Instruction{Opcode::Drop};
+      });
+  ASSERT_NE(values.end(), drop);
+  ASSERT_EQ(1u, drop->operands.size());
+  EXPECT_EQ((Instruction{Opcode::F32Const, f32{0}}),
+            values[drop->operands[0]].instr);
+}
+
+TEST(DfgTest, Table) {
+  Features features;
+  features.enable_reference_types();
+  TestErrors errors;
+  std::vector<TypeEntry> types{TypeEntry{kI32ToI32}};
+  std::vector<Function> functions{Function{0}};
+  DfgBuilder builder{types, functions, features, errors};
+
+  // local.get 0; table.get 0; drop; table.size 0; end
+  EXPECT_TRUE(builder.Build(
+      kI32ToI32, Code{{}, "\x20\x00\x25\x00\x1a\xfc\x10\x00\x0b"_expr}));
+  builder.RemoveTrivialPhis();
+  ExpectNoErrors(errors);
+
+  const auto& values = builder.values();
+  EXPECT_EQ((Instruction{Opcode::TableSize, Index{0}}),
+            values[ReturnOperand(values)].instr);
+}
+
+TEST(DfgTest, UnsupportedExceptions) {
+  Features features;
+  features.enable_exceptions();
+  TestErrors errors;
+  std::vector<TypeEntry> types{TypeEntry{kI32ToI32}};
+  std::vector<Function> functions{Function{0}};
+  DfgBuilder builder{types, functions, features, errors};
+
+  // throw 0; end
+  auto body = "\x08\x00\x0b"_expr;
+  EXPECT_FALSE(builder.Build(kI32ToI32, Code{{}, body}));
+  ExpectError({{0, "`throw 0` is not supported"}}, errors, body.data);
+}
+
+TEST(DfgTest, UnsupportedMultiValue) {
+  Features features;
+  TestErrors errors;
+  std::vector<TypeEntry> types{
+      TypeEntry{kI32ToI32},
+      TypeEntry{FunctionType{{}, {ValueType::I32, ValueType::I32}}}};
+  std::vector<Function> functions{Function{0}, Function{1}};
+  DfgBuilder builder{types, functions, features, errors};
+
+  // call 1; drop; end
+  auto body = "\x10\x01\x1a\x0b"_expr;
+  EXPECT_FALSE(builder.Build(kI32ToI32, Code{{}, body}));
+  ExpectError({{0, "`call 1` is not supported"}}, errors, body.data);
+}
+
+TEST(DfgTest, Reuse) {
+  Features features;
+  TestErrors errors;
+  std::vector<TypeEntry> types{TypeEntry{kI32ToI32}};
+  std::vector<Function> functions{Function{0}, Function{0}};
+  DfgBuilder builder{types, functions, features, errors};
+
+  builder.Build(kI32ToI32, Code{{}, "\x20\x00\x41\x01\x6a\x0b"_expr});
+  auto first = builder.values().size();
+
+  builder.Build(kI32ToI32, Code{{}, "\x20\x00\x0b"_expr});
+  builder.RemoveTrivialPhis();
+  ExpectNoErrors(errors);
+  EXPECT_GT(first, builder.values().size());
+  EXPECT_EQ((Instruction{Opcode::LocalGet, Index{0}}),
+            builder.values()[ReturnOperand(builder.values())].instr);
+}
+
+TEST(DfgTest, ManyLocalsAndBlocks) {
+  const Index kCount = 2000;
+  Features features;
+  TestErrors errors;
+  std::vector<TypeEntry> types{TypeEntry{kI32ToI32}};
+  std::vector<Function> functions{Function{0}};
+  DfgBuilder builder{types, functions, features, errors};
+
+  // Copy local i to local i+1 in its own block, then return the last local.
+  std::vector<u8> data;
+  for (Index i = 0; i < kCount; ++i) {
+    Index from = i, to = i + 1;
+    data.insert(data.end(), {0x02, 0x40, 0x20});
+    for (; from >= 0x80; from >>= 7) {
+      data.push_back(0x80 | (from & 0x7f));
+    }
+    data.push_back(from);
+    data.push_back(0x21);
+    for (; to >= 0x80; to >>= 7) {
+      data.push_back(0x80 | (to & 0x7f));
+    }
+    data.push_back(to);
+    data.push_back(0x0b);
+  }
+  data.insert(data.end(), {0x20, 0xd0, 0x0f, 0x0b});  // local.get 2000; end
+
+  builder.Build(kI32ToI32,
+                Code{{Locals{kCount, ValueType::I32}}, Expression{data}});
+  builder.RemoveTrivialPhis();
+  ExpectNoErrors(errors);
+
+  const auto& values = builder.values();
+  EXPECT_LE(kCount, builder.block_count());
+  EXPECT_EQ((Instruction{Opcode::LocalGet, Index{0}}),
+            values[ReturnOperand(values)].instr);
+}
+
+TEST(DfgTest, ManyJoins) {
+  // Deep enough to overflow the stack if each join recursed.
+  const Index kCount = 50000;
+  Features features;
+  TestErrors errors;
+  std::vector<TypeEntry> types{TypeEntry{kI32ToI32}};
+  std::vector<Function> functions{Function{0}};
+  DfgBuilder builder{types, functions, features, errors};
+
+  // i32.const 7; local.set 1
+  // (local.get 0; if; nop; else; nop; end) * kCount
+  // local.get 1; end
+  std::vector<u8> data{0x41, 0x07, 0x21, 0x01};
+  for (Index i = 0; i < kCount; ++i) {
+    data.insert(data.end(), {0x20, 0x00, 0x04, 0x40, 0x01, 0x05, 0x01, 0x0b});
+  }
+  data.insert(data.end(), {0x20, 0x01, 0x0b});
+
+  // Each join needs a phi for local 1, so the read at the end has to look
+  // through every one of them to find the definition.
+  EXPECT_TRUE(builder.Build(
+      kI32ToI32, Code{{Locals{1, ValueType::I32}}, Expression{data}}));
+  builder.RemoveTrivialPhis();
+  ExpectNoErrors(errors);
+
+  const auto& values = builder.values();
+  EXPECT_LE(kCount * 3, builder.block_count());
+  EXPECT_EQ((Instruction{Opcode::I32Const, s32{7}}),
+            values[ReturnOperand(values)].instr);
+}
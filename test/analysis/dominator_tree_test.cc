@@ -0,0 +1,143 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/analysis/dominator_tree.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "test/binary/test_utils.h"
+#include "wasp/base/features.h"
+
+using namespace ::wasp;
+using namespace ::wasp::analysis;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+
+namespace {
+
+Cfg MakeCfg(SpanU8 body) {
+  Features features;
+  TestErrors errors;
+  auto cfg = BuildCfg(Code{{}, Expression{body}}, features, errors);
+  ExpectNoErrors(errors);
+  return cfg;
+}
+
+std::vector<BBID> ToVector(BBIDSpan span) {
+  return std::vector<BBID>{span.begin(), span.end()};
+}
+
+}  // namespace
+
+TEST(DominatorTreeTest, Empty) {
+  auto cfg = MakeCfg("\x0b"_su8);
+  auto dom = ComputeDominators(cfg);
+  EXPECT_EQ(0u, dom.size());
+  EXPECT_EQ(InvalidBBID, dom.root());
+
+  auto postdom = ComputePostDominators(cfg);
+  EXPECT_EQ(1u, postdom.size());
+  EXPECT_EQ(0u, postdom.root());
+}
+
+TEST(DominatorTreeTest, IfElse) {
+  // Blocks: 0 = condition, 1 = true arm, 2 = join, 3 = false arm.
+  auto cfg = MakeCfg(
+      "\x20\x00\x04\x7f\x41\x01\x05\x41\x02\x0b\x41\x03\x6a\x0b"_su8);
+  ASSERT_EQ(4u, cfg.block_count());
+
+  auto dom = ComputeDominators(cfg);
+  EXPECT_EQ(0u, dom.root());
+  EXPECT_EQ(InvalidBBID, dom.idom(0));
+  EXPECT_EQ(0u, dom.idom(1));
+  EXPECT_EQ(0u, dom.idom(2));
+  EXPECT_EQ(0u, dom.idom(3));
+  EXPECT_EQ((std::vector<BBID>{1, 2, 3}), ToVector(dom.children(0)));
+  EXPECT_TRUE(dom.Dominates(0, 2));
+  EXPECT_TRUE(dom.Dominates(2, 2));
+  EXPECT_FALSE(dom.Dominates(1, 2));
+  EXPECT_FALSE(dom.Dominates(2, 0));
+
+  auto postdom = ComputePostDominators(cfg);
+  const BBID exit = cfg.block_count();
+  EXPECT_EQ(exit, postdom.root());
+  EXPECT_EQ(2u, postdom.idom(0));
+  EXPECT_EQ(2u, postdom.idom(1));
+  EXPECT_EQ(exit, postdom.idom(2));
+  EXPECT_EQ(2u, postdom.idom(3));
+  EXPECT_TRUE(postdom.Dominates(2, 0));
+  EXPECT_FALSE(postdom.Dominates(1, 0));
+}
+
+TEST(DominatorTreeTest, Loop) {
+  // Blocks: 0 = loop body, 1 = after the loop.
+  auto cfg = MakeCfg("\x03\x40\x20\x00\x0d\x00\x0b\x41\x00\x0b"_su8);
+  ASSERT_EQ(2u, cfg.block_count());
+
+  auto dom = ComputeDominators(cfg);
+  EXPECT_EQ(InvalidBBID, dom.idom(0));
+  EXPECT_EQ(0u, dom.idom(1));
+
+  auto postdom = ComputePostDominators(cfg);
+  EXPECT_EQ(1u, postdom.idom(0));
+  EXPECT_EQ(2u, postdom.idom(1));
+}
+
+TEST(DominatorTreeTest, Unreachable) {
+  // unreachable nop
+  auto cfg = MakeCfg("\x00\x01\x0b"_su8);
+  ASSERT_EQ(2u, cfg.block_count());
+
+  // Block 1 can't be reached from the start.
+  auto dom = ComputeDominators(cfg);
+  EXPECT_TRUE(dom.reachable(0));
+  EXPECT_FALSE(dom.reachable(1));
+  EXPECT_EQ(InvalidBBID, dom.idom(1));
+  EXPECT_FALSE(dom.Dominates(0, 1));
+
+  // Block 0 never leaves the function.
+  auto postdom = ComputePostDominators(cfg);
+  EXPECT_FALSE(postdom.reachable(0));
+  EXPECT_TRUE(postdom.reachable(1));
+  EXPECT_EQ(2u, postdom.idom(1));
+}
+
+TEST(DominatorTreeTest, LongChain) {
+  const Index kCount = 5000;
+  // block local.get 0 br_if 0 nop end, repeated, then nop.
+  std::vector<u8> data;
+  for (Index i = 0; i < kCount; ++i) {
+    data.insert(data.end(), {0x02, 0x40, 0x20, 0x00, 0x0d, 0x00, 0x01, 0x0b});
+  }
+  data.insert(data.end(), {0x01, 0x0b});
+  auto cfg = MakeCfg(SpanU8{data});
+
+  auto dom = ComputeDominators(cfg);
+  auto postdom = ComputePostDominators(cfg);
+  // The last block is the only one that leaves the function.
+  BBID last = InvalidBBID;
+  for (BBID bbid = 0; bbid < cfg.block_count(); ++bbid) {
+    if (cfg.successors(bbid)[0].target == InvalidBBID) {
+      last = bbid;
+    }
+  }
+  ASSERT_NE(InvalidBBID, last);
+  EXPECT_TRUE(dom.reachable(last));
+  EXPECT_TRUE(dom.Dominates(cfg.start(), last));
+  EXPECT_TRUE(postdom.Dominates(last, cfg.start()));
+}
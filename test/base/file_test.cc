@@ -0,0 +1,115 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/file.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define WASP_TEST_HAS_PIPE 1
+#else
+#define WASP_TEST_HAS_PIPE 0
+#endif
+
+using namespace ::wasp;
+
+namespace {
+
+// A file in the test's temporary directory, removed when destroyed.
+class TempFile {
+ public:
+  TempFile(const std::string& name, const std::string& contents)
+      : path_{::testing::TempDir() + name} {
+    std::ofstream stream{path_, std::ios::out | std::ios::binary};
+    stream << contents;
+  }
+
+  ~TempFile() { std::remove(path_.c_str()); }
+
+  const std::string& path() const { return path_; }
+
+ private:
+  std::string path_;
+};
+
+std::string ToString(SpanU8 data) {
+  return std::string{data.begin(), data.end()};
+}
+
+}  // namespace
+
+TEST(FileTest, MapFile_Regular) {
+  const std::string contents{"\0asm\x01\0\0\0", 8};
+  TempFile file{"wasp_file_test_regular", contents};
+  auto mapped = MapFile(file.path());
+  ASSERT_TRUE(mapped.has_value());
+  EXPECT_EQ(contents, ToString(mapped->data()));
+}
+
+TEST(FileTest, MapFile_Empty) {
+  TempFile file{"wasp_file_test_empty", ""};
+  auto mapped = MapFile(file.path());
+  ASSERT_TRUE(mapped.has_value());
+  EXPECT_FALSE(mapped->is_mapped());
+  EXPECT_EQ(0, mapped->data().size());
+}
+
+TEST(FileTest, MapFile_Missing) {
+  EXPECT_FALSE(
+      MapFile(::testing::TempDir() + "wasp_file_test_missing").has_value());
+}
+
+TEST(FileTest, MappedFile_Move) {
+  TempFile file{"wasp_file_test_move", "abcd"};
+  auto mapped = MapFile(file.path());
+  ASSERT_TRUE(mapped.has_value());
+  MappedFile moved{std::move(*mapped)};
+  EXPECT_EQ("abcd", ToString(moved.data()));
+  EXPECT_EQ(0, mapped->data().size());
+}
+
+#if WASP_TEST_HAS_PIPE
+
+TEST(FileTest, MapFile_Stdin) {
+  // Replace stdin with a pipe, so "-" falls back to reading into a buffer.
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  const std::string contents = "streamed through stdin";
+  ASSERT_EQ(static_cast<ssize_t>(contents.size()),
+            write(fds[1], contents.data(), contents.size()));
+  close(fds[1]);
+
+  int saved_stdin = dup(STDIN_FILENO);
+  ASSERT_NE(-1, saved_stdin);
+  ASSERT_NE(-1, dup2(fds[0], STDIN_FILENO));
+  close(fds[0]);
+
+  auto mapped = MapFile("-");
+
+  dup2(saved_stdin, STDIN_FILENO);
+  close(saved_stdin);
+
+  ASSERT_TRUE(mapped.has_value());
+  EXPECT_FALSE(mapped->is_mapped());
+  EXPECT_EQ(contents, ToString(mapped->data()));
+}
+
+#endif  // WASP_TEST_HAS_PIPE
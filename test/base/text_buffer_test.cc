@@ -0,0 +1,99 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/text_buffer.h"
+
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+using namespace ::wasp;
+
+TEST(TextBufferTest, Append) {
+  std::ostringstream stream;
+  {
+    TextBuffer buffer{stream};
+    buffer.Append("hello");
+    buffer.Append(',');
+    buffer.AppendSpaces(3);
+    buffer.Append("world");
+    EXPECT_EQ("hello,   world", buffer.text());
+    EXPECT_EQ("", stream.str());
+  }
+  EXPECT_EQ("hello,   world", stream.str());
+}
+
+TEST(TextBufferTest, AppendUnsigned) {
+  std::ostringstream stream;
+  TextBuffer buffer{stream};
+  buffer.AppendUnsigned(0);
+  buffer.Append(' ');
+  buffer.AppendUnsigned(1234567890);
+  buffer.Append(' ');
+  buffer.AppendUnsigned(18446744073709551615ull);
+  EXPECT_EQ("0 1234567890 18446744073709551615", buffer.text());
+}
+
+TEST(TextBufferTest, AppendSigned) {
+  std::ostringstream stream;
+  TextBuffer buffer{stream};
+  buffer.AppendSigned(0);
+  buffer.Append(' ');
+  buffer.AppendSigned(-42);
+  buffer.Append(' ');
+  buffer.AppendSigned(9223372036854775807ll);
+  buffer.Append(' ');
+  buffer.AppendSigned(-9223372036854775807ll - 1);
+  EXPECT_EQ("0 -42 9223372036854775807 -9223372036854775808", buffer.text());
+}
+
+TEST(TextBufferTest, AppendHex) {
+  std::ostringstream stream;
+  TextBuffer buffer{stream};
+  buffer.AppendHex(0);
+  buffer.Append(' ');
+  buffer.AppendHex(0xab, 2);
+  buffer.Append(' ');
+  buffer.AppendHex(0x5, 2);
+  buffer.Append(' ');
+  buffer.AppendHex(0x1234, 6);
+  buffer.Append(' ');
+  buffer.AppendHex(0x12345678, 6);
+  buffer.Append(' ');
+  buffer.AppendHex(0xffffffffffffffffull);
+  EXPECT_EQ("0 ab 05 001234 12345678 ffffffffffffffff", buffer.text());
+}
+
+TEST(TextBufferTest, Print) {
+  std::ostringstream stream;
+  TextBuffer buffer{stream};
+  buffer.Print("{} + {} = {:>3}", 1, 2, 3);
+  EXPECT_EQ("1 + 2 =   3", buffer.text());
+}
+
+TEST(TextBufferTest, FlushAtThreshold) {
+  std::ostringstream stream;
+  TextBuffer buffer{stream, 8};
+  buffer.Append("1234");
+  EXPECT_EQ("", stream.str());
+  buffer.Append("5678");
+  EXPECT_EQ("12345678", stream.str());
+  EXPECT_EQ(0u, buffer.size());
+  buffer.Append("9");
+  EXPECT_EQ("12345678", stream.str());
+  buffer.Flush();
+  EXPECT_EQ("123456789", stream.str());
+}
@@ -0,0 +1,67 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/br_table_immediate.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "test/binary/test_utils.h"
+#include "wasp/binary/instruction.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+
+TEST(BrTableImmediateTest, Size) {
+  // The targets are a view, so a br_table immediate is no larger than a list
+  // of targets would be, and doesn't grow every Instruction.
+  EXPECT_LE(sizeof(BrTableImmediate), 4 * sizeof(void*));
+  EXPECT_LE(sizeof(Instruction), 6 * sizeof(void*));
+}
+
+TEST(BrTableImmediateTest, Targets) {
+  BrTableTargets targets{3, "\x01\x80\x01\xff\xff\xff\xff\x0f"_su8};
+  EXPECT_EQ(3u, targets.size());
+  EXPECT_EQ((std::vector<Index>{1, 128, 0xffffffff}),
+            (std::vector<Index>{targets.begin(), targets.end()}));
+}
+
+TEST(BrTableImmediateTest, Buffer) {
+  BrTableTargetsBuffer buffer{0, 200, 3};
+  buffer.push_back(0xffffffff);
+  auto targets = buffer.targets();
+  EXPECT_EQ(4u, targets.size());
+  EXPECT_EQ("\x00\xc8\x01\x03\xff\xff\xff\xff\x0f"_su8, targets.data());
+  EXPECT_EQ((std::vector<Index>{0, 200, 3, 0xffffffff}),
+            (std::vector<Index>{targets.begin(), targets.end()}));
+}
+
+TEST(BrTableImmediateTest, IteratorsOutliveTargets) {
+  // The iterators only refer to the encoded bytes, not the view, so they
+  // can outlive a temporary BrTableTargets.
+  BrTableTargetsBuffer buffer{5, 6, 7};
+  auto begin = buffer.targets().begin();
+  auto end = buffer.targets().end();
+  EXPECT_EQ((std::vector<Index>{5, 6, 7}), (std::vector<Index>{begin, end}));
+}
+
+TEST(BrTableImmediateTest, Empty) {
+  BrTableTargetsBuffer buffer;
+  EXPECT_TRUE(buffer.targets().empty());
+  EXPECT_EQ(BrTableTargets{}, buffer.targets());
+}
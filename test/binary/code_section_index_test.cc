@@ -0,0 +1,67 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/code_section_index.h"
+
+#include "gtest/gtest.h"
+
+#include "test/binary/test_utils.h"
+#include "wasp/base/features.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+
+TEST(CodeSectionIndexTest, Basic) {
+  Features features;
+  TestErrors errors;
+  auto data =
+      "\x03"
+      "\x02\x00\x0b"              // No locals.
+      "\x06\x02\x01\x7f\x02\x7e"  // 1 i32, 2 i64
+      "\x0b"
+      "\x04\x00\x41\x00\x0b"_su8;  // i32.const 0
+  CodeSectionIndex index{data, features, errors};
+
+  ASSERT_EQ(3u, index.size());
+  EXPECT_EQ("\x00"_su8, index.entries()[0].locals);
+  EXPECT_EQ("\x0b"_su8, index.entries()[0].body);
+  EXPECT_EQ("\x02\x01\x7f\x02\x7e"_su8, index.entries()[1].locals);
+  EXPECT_EQ("\x0b"_su8, index.entries()[1].body);
+  EXPECT_EQ("\x41\x00\x0b"_su8, index.entries()[2].body);
+
+  EXPECT_EQ((Code{{}, "\x0b"_expr}), index.GetCode(0, features, errors));
+  EXPECT_EQ((Code{{Locals{1, ValueType::I32}, Locals{2, ValueType::I64}},
+                  "\x0b"_expr}),
+            index.GetCode(1, features, errors));
+  EXPECT_EQ((Code{{}, "\x41\x00\x0b"_expr}), index.GetCode(2, features, errors));
+  EXPECT_EQ(nullopt, index.GetCode(3, features, errors));
+  ExpectNoErrors(errors);
+}
+
+TEST(CodeSectionIndexTest, BodyPastEnd) {
+  Features features;
+  TestErrors errors;
+  auto data =
+      "\x02"
+      "\x02\x00\x0b"
+      "\x05\x00\x0b"_su8;
+  CodeSectionIndex index{data, features, errors};
+
+  EXPECT_EQ(1u, index.size());
+  ExpectError({{4, "code"}, {5, "Length extends past end: 5 > 2"}}, errors,
+              data);
+}
@@ -0,0 +1,113 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/compact_instruction.h"
+
+#include <type_traits>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "test/binary/test_utils.h"
+#include "wasp/base/features.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+
+static_assert(std::is_trivially_copyable<CompactInstruction>::value,
+              "CompactInstruction must be trivially copyable");
+
+TEST(CompactInstructionTest, RoundTrip) {
+  using I = Instruction;
+  using O = Opcode;
+
+  const BrTableTargetsBuffer targets{1, 2, 3};
+  std::vector<Instruction> instructions = {
+      I{O::Nop},
+      I{O::Block, BlockType::I32},
+      I{O::Br, Index{3}},
+      I{O::CallIndirect, CallIndirectImmediate{5, 0}},
+      I{O::BrTable, BrTableImmediate{targets.targets(), 4}},
+      I{O::BrOnExn, BrOnExnImmediate{1, 2}},
+      I{O::MemorySize, u8{0}},
+      I{O::I32Load, MemArgImmediate{2, 0x12345678}},
+      I{O::I32Const, s32{-1}},
+      I{O::I64Const, s64{-0x123456789abcLL}},
+      I{O::F32Const, f32{1.5f}},
+      I{O::F64Const, f64{-2.25}},
+      I{O::V128Const, v128{u32x4{{1, 2, 3, 4}}}},
+      I{O::MemoryInit, InitImmediate{7, 0}},
+      I{O::MemoryCopy, CopyImmediate{0, 1}},
+      I{O::V8X16Shuffle, ShuffleImmediate{{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10,
+                                           11, 12, 13, 14, 15}}},
+      I{O::BrTable, BrTableImmediate{{}, 9}},
+  };
+
+  CompactExpression expr;
+  for (const auto& instruction : instructions) {
+    expr.Append(instruction);
+  }
+
+  ASSERT_EQ(instructions.size(), expr.instructions.size());
+  for (size_t i = 0; i < instructions.size(); ++i) {
+    BrTableTargetsBuffer buffer;
+    EXPECT_EQ(instructions[i],
+              expr.ToInstruction(expr.instructions[i], &buffer));
+  }
+
+  // Only br_table, v128 and shuffle use the arena.
+  EXPECT_EQ(4u + 4 + 4 + 1, expr.arena.size());
+
+  expr.clear();
+  EXPECT_TRUE(expr.instructions.empty());
+  EXPECT_TRUE(expr.arena.empty());
+}
+
+TEST(CompactInstructionTest, ReadCompactExpression) {
+  Features features;
+  TestErrors errors;
+  CompactExpression expr;
+  EXPECT_TRUE(ReadCompactExpression("\x41\x01\x0e\x02\x00\x01\x02\x1a\x0b"_expr,
+                                    features, errors, &expr));
+  ASSERT_EQ(4u, expr.instructions.size());
+  EXPECT_EQ(Opcode::I32Const, expr.instructions[0].opcode());
+  EXPECT_EQ(1, expr.instructions[0].s32_immediate());
+  EXPECT_EQ(Opcode::BrTable, expr.instructions[1].opcode());
+  EXPECT_EQ(CompactImmediateKind::BrTable, expr.instructions[1].kind());
+  auto targets = expr.instructions[1].br_table_targets(expr);
+  EXPECT_EQ((std::vector<Index>{0, 1}),
+            (std::vector<Index>{targets.begin(), targets.end()}));
+  EXPECT_EQ(2u, expr.instructions[1].br_table_default_target(expr));
+  EXPECT_EQ(Opcode::Drop, expr.instructions[2].opcode());
+  EXPECT_EQ(Opcode::End, expr.instructions[3].opcode());
+  ExpectNoErrors(errors);
+
+  // Reusing the expression replaces its contents.
+  EXPECT_TRUE(ReadCompactExpression("\x0b"_expr, features, errors, &expr));
+  EXPECT_EQ(1u, expr.instructions.size());
+  EXPECT_TRUE(expr.arena.empty());
+}
+
+TEST(CompactInstructionTest, ReadCompactExpression_Error) {
+  Features features;
+  TestErrors errors;
+  CompactExpression expr;
+  EXPECT_FALSE(
+      ReadCompactExpression("\x01\x41"_expr, features, errors, &expr));
+  EXPECT_EQ(1u, expr.instructions.size());
+  EXPECT_FALSE(errors.errors.empty());
+}
@@ -0,0 +1,98 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/errors.h"
+
+#include "gtest/gtest.h"
+
+#include "test/binary/test_utils.h"
+#include "wasp/base/features.h"
+#include "wasp/binary/errors_nop.h"
+#include "wasp/binary/read/read_instruction.h"
+#include "wasp/binary/read/read_reserved.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+
+namespace {
+
+// Counts calls that reach the handlers.
+class CountingErrors : public Errors {
+ public:
+  CountingErrors() = default;
+  explicit CountingErrors(Discard discard) : Errors{discard} {}
+
+  static CountingErrors MakeDiscarding() { return CountingErrors{Discard{}}; }
+
+  int push_count = 0;
+  int pop_count = 0;
+  int error_count = 0;
+
+ protected:
+  void HandlePushContext(SpanU8 pos, string_view desc) override {
+    ++push_count;
+  }
+  void HandlePopContext() override { ++pop_count; }
+  void HandleOnError(SpanU8 pos, string_view message) override {
+    ++error_count;
+  }
+};
+
+}  // namespace
+
+TEST(ErrorsTest, Forwards) {
+  CountingErrors errors;
+  EXPECT_FALSE(errors.discards());
+
+  errors.PushContext({}, "context");
+  errors.OnError({}, "error");
+  errors.PopContext();
+
+  EXPECT_EQ(1, errors.push_count);
+  EXPECT_EQ(1, errors.error_count);
+  EXPECT_EQ(1, errors.pop_count);
+}
+
+TEST(ErrorsTest, Discards) {
+  auto errors = CountingErrors::MakeDiscarding();
+  EXPECT_TRUE(errors.discards());
+
+  errors.PushContext({}, "context");
+  errors.OnError({}, "error");
+  errors.PopContext();
+
+  EXPECT_EQ(0, errors.push_count);
+  EXPECT_EQ(0, errors.error_count);
+  EXPECT_EQ(0, errors.pop_count);
+}
+
+TEST(ErrorsTest, ErrorsNop) {
+  ErrorsNop errors;
+  EXPECT_TRUE(errors.discards());
+  EXPECT_FALSE(TestErrors{}.discards());
+}
+
+TEST(ErrorsTest, ErrorsNop_ReadStillFails) {
+  // Discarding the message must not change the result of the read.
+  Features features;
+  ErrorsNop errors;
+  auto data = "\x01"_su8;
+  EXPECT_EQ(nullopt, ReadReserved(&data, features, errors));
+
+  auto bad_opcode = "\xff"_su8;
+  EXPECT_EQ(nullopt, Read<Instruction>(&bad_opcode, features, errors));
+}
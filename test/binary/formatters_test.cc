@@ -234,9 +234,15 @@ TEST(FormattersTest, CallIndirectImmediate) {
 }
 
 TEST(FormattersTest, BrTableImmediate) {
+  const BrTableTargetsBuffer targets{1, 2};
+  const BrTableTargetsBuffer one_target{42};
   EXPECT_EQ(R"([] 100)", format("{}", BrTableImmediate{{}, 100}));
-  EXPECT_EQ(R"([1 2] 3)", format("{}", BrTableImmediate{{1, 2}, 3}));
-  EXPECT_EQ(R"(  [42] 0)", format("{:>8s}", BrTableImmediate{{42}, 0}));
+  EXPECT_EQ(R"([1 2] 3)", format("{}", BrTableImmediate{targets.targets(), 3}));
+  EXPECT_EQ(R"(  [42] 0)",
+            format("{:>8s}", BrTableImmediate{one_target.targets(), 0}));
+  EXPECT_EQ(R"([5 128] 0)",
+            format("{}", BrTableImmediate{BrTableTargets{2, "\x05\x80\x01"_su8},
+                                          0}));
 }
 
 TEST(FormattersTest, BrOnExnImmediate) {
@@ -272,9 +278,10 @@ TEST(FormattersTest, Instruction) {
   // br 3
   EXPECT_EQ(R"(br 3)", format("{}", Instruction{Opcode::Br, Index{3u}}));
   // br_table 0 1 4
-  EXPECT_EQ(
-      R"(br_table [0 1] 4)",
-      format("{}", Instruction{Opcode::BrTable, BrTableImmediate{{0, 1}, 4}}));
+  const BrTableTargetsBuffer targets{0, 1};
+  EXPECT_EQ(R"(br_table [0 1] 4)",
+            format("{}", Instruction{Opcode::BrTable,
+                                     BrTableImmediate{targets.targets(), 4}}));
   // call_indirect 1 (w/ a reserved value of 0)
   EXPECT_EQ(
       R"(call_indirect 1 0)",
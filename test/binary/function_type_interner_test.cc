@@ -0,0 +1,93 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/function_type_interner.h"
+
+#include "gtest/gtest.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+
+namespace {
+
+using VT = ValueType;
+
+ValueTypes ToVector(ValueTypeSpan span) {
+  return ValueTypes(span.begin(), span.end());
+}
+
+}  // namespace
+
+TEST(FunctionTypeInternerTest, Basic) {
+  FunctionTypeInterner interner;
+
+  EXPECT_EQ(0u, interner.Intern(FunctionType{}));
+  EXPECT_EQ(1u, interner.Intern(FunctionType{{VT::I32}, {}}));
+  EXPECT_EQ(2u, interner.Intern(FunctionType{{}, {VT::I32}}));
+  EXPECT_EQ(3u, interner.Intern(FunctionType{{VT::I32, VT::F64}, {VT::I64}}));
+  EXPECT_EQ(4u, interner.size());
+
+  // Duplicates get the id of the first occurrence.
+  EXPECT_EQ(0u, interner.Intern(FunctionType{}));
+  EXPECT_EQ(2u, interner.Intern(FunctionType{{}, {VT::I32}}));
+  EXPECT_EQ(3u, interner.Intern(FunctionType{{VT::I32, VT::F64}, {VT::I64}}));
+  EXPECT_EQ(4u, interner.size());
+
+  EXPECT_EQ((ValueTypes{}), ToVector(interner.param_types(0)));
+  EXPECT_EQ((ValueTypes{}), ToVector(interner.result_types(0)));
+  EXPECT_EQ((ValueTypes{VT::I32}), ToVector(interner.param_types(1)));
+  EXPECT_EQ((ValueTypes{}), ToVector(interner.result_types(1)));
+  EXPECT_EQ((ValueTypes{}), ToVector(interner.param_types(2)));
+  EXPECT_EQ((ValueTypes{VT::I32}), ToVector(interner.result_types(2)));
+  EXPECT_EQ((ValueTypes{VT::I32, VT::F64}), ToVector(interner.param_types(3)));
+  EXPECT_EQ((ValueTypes{VT::I64}), ToVector(interner.result_types(3)));
+}
+
+TEST(FunctionTypeInternerTest, Find) {
+  FunctionTypeInterner interner;
+  const ValueType i32[] = {VT::I32};
+
+  EXPECT_EQ(nullopt, interner.Find({}, {}));
+  interner.Intern(i32, {});
+  EXPECT_EQ(0u, interner.Find(i32, {}));
+  EXPECT_EQ(nullopt, interner.Find({}, i32));
+  EXPECT_EQ(nullopt, interner.Find({}, {}));
+}
+
+TEST(FunctionTypeInternerTest, Many) {
+  FunctionTypeInterner interner;
+  const VT types[] = {VT::I32, VT::I64, VT::F32, VT::F64};
+
+  // Every signature with up to 3 params and 1 result, interned twice. This
+  // grows the table several times.
+  for (int pass = 0; pass < 2; ++pass) {
+    Index id = 0;
+    for (int params = 0; params < 64; ++params) {
+      for (int result = 0; result < 4; ++result) {
+        ValueTypes param_types;
+        for (int n = params; n != 0; n /= 4) {
+          param_types.push_back(types[n % 4]);
+        }
+        ValueTypes result_types{types[result]};
+        EXPECT_EQ(id, interner.Intern(FunctionType{param_types, result_types}));
+        EXPECT_EQ(param_types, ToVector(interner.param_types(id)));
+        EXPECT_EQ(result_types, ToVector(interner.result_types(id)));
+        ++id;
+      }
+    }
+  }
+  EXPECT_EQ(256u, interner.size());
+}
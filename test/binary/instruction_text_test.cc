@@ -0,0 +1,80 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/instruction_text.h"
+
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "wasp/base/text_buffer.h"
+#include "wasp/binary/formatters.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+
+namespace {
+
+std::string AppendToString(const Instruction& instr) {
+  std::ostringstream stream;
+  TextBuffer buffer{stream};
+  AppendInstruction(buffer, instr);
+  return buffer.text().to_string();
+}
+
+}  // namespace
+
+TEST(InstructionTextTest, GetOpcodeName) {
+  EXPECT_EQ("unreachable", GetOpcodeName(Opcode::Unreachable));
+  EXPECT_EQ("i32.add", GetOpcodeName(Opcode::I32Add));
+  EXPECT_EQ("memory.init", GetOpcodeName(Opcode::MemoryInit));
+  EXPECT_EQ("v8x16.shuffle", GetOpcodeName(Opcode::V8X16Shuffle));
+}
+
+TEST(InstructionTextTest, GetBlockTypeName) {
+  EXPECT_EQ("[i32]", GetBlockTypeName(BlockType::I32));
+  EXPECT_EQ("[]", GetBlockTypeName(BlockType::Void));
+}
+
+TEST(InstructionTextTest, MatchesFormatter) {
+  const BrTableTargetsBuffer targets{0, 1, 2};
+  const Instruction instrs[] = {
+      Instruction{Opcode::Nop},
+      Instruction{Opcode::Block, BlockType::I32},
+      Instruction{Opcode::Loop, BlockType::Void},
+      Instruction{Opcode::Br, Index{3u}},
+      Instruction{Opcode::BrTable, BrTableImmediate{{}, 4}},
+      Instruction{Opcode::BrTable, BrTableImmediate{targets.targets(), 4}},
+      Instruction{Opcode::CallIndirect, CallIndirectImmediate{1, 0}},
+      Instruction{Opcode::MemorySize, u8{0}},
+      Instruction{Opcode::I32Load, MemArgImmediate{2, 10}},
+      Instruction{Opcode::I32Const, s32{-100}},
+      Instruction{Opcode::I64Const, s64{1000}},
+      Instruction{Opcode::I64Const, s64{-9223372036854775807ll - 1}},
+      Instruction{Opcode::F32Const, f32{1.5}},
+      Instruction{Opcode::F64Const, f64{6.25}},
+      Instruction{Opcode::MemoryInit, InitImmediate{0, 10}},
+      Instruction{Opcode::MemoryCopy, CopyImmediate{0, 1}},
+      Instruction{Opcode::V8X16Shuffle,
+                  ShuffleImmediate{
+                      {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}}},
+  };
+
+  for (const auto& instr : instrs) {
+    EXPECT_EQ(format("{}", instr), AppendToString(instr));
+  }
+}
@@ -108,3 +108,22 @@ TEST(LazyModuleUtilsTest, GetImportCount) {
   EXPECT_EQ(1u, GetImportCount(module, ExternalKind::Table, features, errors));
   ExpectNoErrors(errors);
 }
+
+TEST(LazyModuleUtilsTest, CopyFunctionNames_SectionIndex) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadModule(GetModuleData(), features, errors);
+  SectionIndex index{module};
+
+  using FunctionNameMap = std::map<Index, string_view>;
+
+  FunctionNameMap function_names;
+  CopyFunctionNames(index, std::inserter(function_names, function_names.end()),
+                    features, errors);
+
+  EXPECT_EQ((FunctionNameMap{{0, "import"}, {1, "export"}, {2, "custom"}}),
+            function_names);
+  EXPECT_EQ(1u,
+            GetImportCount(index, ExternalKind::Function, features, errors));
+  ExpectNoErrors(errors);
+}
@@ -0,0 +1,164 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/opcode_info.h"
+
+#include "gtest/gtest.h"
+
+#include "wasp/base/features.h"
+#include "wasp/binary/encoding/opcode_encoding.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+
+TEST(OpcodeInfoTest, GetOpcodeInfo) {
+  auto info = GetOpcodeInfo(Opcode::I32Load);
+  ASSERT_NE(nullptr, info);
+  EXPECT_EQ(Opcode::I32Load, info->opcode);
+  EXPECT_EQ(0, info->prefix);
+  EXPECT_EQ(0x28u, info->code);
+  EXPECT_EQ(ImmediateKind::MemArg, info->immediate);
+  EXPECT_EQ(nullptr, info->feature);
+  EXPECT_EQ("i32.load", info->name);
+
+  info = GetOpcodeInfo(Opcode::MemoryCopy);
+  ASSERT_NE(nullptr, info);
+  EXPECT_EQ(0xfc, info->prefix);
+  EXPECT_EQ(0x0au, info->code);
+  EXPECT_EQ(ImmediateKind::Copy, info->immediate);
+  EXPECT_EQ(&Features::bulk_memory_enabled, info->feature);
+
+  EXPECT_EQ(nullptr, GetOpcodeInfo(static_cast<Opcode>(0xffffffff)));
+}
+
+TEST(OpcodeInfoTest, ImmediateKinds) {
+  EXPECT_EQ(ImmediateKind::Empty, GetOpcodeInfo(Opcode::I32Add)->immediate);
+  EXPECT_EQ(ImmediateKind::BlockType, GetOpcodeInfo(Opcode::If)->immediate);
+  EXPECT_EQ(ImmediateKind::Index, GetOpcodeInfo(Opcode::TableSize)->immediate);
+  EXPECT_EQ(ImmediateKind::Reserved,
+            GetOpcodeInfo(Opcode::MemoryGrow)->immediate);
+  EXPECT_EQ(ImmediateKind::U8,
+            GetOpcodeInfo(Opcode::I8X16ExtractLaneS)->immediate);
+  EXPECT_EQ(ImmediateKind::MemArg,
+            GetOpcodeInfo(Opcode::I64AtomicRmw32CmpxchgU)->immediate);
+}
+
+TEST(OpcodeInfoTest, DecodeMatchesEncoding) {
+  Features features;
+  features.EnableAll();
+  Index count = 0;
+  for (u32 i = 0;; ++i) {
+    auto opcode = static_cast<Opcode>(i);
+    auto info = GetOpcodeInfo(opcode);
+    if (!info) {
+      break;
+    }
+    ++count;
+    auto encoded = encoding::Opcode::Encode(opcode);
+    if (encoded.u32_code) {
+      EXPECT_EQ(info->prefix, encoded.u8_code);
+      EXPECT_EQ(info->code, *encoded.u32_code);
+      EXPECT_EQ(info, DecodeOpcode(info->prefix, info->code, features));
+    } else {
+      EXPECT_EQ(0, info->prefix);
+      EXPECT_EQ(info->code, encoded.u8_code);
+      EXPECT_EQ(info, DecodeOpcode(encoded.u8_code, features));
+    }
+  }
+  EXPECT_GT(count, 400u);
+}
+
+TEST(OpcodeInfoTest, DecodeMatchesSwitch) {
+  Features features;
+  features.EnableAll();
+  for (u32 code = 0; code < 256; ++code) {
+    auto info = DecodeOpcode(code, features);
+    auto opcode = encoding::Opcode::Decode(code, features);
+    ASSERT_EQ(info != nullptr, opcode.has_value()) << code;
+    if (info) {
+      EXPECT_EQ(*opcode, info->opcode);
+    }
+  }
+
+  for (u8 prefix : {encoding::Opcode::MiscPrefix, encoding::Opcode::SimdPrefix,
+                    encoding::Opcode::ThreadsPrefix}) {
+    for (u32 code = 0; code < 512; ++code) {
+      auto info = DecodeOpcode(prefix, code, features);
+      auto opcode = encoding::Opcode::Decode(prefix, code, features);
+      ASSERT_EQ(info != nullptr, opcode.has_value()) << prefix << " " << code;
+      if (info) {
+        EXPECT_EQ(*opcode, info->opcode);
+      }
+    }
+  }
+}
+
+TEST(OpcodeInfoTest, DecodeFeatures) {
+  Features features;
+  EXPECT_EQ(nullptr, DecodeOpcode(0xc0, features));  // i32.extend8_s
+  EXPECT_EQ(nullptr, DecodeOpcode(0xfc, 0x0a, features));  // memory.copy
+
+  features.enable_sign_extension();
+  features.enable_bulk_memory();
+  ASSERT_NE(nullptr, DecodeOpcode(0xc0, features));
+  EXPECT_EQ(Opcode::I32Extend8S, DecodeOpcode(0xc0, features)->opcode);
+  ASSERT_NE(nullptr, DecodeOpcode(0xfc, 0x0a, features));
+  EXPECT_EQ(Opcode::MemoryCopy, DecodeOpcode(0xfc, 0x0a, features)->opcode);
+}
+
+TEST(OpcodeInfoTest, DecodeUnknown) {
+  Features features;
+  features.EnableAll();
+  EXPECT_EQ(nullptr, DecodeOpcode(0xff, features));
+  EXPECT_EQ(nullptr, DecodeOpcode(0xfc, 0xffffffff, features));
+  EXPECT_EQ(nullptr, DecodeOpcode(0x00, 0x00, features));
+}
+
+namespace {
+
+ValueTypes ToValueTypes(ValueTypeSpan span) {
+  return ValueTypes{span.begin(), span.end()};
+}
+
+}  // namespace
+
+TEST(OpcodeInfoTest, StackSignature) {
+  auto sig = GetOpcodeInfo(Opcode::I32Add)->stack_signature;
+  ASSERT_NE(nullptr, sig);
+  EXPECT_EQ((ValueTypes{ValueType::I32, ValueType::I32}),
+            ToValueTypes(sig->param_types()));
+  EXPECT_EQ(ValueTypes{ValueType::I32}, ToValueTypes(sig->result_types()));
+
+  sig = GetOpcodeInfo(Opcode::I64Store32)->stack_signature;
+  ASSERT_NE(nullptr, sig);
+  EXPECT_EQ((ValueTypes{ValueType::I32, ValueType::I64}),
+            ToValueTypes(sig->param_types()));
+  EXPECT_EQ(0, sig->result_count);
+
+  sig = GetOpcodeInfo(Opcode::V128BitSelect)->stack_signature;
+  ASSERT_NE(nullptr, sig);
+  EXPECT_EQ(3, sig->param_count);
+  EXPECT_EQ(1, sig->result_count);
+
+  sig = GetOpcodeInfo(Opcode::Nop)->stack_signature;
+  ASSERT_NE(nullptr, sig);
+  EXPECT_EQ(0, sig->param_count);
+  EXPECT_EQ(0, sig->result_count);
+
+  EXPECT_EQ(nullptr, GetOpcodeInfo(Opcode::Call)->stack_signature);
+  EXPECT_EQ(nullptr, GetOpcodeInfo(Opcode::LocalGet)->stack_signature);
+  EXPECT_EQ(nullptr, GetOpcodeInfo(Opcode::Select)->stack_signature);
+}
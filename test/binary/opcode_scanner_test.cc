@@ -0,0 +1,142 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/opcode_scanner.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "test/binary/test_utils.h"
+#include "wasp/base/features.h"
+#include "wasp/binary/formatters.h"
+#include "wasp/binary/lazy_expression.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+
+namespace {
+
+std::vector<ScannedInstruction> ScanAll(SpanU8 data,
+                                        const OpcodeSet& opcodes,
+                                        const Features& features,
+                                        Errors& errors) {
+  std::vector<ScannedInstruction> result;
+  OpcodeScanner scanner{data, opcodes, features, errors};
+  while (auto scanned = scanner.Next()) {
+    result.push_back(*scanned);
+  }
+  return result;
+}
+
+// One instruction of each immediate kind, with multi-byte LEB128 values.
+const SpanU8 kMixedBody =
+    "\x02\x40"                              // 0: block
+    "\x20\x80\x01"                          // 2: local.get 128
+    "\x10\x01"                              // 5: call 1
+    "\x0e\x02\x00\x81\x00\x00"              // 7: br_table 0 1 0
+    "\x28\x02\x90\x80\x01"                  // 13: i32.load align=2
+    "\x42\xff\xff\xff\xff\xff\xff\x00"      // 18: i64.const
+    "\x43\x00\x00\x80\x3f"                  // 26: f32.const 1
+    "\x44\x00\x00\x00\x00\x00\x00\xf0\x3f"  // 31: f64.const 1
+    "\x11\x00\x00"                          // 40: call_indirect 0
+    "\x3f\x00"                              // 43: memory.size
+    "\xfc\x0a\x00\x00"                      // 45: memory.copy
+    "\xfd\x02\x00\x01\x02\x03\x04\x05\x06\x07"
+    "\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f"      // 49: v128.const
+    "\xfd\x0d\x01"                          // 67: i8x16.extract_lane_s 1
+    "\x10\x82\x01"                          // 70: call 130
+    "\x0b"                                  // 73: end
+    "\x0b"_su8;                             // 74: end
+
+}  // namespace
+
+TEST(OpcodeScannerTest, OpcodeSet) {
+  OpcodeSet set{Opcode::Call, Opcode::I32Load};
+  EXPECT_TRUE(set.Contains(Opcode::Call));
+  EXPECT_TRUE(set.Contains(Opcode::I32Load));
+  EXPECT_FALSE(set.Contains(Opcode::Nop));
+  EXPECT_FALSE(set.Contains(Opcode::V128Const));
+
+  set.Add(Opcode::V128Const);
+  EXPECT_TRUE(set.Contains(Opcode::V128Const));
+}
+
+TEST(OpcodeScannerTest, Calls) {
+  Features features;
+  features.EnableAll();
+  TestErrors errors;
+  auto scanned = ScanAll(kMixedBody, OpcodeSet{Opcode::Call}, features, errors);
+  ExpectNoErrors(errors);
+
+  ASSERT_EQ(2u, scanned.size());
+  EXPECT_EQ(5u, scanned[0].offset);
+  EXPECT_EQ((Instruction{Opcode::Call, Index{1}}), scanned[0].instruction);
+  EXPECT_EQ(70u, scanned[1].offset);
+  EXPECT_EQ((Instruction{Opcode::Call, Index{130}}), scanned[1].instruction);
+}
+
+TEST(OpcodeScannerTest, EmptySet) {
+  Features features;
+  features.EnableAll();
+  TestErrors errors;
+  EXPECT_TRUE(ScanAll(kMixedBody, OpcodeSet{}, features, errors).empty());
+  ExpectNoErrors(errors);
+}
+
+TEST(OpcodeScannerTest, MatchesReadExpression) {
+  Features features;
+  features.EnableAll();
+  TestErrors errors;
+
+  OpcodeSet all;
+  std::vector<Instruction> expected;
+  for (const auto& instr : ReadExpression(kMixedBody, features, errors)) {
+    all.Add(instr.opcode);
+    expected.push_back(instr);
+  }
+
+  auto scanned = ScanAll(kMixedBody, all, features, errors);
+  ExpectNoErrors(errors);
+  ASSERT_EQ(expected.size(), scanned.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i], scanned[i].instruction);
+  }
+  EXPECT_EQ(0u, scanned[0].offset);
+  EXPECT_EQ(13u, scanned[4].offset);
+  EXPECT_EQ(74u, scanned.back().offset);
+}
+
+TEST(OpcodeScannerTest, UnknownOpcode) {
+  Features features;
+  TestErrors errors;
+  const SpanU8 data = "\x01\x10\x00\x06\x10\x01"_su8;
+  auto scanned = ScanAll(data, OpcodeSet{Opcode::Call}, features, errors);
+  ASSERT_EQ(1u, scanned.size());
+  EXPECT_EQ(1u, scanned[0].offset);
+  ExpectError({{3, "opcode"}, {4, "Unknown opcode: 6"}}, errors, data);
+}
+
+TEST(OpcodeScannerTest, TruncatedImmediate) {
+  Features features;
+  TestErrors errors;
+  const SpanU8 data = "\x01\x41\x80"_su8;
+  auto scanned = ScanAll(data, OpcodeSet{Opcode::Call}, features, errors);
+  EXPECT_TRUE(scanned.empty());
+  ExpectError({{2, "i32 constant"}, {2, "s32"}, {3, "Unable to read u8"}},
+              errors, data);
+}
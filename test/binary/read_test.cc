@@ -70,6 +70,7 @@
 #include "wasp/binary/read/read_u8.h"
 #include "wasp/binary/read/read_v128.h"
 #include "wasp/binary/read/read_value_type.h"
+#include "wasp/binary/read/read_var_u32s.h"
 #include "wasp/binary/read/read_vector.h"
 
 using namespace ::wasp;
@@ -125,11 +126,27 @@ TEST(ReadTest, BrOnExnImmediate_PastEnd) {
 }
 
 TEST(ReadTest, BrTableImmediate) {
+  const BrTableTargetsBuffer targets{1, 2};
   ExpectRead<BrTableImmediate>(BrTableImmediate{{}, 0}, "\x00\x00"_su8);
-  ExpectRead<BrTableImmediate>(BrTableImmediate{{1, 2}, 3},
+  ExpectRead<BrTableImmediate>(BrTableImmediate{targets.targets(), 3},
                                "\x02\x01\x02\x03"_su8);
 }
 
+TEST(ReadTest, BrTableImmediate_EncodedTargets) {
+  Features features;
+  TestErrors errors;
+  SpanU8 data = "\x03\x80\x01\x02\xff\xff\x03\x04"_su8;
+  auto result = Read<BrTableImmediate>(&data, features, errors);
+  ExpectNoErrors(errors);
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(0u, data.size());
+  EXPECT_EQ(3u, result->targets.size());
+  EXPECT_EQ((std::vector<Index>{128, 2, 65535}),
+            (std::vector<Index>{result->targets.begin(),
+                                result->targets.end()}));
+  EXPECT_EQ(4u, result->default_target);
+}
+
 TEST(ReadTest, BrTableImmediate_PastEnd) {
   ExpectReadFailure<BrTableImmediate>(
       {{0, "br_table"}, {0, "targets"}, {0, "count"}, {0, "Unable to read u8"}},
@@ -138,6 +155,12 @@ TEST(ReadTest, BrTableImmediate_PastEnd) {
   ExpectReadFailure<BrTableImmediate>(
       {{0, "br_table"}, {1, "default target"}, {1, "Unable to read u8"}},
       "\x00"_su8);
+
+  ExpectReadFailure<BrTableImmediate>({{0, "br_table"},
+                                       {0, "targets"},
+                                       {2, "u32"},
+                                       {3, "Unable to read u8"}},
+                                      "\x02\x01\x80"_su8);
 }
 
 TEST(ReadTest, ReadBytes) {
@@ -915,6 +938,7 @@ TEST(ReadTest, Instruction) {
   using I = Instruction;
   using O = Opcode;
   using MemArg = MemArgImmediate;
+  const BrTableTargetsBuffer targets{3, 4, 5};
 
   ExpectRead<I>(I{O::Unreachable}, "\x00"_su8);
   ExpectRead<I>(I{O::Nop}, "\x01"_su8);
@@ -925,7 +949,7 @@ TEST(ReadTest, Instruction) {
   ExpectRead<I>(I{O::End}, "\x0b"_su8);
   ExpectRead<I>(I{O::Br, Index{1}}, "\x0c\x01"_su8);
   ExpectRead<I>(I{O::BrIf, Index{2}}, "\x0d\x02"_su8);
-  ExpectRead<I>(I{O::BrTable, BrTableImmediate{{3, 4, 5}, 6}},
+  ExpectRead<I>(I{O::BrTable, BrTableImmediate{targets.targets(), 6}},
                 "\x0e\x03\x03\x04\x05\x06"_su8);
   ExpectRead<I>(I{O::Return}, "\x0f"_su8);
   ExpectRead<I>(I{O::Call, Index{7}}, "\x10\x07"_su8);
@@ -2462,6 +2486,82 @@ TEST(ReadTest, U32_PastEnd) {
                          "\xf0\xf0\xf0\xf0"_su8);
 }
 
+TEST(ReadTest, U32_FastPath) {
+  // Trailing bytes, so the longest encoding always fits.
+  auto expect_read = [](u32 expected, SpanU8 data, size_t expected_size) {
+    Features features;
+    TestErrors errors;
+    auto result = Read<u32>(&data, features, errors);
+    ExpectNoErrors(errors);
+    EXPECT_EQ(expected, result);
+    EXPECT_EQ(expected_size, data.size());
+  };
+  expect_read(32u, "\x20\x00\x00\x00\x00\x00"_su8, 5);
+  expect_read(448u, "\xc0\x03\x00\x00\x00\x00"_su8, 4);
+  expect_read(1042036848u, "\xf0\xf0\xf0\xf0\x03\x00"_su8, 1);
+
+  ExpectReadFailure<u32>(
+      {{0, "u32"},
+       {5, "Last byte of u32 must be zero extension: expected 0x2, got 0x12"}},
+      "\xf0\xf0\xf0\xf0\x12\x00"_su8);
+}
+
+TEST(ReadTest, VarU32s) {
+  Features features;
+  TestErrors errors;
+  std::vector<u8> bytes;
+  std::vector<u32> expected;
+  // Long runs of single-byte values, interrupted by multi-byte values.
+  for (u32 i = 0; i < 200; ++i) {
+    if (i % 37 == 0) {
+      bytes.insert(bytes.end(), {0xf0, 0xf0, 0xf0, 0xf0, 0x03});
+      expected.push_back(1042036848u);
+    } else if (i % 53 == 0) {
+      bytes.insert(bytes.end(), {0xc0, 0x03});
+      expected.push_back(448u);
+    } else {
+      bytes.push_back(i & 0x7f);
+      expected.push_back(i & 0x7f);
+    }
+  }
+  bytes.push_back(0xff);  // Not part of the values.
+
+  SpanU8 data{bytes};
+  std::vector<u32> actual(expected.size());
+  EXPECT_TRUE(
+      ReadVarU32s(&data, actual.data(), actual.size(), features, errors));
+  ExpectNoErrors(errors);
+  EXPECT_EQ(expected, actual);
+  EXPECT_EQ(1u, data.size());
+}
+
+TEST(ReadTest, VarU32s_Errors) {
+  std::vector<u8> bytes(40, 0x01);
+  bytes.insert(bytes.end(), {0xf0, 0xf0, 0xf0, 0xf0, 0x12, 0x00});
+  const SpanU8 orig_data{bytes};
+  std::vector<u32> out(41);
+
+  Features features;
+  TestErrors errors;
+  SpanU8 data = orig_data;
+  EXPECT_EQ(40u, DecodeVarU32s(&data, out.data(), out.size()));
+  EXPECT_EQ(6u, data.size());
+
+  data = orig_data;
+  EXPECT_FALSE(ReadVarU32s(&data, out.data(), out.size(), features, errors));
+  ExpectError(
+      {{40, "u32"},
+       {45, "Last byte of u32 must be zero extension: expected 0x2, got 0x12"}},
+      errors, orig_data);
+
+  // Truncated.
+  TestErrors errors2;
+  data = SpanU8{bytes.data(), 42};
+  EXPECT_FALSE(ReadVarU32s(&data, out.data(), out.size(), features, errors2));
+  ExpectError({{40, "u32"}, {42, "Unable to read u8"}}, errors2,
+              SpanU8{bytes.data(), 42});
+}
+
 TEST(ReadTest, U8) {
   ExpectRead<u8>(32, "\x20"_su8);
   ExpectReadFailure<u8>({{0, "Unable to read u8"}}, ""_su8);
@@ -0,0 +1,103 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/relocation_index.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "test/binary/test_utils.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+
+namespace {
+
+std::vector<u32> Offsets(RelocationEntrySpan entries) {
+  std::vector<u32> result;
+  for (const auto& entry : entries) {
+    result.push_back(entry.offset);
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(RelocationIndexTest, Sorted) {
+  Features features;
+  TestErrors errors;
+  auto sec = ReadRelocationSection(
+      "\x01\x04"  // Section index = 1, 4 relocations.
+      "\x00\x14\x00"
+      "\x00\x05\x01"
+      "\x00\x0a\x02"
+      "\x00\x05\x03"_su8,
+      features, errors);
+  RelocationIndex index{sec};
+  ExpectNoErrors(errors);
+
+  EXPECT_EQ((std::vector<u32>{5, 5, 10, 20}), Offsets(index.entries()));
+  // Entries with the same offset keep their order.
+  EXPECT_EQ(1u, index.entries()[0].index);
+  EXPECT_EQ(3u, index.entries()[1].index);
+}
+
+TEST(RelocationIndexTest, Find) {
+  Features features;
+  TestErrors errors;
+  auto sec = ReadRelocationSection(
+      "\x01\x03"
+      "\x00\x05\x00"
+      "\x00\x0a\x00"
+      "\x00\x14\x00"_su8,
+      features, errors);
+  RelocationIndex index{sec};
+
+  EXPECT_EQ((std::vector<u32>{5, 10}), Offsets(index.Find(0, 11)));
+  EXPECT_EQ((std::vector<u32>{10}), Offsets(index.Find(10, 20)));
+  EXPECT_EQ((std::vector<u32>{}), Offsets(index.Find(11, 20)));
+  EXPECT_EQ((std::vector<u32>{20}), Offsets(index.Find(11, 100)));
+}
+
+TEST(RelocationIndexTest, Cursor) {
+  Features features;
+  TestErrors errors;
+  auto sec = ReadRelocationSection(
+      "\x01\x04"
+      "\x00\x05\x00"
+      "\x00\x0a\x00"
+      "\x00\x0b\x00"
+      "\x00\x14\x00"_su8,
+      features, errors);
+  RelocationIndex index{sec};
+
+  auto cursor = index.GetCursor(6);
+  EXPECT_EQ((std::vector<u32>{}), Offsets(cursor.AdvanceTo(10)));
+  EXPECT_EQ((std::vector<u32>{10, 11}), Offsets(cursor.AdvanceTo(12)));
+  EXPECT_FALSE(cursor.done());
+  EXPECT_EQ((std::vector<u32>{20}), Offsets(cursor.AdvanceTo(100)));
+  EXPECT_TRUE(cursor.done());
+  EXPECT_EQ((std::vector<u32>{}), Offsets(cursor.AdvanceTo(200)));
+}
+
+TEST(RelocationIndexTest, Empty) {
+  RelocationIndex index;
+  EXPECT_TRUE(index.entries().empty());
+  EXPECT_TRUE(index.Find(0, 100).empty());
+  EXPECT_TRUE(index.GetCursor(0).done());
+}
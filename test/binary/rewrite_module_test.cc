@@ -0,0 +1,163 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/rewrite_module.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "test/binary/test_utils.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/write/write_section.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+
+namespace {
+
+const SpanU8 kModule =
+    "\0asm\x01\0\0\0"
+    "\x01\x03\0\0\0"            // Type section.
+    "\x00\x06\x03yup\0\0"       // Custom section "yup".
+    "\x0a\x01\0"                // Code section.
+    "\x00\x05\x04name"_su8;     // Custom section "name".
+
+std::vector<u8> ToVector(SpanU8 data) {
+  return std::vector<u8>(data.begin(), data.end());
+}
+
+}  // namespace
+
+TEST(RewriteModuleTest, KeepAll) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadModule(kModule, features, errors);
+
+  std::vector<SpanU8> spans;
+  EXPECT_TRUE(RewriteModule(
+      module,
+      [](const Section&, WriteBuffer&) { return SectionAction::Keep; },
+      [&](SpanU8 data) { spans.push_back(data); }));
+
+  // The whole module is passed through as one span of the original data.
+  ASSERT_EQ(1u, spans.size());
+  EXPECT_EQ(kModule.begin(), spans[0].begin());
+  EXPECT_EQ(kModule.size(), spans[0].size());
+  ExpectNoErrors(errors);
+}
+
+TEST(RewriteModuleTest, DropCustomSections) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadModule(kModule, features, errors);
+
+  std::vector<SpanU8> spans;
+  EXPECT_TRUE(RewriteModule(
+      module,
+      [](const Section& section, WriteBuffer&) {
+        return section.is_custom() ? SectionAction::Drop : SectionAction::Keep;
+      },
+      [&](SpanU8 data) { spans.push_back(data); }));
+
+  // One run for the header and type section, one for the code section.
+  ASSERT_EQ(2u, spans.size());
+  EXPECT_EQ(kModule.begin(), spans[0].begin());
+  EXPECT_EQ(ToVector("\0asm\x01\0\0\0\x01\x03\0\0\0"_su8), ToVector(spans[0]));
+  EXPECT_EQ(ToVector("\x0a\x01\0"_su8), ToVector(spans[1]));
+  ExpectNoErrors(errors);
+}
+
+TEST(RewriteModuleTest, Replace) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadModule(kModule, features, errors);
+
+  WriteBuffer out;
+  EXPECT_TRUE(RewriteModule(
+      module,
+      [](const Section& section, WriteBuffer& replacement) {
+        if (section.is_known() && section.known().id == SectionId::Code) {
+          Write(KnownSection{SectionId::Code, "\x01\x02"_su8},
+                replacement.output());
+          return SectionAction::Replace;
+        }
+        return SectionAction::Keep;
+      },
+      out));
+
+  EXPECT_EQ(ToVector("\0asm\x01\0\0\0"
+                     "\x01\x03\0\0\0"
+                     "\x00\x06\x03yup\0\0"
+                     "\x0a\x02\x01\x02"
+                     "\x00\x05\x04name"_su8),
+            ToVector(out.data()));
+  ExpectNoErrors(errors);
+}
+
+TEST(RewriteModuleTest, ReplaceWithNothing) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadModule(kModule, features, errors);
+
+  WriteBuffer out;
+  EXPECT_TRUE(RewriteModule(
+      module,
+      [](const Section& section, WriteBuffer&) {
+        return section.is_known() ? SectionAction::Replace
+                                  : SectionAction::Keep;
+      },
+      out));
+
+  EXPECT_EQ(ToVector("\0asm\x01\0\0\0"
+                     "\x00\x06\x03yup\0\0"
+                     "\x00\x05\x04name"_su8),
+            ToVector(out.data()));
+  ExpectNoErrors(errors);
+}
+
+TEST(RewriteModuleTest, MalformedSection) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadModule(
+      "\0asm\x01\0\0\0"
+      "\x01\x03\0\0\0"   // Type section.
+      "\x0a\x05\0"_su8,  // Code section, past the end.
+      features, errors);
+
+  WriteBuffer out;
+  EXPECT_FALSE(RewriteModule(
+      module,
+      [](const Section&, WriteBuffer&) { return SectionAction::Keep; },
+      out));
+  EXPECT_EQ(ToVector("\0asm\x01\0\0\0\x01\x03\0\0\0"_su8),
+            ToVector(out.data()));
+  EXPECT_FALSE(errors.errors.empty());
+}
+
+TEST(RewriteModuleTest, BadHeader) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadModule("\0asm"_su8, features, errors);
+
+  WriteBuffer out;
+  EXPECT_FALSE(RewriteModule(
+      module,
+      [](const Section&, WriteBuffer&) { return SectionAction::Keep; },
+      out));
+  EXPECT_TRUE(out.empty());
+}
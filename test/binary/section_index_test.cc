@@ -0,0 +1,80 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/section_index.h"
+
+#include "gtest/gtest.h"
+
+#include "test/binary/test_utils.h"
+#include "wasp/binary/lazy_module.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+
+TEST(SectionIndexTest, Basic) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadModule(
+      "\0asm\x01\0\0\0"
+      "\x01\x03\0\0\0"            // Type section.
+      "\x00\x06\x03yup\0\0"       // Custom section "yup".
+      "\x0a\x01\0"                // Code section.
+      "\x00\x05\x03yup\0"_su8,    // Another custom section "yup".
+      features, errors);
+
+  SectionIndex index{module};
+
+  ASSERT_EQ(4u, index.entries().size());
+  EXPECT_EQ(SectionId::Type, index.entries()[0].id);
+  EXPECT_EQ(10u, index.entries()[0].offset);
+  EXPECT_EQ(3u, index.entries()[0].length);
+  EXPECT_EQ(SectionId::Custom, index.entries()[1].id);
+  EXPECT_EQ("yup", index.entries()[1].name);
+  EXPECT_EQ(19u, index.entries()[1].offset);
+  EXPECT_EQ(2u, index.entries()[1].length);
+  EXPECT_EQ(SectionId::Code, index.entries()[2].id);
+  EXPECT_EQ(SectionId::Custom, index.entries()[3].id);
+
+  EXPECT_EQ((KnownSection{SectionId::Type, "\0\0\0"_su8}),
+            index.GetKnownSection(SectionId::Type));
+  EXPECT_EQ((KnownSection{SectionId::Code, "\0"_su8}),
+            index.GetKnownSection(SectionId::Code));
+  EXPECT_EQ(nullopt, index.GetKnownSection(SectionId::Import));
+  EXPECT_EQ(nullopt, index.GetKnownSection(SectionId::Custom));
+
+  // The first custom section with a given name is returned.
+  EXPECT_EQ((CustomSection{"yup", "\0\0"_su8}), index.GetCustomSection("yup"));
+  EXPECT_EQ(nullopt, index.GetCustomSection("nope"));
+
+  EXPECT_EQ((Section{CustomSection{"yup", "\0"_su8}}),
+            index.GetSection(index.entries()[3]));
+
+  ExpectNoErrors(errors);
+}
+
+TEST(SectionIndexTest, Empty) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadModule("\0asm\x01\0\0\0"_su8, features, errors);
+
+  SectionIndex index{module};
+
+  EXPECT_EQ(0u, index.entries().size());
+  EXPECT_EQ(nullopt, index.GetKnownSection(SectionId::Type));
+  EXPECT_EQ(nullopt, index.GetCustomSection("name"));
+  ExpectNoErrors(errors);
+}
@@ -0,0 +1,207 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/stream_reader.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "test/binary/test_utils.h"
+#include "wasp/base/format.h"
+#include "wasp/binary/formatters.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+
+namespace {
+
+// Records each callback as a string, copying out the data since it is only
+// valid during the callback.
+class RecordCallbacks : public StreamReaderCallbacks {
+ public:
+  void OnSection(const Section& section) override {
+    if (section.is_known()) {
+      events.push_back(format("section {} {}", section.known().id,
+                              section.known().data));
+    } else {
+      events.push_back(format("custom {} {}", section.custom().name,
+                              section.custom().data));
+    }
+  }
+
+  void OnCodeSectionStart(Index count) override {
+    events.push_back(format("code start {}", count));
+  }
+
+  void OnCode(Index code_index, const Code& code) override {
+    events.push_back(format("code {} {}", code_index, code));
+  }
+
+  void OnCodeSectionEnd() override { events.push_back("code end"); }
+
+  std::vector<std::string> events;
+};
+
+const SpanU8 kModule =
+    "\0asm\x01\0\0\0"
+    "\x01\x05\x01\x60\0\0\x00"       // Type section.
+    "\x0a\x0b\x02"                   // Code section, 2 bodies.
+    "\x02\x00\x0b"                   // Body 0.
+    "\x06\x01\x02\x7f\x20\x00\x0b"   // Body 1: 2 i32 locals.
+    "\x00\x06\x03yup\xaa\xbb"_su8;   // Custom section "yup".
+
+const std::vector<std::string> kModuleEvents{
+    R"(section type "\01\60\00\00\00")",
+    "code start 2",
+    R"(code 0 {locals [], body "\0b"})",
+    R"(code 1 {locals [i32 ** 2], body "\20\00\0b"})",
+    "code end",
+    R"(custom yup "\aa\bb")",
+};
+
+}  // namespace
+
+TEST(StreamReaderTest, WholeModule) {
+  Features features;
+  TestErrors errors;
+  RecordCallbacks callbacks;
+  StreamReader reader{callbacks, features, errors};
+  EXPECT_TRUE(reader.Append(kModule));
+  EXPECT_TRUE(reader.Finish());
+  ExpectNoErrors(errors);
+  EXPECT_EQ(kModuleEvents, callbacks.events);
+}
+
+TEST(StreamReaderTest, Chunks) {
+  for (SpanU8::index_type chunk_size = 1; chunk_size < kModule.size();
+       ++chunk_size) {
+    Features features;
+    TestErrors errors;
+    RecordCallbacks callbacks;
+    StreamReader reader{callbacks, features, errors};
+    SpanU8 data = kModule;
+    while (!data.empty()) {
+      auto size = std::min<SpanU8::index_type>(chunk_size, data.size());
+      EXPECT_TRUE(reader.Append(data.first(size)));
+      remove_prefix(&data, size);
+    }
+    EXPECT_TRUE(reader.Finish());
+    ExpectNoErrors(errors);
+    EXPECT_EQ(kModuleEvents, callbacks.events) << "chunk size " << chunk_size;
+  }
+}
+
+TEST(StreamReaderTest, ItemsBeforeEnd) {
+  Features features;
+  TestErrors errors;
+  RecordCallbacks callbacks;
+  StreamReader reader{callbacks, features, errors};
+  // Everything up to the middle of body 1.
+  EXPECT_TRUE(reader.Append(kModule.first(26)));
+  EXPECT_EQ((std::vector<std::string>{kModuleEvents.begin(),
+                                      kModuleEvents.begin() + 3}),
+            callbacks.events);
+}
+
+TEST(StreamReaderTest, BadMagic) {
+  Features features;
+  TestErrors errors;
+  RecordCallbacks callbacks;
+  StreamReader reader{callbacks, features, errors};
+  const SpanU8 data = "\0ASM\x01\0\0\0"_su8;
+  EXPECT_FALSE(reader.Append(data));
+  EXPECT_FALSE(reader.Append("\x01\x01\x00"_su8));
+  ExpectError(
+      {{0, "magic"},
+       {4, R"(Mismatch: expected "\00\61\73\6d", got "\00\41\53\4d")"}},
+      errors, data);
+}
+
+TEST(StreamReaderTest, Truncated) {
+  Features features;
+  TestErrors errors;
+  RecordCallbacks callbacks;
+  StreamReader reader{callbacks, features, errors};
+  const SpanU8 data = "\0asm\x01\0\0\0\x01\x05\x01"_su8;
+  EXPECT_TRUE(reader.Append(data));
+  EXPECT_FALSE(reader.Finish());
+  EXPECT_EQ(1u, errors.errors.size());
+  EXPECT_TRUE(callbacks.events.empty());
+}
+
+TEST(StreamReaderTest, TruncatedCodeSection) {
+  Features features;
+  TestErrors errors;
+  RecordCallbacks callbacks;
+  StreamReader reader{callbacks, features, errors};
+  EXPECT_TRUE(reader.Append(kModule.first(23)));
+  EXPECT_FALSE(reader.Finish());
+  EXPECT_EQ(1u, errors.errors.size());
+  EXPECT_EQ((std::vector<std::string>{kModuleEvents.begin(),
+                                      kModuleEvents.begin() + 3}),
+            callbacks.events);
+}
+
+TEST(StreamReaderTest, BodyPastCodeSection) {
+  Features features;
+  TestErrors errors;
+  RecordCallbacks callbacks;
+  StreamReader reader{callbacks, features, errors};
+  // The code section is 4 bytes long, but its only body claims 5.
+  const SpanU8 data = "\0asm\x01\0\0\0\x0a\x04\x01\x05\x00\x0b\x0b\x0b"_su8;
+  EXPECT_FALSE(reader.Append(data));
+  ExpectError({{11, "code"}, {12, "Length extends past end: 5 > 2"}}, errors,
+              data);
+}
+
+TEST(StreamReaderTest, TooFewBodies) {
+  Features features;
+  TestErrors errors;
+  RecordCallbacks callbacks;
+  StreamReader reader{callbacks, features, errors};
+  // The code section declares 2 bodies, but only has room for 1.
+  const SpanU8 data = "\0asm\x01\0\0\0\x0a\x04\x02\x02\x00\x0b"_su8;
+  EXPECT_FALSE(reader.Append(data));
+  ExpectError({{14, "Expected 2 function bodies, got 1"}}, errors, data);
+  EXPECT_EQ((std::vector<std::string>{"code start 2",
+                                      R"(code 0 {locals [], body "\0b"})"}),
+            callbacks.events);
+}
+
+TEST(StreamReaderTest, TooManyBodies) {
+  Features features;
+  TestErrors errors;
+  RecordCallbacks callbacks;
+  StreamReader reader{callbacks, features, errors};
+  // The code section declares 1 body, but has 2.
+  const SpanU8 data =
+      "\0asm\x01\0\0\0\x0a\x07\x01\x02\x00\x0b\x02\x00\x0b"_su8;
+  EXPECT_FALSE(reader.Append(data));
+  ExpectError({{14, "Expected 1 function bodies, got more"}}, errors, data);
+}
+
+TEST(StreamReaderTest, NoBodiesInNonEmptySection) {
+  Features features;
+  TestErrors errors;
+  RecordCallbacks callbacks;
+  StreamReader reader{callbacks, features, errors};
+  const SpanU8 data = "\0asm\x01\0\0\0\x0a\x04\x00\x02\x00\x0b"_su8;
+  EXPECT_FALSE(reader.Append(data));
+  ExpectError({{11, "Expected 0 function bodies, got more"}}, errors, data);
+}
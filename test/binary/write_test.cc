@@ -16,6 +16,7 @@
 
 #include <cmath>
 #include <iterator>
+#include <list>
 #include <string>
 #include <vector>
 
@@ -23,10 +24,13 @@
 
 // Write() functions must be declared here before they can be used by
 // ExpectWrite (defined in write_test_utils.h below).
+#include "wasp/binary/write/size_of.h"
 #include "wasp/binary/write/write_block_type.h"
 #include "wasp/binary/write/write_br_table_immediate.h"
 #include "wasp/binary/write/write_bytes.h"
+#include "wasp/binary/write/write_buffer.h"
 #include "wasp/binary/write/write_call_indirect_immediate.h"
+#include "wasp/binary/write/write_code.h"
 #include "wasp/binary/write/write_comdat.h"
 #include "wasp/binary/write/write_comdat_symbol.h"
 #include "wasp/binary/write/write_comdat_symbol_kind.h"
@@ -37,6 +41,7 @@
 #include "wasp/binary/write/write_element_segment.h"
 #include "wasp/binary/write/write_element_type.h"
 #include "wasp/binary/write/write_export.h"
+#include "wasp/binary/write/write_expression.h"
 #include "wasp/binary/write/write_external_kind.h"
 #include "wasp/binary/write/write_f32.h"
 #include "wasp/binary/write/write_f64.h"
@@ -58,6 +63,7 @@
 #include "wasp/binary/write/write_opcode.h"
 #include "wasp/binary/write/write_s32.h"
 #include "wasp/binary/write/write_s64.h"
+#include "wasp/binary/write/write_section.h"
 #include "wasp/binary/write/write_section_id.h"
 #include "wasp/binary/write/write_shuffle_immediate.h"
 #include "wasp/binary/write/write_start.h"
@@ -92,9 +98,10 @@ TEST(WriteTest, BrOnExnImmediate) {
 }
 
 TEST(WriteTest, BrTableImmediate) {
+  const BrTableTargetsBuffer targets{1, 2};
   ExpectWrite<BrTableImmediate>("\x00\x00"_su8, BrTableImmediate{{}, 0});
   ExpectWrite<BrTableImmediate>("\x02\x01\x02\x03"_su8,
-                                BrTableImmediate{{1, 2}, 3});
+                                BrTableImmediate{targets.targets(), 3});
 }
 
 TEST(WriteTest, Bytes) {
@@ -111,6 +118,14 @@ TEST(WriteTest, CallIndirectImmediate) {
                                      CallIndirectImmediate{128, 0});
 }
 
+TEST(WriteTest, Code) {
+  ExpectWrite<Code>("\x02\x00\x0b"_su8, Code{{}, Expression{"\x0b"_su8}});
+  ExpectWrite<Code>(
+      "\x07\x02\x02\x7f\x80\x01\x7e\x0b"_su8,
+      Code{{Locals{2, ValueType::I32}, Locals{128, ValueType::I64}},
+           Expression{"\x0b"_su8}});
+}
+
 TEST(WriteTest, ConstantExpression) {
   // i32.const
   ExpectWrite<ConstantExpression>(
@@ -142,6 +157,11 @@ TEST(WriteTest, CopyImmediate) {
   ExpectWrite<CopyImmediate>("\x00\x00"_su8, CopyImmediate{0, 0});
 }
 
+TEST(WriteTest, CustomSection) {
+  ExpectWrite<CustomSection>("\x00\x07\x04name\x01\x02"_su8,
+                             CustomSection{"name", "\x01\x02"_su8});
+}
+
 TEST(WriteTest, DataSegment) {
   ExpectWrite<DataSegment>(
       "\x00\x42\x01\x0b\x04wxyz"_su8,
@@ -211,6 +231,10 @@ TEST(WriteTest, Export) {
                       Export{ExternalKind::Global, "g", 1});
 }
 
+TEST(WriteTest, Expression) {
+  ExpectWrite<Expression>("\x41\x01\x0b"_su8, Expression{"\x41\x01\x0b"_su8});
+}
+
 TEST(WriteTest, ExternalKind) {
   ExpectWrite<ExternalKind>("\x00"_su8, ExternalKind::Function);
   ExpectWrite<ExternalKind>("\x01"_su8, ExternalKind::Table);
@@ -379,6 +403,7 @@ TEST(WriteTest, Instruction) {
   using I = Instruction;
   using O = Opcode;
   using MemArg = MemArgImmediate;
+  const BrTableTargetsBuffer targets{3, 4, 5};
 
   ExpectWrite<I>("\x00"_su8, I{O::Unreachable});
   ExpectWrite<I>("\x01"_su8, I{O::Nop});
@@ -390,7 +415,7 @@ TEST(WriteTest, Instruction) {
   ExpectWrite<I>("\x0c\x01"_su8, I{O::Br, Index{1}});
   ExpectWrite<I>("\x0d\x02"_su8, I{O::BrIf, Index{2}});
   ExpectWrite<I>("\x0e\x03\x03\x04\x05\x06"_su8,
-                 I{O::BrTable, BrTableImmediate{{3, 4, 5}, 6}});
+                 I{O::BrTable, BrTableImmediate{targets.targets(), 6}});
   ExpectWrite<I>("\x0f"_su8, I{O::Return});
   ExpectWrite<I>("\x10\x07"_su8, I{O::Call, Index{7}});
   ExpectWrite<I>("\x11\x08\x00"_su8,
@@ -862,6 +887,11 @@ TEST(WriteTest, Instruction_threads) {
   ExpectWrite<I>("\xfe\x4e\x00\x00"_su8, I{O::I64AtomicRmw32CmpxchgU, m});
 }
 
+TEST(WriteTest, KnownSection) {
+  ExpectWrite<KnownSection>("\x01\x03\x01\x02\x03"_su8,
+                            KnownSection{SectionId::Type, "\x01\x02\x03"_su8});
+}
+
 TEST(WriteTest, Limits) {
   ExpectWrite<Limits>("\x00\x81\x01"_su8, Limits{129});
   ExpectWrite<Limits>("\x01\x02\xe8\x07"_su8, Limits{2, 1000});
@@ -1381,6 +1411,13 @@ TEST(WriteTest, S64) {
                    -3540960223848057090);
 }
 
+TEST(WriteTest, Section) {
+  ExpectWrite<Section>("\x0a\x01\x00"_su8,
+                       Section{KnownSection{SectionId::Code, "\x00"_su8}});
+  ExpectWrite<Section>("\x00\x02\x01x"_su8,
+                       Section{CustomSection{"x", {}}});
+}
+
 TEST(WriteTest, SectionId) {
   ExpectWrite<SectionId>("\x00"_su8, SectionId::Custom);
   ExpectWrite<SectionId>("\x01"_su8, SectionId::Type);
@@ -1403,6 +1440,16 @@ TEST(WriteTest, ShuffleImmediate) {
       ShuffleImmediate{{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}});
 }
 
+TEST(WriteTest, SizeOf) {
+  EXPECT_EQ(1u, SizeOf(u32{0}));
+  EXPECT_EQ(5u, SizeOf(u32{0xffffffff}));
+  EXPECT_EQ(6u, SizeOf(string_view{"hello"}));
+  EXPECT_EQ(2u, SizeOf(Instruction{Opcode::I32Const, s32{1}}));
+
+  const std::vector<u32> input{5, 128, 206412};
+  EXPECT_EQ(7u, SizeOfVector(input.begin(), input.end()));
+}
+
 TEST(WriteTest, Start) {
   ExpectWrite<Start>("\x80\x02"_su8, Start{256});
 }
@@ -1475,3 +1522,46 @@ TEST(WriteTest, WriteVector_u32) {
   EXPECT_EQ(iter.base(), output.end());
   EXPECT_EQ(expected, wasp::SpanU8{output});
 }
+
+TEST(WriteTest, WriteVector_Count) {
+  const auto expected = "\x02\x05\x80\x01"_su8;
+  const std::vector<u32> input{5, 128};
+  std::vector<u8> output;
+  WriteVector(input.begin(), input.end(), std::back_inserter(output), 2);
+  EXPECT_EQ(expected, wasp::SpanU8{output});
+}
+
+TEST(WriteTest, WriteVector_NotRandomAccess) {
+  const auto expected = "\x03\x05\x80\x01\xcc\xcc\x0c"_su8;
+  const std::list<u32> input{5, 128, 206412};
+  std::vector<u8> output;
+  WriteVector(input.begin(), input.end(), std::back_inserter(output));
+  EXPECT_EQ(expected, wasp::SpanU8{output});
+}
+
+TEST(WriteTest, WriteBuffer) {
+  WriteBuffer buffer;
+  auto out = buffer.output();
+  out = Write(u32{128}, out);
+  out = Write(string_view{"hello"}, out);
+  out = WriteBytes("\x01\x02"_su8, out);
+  EXPECT_EQ("\x80\x01\x05hello\x01\x02"_su8, buffer.data());
+
+  std::vector<u8> released = buffer.Release();
+  EXPECT_EQ(10u, released.size());
+  EXPECT_TRUE(buffer.empty());
+}
+
+TEST(WriteTest, WriteBuffer_Growth) {
+  WriteBuffer buffer{4};
+  const std::vector<u8> bytes(100, 0xab);
+  auto out = buffer.output();
+  for (int i = 0; i < 10; ++i) {
+    out = WriteBytes(SpanU8{bytes}, out);
+  }
+  EXPECT_EQ(1000u, buffer.size());
+  EXPECT_GE(buffer.capacity(), 1000u);
+  for (auto byte : buffer.data()) {
+    EXPECT_EQ(0xab, byte);
+  }
+}
@@ -21,6 +21,8 @@
 #include <vector>
 
 #include "wasp/base/span.h"
+#include "wasp/binary/write/size_of.h"
+#include "wasp/binary/write/write_buffer.h"
 
 #include "gtest/gtest.h"
 
@@ -91,6 +93,11 @@ void ExpectWrite(wasp::SpanU8 expected, const T& value) {
   EXPECT_FALSE(iter.overflow());
   EXPECT_EQ(iter.base(), result.end());
   EXPECT_EQ(expected, wasp::SpanU8{result});
+  EXPECT_EQ(expected.size(), wasp::binary::SizeOf(value));
+
+  wasp::binary::WriteBuffer buffer;
+  wasp::binary::Write(value, buffer.output());
+  EXPECT_EQ(expected, buffer.data());
 }
 
 }  // namespace test
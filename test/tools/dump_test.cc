@@ -0,0 +1,112 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/tools/dump.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace ::wasp;
+
+namespace {
+
+// A module with one imported function (index 0) and one defined function
+// (index 1).
+const std::string kModule{
+    "\0asm\x01\0\0\0"
+    "\x01\x04\x01\x60\x00\x00"                  // type section: () -> ()
+    "\x02\x07\x01\x01m\x01" "f\x00\x00"         // import section: m.f
+    "\x03\x02\x01\x00"                          // function section
+    "\x0a\x04\x01\x02\x00\x0b",                 // code section: end
+    33};
+
+// The module written to the test's temporary directory, removed when
+// destroyed.
+class TempModule {
+ public:
+  explicit TempModule(const std::string& name)
+      : path_{::testing::TempDir() + name} {
+    std::ofstream stream{path_, std::ios::out | std::ios::binary};
+    stream << kModule;
+  }
+
+  ~TempModule() { std::remove(path_.c_str()); }
+
+  const std::string& path() const { return path_; }
+
+ private:
+  std::string path_;
+};
+
+struct Result {
+  int exit_code;
+  std::string out;
+};
+
+Result RunDump(std::vector<std::string> args) {
+  std::vector<char*> argv;
+  for (auto& arg : args) {
+    argv.push_back(&arg[0]);
+  }
+  std::ostringstream out;
+  std::ostringstream err;
+  int exit_code = tools::dump::Main(static_cast<int>(argv.size()),
+                                    argv.data(), out, err);
+  return Result{exit_code, out.str()};
+}
+
+bool Contains(const std::string& haystack, const std::string& needle) {
+  return haystack.find(needle) != std::string::npos;
+}
+
+}  // namespace
+
+TEST(DumpTest, Function_Defined) {
+  TempModule module{"wasp_dump_test_defined.wasm"};
+  auto result = RunDump({module.path(), "-d", "-f", "1"});
+  EXPECT_EQ(0, result.exit_code);
+  EXPECT_TRUE(Contains(result.out, "func[1]")) << result.out;
+}
+
+TEST(DumpTest, Function_Imported) {
+  TempModule module{"wasp_dump_test_imported.wasm"};
+  auto result = RunDump({module.path(), "-d", "-f", "0"});
+  EXPECT_EQ(1, result.exit_code);
+  EXPECT_TRUE(Contains(result.out, "Function 0 is imported\n")) << result.out;
+  EXPECT_FALSE(Contains(result.out, "func[")) << result.out;
+}
+
+TEST(DumpTest, Function_PastCodeEntries) {
+  TempModule module{"wasp_dump_test_past_code.wasm"};
+  auto result = RunDump({module.path(), "-d", "-f", "2"});
+  EXPECT_EQ(1, result.exit_code);
+  EXPECT_TRUE(Contains(result.out, "Invalid function index 2\n"))
+      << result.out;
+  EXPECT_FALSE(Contains(result.out, "func[")) << result.out;
+}
+
+TEST(DumpTest, Function_Unknown) {
+  TempModule module{"wasp_dump_test_unknown.wasm"};
+  auto result = RunDump({module.path(), "-d", "-f", "missing"});
+  EXPECT_EQ(1, result.exit_code);
+  EXPECT_TRUE(Contains(result.out, "Unknown function missing\n"))
+      << result.out;
+}
@@ -0,0 +1,57 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/local_types.h"
+
+#include "gtest/gtest.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::valid;
+
+TEST(LocalTypesTest, Basic) {
+  LocalTypes locals;
+  EXPECT_EQ(0u, locals.GetCount());
+  EXPECT_EQ(nullopt, locals.GetType(0));
+
+  EXPECT_TRUE(locals.Append(2, ValueType::I32));
+  EXPECT_TRUE(locals.Append(0, ValueType::F32));
+  EXPECT_TRUE(locals.Append(3, ValueType::I64));
+  EXPECT_TRUE(locals.Append(1, ValueType::I64));
+  EXPECT_TRUE(locals.Append(1, ValueType::I32));
+  EXPECT_EQ(7u, locals.GetCount());
+
+  EXPECT_EQ(ValueType::I32, locals.GetType(0));
+  EXPECT_EQ(ValueType::I32, locals.GetType(1));
+  EXPECT_EQ(ValueType::I64, locals.GetType(2));
+  EXPECT_EQ(ValueType::I64, locals.GetType(5));
+  EXPECT_EQ(ValueType::I32, locals.GetType(6));
+  EXPECT_EQ(nullopt, locals.GetType(7));
+
+  locals.Reset();
+  EXPECT_EQ(0u, locals.GetCount());
+  EXPECT_EQ(nullopt, locals.GetType(0));
+}
+
+TEST(LocalTypesTest, Overflow) {
+  LocalTypes locals;
+  EXPECT_TRUE(locals.Append(0xfffffff0, ValueType::I32));
+  EXPECT_FALSE(locals.Append(0x10, ValueType::F32));
+  EXPECT_EQ(0xfffffff0u, locals.GetCount());
+  EXPECT_EQ(nullopt, locals.GetType(0xfffffff0));
+  EXPECT_TRUE(locals.Append(0xf, ValueType::F32));
+  EXPECT_EQ(ValueType::F32, locals.GetType(0xfffffffe));
+}
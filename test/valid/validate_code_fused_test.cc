@@ -0,0 +1,254 @@
+//
+// Copyright 2019 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/validate_code_fused.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "wasp/base/features.h"
+#include "wasp/valid/context.h"
+#include "wasp/valid/errors.h"
+#include "wasp/valid/validate_code.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::valid;
+
+namespace {
+
+using VT = ValueType;
+
+class RecordErrors : public valid::Errors {
+ public:
+  std::vector<std::string> messages;
+
+ protected:
+  void HandlePushContext(string_view desc) {}
+  void HandlePopContext() {}
+  void HandleOnError(string_view message) {
+    messages.push_back(message.to_string());
+  }
+};
+
+class ValidateCodeFusedTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    // Function 0 is the function being validated, function 1 has type
+    // (i32, f32) -> (i64).
+    context.types.push_back(TypeEntry{FunctionType{}});
+    context.types.push_back(TypeEntry{FunctionType{{VT::I32}, {VT::I32}}});
+    context.types.push_back(
+        TypeEntry{FunctionType{{VT::I32, VT::F32}, {VT::I64}}});
+    context.functions.push_back(Function{0});
+    context.functions.push_back(Function{2});
+    context.globals.push_back(GlobalType{VT::I32, Mutability::Const});
+    context.globals.push_back(GlobalType{VT::F64, Mutability::Var});
+  }
+
+  // Checks that the fused validator gives the same result and errors as the
+  // general one, and returns the result.
+  bool Check(Index type_index,
+             std::vector<Locals> locals,
+             const std::string& body) {
+    context.functions[0].type_index = type_index;
+    Code code{std::move(locals),
+              Expression{SpanU8{reinterpret_cast<const u8*>(body.data()),
+                                static_cast<SpanU8::index_type>(body.size())}}};
+
+    RecordErrors errors, fused_errors;
+    FunctionContext function, fused_function;
+    bool valid = Validate(code, 0, context, function, features, errors);
+    bool fused_valid =
+        ValidateFused(code, 0, context, fused_function, features, fused_errors);
+    EXPECT_EQ(valid, fused_valid);
+    EXPECT_EQ(errors.messages, fused_errors.messages);
+    EXPECT_EQ(function.type_stack, fused_function.type_stack);
+    return fused_valid;
+  }
+
+  bool Check(const std::string& body) { return Check(0, {}, body); }
+
+  Context context;
+  Features features;
+};
+
+}  // namespace
+
+TEST_F(ValidateCodeFusedTest, Basic) {
+  EXPECT_TRUE(Check(std::string("\x0b", 1)));
+  EXPECT_TRUE(Check(std::string("\x41\x01\x1a\x0b", 4)));
+  EXPECT_TRUE(Check(std::string("\x42\x80\x01\x50\x1a\x0b", 6)));
+  EXPECT_TRUE(Check(std::string("\x43\0\0\0\0\x8c\x1a\x0b", 8)));
+  EXPECT_TRUE(Check(std::string("\x44\0\0\0\0\0\0\0\0\xb6\x1a\x0b", 12)));
+  EXPECT_TRUE(Check(std::string("\x01\x41\x00\x41\x00\x6a\x1a\x0b", 8)));
+}
+
+TEST_F(ValidateCodeFusedTest, TypeMismatch) {
+  // i32.const 0; f32.const 0; i32.add
+  EXPECT_FALSE(Check(std::string("\x41\x00\x43\0\0\0\0\x6a\x1a\x0b", 10)));
+  // drop with an empty stack.
+  EXPECT_FALSE(Check(std::string("\x1a\x0b", 2)));
+  // Value left on the stack at the end.
+  EXPECT_FALSE(Check(std::string("\x41\x00\x0b", 3)));
+}
+
+TEST_F(ValidateCodeFusedTest, FunctionResult) {
+  EXPECT_TRUE(Check(1, {}, std::string("\x20\x00\x0b", 3)));
+  EXPECT_FALSE(Check(1, {}, std::string("\x0b", 1)));
+  EXPECT_FALSE(Check(1, {}, std::string("\x43\0\0\0\0\x0b", 6)));
+  EXPECT_TRUE(Check(1, {}, std::string("\x41\x00\x0f\x0b", 4)));
+  EXPECT_FALSE(Check(1, {}, std::string("\x0f\x0b", 2)));
+  EXPECT_FALSE(Check(1, {}, std::string("\x43\0\0\0\0\x0f\x0b", 7)));
+}
+
+TEST_F(ValidateCodeFusedTest, Blocks) {
+  // block (result i32) i32.const 1 end drop
+  EXPECT_TRUE(Check(std::string("\x02\x7f\x41\x01\x0b\x1a\x0b", 7)));
+  // loop (result f32) i32.const 1 end drop
+  EXPECT_FALSE(Check(std::string("\x03\x7d\x41\x01\x0b\x1a\x0b", 7)));
+  // i32.const 0 if (result i32) i32.const 1 else i32.const 2 end drop
+  EXPECT_TRUE(Check(
+      std::string("\x41\x00\x04\x7f\x41\x01\x05\x41\x02\x0b\x1a\x0b", 12)));
+  // i32.const 0 if (result i32) i32.const 1 end drop
+  EXPECT_FALSE(Check(std::string("\x41\x00\x04\x7f\x41\x01\x0b\x1a\x0b", 9)));
+  // i32.const 0 if nop else nop end
+  EXPECT_TRUE(Check(std::string("\x41\x00\x04\x40\x01\x05\x01\x0b\x0b", 9)));
+  // else without if.
+  EXPECT_FALSE(Check(std::string("\x02\x40\x05\x0b\x0b", 5)));
+  // Missing end.
+  EXPECT_FALSE(Check(std::string("\x02\x40\x0b", 3)));
+  // Instruction after the function's end.
+  EXPECT_FALSE(Check(std::string("\x0b\x01", 2)));
+}
+
+TEST_F(ValidateCodeFusedTest, Unreachable) {
+  // unreachable i32.add drop
+  EXPECT_TRUE(Check(std::string("\x00\x6a\x1a\x0b", 4)));
+  // unreachable f32.const 0 i32.add drop
+  EXPECT_FALSE(Check(std::string("\x00\x43\0\0\0\0\x6a\x1a\x0b", 9)));
+  // block (result i32) unreachable end drop
+  EXPECT_TRUE(Check(std::string("\x02\x7f\x00\x0b\x1a\x0b", 6)));
+  // block (result i32) unreachable i64.const 0 end drop
+  EXPECT_FALSE(Check(std::string("\x02\x7f\x00\x42\x00\x0b\x1a\x0b", 8)));
+}
+
+TEST_F(ValidateCodeFusedTest, Branches) {
+  // block (result i32) i32.const 1 br 0 end drop
+  EXPECT_TRUE(Check(std::string("\x02\x7f\x41\x01\x0c\x00\x0b\x1a\x0b", 9)));
+  // block (result i32) br 0 end drop
+  EXPECT_FALSE(Check(std::string("\x02\x7f\x0c\x00\x0b\x1a\x0b", 7)));
+  // loop (result i32) br 0 end drop
+  EXPECT_TRUE(Check(std::string("\x03\x7f\x0c\x00\x0b\x1a\x0b", 7)));
+  // block i32.const 0 br_if 0 end
+  EXPECT_TRUE(Check(std::string("\x02\x40\x41\x00\x0d\x00\x0b\x0b", 8)));
+  // br 2 with only two labels.
+  EXPECT_FALSE(Check(std::string("\x02\x40\x0c\x02\x0b\x0b", 6)));
+  // block i32.const 0 br_table 0 0 end
+  EXPECT_TRUE(
+      Check(std::string("\x02\x40\x41\x00\x0e\x01\x00\x00\x0b\x0b", 10)));
+  // block i32.const 0 br_table 0 1 end, with different label types.
+  EXPECT_FALSE(Check(
+      1, {}, std::string("\x02\x40\x41\x00\x0e\x01\x00\x01\x0b\x0b", 10)));
+}
+
+TEST_F(ValidateCodeFusedTest, Calls) {
+  // i32.const 0 f32.const 0 call 1 drop
+  EXPECT_TRUE(Check(std::string("\x41\x00\x43\0\0\0\0\x10\x01\x1a\x0b", 11)));
+  // f32.const 0 i32.const 0 call 1 drop
+  EXPECT_FALSE(Check(std::string("\x43\0\0\0\0\x41\x00\x10\x01\x1a\x0b", 11)));
+  // call 2
+  EXPECT_FALSE(Check(std::string("\x10\x02\x0b", 3)));
+}
+
+TEST_F(ValidateCodeFusedTest, LocalsAndGlobals) {
+  std::vector<Locals> locals{{2, VT::I64}, {1, VT::F32}};
+  // local.get 1 local.set 0 local.get 2 local.tee 2 drop
+  EXPECT_TRUE(Check(
+      0, locals, std::string("\x20\x01\x21\x00\x20\x02\x22\x02\x1a\x0b", 10)));
+  // local.get 2 local.set 0
+  EXPECT_FALSE(Check(0, locals, std::string("\x20\x02\x21\x00\x0b", 5)));
+  // local.get 3
+  EXPECT_FALSE(Check(0, locals, std::string("\x20\x03\x1a\x0b", 4)));
+  // global.get 0 drop global.get 1 global.set 1
+  EXPECT_TRUE(Check(std::string("\x23\x00\x1a\x23\x01\x24\x01\x0b", 8)));
+  // global.get 0 global.set 0, which is immutable.
+  EXPECT_FALSE(Check(std::string("\x23\x00\x24\x00\x0b", 5)));
+  // global.get 2
+  EXPECT_FALSE(Check(std::string("\x23\x02\x1a\x0b", 4)));
+}
+
+TEST_F(ValidateCodeFusedTest, Memory) {
+  // i32.const 0 i64.load 3 0 drop
+  const std::string load("\x41\x00\x29\x03\x00\x1a\x0b", 7);
+  // i32.const 0 f32.const 0 f32.store 2 0
+  const std::string store("\x41\x00\x43\0\0\0\0\x38\x02\x00\x0b", 11);
+  // i32.const 0 i32.load8_u 1 0 drop, which is over-aligned.
+  const std::string bad_align("\x41\x00\x2d\x01\x00\x1a\x0b", 7);
+  // memory.size memory.grow drop
+  const std::string size_grow("\x3f\x00\x40\x00\x1a\x0b", 6);
+
+  // No memory.
+  EXPECT_FALSE(Check(load));
+  EXPECT_FALSE(Check(store));
+  EXPECT_FALSE(Check(size_grow));
+
+  context.memories.push_back(MemoryType{Limits{1}});
+  EXPECT_TRUE(Check(load));
+  EXPECT_TRUE(Check(store));
+  EXPECT_FALSE(Check(bad_align));
+  EXPECT_TRUE(Check(size_grow));
+}
+
+TEST_F(ValidateCodeFusedTest, Decoded) {
+  // Instructions the fast path hands to the general validator.
+  // i32.const 0 i32.const 0 i32.const 0 select
+  EXPECT_TRUE(Check(std::string("\x41\x00\x41\x00\x41\x00\x1b\x0b", 8)));
+  // unreachable select
+  EXPECT_FALSE(Check(std::string("\x00\x1b\x0b", 3)));
+  // i32.const 0 i32.extend8_s drop, which needs the sign-extension feature.
+  const std::string extend("\x41\x00\xc0\x1a\x0b", 5);
+  EXPECT_FALSE(Check(extend));
+  features.EnableAll();
+  EXPECT_TRUE(Check(extend));
+}
+
+TEST_F(ValidateCodeFusedTest, Malformed) {
+  // i32.const with a truncated immediate.
+  EXPECT_FALSE(Check(std::string("\x41\x80", 2)));
+  // f64.const with a truncated immediate.
+  EXPECT_FALSE(Check(std::string("\x44\0\0\0", 4)));
+  // Unknown opcode.
+  EXPECT_FALSE(Check(std::string("\xff\x0b", 2)));
+}
+
+TEST_F(ValidateCodeFusedTest, Context) {
+  Context context;
+  context.types.push_back(TypeEntry{FunctionType{}});
+  context.functions.push_back(Function{0});
+  context.functions.push_back(Function{0});
+  RecordErrors errors;
+  Code code{{}, Expression{SpanU8{reinterpret_cast<const u8*>("\x0b"), 1}}};
+  EXPECT_TRUE(ValidateFused(code, context, features, errors));
+  EXPECT_TRUE(ValidateFused(code, context, features, errors));
+  EXPECT_EQ(2u, context.code_count);
+  EXPECT_FALSE(ValidateFused(code, context, features, errors));
+  EXPECT_EQ(std::vector<std::string>{
+                "Unexpected code index 2, function count is 2"},
+            errors.messages);
+}
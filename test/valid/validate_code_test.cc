@@ -14,12 +14,17 @@
 // limitations under the License.
 //
 
+#include <string>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 #include "wasp/base/features.h"
 #include "wasp/valid/begin_code.h"
 #include "wasp/valid/context.h"
 #include "wasp/valid/test_utils.h"
+#include "wasp/valid/validate_code.h"
+#include "wasp/valid/validate_code_section_parallel.h"
 #include "wasp/valid/validate_locals.h"
 
 using namespace ::wasp;
@@ -58,3 +63,134 @@ TEST(ValidateCodeTest, Locals) {
   EXPECT_TRUE(
       Validate(Locals{10, ValueType::I32}, context, Features{}, errors));
 }
+
+TEST(ValidateCodeTest, Locals_Large) {
+  Context context;
+  TestErrors errors;
+  // Only the declarations are stored, not one entry per local.
+  Features features;
+  EXPECT_TRUE(
+      Validate(Locals{0x7fffffff, ValueType::I32}, context, features, errors));
+  EXPECT_TRUE(
+      Validate(Locals{0x7fffffff, ValueType::F64}, context, features, errors));
+  EXPECT_EQ(0xfffffffeu, context.locals.GetCount());
+  EXPECT_EQ(ValueType::I32, context.locals.GetType(0x7ffffffe));
+  EXPECT_EQ(ValueType::F64, context.locals.GetType(0x7fffffff));
+  EXPECT_EQ(nullopt, context.locals.GetType(0xfffffffe));
+}
+
+namespace {
+
+class RecordErrors : public valid::Errors {
+ public:
+  std::vector<std::string> messages;
+
+ protected:
+  void HandlePushContext(string_view desc) {}
+  void HandlePopContext() {}
+  void HandleOnError(string_view message) {
+    messages.push_back(message.to_string());
+  }
+};
+
+Code MakeCode(const char* body, size_t size) {
+  return Code{{}, Expression{SpanU8{reinterpret_cast<const u8*>(body),
+                                    static_cast<SpanU8::index_type>(size)}}};
+}
+
+Context MakeContext(Index function_count) {
+  Context context;
+  context.types.push_back(TypeEntry{FunctionType{}});
+  for (Index i = 0; i < function_count; ++i) {
+    context.functions.push_back(Function{0});
+  }
+  return context;
+}
+
+}  // namespace
+
+TEST(ValidateCodeTest, Locals_TooMany) {
+  Context context;
+  RecordErrors errors;
+  Features features;
+  EXPECT_TRUE(
+      Validate(Locals{0xffffffff, ValueType::I32}, context, features, errors));
+  EXPECT_FALSE(Validate(Locals{1, ValueType::I32}, context, features, errors));
+  EXPECT_EQ(0xffffffffu, context.locals.GetCount());
+  EXPECT_EQ(std::vector<std::string>{"Too many locals; max is 4294967295, got "
+                                     "4294967296"},
+            errors.messages);
+}
+
+TEST(ValidateCodeTest, Code) {
+  Context context = MakeContext(1);
+  TestErrors errors;
+  EXPECT_TRUE(Validate(MakeCode("\x01\x0b", 2), context, Features{}, errors));
+  EXPECT_EQ(1u, context.code_count);
+}
+
+TEST(ValidateCodeTest, Code_MissingEnd) {
+  Context context = MakeContext(1);
+  RecordErrors errors;
+  EXPECT_FALSE(Validate(MakeCode("\x01", 1), context, Features{}, errors));
+  EXPECT_EQ(std::vector<std::string>{"Expected end of function"},
+            errors.messages);
+}
+
+TEST(ValidateCodeTest, Code_IndexOOBAfterReuse) {
+  Context module = MakeContext(1);
+  FunctionContext function;
+  RecordErrors errors;
+  // A valid function, then one that is missing its end and leaves its labels
+  // behind.
+  EXPECT_TRUE(Validate(MakeCode("\x01\x0b", 2), 0, module, function,
+                       Features{}, errors));
+  EXPECT_FALSE(
+      Validate(MakeCode("\x01", 1), 0, module, function, Features{}, errors));
+  errors.messages.clear();
+
+  // The out-of-range index is the only error; the body isn't validated
+  // against the previous function's frame.
+  EXPECT_FALSE(Validate(MakeCode("\x1a\x0b", 2), 1, module, function,
+                        Features{}, errors));
+  EXPECT_EQ(std::vector<std::string>{"Unexpected code index 1, function "
+                                     "count is 1"},
+            errors.messages);
+  EXPECT_TRUE(function.label_stack.empty());
+  EXPECT_EQ(0u, function.locals.GetCount());
+}
+
+TEST(ValidateCodeTest, CodeSectionParallel) {
+  std::vector<Code> codes;
+  for (int i = 0; i < 20; ++i) {
+    if (i % 5 == 1) {
+      // i32.const 0; end
+      codes.push_back(MakeCode("\x41\x00\x0b", 3));
+    } else if (i % 5 == 3) {
+      // drop; end
+      codes.push_back(MakeCode("\x1a\x0b", 2));
+    } else {
+      // nop; end
+      codes.push_back(MakeCode("\x01\x0b", 2));
+    }
+  }
+
+  Context sequential_context = MakeContext(codes.size());
+  RecordErrors sequential_errors;
+  bool sequential_valid = true;
+  for (const auto& code : codes) {
+    sequential_valid &=
+        Validate(code, sequential_context, Features{}, sequential_errors);
+  }
+
+  for (unsigned thread_count : {1, 2, 4, 16}) {
+    Context context = MakeContext(codes.size());
+    RecordErrors errors;
+    EXPECT_FALSE(ValidateCodeSectionParallel(codes, context, Features{},
+                                             errors, thread_count));
+    EXPECT_FALSE(sequential_valid);
+    EXPECT_EQ(sequential_errors.messages, errors.messages);
+    EXPECT_EQ(8u, errors.messages.size());
+    EXPECT_EQ(codes.size(), context.code_count);
+  }
+}
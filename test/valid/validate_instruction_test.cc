@@ -79,7 +79,8 @@ class ValidateInstructionTest : public ::testing::Test {
   }
 
   Index AddLocal(const ValueType& value_type) {
-    return AddItem(context.locals, value_type);
+    context.locals.Append(1, value_type);
+    return context.locals.GetCount() - 1;
   }
 
   void Ok(const Instruction& instruction) {
@@ -190,6 +191,29 @@ TEST_F(ValidateInstructionTest, Loop_SingleResult) {
   }
 }
 
+TEST_F(ValidateInstructionTest, Block_Nested) {
+  const size_t count = sizeof(all_value_types) / sizeof(all_value_types[0]);
+  auto nest = [&]() {
+    for (const auto& info : all_value_types) {
+      Ok(I{O::Block, info.block_type});
+    }
+    EXPECT_EQ(count, context.label_types.size());
+    for (size_t i = count; i-- > 0;) {
+      EXPECT_EQ(all_value_types[i].value_type, context.label_types.back());
+      Ok(all_value_types[i].instruction);
+      Ok(I{O::End});
+      Ok(I{O::Drop});
+    }
+    EXPECT_EQ(0u, context.label_types.size());
+  };
+
+  nest();
+  // The label types are kept in one buffer that is reused, not reallocated.
+  auto capacity = context.label_types.capacity();
+  nest();
+  EXPECT_EQ(capacity, context.label_types.capacity());
+}
+
 TEST_F(ValidateInstructionTest, If_End_Void) {
   Ok(I{O::I32Const, s32{}});
   Ok(I{O::If, BlockType::Void});
@@ -487,27 +511,30 @@ TEST_F(ValidateInstructionTest, BrIf_Loop_SingleResult) {
 }
 
 TEST_F(ValidateInstructionTest, BrTable_Void) {
+  const BrTableTargetsBuffer targets{0, 0, 0};
   Ok(I{O::I32Const, s32{}});
-  Ok(I{O::BrTable, BrTableImmediate{{0, 0, 0}, 0}});
+  Ok(I{O::BrTable, BrTableImmediate{targets.targets(), 0}});
 }
 
 TEST_F(ValidateInstructionTest, BrTable_MultiDepth_Void) {
+  const BrTableTargetsBuffer targets{0, 1, 2, 3};
   Ok(I{O::Block, BlockType::Void});  // 3
   Ok(I{O::Block, BlockType::Void});  // 2
   Ok(I{O::Block, BlockType::Void});  // 1
   Ok(I{O::Block, BlockType::Void});  // 0
   Ok(I{O::I32Const, s32{}});
-  Ok(I{O::BrTable, BrTableImmediate{{0, 1, 2, 3}, 4}});
+  Ok(I{O::BrTable, BrTableImmediate{targets.targets(), 4}});
 }
 
 TEST_F(ValidateInstructionTest, BrTable_MultiDepth_SingleResult) {
+  const BrTableTargetsBuffer targets{1, 1, 1, 3};
   Ok(I{O::Block, BlockType::I32});   // 3
   Ok(I{O::Block, BlockType::Void});  // 2
   Ok(I{O::Block, BlockType::I32});   // 1
   Ok(I{O::Block, BlockType::Void});  // 0
   Ok(I{O::I32Const, s32{}});
   Ok(I{O::I32Const, s32{}});
-  Ok(I{O::BrTable, BrTableImmediate{{1, 1, 1, 3}, 3}});
+  Ok(I{O::BrTable, BrTableImmediate{targets.targets(), 3}});
 }
 
 TEST_F(ValidateInstructionTest, BrTable_Unreachable) {
@@ -528,18 +555,20 @@ TEST_F(ValidateInstructionTest, BrTable_EmptyStack) {
 }
 
 TEST_F(ValidateInstructionTest, BrTable_ValueTypeMismatch) {
+  const BrTableTargetsBuffer targets{0};
   Ok(I{O::Block, BlockType::I32});
   Ok(I{O::F32Const, f32{}});
   Ok(I{O::I32Const, s32{}});
-  Fail(I{O::BrTable, BrTableImmediate{{0}, 0}});
+  Fail(I{O::BrTable, BrTableImmediate{targets.targets(), 0}});
 }
 
 TEST_F(ValidateInstructionTest, BrTable_InconsistentLabelSignature) {
+  const BrTableTargetsBuffer targets{1};
   Ok(I{O::Block, BlockType::Void});
   Ok(I{O::Block, BlockType::I32});
   Ok(I{O::I32Const, s32{}});
   Ok(I{O::I32Const, s32{}});
-  Fail(I{O::BrTable, BrTableImmediate{{1}, 0}});
+  Fail(I{O::BrTable, BrTableImmediate{targets.targets(), 0}});
 }
 
 TEST_F(ValidateInstructionTest, Return) {
@@ -944,7 +973,8 @@ TEST_F(ValidateInstructionTest, Conversion) {
     Opcode opcode;
     ValueType to;
     ValueType from;
-  } infos[] = {{O::I32TruncF32S, VT::I32, VT::F32},
+  } infos[] = {{O::I32WrapI64, VT::I32, VT::I64},
+               {O::I32TruncF32S, VT::I32, VT::F32},
                {O::I32TruncF32U, VT::I32, VT::F32},
                {O::I32ReinterpretF32, VT::I32, VT::F32},
                {O::I32TruncF64S, VT::I32, VT::F64},